@@ -87,7 +87,7 @@ void ARAPluginDemoAudioProcessor::changeProgramName (int /*index*/, const juce::
 //==============================================================================
 void ARAPluginDemoAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    if (prepareToPlayForARA (sampleRate, samplesPerBlock, getMainBusNumOutputChannels()))
+    if (prepareToPlayForARA (sampleRate, samplesPerBlock, getMainBusNumOutputChannels(), getProcessingPrecision()))
         return;
 
     // since we're always bypassing without ARA, we do not need to handle additional ressources here
@@ -128,6 +128,17 @@ bool ARAPluginDemoAudioProcessor::isBusesLayoutSupported (const BusesLayout& lay
 #endif
 
 void ARAPluginDemoAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processBlockTemplate (buffer, midiMessages);
+}
+
+void ARAPluginDemoAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processBlockTemplate (buffer, midiMessages);
+}
+
+template <typename FloatType>
+void ARAPluginDemoAudioProcessor::processBlockTemplate (juce::AudioBuffer<FloatType>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
 
@@ -31,6 +31,9 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    bool supportsDoublePrecisionProcessing() const override     { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -57,6 +60,9 @@ public:
 
 private:
     //==============================================================================
+    template <typename FloatType>
+    void processBlockTemplate (juce::AudioBuffer<FloatType>&, juce::MidiBuffer&);
+
     juce::AudioPlayHead::CurrentPositionInfo lastPositionInfo;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ARAPluginDemoAudioProcessor)
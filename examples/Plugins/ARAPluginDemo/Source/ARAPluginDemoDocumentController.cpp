@@ -5,7 +5,7 @@
 //==============================================================================
 ARA::PlugIn::AudioModification* ARAPluginDemoDocumentController::doCreateAudioModification (ARA::PlugIn::AudioSource* audioSource, ARA::ARAAudioModificationHostRef hostRef, const ARA::PlugIn::AudioModification* optionalModificationToClone) noexcept
 {
-    return new ARAPluginDemoAudioModification (static_cast<juce::ARAAudioSource*> (audioSource), hostRef, static_cast<const juce::ARAAudioModification*> (optionalModificationToClone));
+    return new (getModelObjectPool()) ARAPluginDemoAudioModification (static_cast<juce::ARAAudioSource*> (audioSource), hostRef, static_cast<const juce::ARAAudioModification*> (optionalModificationToClone));
 }
 
 ARA::PlugIn::PlaybackRenderer* ARAPluginDemoDocumentController::doCreatePlaybackRenderer() noexcept
@@ -48,12 +48,17 @@ bool ARAPluginDemoDocumentController::doRestoreObjectsFromStream (juce::ARAInput
 
     getHostArchivingController()->notifyDocumentUnarchivingProgress (1.0f);
 
+    // restore the waveform overviews stored after the audio modification states, if any
+    // (archives written by previous versions of this plug-in end here)
+    if (! input.isExhausted() && ! getWaveformOverviewManager().restoreOverviews (input, filter))
+        return false;
+
     return ! input.failed();
 }
 
 bool ARAPluginDemoDocumentController::doStoreObjectsToStream (juce::ARAOutputStream& output, const juce::ARAStoreObjectsFilter* filter) noexcept
 {
-    // this example implementation only deals with audio modification states
+    // besides the waveform overviews below, this example implementation only deals with audio modification states
     const auto& audioModificationsToPersist{ filter->getAudioModificationsToStore<ARAPluginDemoAudioModification>() };
 
     // write the number of audio modifications we are persisting
@@ -73,6 +78,9 @@ bool ARAPluginDemoDocumentController::doStoreObjectsToStream (juce::ARAOutputStr
 
     getHostArchivingController()->notifyDocumentArchivingProgress (1.0);
 
+    // store the waveform overviews of the audio sources, so they don't need to be rebuilt when restoring
+    success = success && getWaveformOverviewManager().storeOverviews (output, filter);
+
     return success;
 }
 
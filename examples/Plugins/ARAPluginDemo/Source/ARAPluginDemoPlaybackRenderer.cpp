@@ -2,35 +2,29 @@
 #include "ARAPluginDemoAudioModification.h"
 
 //==============================================================================
-void PluginDemoPlaybackRenderer::prepareToPlay (double rate, int maxSamplesPerBlock, int numChans, bool alwaysNonRealtime)
+void PluginDemoPlaybackRenderer::prepareToPlay (double rate, int maxSamplesPerBlock, int numChans, bool alwaysNonRealtime,
+                                                juce::AudioProcessor::ProcessingPrecision precision)
 {
+    juce::ARAPlaybackRenderer::prepareToPlay (rate, maxSamplesPerBlock, numChans, alwaysNonRealtime, precision);
+
     sampleRate = rate;
     maximumSamplesPerBlock = maxSamplesPerBlock;
     numChannels = numChans;
     useBufferedAudioSourceReader = ! alwaysNonRealtime;
 
-    audioSourceReaders.clear();
-
-    for (const auto& playbackRegion : getPlaybackRegions())
-    {
-        auto audioSource = playbackRegion->getAudioModification()->getAudioSource();
-        if (audioSourceReaders.count (audioSource) == 0)
-        {
-            juce::AudioFormatReader* sourceReader = new juce::ARAAudioSourceReader (audioSource);
+    // Create a reader for each audio source we're playing back, we'll use them to pull ARA
+    // samples from the host as we render. If we're being used in real-time, the readers are
+    // buffering to avoid blocking while reading samples in processBlock.
+    prepareAudioSourceReaders();
 
-            if (useBufferedAudioSourceReader)
-            {
-                // If we're being used in real-time, wrap our source reader in a buffering
-                // reader to avoid blocking while reading samples in processBlock.
-                const int readAheadSize = juce::jmax (4 * maximumSamplesPerBlock, juce::roundToInt (2.0 * sampleRate));
-                sourceReader = new juce::BufferingAudioReader (sourceReader, *sharedTimesliceThread, readAheadSize);
-            }
+    // Regions with time stretching enabled are rendered through the time stretch stage, which uses
+    // its high quality mode if the renderer is never used in realtime.
+    timeStretchStage.prepare (numChannels, alwaysNonRealtime ? juce::ARATimeStretcher::Mode::offline
+                                                             : juce::ARATimeStretcher::Mode::realtime);
 
-            audioSourceReaders.emplace (audioSource, sourceReader);
-        }
-    }
-
-    if (getPlaybackRegions().size() > 1)
+    // In double precision, the float samples of the readers are always read into the temp buffer
+    // and then converted while mixing into the output.
+    if (getPlaybackRegions().size() > 1 || precision == juce::AudioProcessor::doublePrecision)
         tempBuffer.reset (new juce::AudioBuffer<float> (numChannels, maximumSamplesPerBlock));
     else
         tempBuffer.reset();
@@ -38,13 +32,69 @@ void PluginDemoPlaybackRenderer::prepareToPlay (double rate, int maxSamplesPerBl
 
 void PluginDemoPlaybackRenderer::releaseResources()
 {
-    audioSourceReaders.clear();
+    juce::ARAPlaybackRenderer::releaseResources();
+
+    timeStretchStage.releaseResources();
     tempBuffer.reset();
 }
 
 //==============================================================================
+// Float output buffers can be read into directly, double buffers need the temp buffer for conversion.
+static juce::AudioBuffer<float>& getReadBuffer (juce::AudioBuffer<float>& buffer, juce::AudioBuffer<float>* tempBuffer, bool needsTempBuffer)
+{
+    return needsTempBuffer ? *tempBuffer : buffer;
+}
+
+static juce::AudioBuffer<float>& getReadBuffer (juce::AudioBuffer<double>&, juce::AudioBuffer<float>* tempBuffer, bool)
+{
+    return *tempBuffer;
+}
+
+static void mixReadBuffer (juce::AudioBuffer<float>& buffer, const juce::AudioBuffer<float>& readBuffer, int startSample, int numSamples, bool addToBuffer)
+{
+    for (int c = 0; c < buffer.getNumChannels(); ++c)
+    {
+        if (addToBuffer)
+            buffer.addFrom (c, startSample, readBuffer, c, startSample, numSamples);
+        else
+            buffer.copyFrom (c, startSample, readBuffer, c, startSample, numSamples);
+    }
+}
+
+static void mixReadBuffer (juce::AudioBuffer<double>& buffer, const juce::AudioBuffer<float>& readBuffer, int startSample, int numSamples, bool addToBuffer)
+{
+    for (int c = 0; c < buffer.getNumChannels(); ++c)
+    {
+        auto* dest = buffer.getWritePointer (c, startSample);
+        auto* src = readBuffer.getReadPointer (c, startSample);
+
+        if (addToBuffer)
+            for (int i = 0; i < numSamples; ++i)
+                dest[i] += (double) src[i];
+        else
+            for (int i = 0; i < numSamples; ++i)
+                dest[i] = (double) src[i];
+    }
+}
+
 bool PluginDemoPlaybackRenderer::processBlock (juce::AudioBuffer<float>& buffer, bool isNonRealtime, const juce::AudioPlayHead::CurrentPositionInfo& positionInfo) noexcept
 {
+    return processBlockTemplate (buffer, isNonRealtime, positionInfo);
+}
+
+bool PluginDemoPlaybackRenderer::processBlock (juce::AudioBuffer<double>& buffer, bool isNonRealtime, const juce::AudioPlayHead::CurrentPositionInfo& positionInfo) noexcept
+{
+    // Rendering natively in double precision avoids converting the entire output buffer to float
+    // and back - only the samples read from the audio sources need to be converted while mixing.
+    jassert (isUsingDoublePrecision());
+    return processBlockTemplate (buffer, isNonRealtime, positionInfo);
+}
+
+template <typename FloatType>
+bool PluginDemoPlaybackRenderer::processBlockTemplate (juce::AudioBuffer<FloatType>& buffer, bool isNonRealtime, const juce::AudioPlayHead::CurrentPositionInfo& positionInfo) noexcept
+{
+    constexpr auto isDoublePrecision = std::is_same<FloatType, double>::value;
+
     const auto numSamples = buffer.getNumSamples();
     jassert (numSamples <= maximumSamplesPerBlock);
     jassert (numChannels == buffer.getNumChannels());
@@ -57,76 +107,84 @@ bool PluginDemoPlaybackRenderer::processBlock (juce::AudioBuffer<float>& buffer,
     if (isPlaying)
     {
         const auto blockRange = juce::Range<juce::int64>::withStartAndLength (timeInSamples, numSamples);
-        for (const auto& playbackRegion : getPlaybackRegions())
+        // Only visit the regions that overlap the current block, using the renderer's region index.
+        // The sample ranges and readers of the regions have been resolved when the regions changed,
+        // and the timeout of the buffering readers is adjusted to isNonRealtime as needed.
+        forEachPreparedPlaybackRegionOverlapping (blockRange, isNonRealtime, [&] (const PreparedPlaybackRegion& preparedRegion)
         {
             // Evaluate region borders in song time, calculate sample range to render in song time.
-            // Note that this example does not use head- or tailtime, so the includeHeadAndTail
-            // parameter is set to false here - this might need to be adjusted in actual plug-ins.
-            const auto playbackSampleRange = playbackRegion->getSampleRange (sampleRate, false);
+            // Note that this example does not use head- or tailtime, so the range excluding head and
+            // tail is used here - this might need to be adjusted in actual plug-ins.
+            const auto& playbackSampleRange = preparedRegion.playbackSampleRange;
             auto renderRange = blockRange.getIntersectionWith (playbackSampleRange);
             if (renderRange.isEmpty())
-                continue;
+                return;
 
-            // Evaluate region borders in modification/source time and calculate offset between
-            // song and source samples, then clip song samples accordingly
-            // (if an actual plug-in supports time stretching, this must be taken into account here).
-            juce::Range<juce::int64> modificationSampleRange { playbackRegion->getStartInAudioModificationSamples(), playbackRegion->getEndInAudioModificationSamples() };
-            const auto modificationSampleOffset = modificationSampleRange.getStart() - playbackSampleRange.getStart();
-
-            renderRange = renderRange.getIntersectionWith (modificationSampleRange.movedToStartAt (playbackSampleRange.getStart()));
-            if (renderRange.isEmpty())
-                continue;
-
-            // Get the audio source for the region and find the reader for that source.
-            // This simplified example code only produces audio if sample rate and channel count match -
-            // proper plug-in would need to do conversion, see ARA SDK documentation.
-            const auto audioSource = playbackRegion->getAudioModification()->getAudioSource();
-            const auto readerIt = audioSourceReaders.find (audioSource);
-            if ((audioSource->getChannelCount() != numChannels) ||
-                (audioSource->getSampleRate() != sampleRate) ||
-                (readerIt == audioSourceReaders.end()))
+            // Unless the region is time stretched, clip song samples to the region borders in modification/source time.
+            const bool isStretched = juce::ARATimeStretchStage::needsStretching (preparedRegion);
+            if (! isStretched)
             {
-                success = false;
-                continue;
+                renderRange = renderRange.getIntersectionWith (preparedRegion.modificationSampleRange.movedToStartAt (playbackSampleRange.getStart()));
+                if (renderRange.isEmpty())
+                    return;
             }
-            const auto& reader = readerIt->second;
 
-            // If we're using a buffering reader, set the appropriate timeout.
-            if (useBufferedAudioSourceReader)
+            // The prepared readers convert the sample rate and channel count of the audio source to the
+            // render format as needed, and the modification sample range and offset take this into account.
+            const auto reader = preparedRegion.reader;
+            if (reader == nullptr)
             {
-                jassert (dynamic_cast<juce::BufferingAudioReader*> (reader.get()) != nullptr);
-                auto bufferingReader = static_cast<juce::BufferingAudioReader*> (reader.get());
-                bufferingReader->setReadTimeout (isNonRealtime ? 100 : 0);
+                success = false;
+                return;
             }
 
             // Calculate buffer offsets and handle reverse playback setting.
             const int numSamplesToRead = (int) renderRange.getLength();
             const int startInBuffer = (int) (renderRange.getStart() - blockRange.getStart());
-            auto startInSource = renderRange.getStart() + modificationSampleOffset;
-            const bool playReversed = playbackRegion->getAudioModification<ARAPluginDemoAudioModification>()->getReversePlayback();
-            if (playReversed)
-                startInSource = audioSource->getSampleCount() - startInSource - numSamplesToRead;
+            const bool playReversed = preparedRegion.playbackRegion->getAudioModification<ARAPluginDemoAudioModification>()->getReversePlayback();
 
             // Read samples:
-            // first region can write directly into output, later regions need to use local buffer.
-            auto& readBuffer = (didRenderAnyRegion) ? *tempBuffer : buffer;
-            if (! reader->read (&readBuffer, startInBuffer, numSamplesToRead, startInSource, true, true))
+            // first region can write directly into float output, later regions need to use local buffer.
+            auto& readBuffer = getReadBuffer (buffer, tempBuffer.get(), didRenderAnyRegion);
+            if (isStretched)
             {
-                success = false;
-                continue;
+                // The stage maps the song samples to the modification samples according to the stretch
+                // factor, and caches the stretched samples so that they're not stretched again when
+                // playing back the region again.
+                if (! timeStretchStage.renderPlaybackRegion (preparedRegion, readBuffer, startInBuffer, renderRange.getStart(),
+                                                             numSamplesToRead, 1.0, playReversed))
+                {
+                    success = false;
+                    return;
+                }
+            }
+            else
+            {
+                auto startInSource = renderRange.getStart() + preparedRegion.modificationSampleOffset;
+                if (playReversed)
+                    startInSource = reader->lengthInSamples - startInSource - numSamplesToRead;
+
+                if (! reader->read (&readBuffer, startInBuffer, numSamplesToRead, startInSource, true, true))
+                {
+                    success = false;
+                    return;
+                }
+
+                if (playReversed)
+                    readBuffer.reverse (startInBuffer, numSamplesToRead);
             }
-
-            if (playReversed)
-                readBuffer.reverse (startInBuffer, numSamplesToRead);
 
             if (didRenderAnyRegion)
             {
                 // Mix local buffer into the output buffer.
-                for (int c = 0; c < numChannels; ++c)
-                    buffer.addFrom (c, startInBuffer, *tempBuffer, c, startInBuffer, numSamplesToRead);
+                mixReadBuffer (buffer, *tempBuffer, startInBuffer, numSamplesToRead, true);
             }
             else
             {
+                // Convert local buffer into the output buffer.
+                if (isDoublePrecision)
+                    mixReadBuffer (buffer, *tempBuffer, startInBuffer, numSamplesToRead, false);
+
                 // Clear any excess at start or end of the region.
                 if (startInBuffer != 0)
                     buffer.clear (0, startInBuffer);
@@ -138,7 +196,7 @@ bool PluginDemoPlaybackRenderer::processBlock (juce::AudioBuffer<float>& buffer,
 
                 didRenderAnyRegion = true;
             }
-        }
+        });
     }
 
     // If no playback or no region did intersect, clear buffer now.
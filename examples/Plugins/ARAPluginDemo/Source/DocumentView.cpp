@@ -57,15 +57,19 @@ DocumentView::~DocumentView()
 }
 
 //==============================================================================
-void DocumentView::onNewSelection (const juce::ARAViewSelection& /*viewSelection*/)
+void DocumentView::onSelectionChanged (const juce::ARAEditorView::SelectionChange& change)
 {
-    if (showOnlySelectedRegionSequences)
+    // the effective region sequences can only change if the selected regions or sequences change
+    if (showOnlySelectedRegionSequences
+        && ! (change.addedPlaybackRegions.empty() && change.removedPlaybackRegions.empty()
+              && change.addedRegionSequences.empty() && change.removedRegionSequences.empty()))
         invalidateRegionSequenceViewContainers();
 
-    timeRangeSelectionView.repaint();
+    if (change.timeRangeChanged)
+        timeRangeSelectionView.repaint();
 }
 
-void DocumentView::onHideRegionSequences (std::vector<juce::ARARegionSequence*> const& /*regionSequences*/)
+void DocumentView::onHiddenRegionSequencesChanged (const juce::ARAEditorView::HiddenRegionSequencesChange& /*change*/)
 {
     if (! showOnlySelectedRegionSequences)
         invalidateRegionSequenceViewContainers();
@@ -230,7 +234,7 @@ void DocumentView::rebuildRegionSequenceViewContainers()
     else    // show all RegionSequences of Document...
     {
         for (auto regionSequence : getDocument()->getRegionSequences())
-            if (! ARA::contains (getARAEditorView()->getHiddenRegionSequences(), regionSequence))
+            if (! getARAEditorView()->isHidden (regionSequence))
                 regionSequenceViewContainers.add (new RegionSequenceViewContainer (*this, regionSequence));
     }
 
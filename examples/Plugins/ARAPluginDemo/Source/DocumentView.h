@@ -21,8 +21,8 @@ public:
     ~DocumentView() override;
 
     // ARAEditorView::Listener overrides
-    void onNewSelection (const juce::ARAViewSelection& viewSelection) override;
-    void onHideRegionSequences (std::vector<juce::ARARegionSequence*> const& regionSequences) override;
+    void onSelectionChanged (const juce::ARAEditorView::SelectionChange& change) override;
+    void onHiddenRegionSequencesChanged (const juce::ARAEditorView::HiddenRegionSequencesChange& change) override;
 
     // ARADocument::Listener overrides
     void didEndEditing (juce::ARADocument* document) override;
@@ -64,8 +64,6 @@ public:
     juce::Viewport& getRegionSequenceHeadersViewport() { return regionSequenceHeadersViewport; }
     juce::Viewport& getMusicalContextViewport() { return musicalContextViewport; }
 
-    juce::AudioFormatManager& getAudioFormatManger() { return audioFormatManger; }
-
     const juce::AudioPlayHead::CurrentPositionInfo& getPlayHeadPositionInfo() const { return positionInfo; }
 
     // juce::Component overrides
@@ -133,8 +131,6 @@ private:
     juce::Viewport musicalContextViewport;
     MusicalContextView musicallContextView;
 
-    juce::AudioFormatManager audioFormatManger;
-
     // Component View States
     bool scrollFollowsPlayHead { true };
     bool showOnlySelectedRegionSequences { true };
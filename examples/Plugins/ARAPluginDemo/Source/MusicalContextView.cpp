@@ -2,7 +2,6 @@
 #include "DocumentView.h"
 
 #include "ARA_Library/Utilities/ARAPitchInterpretation.h"
-#include "ARA_Library/Utilities/ARATimelineConversion.h"
 
 //==============================================================================
 MusicalContextView::MusicalContextView (DocumentView& docView)
@@ -95,8 +94,7 @@ void MusicalContextView::paint (juce::Graphics& g)
     }
 
     const auto visibleRange = documentView.getVisibleTimeRange();
-    const ARA::PlugIn::HostContentReader<ARA::kARAContentTypeTempoEntries> tempoReader (musicalContext);
-    const ARA::TempoConverter<decltype (tempoReader)> tempoConverter (tempoReader);
+    const auto& tempoMap = musicalContext->getTempoMap();
 
     // we'll draw three rulers: seconds, beats, and chords
     constexpr int lightLineWidth = 1;
@@ -124,33 +122,28 @@ void MusicalContextView::paint (juce::Graphics& g)
     g.drawText ("seconds", bounds.withTrimmedRight (2), juce::Justification::bottomRight);
 
     // beat ruler: evaluates tempo and bar signatures to draw a line for each beat
-    if (tempoReader)
+    if (tempoMap.hasTempoEntries() && tempoMap.hasBarSignatures())
     {
-        const ARA::PlugIn::HostContentReader<ARA::kARAContentTypeBarSignatures> barSignaturesReader (musicalContext);
-        const ARA::BarSignaturesConverter<decltype (barSignaturesReader)> barSignaturesConverter (barSignaturesReader);
-        if (barSignaturesReader)
+        juce::RectangleList<int> rects;
+        const double beatStart = tempoMap.getBeatForQuarter (tempoMap.getQuarterForTime (visibleRange.getStart()));
+        const double beatEnd = tempoMap.getBeatForQuarter (tempoMap.getQuarterForTime (visibleRange.getEnd()));
+        const int endBeat = juce::roundToInt (floor (beatEnd));
+        for (int beat = juce::roundToInt (ceil (beatStart)); beat <= endBeat; ++beat)
         {
-            juce::RectangleList<int> rects;
-            const double beatStart = barSignaturesConverter.getBeatForQuarter (tempoConverter.getQuarterForTime (visibleRange.getStart()));
-            const double beatEnd = barSignaturesConverter.getBeatForQuarter (tempoConverter.getQuarterForTime (visibleRange.getEnd()));
-            const int endBeat = juce::roundToInt (floor (beatEnd));
-            for (int beat = juce::roundToInt (ceil (beatStart)); beat <= endBeat; ++beat)
-            {
-                const auto quarterPos = barSignaturesConverter.getQuarterForBeat (beat);
-                const int x = documentView.getPlaybackRegionsViewsXForTime (tempoConverter.getTimeForQuarter (quarterPos));
-                const auto barSignature = barSignaturesConverter.getBarSignatureForQuarter (quarterPos);
-                const int lineWidth = (quarterPos == barSignature.position) ? heavyLineWidth : lightLineWidth;
-                const int beatsSinceBarStart = juce::roundToInt( barSignaturesConverter.getBeatDistanceFromBarStartForQuarter (quarterPos));
-                const int lineHeight = (beatsSinceBarStart == 0) ? beatsRulerHeight : beatsRulerHeight / 2;
-                rects.addWithoutMerging (juce::Rectangle<int> (x - lineWidth / 2, beatsRulerY + beatsRulerHeight - lineHeight, lineWidth, lineHeight));
-            }
-            g.fillRectList (rects);
+            const auto quarterPos = tempoMap.getQuarterForBeat (beat);
+            const int x = documentView.getPlaybackRegionsViewsXForTime (tempoMap.getTimeForQuarter (quarterPos));
+            const auto barSignature = tempoMap.getBarSignatureForQuarter (quarterPos);
+            const int lineWidth = (quarterPos == barSignature.quarterPosition) ? heavyLineWidth : lightLineWidth;
+            const int beatsSinceBarStart = juce::roundToInt( tempoMap.getBeatDistanceFromBarStartForQuarter (quarterPos));
+            const int lineHeight = (beatsSinceBarStart == 0) ? beatsRulerHeight : beatsRulerHeight / 2;
+            rects.addWithoutMerging (juce::Rectangle<int> (x - lineWidth / 2, beatsRulerY + beatsRulerHeight - lineHeight, lineWidth, lineHeight));
         }
+        g.fillRectList (rects);
     }
     g.drawText ("beats", bounds.withTrimmedRight (2).withTrimmedBottom (secondsRulerHeight), juce::Justification::bottomRight);
 
     // chord ruler: one rect per chord, skipping empty "no chords"
-    if (tempoReader)
+    if (tempoMap.hasTempoEntries())
     {
         juce::RectangleList<int> rects;
         const ARA::ChordInterpreter interpreter (true);
@@ -165,7 +158,7 @@ void MusicalContextView::paint (juce::Graphics& g)
             
             // find the starting position of the chord in pixels
             const auto chordStartTime = (itChord == chordsReader.begin()) ?
-                                            documentView.getTimeRange().getStart() : tempoConverter.getTimeForQuarter (itChord->position);
+                                            documentView.getTimeRange().getStart() : tempoMap.getTimeForQuarter (itChord->position);
             if (chordStartTime >= visibleRange.getEnd())
                 break;
             chordRect.setLeft (documentView.getPlaybackRegionsViewsXForTime (chordStartTime));
@@ -173,7 +166,7 @@ void MusicalContextView::paint (juce::Graphics& g)
             // if we have a chord after this one, use its starting position to end our rect
             if (std::next (itChord) != chordsReader.end())
             {
-                const auto nextChordStartTime = tempoConverter.getTimeForQuarter (std::next (itChord)->position);
+                const auto nextChordStartTime = tempoMap.getTimeForQuarter (std::next (itChord)->position);
                 if (nextChordStartTime < visibleRange.getStart())
                     continue;
                 chordRect.setRight (documentView.getPlaybackRegionsViewsXForTime (nextChordStartTime));
@@ -189,8 +182,8 @@ void MusicalContextView::paint (juce::Graphics& g)
     // locators
     {
         lastPaintedPosition = documentView.getPlayHeadPositionInfo();
-        const auto startInSeconds = tempoConverter.getTimeForQuarter (lastPaintedPosition.ppqLoopStart);
-        const auto endInSeconds = tempoConverter.getTimeForQuarter (lastPaintedPosition.ppqLoopEnd);
+        const auto startInSeconds = tempoMap.getTimeForQuarter (lastPaintedPosition.ppqLoopStart);
+        const auto endInSeconds = tempoMap.getTimeForQuarter (lastPaintedPosition.ppqLoopEnd);
         const int startX = documentView.getPlaybackRegionsViewsXForTime (startInSeconds);
         const int endX = documentView.getPlaybackRegionsViewsXForTime (endInSeconds);
         g.setColour (lastPaintedPosition.isLooping ? juce::Colours::skyblue.withAlpha (0.3f) : juce::Colours::grey.withAlpha (0.3f));
@@ -8,19 +8,20 @@ PlaybackRegionView::PlaybackRegionView (RegionSequenceViewContainer& viewContain
     : regionSequenceViewContainer (viewContainer),
       documentView (regionSequenceViewContainer.getDocumentView()),
       playbackRegion (region),
-      audioThumb (128, documentView.getAudioFormatManger(), *sharedAudioThumbnailCache)
+      waveformOverview (playbackRegion->getDocumentController<juce::ARADocumentController>()->getWaveformOverviewManager()
+                            .getOverview (playbackRegion->getAudioModification()->getAudioSource()))
 {
-    audioThumb.addChangeListener (this);
+    waveformOverview.addChangeListener (this);
 
     documentView.getARAEditorView()->addListener (this);
-    onNewSelection (documentView.getARAEditorView()->getViewSelection());
+    setSelected (documentView.getARAEditorView()->getSelectionSnapshot()->isSelected (playbackRegion));
 
     playbackRegion->getRegionSequence()->getDocument()->addListener (this);
     playbackRegion->getAudioModification()->addListener (this);
     playbackRegion->getAudioModification()->getAudioSource()->addListener (this);
     playbackRegion->addListener (this);
 
-    recreatePlaybackRegionReader();
+    updateTooltip();
 }
 
 PlaybackRegionView::~PlaybackRegionView()
@@ -32,8 +33,7 @@ PlaybackRegionView::~PlaybackRegionView()
     playbackRegion->getAudioModification()->getAudioSource()->removeListener (this);
     playbackRegion->getRegionSequence()->getDocument()->removeListener (this);
 
-    destroyPlaybackRegionReader();
-    audioThumb.removeChangeListener (this);
+    waveformOverview.removeChangeListener (this);
 }
 
 void PlaybackRegionView::mouseDoubleClick (const juce::MouseEvent& /*event*/)
@@ -74,25 +74,22 @@ void PlaybackRegionView::paint (juce::Graphics& g)
     g.setColour (regionColour);
     g.fillRect (rect);
 
-    auto audioModification = playbackRegion->getAudioModification<ARAPluginDemoAudioModification>();
-    if (audioModification->getAudioSource()->isSampleAccessEnabled())
+    auto clipBounds = g.getClipBounds();
+    if (clipBounds.getWidth() > 0)
     {
-        auto clipBounds = g.getClipBounds();
-        if (clipBounds.getWidth() > 0)
-        {
-            const auto convertedBounds = clipBounds + getBoundsInParent().getPosition();
-            const double startTime = documentView.getPlaybackRegionsViewsTimeForX (convertedBounds.getX());
-            const double endTime = documentView.getPlaybackRegionsViewsTimeForX (convertedBounds.getRight());
-
-            const auto regionTimeRange = getTimeRange();
-
-            auto drawBounds = getBounds() - getPosition();
-            drawBounds.setHorizontalRange (clipBounds.getHorizontalRange());
-            g.setColour (regionColour.contrasting (0.7f));
-            audioThumb.drawChannels (g, drawBounds, startTime - regionTimeRange.getStart(), endTime - regionTimeRange.getStart(), 1.0f);
-        }
+        const auto convertedBounds = clipBounds + getBoundsInParent().getPosition();
+        const double startTime = documentView.getPlaybackRegionsViewsTimeForX (convertedBounds.getX());
+        const double endTime = documentView.getPlaybackRegionsViewsTimeForX (convertedBounds.getRight());
+
+        auto drawBounds = getBounds() - getPosition();
+        drawBounds.setHorizontalRange (clipBounds.getHorizontalRange());
+        g.setColour (regionColour.contrasting (0.7f));
+        drawWaveform (g, drawBounds, { startTime, endTime });
     }
-    else
+
+    // the overview remains available while access is disabled, unless it hasn't been built completely
+    auto audioModification = playbackRegion->getAudioModification<ARAPluginDemoAudioModification>();
+    if (! audioModification->getAudioSource()->isSampleAccessEnabled() && ! waveformOverview.isFullyBuilt())
     {
         g.setColour (regionColour.contrasting (1.0f));
         g.setFont (juce::Font (12.0f));
@@ -106,16 +103,67 @@ void PlaybackRegionView::paint (juce::Graphics& g)
     g.drawText ((audioModification->getReversePlayback() ? "<==" : "==>"), rect, juce::Justification::bottomLeft);
 }
 
+void PlaybackRegionView::drawWaveform (juce::Graphics& g, juce::Rectangle<int> drawBounds, juce::Range<double> playbackTimeRange)
+{
+    const auto numChannels = waveformOverview.getNumChannels();
+    const auto numPixels = drawBounds.getWidth();
+    if (numChannels <= 0 || numPixels <= 0 || playbackRegion->getDurationInPlaybackTime() <= 0.0)
+        return;
+
+    // map the playback time range into the audio modification, and from there into the audio source
+    const auto timeScale = playbackRegion->getDurationInAudioModificationTime() / playbackRegion->getDurationInPlaybackTime();
+    const auto toModificationTime = [&] (double playbackTime)
+    {
+        return playbackRegion->getStartInAudioModificationTime() + (playbackTime - playbackRegion->getStartInPlaybackTime()) * timeScale;
+    };
+
+    juce::Range<double> sourceTimeRange { toModificationTime (playbackTimeRange.getStart()), toModificationTime (playbackTimeRange.getEnd()) };
+
+    // reverse playback mirrors the audio source, see PluginDemoPlaybackRenderer::processBlock()
+    const bool playReversed = playbackRegion->getAudioModification<ARAPluginDemoAudioModification>()->getReversePlayback();
+    if (playReversed)
+    {
+        const auto sourceDuration = (double) waveformOverview.getLengthInSamples() / waveformOverview.getSampleRate();
+        sourceTimeRange = { sourceDuration - sourceTimeRange.getEnd(), sourceDuration - sourceTimeRange.getStart() };
+    }
+
+    waveformBins.resize ((size_t) numPixels);
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        const auto channelBounds = drawBounds.toFloat().withTrimmedTop ((float) drawBounds.getHeight() * (float) c / (float) numChannels)
+                                                       .withHeight ((float) drawBounds.getHeight() / (float) numChannels);
+        const auto centreY = channelBounds.getCentreY();
+        const auto halfHeight = channelBounds.getHeight() * 0.5f;
+
+        waveformOverview.getBins (c, sourceTimeRange, waveformBins.data(), numPixels);
+        if (playReversed)
+            std::reverse (waveformBins.begin(), waveformBins.end());
+
+        for (int x = 0; x < numPixels; ++x)
+        {
+            const auto& bin = waveformBins[(size_t) x];
+            const auto top = centreY - juce::jlimit (-1.0f, 1.0f, bin.maxValue) * halfHeight;
+            const auto bottom = centreY - juce::jlimit (-1.0f, 1.0f, bin.minValue) * halfHeight;
+            g.fillRect ((float) (drawBounds.getX() + x), top, 1.0f, juce::jmax (1.0f, bottom - top));
+        }
+    }
+}
+
 //==============================================================================
 void PlaybackRegionView::changeListenerCallback (juce::ChangeBroadcaster* /*broadcaster*/)
 {
-    // our thumb nail has changed
+    // our waveform overview has been (re)built
     repaint();
 }
 
-void PlaybackRegionView::onNewSelection (const juce::ARAViewSelection& viewSelection)
+void PlaybackRegionView::onSelectionChanged (const juce::ARAEditorView::SelectionChange& change)
+{
+    setSelected (change.currentSelection.isSelected (playbackRegion));
+}
+
+void PlaybackRegionView::setSelected (bool selected)
 {
-    bool selected = ARA::contains (viewSelection.getPlaybackRegions(), playbackRegion);
     if (selected != isSelected)
     {
         isSelected = selected;
@@ -125,29 +173,18 @@ void PlaybackRegionView::onNewSelection (const juce::ARAViewSelection& viewSelec
 
 void PlaybackRegionView::didEndEditing (juce::ARADocument* /*document*/)
 {
-    // our reader will pick up any changes in audio samples or region time range
-    if (playbackRegionReader ==  nullptr || ! playbackRegionReader->isValid())
+    // the region time range may have changed, which only requires redrawing it from the overview
+    if (needsBoundsUpdate)
     {
-        recreatePlaybackRegionReader();
+        needsBoundsUpdate = false;
         updateBounds();
         repaint();
     }
 }
 
-void PlaybackRegionView::willEnableAudioSourceSamplesAccess (juce::ARAAudioSource* /*audioSource*/, bool enable)
+void PlaybackRegionView::didEnableAudioSourceSamplesAccess (juce::ARAAudioSource* /*audioSource*/, bool /*enable*/)
 {
-    // AudioThumbnail does not handle "pausing" access, so we clear it if any data is still pending, and recreate it when access is reenabled
-    if (! enable && ! audioThumb.isFullyLoaded())
-        destroyPlaybackRegionReader();
-}
-
-void PlaybackRegionView::didEnableAudioSourceSamplesAccess (juce::ARAAudioSource* /*audioSource*/, bool enable)
-{
-    // check whether we need to recreate the thumb data because it hadn't been loaded completely when access was disabled
-    // (if we're inside a host edit cycle, we'll wait until it has completed to catch all changes in one update)
-    if (enable && playbackRegionReader == nullptr && ! playbackRegion->getDocumentController()->isHostEditingDocument())
-        recreatePlaybackRegionReader();
-
+    // the overview manager resumes building the overview, we only need to update the "Access Disabled" state
     repaint();
 }
 
@@ -173,43 +210,24 @@ void PlaybackRegionView::willUpdatePlaybackRegionProperties (juce::ARAPlaybackRe
         documentView.invalidateTimeRange();
 }
 
-void PlaybackRegionView::didUpdatePlaybackRegionContent (juce::ARAPlaybackRegion* /*playbackRegion*/, juce::ARAContentUpdateScopes scopeFlags)
+void PlaybackRegionView::didUpdatePlaybackRegionProperties (juce::ARAPlaybackRegion* /*playbackRegion*/)
 {
-    // Our reader catches this too, but we only check for its validity after host edits.
-    // If the update is triggered inside the plug-in, we need to update the view from this call
-    // (unless we're within a host edit already).
-    if (scopeFlags.affectSamples() && ! playbackRegion->getDocumentController()->isHostEditingDocument())
-    {
-        recreatePlaybackRegionReader();
-        repaint();
-    }
+    // region properties are only changed by the host, so we defer updating our bounds until its edit cycle has ended
+    needsBoundsUpdate = true;
+    updateTooltip();
 }
 
-//==============================================================================
-void PlaybackRegionView::destroyPlaybackRegionReader()
+void PlaybackRegionView::didUpdatePlaybackRegionContent (juce::ARAPlaybackRegion* /*playbackRegion*/, juce::ARAContentUpdateScopes scopeFlags)
 {
-    if (playbackRegionReader == nullptr)
-        return;
-
-    sharedAudioThumbnailCache->removeThumb (reinterpret_cast<intptr_t> (playbackRegionReader));
-    audioThumb.clear();
-    playbackRegionReader = nullptr;
+    // changes of the audio source samples are picked up by the overview, but e.g. toggling
+    // the reverse playback of the audio modification only affects how we draw the overview
+    if (scopeFlags.affectSamples())
+        repaint();
 }
 
-void PlaybackRegionView::recreatePlaybackRegionReader()
+//==============================================================================
+void PlaybackRegionView::updateTooltip()
 {
-    destroyPlaybackRegionReader();
-
-    // Create a playback region reader for our region for our audio thumb
-    playbackRegionReader = new juce::ARAPlaybackRegionReader (playbackRegion);
-    audioThumb.setReader (playbackRegionReader, reinterpret_cast<intptr_t> (playbackRegionReader));
-
-    // TODO JUCE_ARA see juce_AudioThumbnail.cpp, line 122: AudioThumbnail handles zero-length sources
-    // by deleting the reader, therefore we must clear our "weak" pointer to the reader in this case.
-    if (playbackRegionReader->lengthInSamples <= 0)
-        playbackRegionReader = nullptr;
-
-    // Update tooltip whenever updating the reader
     setTooltip ("Playback range " + juce::String (playbackRegion->getStartInPlaybackTime(), 3) + " .. " + juce::String (playbackRegion->getEndInPlaybackTime(), 3) + juce::newLine +
                 "Audio Modification range " + juce::String (playbackRegion->getStartInAudioModificationTime(), 3) + " .. " + juce::String (playbackRegion->getEndInAudioModificationTime(), 3));
 }
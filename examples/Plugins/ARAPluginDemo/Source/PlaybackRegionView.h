@@ -8,6 +8,10 @@
     PlaybackRegionView
     JUCE component used to display ARA playback regions
     along with their output waveform, name, color, and selection state
+
+    The waveform is drawn from the overview of the underlying audio source that is maintained by
+    the document controller's ARAWaveformOverviewManager, mapping the visible part of the region
+    into the audio source, so moving or trimming the region does not require reading any samples.
 */
 class PlaybackRegionView  : public juce::Component,
                             public juce::SettableTooltipClient,
@@ -35,13 +39,12 @@ public:
     void changeListenerCallback (juce::ChangeBroadcaster*) override;
 
     // ARAEditorView::Listener overrides
-    void onNewSelection (const juce::ARAViewSelection& viewSelection) override;
+    void onSelectionChanged (const juce::ARAEditorView::SelectionChange& change) override;
 
-    // ARADocument::Listener overrides: used to check if our reader has been invalidated
+    // ARADocument::Listener overrides: used to update our bounds after the host has edited our region
     void didEndEditing (juce::ARADocument* document) override;
 
     // ARAAudioSource::Listener overrides
-    void willEnableAudioSourceSamplesAccess (juce::ARAAudioSource* audioSource, bool enable) override;
     void didEnableAudioSourceSamplesAccess (juce::ARAAudioSource* audioSource, bool enable) override;
     void willUpdateAudioSourceProperties (juce::ARAAudioSource* audioSource, juce::ARAAudioSource::PropertiesPtr newProperties) override;
 
@@ -50,31 +53,23 @@ public:
 
     // ARAPlaybackRegion::Listener overrides
     void willUpdatePlaybackRegionProperties (juce::ARAPlaybackRegion* playbackRegion, juce::ARAPlaybackRegion::PropertiesPtr newProperties) override;
+    void didUpdatePlaybackRegionProperties (juce::ARAPlaybackRegion* playbackRegion) override;
     void didUpdatePlaybackRegionContent (juce::ARAPlaybackRegion* playbackRegion, juce::ARAContentUpdateScopes scopeFlags) override;
 
 private:
-    void destroyPlaybackRegionReader();
-    void recreatePlaybackRegionReader();
+    void drawWaveform (juce::Graphics& g, juce::Rectangle<int> drawBounds, juce::Range<double> playbackTimeRange);
+    void updateTooltip();
+    void setSelected (bool selected);
 
 private:
-
-    // We're subclassing here only to provide a proper default c'tor for our shared ressource
-    class SharedAudioThumbnailCache   : public juce::AudioThumbnailCache
-    {
-        public:
-            SharedAudioThumbnailCache()
-                : AudioThumbnailCache (20000)
-            {}
-    };
-    juce::SharedResourcePointer<SharedAudioThumbnailCache> sharedAudioThumbnailCache;
-
     RegionSequenceViewContainer& regionSequenceViewContainer;
     DocumentView& documentView;
     juce::ARAPlaybackRegion* playbackRegion;
     bool isSelected { false };
+    bool needsBoundsUpdate { false };
 
-    juce::AudioThumbnail audioThumb;
-    juce::ARAPlaybackRegionReader* playbackRegionReader { nullptr };  // careful: "weak" pointer, actual pointer is owned by our audioThumb
+    juce::ARAWaveformOverview& waveformOverview;
+    std::vector<juce::ARAWaveformOverview::Bin> waveformBins;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PlaybackRegionView)
 };
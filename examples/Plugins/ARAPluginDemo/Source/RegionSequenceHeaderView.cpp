@@ -8,7 +8,7 @@ RegionSequenceHeaderView::RegionSequenceHeaderView (juce::ARAEditorView* view, j
     regionSequence->addListener (this);
 
     editorView->addListener (this);
-    onNewSelection (editorView->getViewSelection());
+    setSelected (editorView->getSelectionSnapshot()->isSelected (regionSequence));
 }
 
 RegionSequenceHeaderView::~RegionSequenceHeaderView()
@@ -49,9 +49,13 @@ void RegionSequenceHeaderView::paint (juce::Graphics& g)
 }
 
 //==============================================================================
-void RegionSequenceHeaderView::onNewSelection (const juce::ARAViewSelection& viewSelection)
+void RegionSequenceHeaderView::onSelectionChanged (const juce::ARAEditorView::SelectionChange& change)
+{
+    setSelected (change.currentSelection.isSelected (regionSequence));
+}
+
+void RegionSequenceHeaderView::setSelected (bool selected)
 {
-    const bool selected = ARA::contains (viewSelection.getRegionSequences(), regionSequence);
     if (selected != isSelected)
     {
         isSelected = selected;
@@ -18,7 +18,7 @@ public:
     void paint (juce::Graphics&) override;
 
     // ARAEditorView::Listener overrides
-    void onNewSelection (const juce::ARAViewSelection& viewSelection) override;
+    void onSelectionChanged (const juce::ARAEditorView::SelectionChange& change) override;
 
     // ARARegionSequence::Listener overrides
     void didUpdateRegionSequenceProperties (juce::ARARegionSequence* regionSequence) override;
@@ -26,6 +26,7 @@ public:
 
 private:
     void detachFromRegionSequence();
+    void setSelected (bool selected);
 
 private:
     juce::ARAEditorView* editorView;
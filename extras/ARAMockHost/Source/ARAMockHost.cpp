@@ -0,0 +1,615 @@
+#include "ARAMockHost.h"
+
+//==============================================================================
+struct ARAMockHost::AudioReader
+{
+    const AudioSource& audioSource;
+    const bool use64BitSamples;
+};
+
+struct ARAMockHost::ArchiveWriter
+{
+    juce::MemoryBlock& data;
+    size_t size;
+};
+
+struct ARAMockHost::PlugInInstance
+{
+    std::unique_ptr<juce::AudioProcessor> processor;
+    const ARA::ARAPlugInExtensionInstance* extensionInstance;
+    std::vector<PlaybackRegion*> playbackRegions;
+};
+
+//==============================================================================
+// The host interface implementations - all host refs of controllers point to the ARAMockHost,
+// all host refs of objects point to the corresponding host side representation.
+struct ARAMockHost::Callbacks
+{
+    template <typename HostRef>
+    static ARAMockHost& getHost (HostRef hostRef) noexcept              { return *reinterpret_cast<ARAMockHost*> (hostRef); }
+
+    template <typename HostRef, typename Object>
+    static HostRef toHostRef (Object* object) noexcept                  { return reinterpret_cast<HostRef> (object); }
+
+    //==============================================================================
+    static ARA::ARAAudioReaderHostRef ARA_CALL createAudioReaderForSource (ARA::ARAAudioAccessControllerHostRef controllerHostRef,
+                                                                           ARA::ARAAudioSourceHostRef audioSourceHostRef,
+                                                                           ARA::ARABool use64BitSamples) noexcept
+    {
+        ++getHost (controllerHostRef).statistics.numAudioReadersCreated;
+
+        const auto& audioSource = *reinterpret_cast<const AudioSource*> (audioSourceHostRef);
+        return toHostRef<ARA::ARAAudioReaderHostRef> (new AudioReader { audioSource, use64BitSamples != ARA::kARAFalse });
+    }
+
+    static ARA::ARABool ARA_CALL readAudioSamples (ARA::ARAAudioAccessControllerHostRef controllerHostRef,
+                                                   ARA::ARAAudioReaderHostRef audioReaderHostRef,
+                                                   ARA::ARASamplePosition samplePosition,
+                                                   ARA::ARASampleCount samplesPerChannel,
+                                                   void* const buffers[]) noexcept
+    {
+        auto& statistics = getHost (controllerHostRef).statistics;
+        const auto& reader = *reinterpret_cast<const AudioReader*> (audioReaderHostRef);
+        const auto& samples = *reader.audioSource.samples;
+
+        // the plug-in may read beyond the ends of the audio source, which must produce silence
+        const auto numSourceSamples = (juce::int64) samples.getNumSamples();
+        const auto startInSource = juce::jlimit ((juce::int64) 0, numSourceSamples, (juce::int64) samplePosition);
+        const auto endInSource = juce::jlimit (startInSource, numSourceSamples, (juce::int64) (samplePosition + samplesPerChannel));
+
+        const auto numSilentBefore = (int) (startInSource - samplePosition);
+        const auto numValid = (int) (endInSource - startInSource);
+        const auto numSilentAfter = (int) samplesPerChannel - numSilentBefore - numValid;
+
+        for (int c = 0; c < samples.getNumChannels(); ++c)
+        {
+            const auto* source = samples.getReadPointer (c) + startInSource;
+
+            if (reader.use64BitSamples)
+            {
+                auto* dest = static_cast<double*> (buffers[c]);
+                std::fill_n (dest, numSilentBefore, 0.0);
+                std::copy (source, source + numValid, dest + numSilentBefore);
+                std::fill_n (dest + numSilentBefore + numValid, numSilentAfter, 0.0);
+            }
+            else
+            {
+                auto* dest = static_cast<float*> (buffers[c]);
+                juce::FloatVectorOperations::clear (dest, numSilentBefore);
+                juce::FloatVectorOperations::copy (dest + numSilentBefore, source, numValid);
+                juce::FloatVectorOperations::clear (dest + numSilentBefore + numValid, numSilentAfter);
+            }
+        }
+
+        ++statistics.numReadCalls;
+        statistics.numSamplesRead += samplesPerChannel;
+        return ARA::kARATrue;
+    }
+
+    static void ARA_CALL destroyAudioReader (ARA::ARAAudioAccessControllerHostRef /*controllerHostRef*/,
+                                             ARA::ARAAudioReaderHostRef audioReaderHostRef) noexcept
+    {
+        delete reinterpret_cast<AudioReader*> (audioReaderHostRef);
+    }
+
+    static const ARA::ARAAudioAccessControllerInterface* getAudioAccessControllerInterface() noexcept
+    {
+        static const ARA::SizedStruct<ARA_STRUCT_MEMBER (ARA::ARAAudioAccessControllerInterface, destroyAudioReader)> interface
+        {
+            createAudioReaderForSource, readAudioSamples, destroyAudioReader
+        };
+
+        return &interface;
+    }
+
+    //==============================================================================
+    static ARA::ARASize ARA_CALL getArchiveSize (ARA::ARAArchivingControllerHostRef /*controllerHostRef*/,
+                                                 ARA::ARAArchiveReaderHostRef archiveReaderHostRef) noexcept
+    {
+        return reinterpret_cast<const juce::MemoryBlock*> (archiveReaderHostRef)->getSize();
+    }
+
+    static ARA::ARABool ARA_CALL readBytesFromArchive (ARA::ARAArchivingControllerHostRef controllerHostRef,
+                                                       ARA::ARAArchiveReaderHostRef archiveReaderHostRef,
+                                                       ARA::ARASize position, ARA::ARASize length, ARA::ARAByte buffer[]) noexcept
+    {
+        const auto& archive = *reinterpret_cast<const juce::MemoryBlock*> (archiveReaderHostRef);
+
+        if (position + length > archive.getSize())
+            return ARA::kARAFalse;
+
+        std::memcpy (buffer, juce::addBytesToPointer (archive.getData(), position), length);
+        getHost (controllerHostRef).statistics.numArchiveBytesRead += (juce::int64) length;
+        return ARA::kARATrue;
+    }
+
+    static ARA::ARABool ARA_CALL writeBytesToArchive (ARA::ARAArchivingControllerHostRef controllerHostRef,
+                                                      ARA::ARAArchiveWriterHostRef archiveWriterHostRef,
+                                                      ARA::ARASize position, ARA::ARASize length, const ARA::ARAByte buffer[]) noexcept
+    {
+        auto& writer = *reinterpret_cast<ArchiveWriter*> (archiveWriterHostRef);
+
+        // grow geometrically, the final size is trimmed once archiving has finished
+        if (position + length > writer.data.getSize())
+            writer.data.ensureSize (juce::jmax (position + length, 2 * writer.data.getSize()));
+
+        writer.data.copyFrom (buffer, (int) position, length);
+        writer.size = juce::jmax (writer.size, (size_t) (position + length));
+
+        getHost (controllerHostRef).statistics.numArchiveBytesWritten += (juce::int64) length;
+        return ARA::kARATrue;
+    }
+
+    static void ARA_CALL notifyDocumentArchivingProgress (ARA::ARAArchivingControllerHostRef, float) noexcept {}
+    static void ARA_CALL notifyDocumentUnarchivingProgress (ARA::ARAArchivingControllerHostRef, float) noexcept {}
+
+    static ARA::ARAPersistentID ARA_CALL getDocumentArchiveID (ARA::ARAArchivingControllerHostRef controllerHostRef,
+                                                               ARA::ARAArchiveReaderHostRef /*archiveReaderHostRef*/) noexcept
+    {
+        return getHost (controllerHostRef).factory->documentArchiveID;
+    }
+
+    static const ARA::ARAArchivingControllerInterface* getArchivingControllerInterface() noexcept
+    {
+        static const ARA::SizedStruct<ARA_STRUCT_MEMBER (ARA::ARAArchivingControllerInterface, getDocumentArchiveID)> interface
+        {
+            getArchiveSize, readBytesFromArchive, writeBytesToArchive,
+            notifyDocumentArchivingProgress, notifyDocumentUnarchivingProgress, getDocumentArchiveID
+        };
+
+        return &interface;
+    }
+
+    //==============================================================================
+    // the mock host does not provide any content information to the plug-in
+    static ARA::ARABool ARA_CALL isMusicalContextContentAvailable (ARA::ARAContentAccessControllerHostRef, ARA::ARAMusicalContextHostRef,
+                                                                   ARA::ARAContentType) noexcept                                        { return ARA::kARAFalse; }
+    static ARA::ARAContentGrade ARA_CALL getMusicalContextContentGrade (ARA::ARAContentAccessControllerHostRef, ARA::ARAMusicalContextHostRef,
+                                                                        ARA::ARAContentType) noexcept                                   { return ARA::kARAContentGradeInitial; }
+    static ARA::ARAContentReaderHostRef ARA_CALL createMusicalContextContentReader (ARA::ARAContentAccessControllerHostRef, ARA::ARAMusicalContextHostRef,
+                                                                                    ARA::ARAContentType, const ARA::ARAContentTimeRange*) noexcept  { return nullptr; }
+    static ARA::ARABool ARA_CALL isAudioSourceContentAvailable (ARA::ARAContentAccessControllerHostRef, ARA::ARAAudioSourceHostRef,
+                                                                ARA::ARAContentType) noexcept                                           { return ARA::kARAFalse; }
+    static ARA::ARAContentGrade ARA_CALL getAudioSourceContentGrade (ARA::ARAContentAccessControllerHostRef, ARA::ARAAudioSourceHostRef,
+                                                                     ARA::ARAContentType) noexcept                                      { return ARA::kARAContentGradeInitial; }
+    static ARA::ARAContentReaderHostRef ARA_CALL createAudioSourceContentReader (ARA::ARAContentAccessControllerHostRef, ARA::ARAAudioSourceHostRef,
+                                                                                 ARA::ARAContentType, const ARA::ARAContentTimeRange*) noexcept { return nullptr; }
+    static ARA::ARAInt32 ARA_CALL getContentReaderEventCount (ARA::ARAContentAccessControllerHostRef, ARA::ARAContentReaderHostRef) noexcept   { return 0; }
+    static const void* ARA_CALL getContentReaderDataForEvent (ARA::ARAContentAccessControllerHostRef, ARA::ARAContentReaderHostRef,
+                                                              ARA::ARAInt32) noexcept                                                   { return nullptr; }
+    static void ARA_CALL destroyContentReader (ARA::ARAContentAccessControllerHostRef, ARA::ARAContentReaderHostRef) noexcept {}
+
+    static const ARA::ARAContentAccessControllerInterface* getContentAccessControllerInterface() noexcept
+    {
+        static const ARA::SizedStruct<ARA_STRUCT_MEMBER (ARA::ARAContentAccessControllerInterface, destroyContentReader)> interface
+        {
+            isMusicalContextContentAvailable, getMusicalContextContentGrade, createMusicalContextContentReader,
+            isAudioSourceContentAvailable, getAudioSourceContentGrade, createAudioSourceContentReader,
+            getContentReaderEventCount, getContentReaderDataForEvent, destroyContentReader
+        };
+
+        return &interface;
+    }
+
+    //==============================================================================
+    static void ARA_CALL notifyAudioSourceAnalysisProgress (ARA::ARAModelUpdateControllerHostRef controllerHostRef, ARA::ARAAudioSourceHostRef,
+                                                            ARA::ARAAnalysisProgressState, float) noexcept
+    {
+        ++getHost (controllerHostRef).statistics.numAnalysisProgressNotifications;
+    }
+
+    static void ARA_CALL notifyAudioSourceContentChanged (ARA::ARAModelUpdateControllerHostRef controllerHostRef, ARA::ARAAudioSourceHostRef,
+                                                          const ARA::ARAContentTimeRange*, ARA::ARAContentUpdateFlags) noexcept
+    {
+        ++getHost (controllerHostRef).statistics.numContentChangedNotifications;
+    }
+
+    static void ARA_CALL notifyAudioModificationContentChanged (ARA::ARAModelUpdateControllerHostRef controllerHostRef, ARA::ARAAudioModificationHostRef,
+                                                                const ARA::ARAContentTimeRange*, ARA::ARAContentUpdateFlags) noexcept
+    {
+        ++getHost (controllerHostRef).statistics.numContentChangedNotifications;
+    }
+
+    static void ARA_CALL notifyPlaybackRegionContentChanged (ARA::ARAModelUpdateControllerHostRef controllerHostRef, ARA::ARAPlaybackRegionHostRef,
+                                                             const ARA::ARAContentTimeRange*, ARA::ARAContentUpdateFlags) noexcept
+    {
+        ++getHost (controllerHostRef).statistics.numContentChangedNotifications;
+    }
+
+    static const ARA::ARAModelUpdateControllerInterface* getModelUpdateControllerInterface() noexcept
+    {
+        static const ARA::SizedStruct<ARA_STRUCT_MEMBER (ARA::ARAModelUpdateControllerInterface, notifyPlaybackRegionContentChanged)> interface
+        {
+            notifyAudioSourceAnalysisProgress, notifyAudioSourceContentChanged,
+            notifyAudioModificationContentChanged, notifyPlaybackRegionContentChanged
+        };
+
+        return &interface;
+    }
+
+    //==============================================================================
+    // there is no transport to control
+    static void ARA_CALL requestStartPlayback (ARA::ARAPlaybackControllerHostRef) noexcept {}
+    static void ARA_CALL requestStopPlayback (ARA::ARAPlaybackControllerHostRef) noexcept {}
+    static void ARA_CALL requestSetPlaybackPosition (ARA::ARAPlaybackControllerHostRef, ARA::ARATimePosition) noexcept {}
+    static void ARA_CALL requestSetCycleRange (ARA::ARAPlaybackControllerHostRef, ARA::ARATimePosition, ARA::ARATimeDuration) noexcept {}
+    static void ARA_CALL requestEnableCycle (ARA::ARAPlaybackControllerHostRef, ARA::ARABool) noexcept {}
+
+    static const ARA::ARAPlaybackControllerInterface* getPlaybackControllerInterface() noexcept
+    {
+        static const ARA::SizedStruct<ARA_STRUCT_MEMBER (ARA::ARAPlaybackControllerInterface, requestEnableCycle)> interface
+        {
+            requestStartPlayback, requestStopPlayback, requestSetPlaybackPosition, requestSetCycleRange, requestEnableCycle
+        };
+
+        return &interface;
+    }
+
+    //==============================================================================
+    static void ARA_CALL assertFunction (ARA::ARAAssertCategory category, const void* problematicArgument, const char* diagnosis) noexcept
+    {
+        std::cerr << "ARA assertion (category " << (int) category << ", argument " << problematicArgument << "): "
+                  << (diagnosis != nullptr ? diagnosis : "") << std::endl;
+        jassertfalse;
+    }
+};
+
+//==============================================================================
+ARAMockHost::ARAMockHost (const ARA::ARAFactory* araFactory, const juce::String& documentName)
+    : factory (araFactory)
+{
+    jassert (factory != nullptr);
+
+    // region sequences and their musical contexts require ARA 2
+    jassert (factory->highestSupportedApiGeneration >= ARA::kARAAPIGeneration_2_0_Final);
+
+    static ARA::ARAAssertFunction assertFunction = Callbacks::assertFunction;
+    const ARA::SizedStruct<ARA_STRUCT_MEMBER (ARA::ARAInterfaceConfiguration, assertFunctionAddress)> interfaceConfiguration
+    {
+        factory->highestSupportedApiGeneration, &assertFunction
+    };
+
+    factory->initializeARAWithConfiguration (&interfaceConfiguration);
+
+    const auto hostRef = this;
+    hostInstance = ARA::SizedStruct<ARA_STRUCT_MEMBER (ARA::ARADocumentControllerHostInstance, playbackControllerInterface)>
+    {
+        Callbacks::toHostRef<ARA::ARAAudioAccessControllerHostRef> (hostRef), Callbacks::getAudioAccessControllerInterface(),
+        Callbacks::toHostRef<ARA::ARAArchivingControllerHostRef> (hostRef), Callbacks::getArchivingControllerInterface(),
+        Callbacks::toHostRef<ARA::ARAContentAccessControllerHostRef> (hostRef), Callbacks::getContentAccessControllerInterface(),
+        Callbacks::toHostRef<ARA::ARAModelUpdateControllerHostRef> (hostRef), Callbacks::getModelUpdateControllerInterface(),
+        Callbacks::toHostRef<ARA::ARAPlaybackControllerHostRef> (hostRef), Callbacks::getPlaybackControllerInterface()
+    };
+
+    const auto documentNameUTF8 = documentName.toStdString();
+    const ARA::SizedStruct<ARA_STRUCT_MEMBER (ARA::ARADocumentProperties, name)> documentProperties { documentNameUTF8.c_str() };
+    documentControllerInstance = factory->createDocumentControllerWithDocument (&hostInstance, &documentProperties);
+    jassert (documentControllerInstance != nullptr);
+
+    // all region sequences share a single musical context
+    beginEditing();
+    const ARA::SizedStruct<ARA_STRUCT_MEMBER (ARA::ARAMusicalContextProperties, color)> musicalContextProperties { "Musical Context", 0, nullptr };
+    musicalContextRef = dc().createMusicalContext (dcRef(), Callbacks::toHostRef<ARA::ARAMusicalContextHostRef> (hostRef), &musicalContextProperties);
+    endEditing();
+}
+
+ARAMockHost::~ARAMockHost()
+{
+    destroyDocument();
+}
+
+void ARAMockHost::destroyDocument()
+{
+    // plug-in instances must be unbound before destroying the document controller
+    while (! plugInInstances.empty())
+        destroyPlaybackRenderer (plugInInstances.back()->processor.get());
+
+    documentControllerAccessInstance = nullptr;
+
+    beginEditing();
+
+    for (auto& playbackRegion : playbackRegions)
+        dc().destroyPlaybackRegion (dcRef(), playbackRegion->ref);
+
+    for (auto& regionSequence : regionSequences)
+        dc().destroyRegionSequence (dcRef(), regionSequence->ref);
+
+    for (auto& audioModification : audioModifications)
+        dc().destroyAudioModification (dcRef(), audioModification->ref);
+
+    for (auto& audioSource : audioSources)
+    {
+        dc().enableAudioSourceSamplesAccess (dcRef(), audioSource->ref, ARA::kARAFalse);
+        dc().destroyAudioSource (dcRef(), audioSource->ref);
+    }
+
+    dc().destroyMusicalContext (dcRef(), musicalContextRef);
+
+    endEditing();
+
+    playbackRegions.clear();
+    regionSequences.clear();
+    audioModifications.clear();
+    audioSources.clear();
+
+    dc().destroyDocumentController (dcRef());
+    factory->uninitializeARA();
+}
+
+//==============================================================================
+void ARAMockHost::beginEditing()
+{
+    jassert (! isEditing);
+    isEditing = true;
+    dc().beginEditing (dcRef());
+}
+
+void ARAMockHost::endEditing()
+{
+    jassert (isEditing);
+    dc().endEditing (dcRef());
+    isEditing = false;
+}
+
+void ARAMockHost::notifyModelUpdates()
+{
+    dc().notifyModelUpdates (dcRef());
+}
+
+//==============================================================================
+ARAMockHost::AudioSource& ARAMockHost::addAudioSource (const juce::String& name, const juce::String& persistentID,
+                                                       const juce::AudioBuffer<float>& samples, double sampleRate)
+{
+    jassert (isEditing);
+
+    audioSources.push_back (std::make_unique<AudioSource> (AudioSource { name, persistentID, &samples, sampleRate }));
+    auto& audioSource = *audioSources.back();
+
+    const ARA::SizedStruct<ARA_STRUCT_MEMBER (ARA::ARAAudioSourceProperties, merits64BitSamples)> properties
+    {
+        name.toRawUTF8(), persistentID.toRawUTF8(),
+        (ARA::ARASampleCount) samples.getNumSamples(), sampleRate, (ARA::ARAChannelCount) samples.getNumChannels(),
+        ARA::kARAFalse
+    };
+
+    audioSource.ref = dc().createAudioSource (dcRef(), Callbacks::toHostRef<ARA::ARAAudioSourceHostRef> (&audioSource), &properties);
+    return audioSource;
+}
+
+void ARAMockHost::enableAudioSourceSamplesAccess (AudioSource& audioSource, bool enable)
+{
+    dc().enableAudioSourceSamplesAccess (dcRef(), audioSource.ref, enable ? ARA::kARATrue : ARA::kARAFalse);
+}
+
+void ARAMockHost::updateAudioSourceContent (AudioSource& audioSource, const juce::Range<double>* timeRange)
+{
+    jassert (isEditing);
+
+    if (timeRange != nullptr)
+    {
+        const ARA::ARAContentTimeRange range { timeRange->getStart(), timeRange->getLength() };
+        dc().updateAudioSourceContent (dcRef(), audioSource.ref, &range, ARA::kARAContentUpdateEverythingChanged);
+    }
+    else
+    {
+        dc().updateAudioSourceContent (dcRef(), audioSource.ref, nullptr, ARA::kARAContentUpdateEverythingChanged);
+    }
+}
+
+ARAMockHost::AudioModification& ARAMockHost::addAudioModification (AudioSource& audioSource, const juce::String& name, const juce::String& persistentID)
+{
+    jassert (isEditing);
+
+    audioModifications.push_back (std::make_unique<AudioModification> (AudioModification { &audioSource, name, persistentID }));
+    auto& audioModification = *audioModifications.back();
+
+    const ARA::SizedStruct<ARA_STRUCT_MEMBER (ARA::ARAAudioModificationProperties, persistentID)> properties
+    {
+        name.toRawUTF8(), persistentID.toRawUTF8()
+    };
+
+    audioModification.ref = dc().createAudioModification (dcRef(), audioSource.ref,
+                                                          Callbacks::toHostRef<ARA::ARAAudioModificationHostRef> (&audioModification),
+                                                          &properties);
+    return audioModification;
+}
+
+ARAMockHost::RegionSequence& ARAMockHost::addRegionSequence (const juce::String& name)
+{
+    jassert (isEditing);
+
+    regionSequences.push_back (std::make_unique<RegionSequence> (RegionSequence { name, (int) regionSequences.size() }));
+    auto& regionSequence = *regionSequences.back();
+
+    const ARA::SizedStruct<ARA_STRUCT_MEMBER (ARA::ARARegionSequenceProperties, color)> properties
+    {
+        name.toRawUTF8(), regionSequence.orderIndex, musicalContextRef, nullptr
+    };
+
+    regionSequence.ref = dc().createRegionSequence (dcRef(), Callbacks::toHostRef<ARA::ARARegionSequenceHostRef> (&regionSequence), &properties);
+    return regionSequence;
+}
+
+ARAMockHost::PlaybackRegion& ARAMockHost::addPlaybackRegion (AudioModification& audioModification, RegionSequence& regionSequence,
+                                                             double startInModificationTime, double durationInModificationTime,
+                                                             double startInPlaybackTime, double durationInPlaybackTime)
+{
+    jassert (isEditing);
+
+    playbackRegions.push_back (std::make_unique<PlaybackRegion> (PlaybackRegion { &audioModification, &regionSequence,
+                                                                                  startInModificationTime, durationInModificationTime,
+                                                                                  startInPlaybackTime, durationInPlaybackTime }));
+    auto& playbackRegion = *playbackRegions.back();
+
+    const auto properties = getPlaybackRegionProperties (playbackRegion);
+    playbackRegion.ref = dc().createPlaybackRegion (dcRef(), audioModification.ref,
+                                                    Callbacks::toHostRef<ARA::ARAPlaybackRegionHostRef> (&playbackRegion),
+                                                    &properties);
+    return playbackRegion;
+}
+
+void ARAMockHost::updatePlaybackRegionProperties (PlaybackRegion& playbackRegion)
+{
+    jassert (isEditing);
+
+    const auto properties = getPlaybackRegionProperties (playbackRegion);
+    dc().updatePlaybackRegionProperties (dcRef(), playbackRegion.ref, &properties);
+}
+
+ARA::ARAPlaybackRegionProperties ARAMockHost::getPlaybackRegionProperties (const PlaybackRegion& playbackRegion) const
+{
+    // only transformations supported by the plug-in may be requested,
+    // and without time stretching both durations must match
+    jassert ((playbackRegion.transformationFlags & ~factory->supportedPlaybackTransformationFlags) == 0);
+    jassert ((playbackRegion.transformationFlags & ARA::kARAPlaybackTransformationTimestretch) != 0
+             || playbackRegion.durationInModificationTime == playbackRegion.durationInPlaybackTime);
+
+    return ARA::SizedStruct<ARA_STRUCT_MEMBER (ARA::ARAPlaybackRegionProperties, color)>
+    {
+        playbackRegion.transformationFlags,
+        playbackRegion.startInModificationTime, playbackRegion.durationInModificationTime,
+        playbackRegion.startInPlaybackTime, playbackRegion.durationInPlaybackTime,
+        musicalContextRef, playbackRegion.regionSequence->ref,
+        nullptr, nullptr
+    };
+}
+
+void ARAMockHost::removePlaybackRegion (PlaybackRegion& playbackRegion)
+{
+    jassert (isEditing);
+
+    // regions must be removed from all renderers before they can be destroyed
+    for (auto& instance : plugInInstances)
+    {
+        auto& regions = instance->playbackRegions;
+        const auto it = std::find (regions.begin(), regions.end(), &playbackRegion);
+
+        if (it != regions.end())
+        {
+            instance->extensionInstance->playbackRendererInterface->removePlaybackRegion (instance->extensionInstance->playbackRendererRef, playbackRegion.ref);
+            regions.erase (it);
+        }
+    }
+
+    dc().destroyPlaybackRegion (dcRef(), playbackRegion.ref);
+
+    playbackRegions.erase (std::find_if (playbackRegions.begin(), playbackRegions.end(),
+                                         [&] (const std::unique_ptr<PlaybackRegion>& region) { return region.get() == &playbackRegion; }));
+}
+
+void ARAMockHost::removeAudioSource (AudioSource& audioSource)
+{
+    jassert (isEditing);
+
+    // the audio modifications of the source and their regions must be destroyed before the source itself
+    for (auto it = audioModifications.begin(); it != audioModifications.end();)
+    {
+        auto& audioModification = **it;
+
+        if (audioModification.audioSource != &audioSource)
+        {
+            ++it;
+            continue;
+        }
+
+        std::vector<PlaybackRegion*> regionsToRemove;
+
+        for (auto& playbackRegion : playbackRegions)
+            if (playbackRegion->audioModification == &audioModification)
+                regionsToRemove.push_back (playbackRegion.get());
+
+        for (auto* playbackRegion : regionsToRemove)
+            removePlaybackRegion (*playbackRegion);
+
+        dc().destroyAudioModification (dcRef(), audioModification.ref);
+        it = audioModifications.erase (it);
+    }
+
+    dc().destroyAudioSource (dcRef(), audioSource.ref);
+
+    audioSources.erase (std::find_if (audioSources.begin(), audioSources.end(),
+                                      [&] (const std::unique_ptr<AudioSource>& source) { return source.get() == &audioSource; }));
+}
+
+double ARAMockHost::getDocumentDuration() const
+{
+    double duration = 0.0;
+
+    for (auto& playbackRegion : playbackRegions)
+        duration = juce::jmax (duration, playbackRegion->startInPlaybackTime + playbackRegion->durationInPlaybackTime);
+
+    return duration;
+}
+
+//==============================================================================
+bool ARAMockHost::storeToArchive (juce::MemoryBlock& archive)
+{
+    jassert (! isEditing);
+
+    archive.reset();
+    ArchiveWriter writer { archive, 0 };
+
+    const auto result = dc().storeObjectsToArchive (dcRef(), Callbacks::toHostRef<ARA::ARAArchiveWriterHostRef> (&writer), nullptr);
+
+    archive.setSize (writer.size);
+    return result != ARA::kARAFalse;
+}
+
+bool ARAMockHost::restoreFromArchive (const juce::MemoryBlock& archive)
+{
+    beginEditing();
+    const auto result = dc().restoreObjectsFromArchive (dcRef(), Callbacks::toHostRef<ARA::ARAArchiveReaderHostRef> (const_cast<juce::MemoryBlock*> (&archive)), nullptr);
+    endEditing();
+
+    return result != ARA::kARAFalse;
+}
+
+//==============================================================================
+ARAMockHost::PlugInInstance& ARAMockHost::createPlugInInstance (ARA::ARAPlugInInstanceRoleFlags roles)
+{
+    auto instance = std::make_unique<PlugInInstance>();
+    instance->processor.reset (juce::createPluginFilterOfType (juce::AudioProcessor::wrapperType_Undefined));
+
+    auto* extension = dynamic_cast<juce::AudioProcessorARAExtension*> (instance->processor.get());
+    jassert (extension != nullptr);
+
+    constexpr auto knownRoles = ARA::kARAPlaybackRendererRole | ARA::kARAEditorRendererRole | ARA::kARAEditorViewRole;
+    instance->extensionInstance = extension->bindToARA (dcRef(), knownRoles, roles);
+    jassert (instance->extensionInstance != nullptr);
+
+    plugInInstances.push_back (std::move (instance));
+    return *plugInInstances.back();
+}
+
+juce::AudioProcessor* ARAMockHost::createPlaybackRenderer (const std::vector<PlaybackRegion*>& regionsToRender)
+{
+    auto& instance = createPlugInInstance (ARA::kARAPlaybackRendererRole);
+
+    for (auto* playbackRegion : regionsToRender)
+        instance.extensionInstance->playbackRendererInterface->addPlaybackRegion (instance.extensionInstance->playbackRendererRef, playbackRegion->ref);
+
+    instance.playbackRegions = regionsToRender;
+    return instance.processor.get();
+}
+
+void ARAMockHost::destroyPlaybackRenderer (juce::AudioProcessor* plugInInstance)
+{
+    const auto it = std::find_if (plugInInstances.begin(), plugInInstances.end(),
+                                  [&] (const std::unique_ptr<PlugInInstance>& instance) { return instance->processor.get() == plugInInstance; });
+    jassert (it != plugInInstances.end());
+
+    auto& instance = **it;
+
+    for (auto* playbackRegion : instance.playbackRegions)
+        instance.extensionInstance->playbackRendererInterface->removePlaybackRegion (instance.extensionInstance->playbackRendererRef, playbackRegion->ref);
+
+    plugInInstances.erase (it);
+}
+
+juce::ARADocumentController* ARAMockHost::getPlugInDocumentController()
+{
+    if (documentControllerAccessInstance == nullptr)
+        documentControllerAccessInstance = &createPlugInInstance (0);
+
+    return dynamic_cast<juce::AudioProcessorARAExtension*> (documentControllerAccessInstance->processor.get())->getDocumentController();
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <juce_audio_plugin_client/juce_audio_plugin_client.h>
+
+//==============================================================================
+/**
+    A minimal ARA host that drives an ARA factory directly through the ARA C API.
+
+    It maintains a host-side representation of an ARA document, sends all edits to the plug-in
+    inside edit cycles, serves audio samples from AudioBuffers held in memory, keeps archives in
+    memory and can create and bind plug-in instances for rendering.
+
+    All functions must be called on the message thread, except for the host interface callbacks
+    which the plug-in may call from any thread.
+*/
+class ARAMockHost
+{
+public:
+    //==============================================================================
+    struct AudioSource
+    {
+        juce::String name, persistentID;
+        const juce::AudioBuffer<float>* samples;
+        double sampleRate;
+        ARA::ARAAudioSourceRef ref { nullptr };
+    };
+
+    struct AudioModification
+    {
+        AudioSource* audioSource;
+        juce::String name, persistentID;
+        ARA::ARAAudioModificationRef ref { nullptr };
+    };
+
+    struct RegionSequence
+    {
+        juce::String name;
+        int orderIndex;
+        ARA::ARARegionSequenceRef ref { nullptr };
+    };
+
+    struct PlaybackRegion
+    {
+        AudioModification* audioModification;
+        RegionSequence* regionSequence;
+        double startInModificationTime, durationInModificationTime;
+        double startInPlaybackTime, durationInPlaybackTime;
+        ARA::ARAPlaybackRegionRef ref { nullptr };
+        ARA::ARAPlaybackTransformationFlags transformationFlags { ARA::kARAPlaybackTransformationNoChanges };
+    };
+
+    /** Counts the calls the plug-in made into the host interfaces. */
+    struct Statistics
+    {
+        std::atomic<juce::int64> numAudioReadersCreated { 0 };
+        std::atomic<juce::int64> numReadCalls { 0 };
+        std::atomic<juce::int64> numSamplesRead { 0 };
+        std::atomic<juce::int64> numArchiveBytesWritten { 0 };
+        std::atomic<juce::int64> numArchiveBytesRead { 0 };
+        std::atomic<juce::int64> numAnalysisProgressNotifications { 0 };
+        std::atomic<juce::int64> numContentChangedNotifications { 0 };
+    };
+
+    //==============================================================================
+    /** Initialises the factory and creates a document controller with an empty document. */
+    explicit ARAMockHost (const ARA::ARAFactory* factory, const juce::String& documentName = "ARA Mock Host Document");
+
+    /** Destroys all plug-in instances, the document and the document controller, then uninitialises the factory. */
+    ~ARAMockHost();
+
+    const ARA::ARAFactory* getFactory() const noexcept      { return factory; }
+    const Statistics& getStatistics() const noexcept        { return statistics; }
+
+    //==============================================================================
+    /** All changes to the document must be made between beginEditing() and endEditing(). */
+    void beginEditing();
+    void endEditing();
+
+    /** Lets the plug-in send its pending notifications, as hosts do regularly on the message thread. */
+    void notifyModelUpdates();
+
+    /** Adds an audio source that reads the given samples, which must outlive the source. */
+    AudioSource& addAudioSource (const juce::String& name, const juce::String& persistentID,
+                                 const juce::AudioBuffer<float>& samples, double sampleRate);
+    void enableAudioSourceSamplesAccess (AudioSource& audioSource, bool enable);
+
+    /** Tells the plug-in that the samples of an audio source have changed, optionally limited to a time range. */
+    void updateAudioSourceContent (AudioSource& audioSource, const juce::Range<double>* timeRange = nullptr);
+
+    AudioModification& addAudioModification (AudioSource& audioSource, const juce::String& name, const juce::String& persistentID);
+
+    RegionSequence& addRegionSequence (const juce::String& name);
+
+    PlaybackRegion& addPlaybackRegion (AudioModification& audioModification, RegionSequence& regionSequence,
+                                       double startInModificationTime, double durationInModificationTime,
+                                       double startInPlaybackTime, double durationInPlaybackTime);
+
+    /** Sends the current properties of the region to the plug-in, after changing them. */
+    void updatePlaybackRegionProperties (PlaybackRegion& playbackRegion);
+
+    void removePlaybackRegion (PlaybackRegion& playbackRegion);
+
+    /** Removes an audio source along with its audio modifications and their playback regions. */
+    void removeAudioSource (AudioSource& audioSource);
+
+    const std::vector<std::unique_ptr<AudioSource>>& getAudioSources() const noexcept                { return audioSources; }
+    const std::vector<std::unique_ptr<AudioModification>>& getAudioModifications() const noexcept    { return audioModifications; }
+    const std::vector<std::unique_ptr<RegionSequence>>& getRegionSequences() const noexcept          { return regionSequences; }
+    const std::vector<std::unique_ptr<PlaybackRegion>>& getPlaybackRegions() const noexcept          { return playbackRegions; }
+
+    /** Returns the end of the last playback region. */
+    double getDocumentDuration() const;
+
+    //==============================================================================
+    /** Stores the entire document into an in-memory archive. */
+    bool storeToArchive (juce::MemoryBlock& archive);
+
+    /** Restores the entire document from an in-memory archive, in an edit cycle of its own.
+        The document must contain the objects with the persistent IDs stored in the archive.
+    */
+    bool restoreFromArchive (const juce::MemoryBlock& archive);
+
+    //==============================================================================
+    /** Creates a plug-in instance, binds it to the document controller with the playback renderer
+        role and adds the given playback regions to it.
+        The instance must be destroyed via destroyPlaybackRenderer() before the host is destroyed.
+    */
+    juce::AudioProcessor* createPlaybackRenderer (const std::vector<PlaybackRegion*>& regionsToRender);
+    void destroyPlaybackRenderer (juce::AudioProcessor* plugInInstance);
+
+    /** Returns the plug-in's JUCE document controller, accessed through a plug-in instance that
+        is bound without any roles.
+    */
+    juce::ARADocumentController* getPlugInDocumentController();
+
+private:
+    //==============================================================================
+    struct AudioReader;
+    struct ArchiveWriter;
+    struct PlugInInstance;
+
+    struct Callbacks;
+    friend struct Callbacks;
+
+    void destroyDocument();
+    const ARA::ARADocumentControllerInterface& dc() const noexcept  { return *documentControllerInstance->documentControllerInterface; }
+    ARA::ARADocumentControllerRef dcRef() const noexcept            { return documentControllerInstance->documentControllerRef; }
+    PlugInInstance& createPlugInInstance (ARA::ARAPlugInInstanceRoleFlags roles);
+    ARA::ARAPlaybackRegionProperties getPlaybackRegionProperties (const PlaybackRegion& playbackRegion) const;
+
+    const ARA::ARAFactory* factory;
+    ARA::ARADocumentControllerHostInstance hostInstance;
+    const ARA::ARADocumentControllerInstance* documentControllerInstance { nullptr };
+    ARA::ARAMusicalContextRef musicalContextRef { nullptr };
+    bool isEditing { false };
+
+    std::vector<std::unique_ptr<AudioSource>> audioSources;
+    std::vector<std::unique_ptr<AudioModification>> audioModifications;
+    std::vector<std::unique_ptr<RegionSequence>> regionSequences;
+    std::vector<std::unique_ptr<PlaybackRegion>> playbackRegions;
+
+    std::vector<std::unique_ptr<PlugInInstance>> plugInInstances;
+    PlugInInstance* documentControllerAccessInstance { nullptr };
+
+    Statistics statistics;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ARAMockHost)
+};
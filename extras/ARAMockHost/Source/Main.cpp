@@ -0,0 +1,975 @@
+#include "ARAMockHost.h"
+
+#if JUCE_LINUX || JUCE_MAC
+ #include <sys/resource.h>
+#endif
+
+//==============================================================================
+namespace
+{
+    struct Options
+    {
+        int numAudioSources = 1000;
+        int numModificationsPerSource = 1;
+        int numRegionsPerModification = 2;
+        int numRegionSequences = 16;
+        int numSampleBuffers = 16;
+        double sourceDuration = 10.0;
+        double sampleRate = 44100.0;
+        int numChannels = 2;
+        int numEditCycles = 100;
+        int numRegionsPerEdit = 10;
+        int blockSize = 512;
+        double renderDuration = 30.0;
+        double stretchFactor = 1.25;
+        int numRenderThreads = juce::jmax (1, juce::SystemStats::getNumCpus() - 1);
+        juce::int64 seed = 0;
+        bool useModelObjectPool = false;
+    };
+
+    const char* const usage = R"([options]
+
+Builds an ARA document in memory, drives the plug-in linked into this executable
+through the ARA API and reports timings for edits, notifications, archiving,
+sample reading, rendering and analysis.
+
+    --sources=N                   number of audio sources (1000)
+    --modifications-per-source=N  audio modifications per audio source (1)
+    --regions-per-modification=N  playback regions per audio modification (2)
+    --sequences=N                 number of region sequences (16)
+    --sample-buffers=N            distinct sample buffers shared by all audio sources (16)
+    --source-duration=SECONDS     duration of each audio source (10)
+    --sample-rate=RATE            sample rate of all audio sources (44100)
+    --channels=N                  channel count of all audio sources (2)
+    --edit-cycles=N               number of edit cycles per edit benchmark (100)
+    --regions-per-edit=N          playback regions moved in each edit cycle (10)
+    --block-size=N                render block size (512)
+    --render-duration=SECONDS     duration rendered per renderer benchmark (30)
+    --render-threads=N            worker threads for parallel region reading (number of cores - 1)
+    --stretch=FACTOR              time stretch factor for the time stretching benchmark (1.25)
+    --seed=N                      random seed (0)
+    --pool                        allocate the model objects from an ARAModelObjectPool
+)";
+
+    Options parseOptions (const juce::ArgumentList& args)
+    {
+        Options options;
+
+        const auto readOption = [&args] (juce::StringRef name, auto& value)
+        {
+            if (args.containsOption (name))
+            {
+                const auto string = args.getValueForOption (name);
+
+                if (string.isEmpty())
+                    juce::ConsoleApplication::fail ("Missing value for option " + juce::String (name));
+
+                using ValueType = typename std::remove_reference<decltype (value)>::type;
+                value = std::is_floating_point<ValueType>::value ? (ValueType) string.getDoubleValue()
+                                                                 : (ValueType) string.getLargeIntValue();
+            }
+        };
+
+        readOption ("--sources", options.numAudioSources);
+        readOption ("--modifications-per-source", options.numModificationsPerSource);
+        readOption ("--regions-per-modification", options.numRegionsPerModification);
+        readOption ("--sequences", options.numRegionSequences);
+        readOption ("--sample-buffers", options.numSampleBuffers);
+        readOption ("--source-duration", options.sourceDuration);
+        readOption ("--sample-rate", options.sampleRate);
+        readOption ("--channels", options.numChannels);
+        readOption ("--edit-cycles", options.numEditCycles);
+        readOption ("--regions-per-edit", options.numRegionsPerEdit);
+        readOption ("--block-size", options.blockSize);
+        readOption ("--render-duration", options.renderDuration);
+        readOption ("--render-threads", options.numRenderThreads);
+        readOption ("--stretch", options.stretchFactor);
+        readOption ("--seed", options.seed);
+        options.useModelObjectPool = args.containsOption ("--pool");
+
+        if (options.numAudioSources < 1 || options.numModificationsPerSource < 1 || options.numRegionsPerModification < 1
+             || options.numRegionSequences < 1 || options.numSampleBuffers < 1 || options.sourceDuration <= 0.0
+             || options.sampleRate <= 0.0 || options.numChannels < 1 || options.blockSize < 1 || options.stretchFactor <= 0.0)
+            juce::ConsoleApplication::fail ("Invalid option value");
+
+        return options;
+    }
+
+    //==============================================================================
+    template <typename Function>
+    double measureSeconds (Function&& function)
+    {
+        const auto start = juce::Time::getMillisecondCounterHiRes();
+        function();
+        return (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+    }
+
+    void printSection (const juce::String& title)
+    {
+        std::cout << std::endl << title << std::endl;
+    }
+
+    void printTiming (const juce::String& name, double seconds, double count = 0.0, const juce::String& unit = {})
+    {
+        auto line = "  " + name.paddedRight (' ', 44) + juce::String (seconds * 1000.0, 3).paddedLeft (' ', 12) + " ms";
+
+        if (count > 0.0 && seconds > 0.0)
+            line << "  " << juce::String (count / seconds, 1).paddedLeft (' ', 16) << " " << unit << "/s";
+
+        std::cout << line << std::endl;
+    }
+
+    void printValue (const juce::String& name, const juce::String& value)
+    {
+        std::cout << "  " << name.paddedRight (' ', 44) << value.paddedLeft (' ', 12) << std::endl;
+    }
+
+    // Returns the peak resident set size of the process, or -1 if not available on this platform.
+    juce::int64 getPeakResidentMemory()
+    {
+       #if JUCE_LINUX || JUCE_MAC
+        struct rusage usage;
+
+        if (getrusage (RUSAGE_SELF, &usage) == 0)
+           #if JUCE_MAC
+            return (juce::int64) usage.ru_maxrss;
+           #else
+            return (juce::int64) usage.ru_maxrss * 1024;
+           #endif
+       #endif
+
+        return -1;
+    }
+
+    //==============================================================================
+    // Test signals: a sine with a random frequency plus some noise, so that no two buffers are alike.
+    std::vector<std::unique_ptr<juce::AudioBuffer<float>>> createSampleBuffers (const Options& options, juce::Random& random)
+    {
+        std::vector<std::unique_ptr<juce::AudioBuffer<float>>> buffers;
+        const auto numSamples = juce::roundToInt (options.sourceDuration * options.sampleRate);
+
+        for (int i = 0; i < options.numSampleBuffers; ++i)
+        {
+            auto buffer = std::make_unique<juce::AudioBuffer<float>> (options.numChannels, numSamples);
+            const auto frequency = 50.0 + 1000.0 * random.nextDouble();
+            const auto increment = juce::MathConstants<double>::twoPi * frequency / options.sampleRate;
+
+            for (int c = 0; c < options.numChannels; ++c)
+            {
+                auto* samples = buffer->getWritePointer (c);
+
+                for (int s = 0; s < numSamples; ++s)
+                    samples[s] = 0.5f * (float) std::sin (increment * s) + 0.1f * (random.nextFloat() - 0.5f);
+            }
+
+            buffers.push_back (std::move (buffer));
+        }
+
+        return buffers;
+    }
+
+    void buildDocument (ARAMockHost& host, const Options& options, const std::vector<std::unique_ptr<juce::AudioBuffer<float>>>& sampleBuffers,
+                        juce::Random& random)
+    {
+        for (int i = 0; i < options.numRegionSequences; ++i)
+            host.addRegionSequence ("Track " + juce::String (i + 1));
+
+        std::vector<double> sequenceEnds ((size_t) options.numRegionSequences, 0.0);
+        int sequenceIndex = 0;
+
+        for (int i = 0; i < options.numAudioSources; ++i)
+        {
+            const auto& samples = *sampleBuffers[(size_t) i % sampleBuffers.size()];
+            const auto sourceID = "audioSource" + juce::String (i);
+            auto& audioSource = host.addAudioSource ("Audio Source " + juce::String (i + 1), sourceID, samples, options.sampleRate);
+
+            for (int m = 0; m < options.numModificationsPerSource; ++m)
+            {
+                const auto modificationID = sourceID + "_modification" + juce::String (m);
+                auto& audioModification = host.addAudioModification (audioSource, "Modification " + juce::String (m + 1), modificationID);
+
+                for (int r = 0; r < options.numRegionsPerModification; ++r)
+                {
+                    // regions cover a random part of the source and are placed end-to-end on the tracks
+                    const auto duration = options.sourceDuration * (0.25 + 0.75 * random.nextDouble());
+                    const auto start = (options.sourceDuration - duration) * random.nextDouble();
+
+                    auto& sequenceEnd = sequenceEnds[(size_t) sequenceIndex];
+                    host.addPlaybackRegion (audioModification, *host.getRegionSequences()[(size_t) sequenceIndex],
+                                            start, duration, sequenceEnd, duration);
+
+                    sequenceEnd += duration;
+                    sequenceIndex = (sequenceIndex + 1) % options.numRegionSequences;
+                }
+            }
+        }
+    }
+
+    //==============================================================================
+    void runDocumentBenchmarks (ARAMockHost& host, const Options& options, const std::vector<std::unique_ptr<juce::AudioBuffer<float>>>& sampleBuffers,
+                                juce::Random& random)
+    {
+        printSection (juce::String ("Document, model object pool ") + (options.useModelObjectPool ? "enabled" : "disabled"));
+
+        auto* documentController = host.getPlugInDocumentController();
+        documentController->setModelObjectPoolEnabled (options.useModelObjectPool);
+
+        const auto peakMemoryBefore = getPeakResidentMemory();
+
+        host.beginEditing();
+        const auto buildTime = measureSeconds ([&] { buildDocument (host, options, sampleBuffers, random); });
+        const auto endEditingTime = measureSeconds ([&] { host.endEditing(); });
+
+        const auto numObjects = host.getAudioSources().size() + host.getAudioModifications().size()
+                              + host.getRegionSequences().size() + host.getPlaybackRegions().size();
+        printTiming ("create " + juce::String ((int) numObjects) + " objects", buildTime, (double) numObjects, "objects");
+        printTiming ("end initial edit cycle", endEditingTime);
+
+        const auto peakMemoryAfter = getPeakResidentMemory();
+        if (peakMemoryBefore >= 0 && peakMemoryAfter >= 0)
+        {
+            printValue ("peak resident memory", juce::File::descriptionOfSizeInBytes (peakMemoryAfter));
+            printValue ("peak resident memory growth", juce::File::descriptionOfSizeInBytes (peakMemoryAfter - peakMemoryBefore));
+        }
+
+        if (auto* pool = documentController->getModelObjectPool())
+            printValue ("model object pool size", juce::File::descriptionOfSizeInBytes ((juce::int64) pool->getNumBytesReserved()));
+
+        const auto enableTime = measureSeconds ([&]
+        {
+            for (auto& audioSource : host.getAudioSources())
+                host.enableAudioSourceSamplesAccess (*audioSource, true);
+        });
+        printTiming ("enable sample access", enableTime, (double) host.getAudioSources().size(), "sources");
+    }
+
+    void runEditBenchmarks (ARAMockHost& host, const Options& options, juce::Random& random)
+    {
+        auto* documentController = host.getPlugInDocumentController();
+        auto& playbackRegions = host.getPlaybackRegions();
+
+        for (const auto batched : { false, true })
+        {
+            printSection (juce::String ("Edit cycles, listener notification batching ") + (batched ? "enabled" : "disabled"));
+
+            documentController->setBatchedListenerNotificationsEnabled (batched);
+            documentController->resetBatchedNotificationStats();
+
+            double editTime = 0.0, endEditingTime = 0.0, notifyTime = 0.0;
+
+            // the regions nudged by the previous cycle, along with their original start times
+            std::vector<std::pair<ARAMockHost::PlaybackRegion*, double>> nudgedRegions;
+            nudgedRegions.reserve ((size_t) options.numRegionsPerEdit);
+
+            const auto moveNudgedRegionsBack = [&]
+            {
+                // in reverse order, in case a region has been nudged more than once
+                for (auto it = nudgedRegions.rbegin(); it != nudgedRegions.rend(); ++it)
+                {
+                    it->first->startInPlaybackTime = it->second;
+                    host.updatePlaybackRegionProperties (*it->first);
+                }
+
+                nudgedRegions.clear();
+            };
+
+            for (int cycle = 0; cycle < options.numEditCycles; ++cycle)
+            {
+                host.beginEditing();
+
+                editTime += measureSeconds ([&]
+                {
+                    // even cycles nudge some random regions, odd cycles move the same regions back,
+                    // so that the document is unchanged after every pair of cycles
+                    if (cycle % 2 == 0)
+                    {
+                        for (int i = 0; i < options.numRegionsPerEdit; ++i)
+                        {
+                            auto& playbackRegion = *playbackRegions[(size_t) random.nextInt ((int) playbackRegions.size())];
+                            nudgedRegions.emplace_back (&playbackRegion, playbackRegion.startInPlaybackTime);
+                            playbackRegion.startInPlaybackTime += 0.001;
+                            host.updatePlaybackRegionProperties (playbackRegion);
+                        }
+                    }
+                    else
+                    {
+                        moveNudgedRegionsBack();
+                    }
+                });
+
+                endEditingTime += measureSeconds ([&] { host.endEditing(); });
+                notifyTime += measureSeconds ([&] { host.notifyModelUpdates(); });
+            }
+
+            // after an odd number of cycles, the last nudge is undone outside of the measurements
+            if (! nudgedRegions.empty())
+            {
+                host.beginEditing();
+                moveNudgedRegionsBack();
+                host.endEditing();
+                host.notifyModelUpdates();
+            }
+
+            const auto numCycles = (double) options.numEditCycles;
+            printTiming ("region property updates", editTime, numCycles * options.numRegionsPerEdit, "updates");
+            printTiming ("end editing (per cycle)", endEditingTime / numCycles);
+            printTiming ("notify model updates (per cycle)", notifyTime / numCycles);
+
+            if (batched)
+            {
+                const auto& stats = documentController->getBatchedNotificationStats();
+                printValue ("listener notifications received", juce::String (stats.numNotificationsReceived));
+                printValue ("listener notifications delivered", juce::String (stats.numNotificationsDelivered));
+            }
+        }
+
+        documentController->setBatchedListenerNotificationsEnabled (false);
+
+        printSection ("Content updates");
+
+        auto& audioSources = host.getAudioSources();
+        const auto numUpdates = juce::jmin (options.numEditCycles, (int) audioSources.size());
+
+        host.beginEditing();
+        const auto updateTime = measureSeconds ([&]
+        {
+            for (int i = 0; i < numUpdates; ++i)
+            {
+                auto& audioSource = *audioSources[(size_t) random.nextInt ((int) audioSources.size())];
+                const auto start = options.sourceDuration * 0.9 * random.nextDouble();
+                const juce::Range<double> range (start, start + options.sourceDuration * 0.1);
+                host.updateAudioSourceContent (audioSource, &range);
+            }
+        });
+        const auto endEditingTime = measureSeconds ([&] { host.endEditing(); });
+        const auto notifyTime = measureSeconds ([&] { host.notifyModelUpdates(); });
+
+        printTiming ("ranged audio source content updates", updateTime, numUpdates, "updates");
+        printTiming ("end editing", endEditingTime);
+        printTiming ("notify model updates", notifyTime);
+    }
+
+    void runArchivingBenchmarks (ARAMockHost& host)
+    {
+        printSection ("Archiving");
+
+        juce::MemoryBlock archive;
+        bool stored = false, restored = false;
+
+        const auto storeTime = measureSeconds ([&] { stored = host.storeToArchive (archive); });
+        printTiming ("store document", storeTime, (double) archive.getSize(), "bytes");
+
+        // restoring into the same document, which contains all the persistent IDs of the archive
+        const auto restoreTime = measureSeconds ([&] { restored = host.restoreFromArchive (archive); });
+        printTiming ("restore document", restoreTime, (double) archive.getSize(), "bytes");
+
+        printValue ("archive size", juce::File::descriptionOfSizeInBytes ((juce::int64) archive.getSize()));
+
+        if (! stored || ! restored)
+            std::cout << "  archiving FAILED" << std::endl;
+    }
+
+    //==============================================================================
+    double readEntireReader (juce::AudioFormatReader& reader, int blockSize)
+    {
+        juce::AudioBuffer<float> buffer ((int) reader.numChannels, blockSize);
+
+        return measureSeconds ([&]
+        {
+            for (juce::int64 position = 0; position < reader.lengthInSamples; position += blockSize)
+            {
+                const auto numSamples = (int) juce::jmin ((juce::int64) blockSize, reader.lengthInSamples - position);
+                reader.read (&buffer, 0, numSamples, position, true, true);
+            }
+        });
+    }
+
+    double readEntireReaderIntoBuffer (juce::ARAAudioSourceReader& reader, int numChannels, int blockSize)
+    {
+        juce::AudioBuffer<float> buffer (numChannels, blockSize);
+
+        return measureSeconds ([&]
+        {
+            for (juce::int64 position = 0; position < reader.lengthInSamples; position += blockSize)
+            {
+                const auto numSamples = (int) juce::jmin ((juce::int64) blockSize, reader.lengthInSamples - position);
+                reader.readIntoBuffer (buffer, 0, position, numSamples);
+            }
+        });
+    }
+
+    void runReaderBenchmarks (ARAMockHost& host, const Options& options)
+    {
+        printSection ("Audio source readers");
+
+        auto* documentController = host.getPlugInDocumentController();
+        const auto& audioSources = documentController->getDocument()->getAudioSources();
+        const auto numSourcesToRead = juce::jmin ((int) audioSources.size(), 32);
+        const auto readBlockSize = 4096;
+
+        double directTime = 0.0, directIntoBufferTime = 0.0, directIntoMonoBufferTime = 0.0;
+        double coldCacheTime = 0.0, warmCacheTime = 0.0, convertingTime = 0.0;
+        double numSamplesRead = 0.0, numConvertedSamples = 0.0;
+
+        auto& blockCache = documentController->getAudioSourceBlockCache();
+        const auto hitsBefore = blockCache.getNumBlockHits();
+        const auto missesBefore = blockCache.getNumBlockMisses();
+
+        for (int i = 0; i < numSourcesToRead; ++i)
+        {
+            auto* audioSource = audioSources[(size_t) i];
+
+            {
+                juce::ARAAudioSourceReader reader (audioSource);
+                directTime += readEntireReader (reader, readBlockSize);
+                directIntoBufferTime += readEntireReaderIntoBuffer (reader, (int) reader.numChannels, readBlockSize);
+                directIntoMonoBufferTime += readEntireReaderIntoBuffer (reader, 1, readBlockSize);
+                numSamplesRead += (double) reader.lengthInSamples;
+            }
+
+            {
+                juce::ARAAudioSourceReader reader (audioSource, true);
+                coldCacheTime += readEntireReader (reader, readBlockSize);
+                warmCacheTime += readEntireReader (reader, readBlockSize);
+            }
+
+            {
+                // converting to a different rate and to mono, as needed when the renderer runs at another sample rate
+                juce::ARAConvertingAudioReader reader (new juce::ARAAudioSourceReader (audioSource), options.sampleRate * 48000.0 / 44100.0, 1);
+                convertingTime += readEntireReader (reader, readBlockSize);
+                numConvertedSamples += (double) reader.lengthInSamples;
+            }
+        }
+
+        printTiming ("direct", directTime, numSamplesRead, "samples");
+        printTiming ("direct, readIntoBuffer()", directIntoBufferTime, numSamplesRead, "samples");
+        printTiming ("direct, readIntoBuffer() skipping channels", directIntoMonoBufferTime, numSamplesRead, "samples");
+        printTiming ("block cache, cold", coldCacheTime, numSamplesRead, "samples");
+        printTiming ("block cache, warm", warmCacheTime, numSamplesRead, "samples");
+        printTiming ("sample rate and channel conversion", convertingTime, numConvertedSamples, "samples");
+        printValue ("block cache hits", juce::String (blockCache.getNumBlockHits() - hitsBefore));
+        printValue ("block cache misses", juce::String (blockCache.getNumBlockMisses() - missesBefore));
+    }
+
+    void runRegionReaderBenchmarks (ARAMockHost& host, const Options& options)
+    {
+        printSection ("Playback region readers");
+
+        auto* documentController = host.getPlugInDocumentController();
+        const auto& playbackRegions = documentController->getDocument()->getRegionSequences().front()->getPlaybackRegions();
+        const auto numRegions = (double) playbackRegions.size();
+
+        for (const auto numThreads : { 0, options.numRenderThreads })
+        {
+            juce::ARAPlaybackRegionReader reader (options.sampleRate, options.numChannels, playbackRegions);
+            reader.setNumParallelRenderThreads (numThreads);
+
+            const auto seconds = readEntireReader (reader, 64 * 1024);
+            printTiming ("first track, " + juce::String (numThreads) + " worker threads", seconds, numRegions, "regions");
+        }
+    }
+
+    //==============================================================================
+    class PlayHead  : public juce::AudioPlayHead
+    {
+    public:
+        explicit PlayHead (double sampleRate)
+        {
+            positionInfo.resetToDefault();
+            positionInfo.isPlaying = true;
+            setPosition (0, sampleRate);
+        }
+
+        void setPosition (juce::int64 timeInSamples, double sampleRate)
+        {
+            positionInfo.timeInSamples = timeInSamples;
+            positionInfo.timeInSeconds = (double) timeInSamples / sampleRate;
+        }
+
+        bool getCurrentPosition (CurrentPositionInfo& result) override
+        {
+            result = positionInfo;
+            return true;
+        }
+
+    private:
+        CurrentPositionInfo positionInfo;
+    };
+
+    template <typename FloatType>
+    double renderTrack (juce::AudioProcessor& processor, const Options& options)
+    {
+        PlayHead playHead (options.sampleRate);
+        processor.setPlayHead (&playHead);
+
+        const auto numChannels = juce::jmax (processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+        juce::AudioBuffer<FloatType> buffer (numChannels, options.blockSize);
+        juce::MidiBuffer midi;
+        const auto numSamplesToRender = (juce::int64) (options.renderDuration * options.sampleRate);
+
+        const auto seconds = measureSeconds ([&]
+        {
+            for (juce::int64 position = 0; position < numSamplesToRender; position += options.blockSize)
+            {
+                playHead.setPosition (position, options.sampleRate);
+                buffer.clear();
+                processor.processBlock (buffer, midi);
+            }
+        });
+
+        processor.setPlayHead (nullptr);
+        return seconds;
+    }
+
+    // Renders double precision buffers through the default ARARenderer::processBlock() for double
+    // precision, which converts the samples to and from the float variant, like for any renderer
+    // that doesn't override it.
+    double renderTrackThroughFloatRenderer (juce::AudioProcessor& processor, juce::ARAPlaybackRenderer& playbackRenderer, const Options& options)
+    {
+        PlayHead playHead (options.sampleRate);
+        juce::AudioPlayHead::CurrentPositionInfo positionInfo;
+
+        const auto numChannels = juce::jmax (processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+        juce::AudioBuffer<double> buffer (numChannels, options.blockSize);
+        const auto numSamplesToRender = (juce::int64) (options.renderDuration * options.sampleRate);
+
+        return measureSeconds ([&]
+        {
+            for (juce::int64 position = 0; position < numSamplesToRender; position += options.blockSize)
+            {
+                playHead.setPosition (position, options.sampleRate);
+                playHead.getCurrentPosition (positionInfo);
+                buffer.clear();
+                playbackRenderer.juce::ARARenderer::processBlock (buffer, true, positionInfo);
+            }
+        });
+    }
+
+    std::vector<ARAMockHost::PlaybackRegion*> getRegionsOnFirstTrack (ARAMockHost& host)
+    {
+        std::vector<ARAMockHost::PlaybackRegion*> regionsOnFirstTrack;
+        for (auto& playbackRegion : host.getPlaybackRegions())
+            if (playbackRegion->regionSequence == host.getRegionSequences().front().get())
+                regionsOnFirstTrack.push_back (playbackRegion.get());
+
+        return regionsOnFirstTrack;
+    }
+
+    void runOfflineRenderJobBenchmark (ARAMockHost& host, const Options& options)
+    {
+        auto* processor = host.createPlaybackRenderer (getRegionsOnFirstTrack (host));
+        processor->setNonRealtime (true);
+        processor->setRateAndBufferSizeDetails (options.sampleRate, options.blockSize);
+        processor->prepareToPlay (options.sampleRate, options.blockSize);
+
+        if (auto* playbackRenderer = dynamic_cast<juce::AudioProcessorARAExtension&> (*processor).getPlaybackRenderer())
+        {
+            const auto numChannels = juce::jmax (processor->getTotalNumInputChannels(), processor->getTotalNumOutputChannels());
+            juce::AudioBuffer<float> buffer (numChannels, options.blockSize);
+            const auto numSamplesToRender = (juce::int64) (options.renderDuration * options.sampleRate);
+            int numPrefetchMisses = 0;
+
+            // includes creating the schedule and waiting for the first window to be prefetched
+            const auto seconds = measureSeconds ([&]
+            {
+                juce::ARAPlaybackRenderer::OfflineRenderJob job (*playbackRenderer, { 0, numSamplesToRender });
+
+                while (! job.isFinished())
+                    job.renderNextBlock (buffer);
+
+                numPrefetchMisses = job.getNumPrefetchMisses();
+            });
+
+            printTiming ("first track, offline render job, realtime factor " + juce::String (options.renderDuration / seconds, 1),
+                         seconds, options.renderDuration * options.sampleRate, "samples");
+            printValue ("offline render job prefetch misses", juce::String (numPrefetchMisses));
+        }
+
+        processor->releaseResources();
+        host.destroyPlaybackRenderer (processor);
+    }
+
+    void runRenderBenchmarks (ARAMockHost& host, const Options& options)
+    {
+        printSection ("Rendering");
+
+        const auto regionsOnFirstTrack = getRegionsOnFirstTrack (host);
+
+        enum class RenderPath { singlePrecision, doublePrecision, doublePrecisionThroughFloatRenderer };
+
+        for (const auto renderPath : { RenderPath::singlePrecision, RenderPath::doublePrecision, RenderPath::doublePrecisionThroughFloatRenderer })
+        {
+            const auto isDouble = (renderPath != RenderPath::singlePrecision);
+            auto* processor = host.createPlaybackRenderer (regionsOnFirstTrack);
+            auto* playbackRenderer = dynamic_cast<juce::AudioProcessorARAExtension&> (*processor).getPlaybackRenderer();
+
+            if ((isDouble && ! processor->supportsDoublePrecisionProcessing())
+                || (renderPath == RenderPath::doublePrecisionThroughFloatRenderer && playbackRenderer == nullptr))
+            {
+                host.destroyPlaybackRenderer (processor);
+                continue;
+            }
+
+            processor->setNonRealtime (true);
+            processor->setProcessingPrecision (isDouble ? juce::AudioProcessor::doublePrecision : juce::AudioProcessor::singlePrecision);
+            processor->setRateAndBufferSizeDetails (options.sampleRate, options.blockSize);
+            processor->prepareToPlay (options.sampleRate, options.blockSize);
+
+            double seconds = 0.0;
+            juce::String description;
+
+            switch (renderPath)
+            {
+                case RenderPath::singlePrecision:
+                    seconds = renderTrack<float> (*processor, options);
+                    description = "float precision";
+                    break;
+
+                case RenderPath::doublePrecision:
+                    seconds = renderTrack<double> (*processor, options);
+                    description = "double precision";
+                    break;
+
+                case RenderPath::doublePrecisionThroughFloatRenderer:
+                    seconds = renderTrackThroughFloatRenderer (*processor, *playbackRenderer, options);
+                    description = "double precision converted for the float renderer";
+                    break;
+            }
+
+            printTiming ("first track, " + description + ", realtime factor " + juce::String (options.renderDuration / seconds, 1),
+                         seconds, options.renderDuration * options.sampleRate, "samples");
+
+            processor->releaseResources();
+            host.destroyPlaybackRenderer (processor);
+        }
+
+        runOfflineRenderJobBenchmark (host, options);
+    }
+
+    void runTimeStretchBenchmarks (ARAMockHost& host, const Options& options)
+    {
+        printSection ("Time stretching");
+
+        if ((host.getFactory()->supportedPlaybackTransformationFlags & ARA::kARAPlaybackTransformationTimestretch) == 0)
+        {
+            std::cout << "  skipped, the plug-in does not support time stretching" << std::endl;
+            return;
+        }
+
+        const auto regionsOnFirstTrack = getRegionsOnFirstTrack (host);
+
+        const auto setStretched = [&] (bool stretch)
+        {
+            host.beginEditing();
+
+            for (auto* playbackRegion : regionsOnFirstTrack)
+            {
+                playbackRegion->transformationFlags = ARA::kARAPlaybackTransformationNoChanges;
+                if (stretch)
+                    playbackRegion->transformationFlags |= ARA::kARAPlaybackTransformationTimestretch;
+
+                playbackRegion->durationInPlaybackTime = playbackRegion->durationInModificationTime * (stretch ? options.stretchFactor : 1.0);
+                host.updatePlaybackRegionProperties (*playbackRegion);
+            }
+
+            host.endEditing();
+            host.notifyModelUpdates();
+        };
+
+        setStretched (true);
+
+        auto* processor = host.createPlaybackRenderer (regionsOnFirstTrack);
+        processor->setNonRealtime (true);
+        processor->setRateAndBufferSizeDetails (options.sampleRate, options.blockSize);
+        processor->prepareToPlay (options.sampleRate, options.blockSize);
+
+        // rendering the same range twice shows the effect of the plug-in caching the stretched samples
+        for (const auto* pass : { "first pass", "second pass" })
+        {
+            const auto seconds = renderTrack<float> (*processor, options);
+
+            printTiming (juce::String ("first track, stretched by ") + juce::String (options.stretchFactor, 2) + ", " + pass
+                            + ", realtime factor " + juce::String (options.renderDuration / seconds, 1),
+                         seconds, options.renderDuration * options.sampleRate, "samples");
+        }
+
+        processor->releaseResources();
+        host.destroyPlaybackRenderer (processor);
+
+        setStretched (false);
+    }
+
+    //==============================================================================
+    // Records which audio sources the analysis jobs started on, and how they finished.
+    struct AnalysisLog
+    {
+        void addStarted (juce::ARAAudioSource* audioSource)
+        {
+            const juce::ScopedLock sl (lock);
+            started.push_back (audioSource);
+        }
+
+        std::vector<juce::ARAAudioSource*> getStarted() const
+        {
+            const juce::ScopedLock sl (lock);
+            return started;
+        }
+
+        bool hasFinished (juce::ARAAudioSource* audioSource, bool succeeded) const
+        {
+            return std::find (finished.begin(), finished.end(), std::make_pair (audioSource, succeeded)) != finished.end();
+        }
+
+        void clear()
+        {
+            const juce::ScopedLock sl (lock);
+            started.clear();
+            finished.clear();
+        }
+
+        juce::CriticalSection lock;
+        std::vector<juce::ARAAudioSource*> started;
+        std::vector<std::pair<juce::ARAAudioSource*, bool>> finished;  // message thread only
+    };
+
+    // A trivial analysis that measures the peak level of an audio source. If it is given a start event,
+    // it holds on to its worker thread until the event is signalled or the job is cancelled.
+    struct PeakAnalysisJob  : public juce::ARAAnalysisScheduler::AnalysisJob
+    {
+        PeakAnalysisJob (juce::ARAAudioSource* source, AnalysisLog& logToUse, juce::WaitableEvent* startEventToUse = nullptr)
+            : AnalysisJob (source), log (logToUse), startEvent (startEventToUse)
+        {}
+
+        bool runAnalysis() override
+        {
+            log.addStarted (getAudioSource());
+
+            if (startEvent != nullptr)
+            {
+                // don't block forever if cancelling doesn't work
+                const auto timeout = juce::Time::getMillisecondCounter() + 10000;
+
+                while (! startEvent->wait (1))
+                    if (shouldExit() || juce::Time::getMillisecondCounter() > timeout)
+                        return false;
+            }
+
+            auto& sourceReader = getReader();
+            juce::AudioBuffer<float> buffer ((int) sourceReader.numChannels, blockSize);
+
+            for (juce::int64 position = 0; position < sourceReader.lengthInSamples; position += blockSize)
+            {
+                if (shouldExit())
+                    return false;
+
+                const auto numSamples = (int) juce::jmin ((juce::int64) blockSize, sourceReader.lengthInSamples - position);
+
+                if (! sourceReader.readIntoBuffer (buffer, 0, position, numSamples))
+                    return false;
+
+                peak = juce::jmax (peak, buffer.getMagnitude (0, numSamples));
+                setProgress ((float) (position + numSamples) / (float) sourceReader.lengthInSamples);
+            }
+
+            return true;
+        }
+
+        void didFinishAnalysis (bool analysisSucceeded) override
+        {
+            log.finished.emplace_back (getAudioSource(), analysisSucceeded);
+        }
+
+        static constexpr int blockSize = 4096;
+
+        AnalysisLog& log;
+        juce::WaitableEvent* const startEvent;
+        float peak = 0.0f;
+    };
+
+    // Dispatches messages, and with them the results of finished analysis jobs, until the condition is met.
+    template <typename Condition>
+    bool dispatchMessagesUntil (Condition&& condition)
+    {
+        const auto timeout = juce::Time::getMillisecondCounter() + 10000;
+
+        while (! condition())
+        {
+            if (juce::Time::getMillisecondCounter() > timeout)
+                return false;
+
+            juce::MessageManager::getInstance()->runDispatchLoopUntil (1);
+        }
+
+        return true;
+    }
+
+    void runAnalysisSchedulerBenchmarks (ARAMockHost& host)
+    {
+        printSection ("Analysis scheduler");
+
+        auto* documentController = host.getPlugInDocumentController();
+        const auto audioSources = documentController->getDocument()->getAudioSources();
+        AnalysisLog log;
+
+        {
+            const auto numSourcesToAnalyse = juce::jmin ((int) audioSources.size(), 32);
+            double numSamplesAnalysed = 0.0;
+            auto& scheduler = documentController->getAnalysisScheduler();
+
+            const auto analysisTime = measureSeconds ([&]
+            {
+                for (int i = 0; i < numSourcesToAnalyse; ++i)
+                {
+                    auto job = std::make_unique<PeakAnalysisJob> (audioSources[(size_t) i], log);
+                    numSamplesAnalysed += (double) job->getReader().lengthInSamples;
+                    scheduler.scheduleAnalysis (std::move (job));
+                }
+
+                if (! dispatchMessagesUntil ([&] { return (int) log.finished.size() == numSourcesToAnalyse; }))
+                    juce::ConsoleApplication::fail ("Analysis jobs did not finish");
+            });
+
+            printTiming ("analyse " + juce::String (numSourcesToAnalyse) + " sources", analysisTime, numSamplesAnalysed, "samples");
+        }
+
+        if (audioSources.size() < 4)
+        {
+            std::cout << "  skipped the priority and cancellation checks, they need at least 4 audio sources" << std::endl;
+            return;
+        }
+
+        const auto findHostAudioSource = [&] (juce::ARAAudioSource* audioSource) -> ARAMockHost::AudioSource&
+        {
+            for (auto& hostAudioSource : host.getAudioSources())
+                if (hostAudioSource->persistentID == audioSource->getPersistentID())
+                    return *hostAudioSource;
+
+            juce::ConsoleApplication::fail ("Unknown audio source");
+            return *host.getAudioSources().front();
+        };
+
+        // with a single worker thread, the jobs queued up behind a running job start one after the other
+        juce::ARAAnalysisScheduler scheduler (1);
+        juce::WaitableEvent startEvent;
+        auto* source0 = audioSources[0];
+        auto* source1 = audioSources[1];
+        auto* source2 = audioSources[2];
+        auto* source3 = audioSources[3];
+
+        const auto waitUntilStarted = [&] (juce::ARAAudioSource* audioSource)
+        {
+            if (! dispatchMessagesUntil ([&] { return ARA::contains (log.getStarted(), audioSource); }))
+                juce::ConsoleApplication::fail ("Analysis job did not start");
+        };
+
+        {
+            log.clear();
+            scheduler.scheduleAnalysis (std::make_unique<PeakAnalysisJob> (source0, log, &startEvent));
+            waitUntilStarted (source0);
+
+            scheduler.scheduleAnalysis (std::make_unique<PeakAnalysisJob> (source1, log));
+            scheduler.scheduleAnalysis (std::make_unique<PeakAnalysisJob> (source2, log), juce::ARAAnalysisScheduler::Priority::requestedByHost);
+            scheduler.scheduleAnalysis (std::make_unique<PeakAnalysisJob> (source3, log));
+            scheduler.setAudioSourcesVisibleInEditor ({ source3 });
+            startEvent.signal();
+
+            if (! dispatchMessagesUntil ([&] { return log.finished.size() == 4; }))
+                juce::ConsoleApplication::fail ("Analysis jobs did not finish");
+
+            if (log.getStarted() != std::vector<juce::ARAAudioSource*> { source0, source3, source2, source1 })
+                juce::ConsoleApplication::fail ("Analysis jobs did not start in order of their priority");
+
+            printValue ("visible, then requested sources first", "ok");
+            scheduler.setAudioSourcesVisibleInEditor ({});
+            startEvent.reset();
+        }
+
+        {
+            // the running job only ends when it is cancelled, while the pending job runs once the first one is gone
+            log.clear();
+            scheduler.scheduleAnalysis (std::make_unique<PeakAnalysisJob> (source0, log, &startEvent));
+            waitUntilStarted (source0);
+            scheduler.scheduleAnalysis (std::make_unique<PeakAnalysisJob> (source1, log));
+
+            auto& hostAudioSource0 = findHostAudioSource (source0);
+            const auto cancelTime = measureSeconds ([&] { host.enableAudioSourceSamplesAccess (hostAudioSource0, false); });
+
+            if (! log.hasFinished (source0, false))
+                juce::ConsoleApplication::fail ("Disabling sample access did not cancel the running analysis");
+
+            host.enableAudioSourceSamplesAccess (hostAudioSource0, true);
+
+            if (! dispatchMessagesUntil ([&] { return log.hasFinished (source1, true); }))
+                juce::ConsoleApplication::fail ("Pending analysis job did not finish");
+
+            printTiming ("cancel running job on disabling sample access", cancelTime);
+        }
+
+        {
+            log.clear();
+            scheduler.scheduleAnalysis (std::make_unique<PeakAnalysisJob> (source0, log, &startEvent));
+            waitUntilStarted (source0);
+            scheduler.scheduleAnalysis (std::make_unique<PeakAnalysisJob> (source1, log));
+
+            auto& hostAudioSource0 = findHostAudioSource (source0);
+            auto& hostAudioSource1 = findHostAudioSource (source1);
+
+            host.beginEditing();
+            const auto cancelPendingTime = measureSeconds ([&] { host.removeAudioSource (hostAudioSource1); });
+            const auto cancelRunningTime = measureSeconds ([&] { host.removeAudioSource (hostAudioSource0); });
+            host.endEditing();
+            host.notifyModelUpdates();
+
+            if (! log.hasFinished (source1, false) || ! log.hasFinished (source0, false) || scheduler.getNumActiveJobs() != 0)
+                juce::ConsoleApplication::fail ("Destroying audio sources did not cancel their analysis");
+
+            printTiming ("cancel pending job on destroying its source", cancelPendingTime);
+            printTiming ("cancel running job on destroying its source", cancelRunningTime);
+        }
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList args (argc, argv);
+
+    if (args.containsOption ("--help|-h"))
+    {
+        std::cout << args.executableName << " " << usage;
+        return 0;
+    }
+
+    return juce::ConsoleApplication::invokeCatchingFailures ([&]
+    {
+        const auto options = parseOptions (args);
+
+        // the plug-in requires a message thread
+        juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+        juce::Random random (options.seed);
+        const auto sampleBuffers = createSampleBuffers (options, random);
+
+        ARAMockHost host (createARAFactory());
+        std::cout << "Plug-in: " << host.getFactory()->plugInName << " " << host.getFactory()->version << std::endl;
+
+        runDocumentBenchmarks (host, options, sampleBuffers, random);
+        runEditBenchmarks (host, options, random);
+        runArchivingBenchmarks (host);
+        runReaderBenchmarks (host, options);
+        runRegionReaderBenchmarks (host, options);
+        runRenderBenchmarks (host, options);
+        runTimeStretchBenchmarks (host, options);
+        runAnalysisSchedulerBenchmarks (host);
+
+        const auto& statistics = host.getStatistics();
+        printSection ("Host interface calls");
+        printValue ("audio readers created", juce::String (statistics.numAudioReadersCreated.load()));
+        printValue ("read calls", juce::String (statistics.numReadCalls.load()));
+        printValue ("samples read", juce::String (statistics.numSamplesRead.load()));
+        printValue ("analysis progress notifications", juce::String (statistics.numAnalysisProgressNotifications.load()));
+        printValue ("content changed notifications", juce::String (statistics.numContentChangedNotifications.load()));
+
+        return 0;
+    });
+}
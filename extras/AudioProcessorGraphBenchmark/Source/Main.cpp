@@ -0,0 +1,356 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 6 End-User License
+   Agreement and JUCE Privacy Policy (both effective as of the 16th June 2020).
+
+   End User License Agreement: www.juce.com/juce-6-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+//==============================================================================
+namespace
+{
+    struct Options
+    {
+        int numChains = 16;
+        int chainLength = 4;
+        int depth = 32;
+        int load = 32;
+        int blockSize = 512;
+        int numBlocks = 1000;
+        double sampleRate = 44100.0;
+        int numRenderThreads = juce::jmax (1, juce::SystemStats::getNumCpus() - 1);
+        int numEdits = 100;
+    };
+
+    const char* const usage = R"([options]
+
+Renders a wide and a deep AudioProcessorGraph, both serially and with
+AudioProcessorGraph::setNumParallelRenderThreads(), and reports the average
+time per block. Then reports the time that it takes to add and remove a
+connection of prepared graphs of increasing size, including the rebuild of
+the rendering sequence.
+
+    --chains=N          parallel chains of the wide graph (16)
+    --chain-length=N    nodes per chain of the wide graph (4)
+    --depth=N           nodes in the single chain of the deep graph (32)
+    --load=N            filter stages per channel that each node runs (32)
+    --block-size=N      render block size (512)
+    --blocks=N          number of blocks rendered per measurement (1000)
+    --sample-rate=RATE  sample rate (44100)
+    --render-threads=N  worker threads for parallel rendering (number of cores - 1)
+    --edits=N           connections added and removed per graph size (100)
+)";
+
+    Options parseOptions (const juce::ArgumentList& args)
+    {
+        Options options;
+
+        const auto readOption = [&args] (juce::StringRef name, auto& value)
+        {
+            if (args.containsOption (name))
+            {
+                const auto string = args.getValueForOption (name);
+
+                if (string.isEmpty())
+                    juce::ConsoleApplication::fail ("Missing value for option " + juce::String (name));
+
+                using ValueType = typename std::remove_reference<decltype (value)>::type;
+                value = std::is_floating_point<ValueType>::value ? (ValueType) string.getDoubleValue()
+                                                                 : (ValueType) string.getLargeIntValue();
+            }
+        };
+
+        readOption ("--chains", options.numChains);
+        readOption ("--chain-length", options.chainLength);
+        readOption ("--depth", options.depth);
+        readOption ("--load", options.load);
+        readOption ("--block-size", options.blockSize);
+        readOption ("--blocks", options.numBlocks);
+        readOption ("--sample-rate", options.sampleRate);
+        readOption ("--render-threads", options.numRenderThreads);
+        readOption ("--edits", options.numEdits);
+
+        if (options.numChains < 1 || options.chainLength < 1 || options.depth < 1 || options.load < 0
+             || options.blockSize < 1 || options.numBlocks < 1 || options.sampleRate <= 0.0 || options.numRenderThreads < 1
+             || options.numEdits < 1)
+            juce::ConsoleApplication::fail ("Invalid option value");
+
+        return options;
+    }
+
+    //==============================================================================
+    template <typename Function>
+    double measureSeconds (Function&& function)
+    {
+        const auto start = juce::Time::getMillisecondCounterHiRes();
+        function();
+        return (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+    }
+
+    void printSection (const juce::String& title)
+    {
+        std::cout << std::endl << title << std::endl;
+    }
+
+    void printEditTiming (const juce::String& name, double secondsPerEdit)
+    {
+        std::cout << "  " << name.paddedRight (' ', 44) << juce::String (secondsPerEdit * 1000.0, 3).paddedLeft (' ', 12) << " ms/edit" << std::endl;
+    }
+
+    void printTiming (const juce::String& name, double secondsPerBlock, double serialSecondsPerBlock)
+    {
+        auto line = "  " + name.paddedRight (' ', 44) + juce::String (secondsPerBlock * 1000.0, 3).paddedLeft (' ', 12) + " ms/block";
+
+        if (secondsPerBlock > 0.0)
+            line << "  speedup " << juce::String (serialSecondsPerBlock / secondsPerBlock, 2);
+
+        std::cout << line << std::endl;
+    }
+
+    //==============================================================================
+    // A stereo node that runs a cascade of one-pole lowpass filters, to simulate a plug-in with a fixed load.
+    class LoadProcessor  : public juce::AudioProcessor
+    {
+    public:
+        explicit LoadProcessor (int numStagesToUse)
+            : AudioProcessor (BusesProperties().withInput  ("Input",  juce::AudioChannelSet::stereo())
+                                               .withOutput ("Output", juce::AudioChannelSet::stereo())),
+              numStages (numStagesToUse)
+        {}
+
+        const juce::String getName() const override                        { return "Load"; }
+
+        void prepareToPlay (double, int) override
+        {
+            states.assign ((size_t) (2 * numStages), 0.0f);
+        }
+
+        void releaseResources() override                                    {}
+
+        void processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) override
+        {
+            for (int channel = 0; channel < juce::jmin (2, buffer.getNumChannels()); ++channel)
+            {
+                auto* data = buffer.getWritePointer (channel);
+
+                for (int stage = 0; stage < numStages; ++stage)
+                {
+                    auto& state = states[(size_t) (channel * numStages + stage)];
+
+                    for (int i = 0; i < buffer.getNumSamples(); ++i)
+                        data[i] = state += 0.5f * (data[i] - state);
+                }
+            }
+        }
+
+        using AudioProcessor::processBlock;
+
+        double getTailLengthSeconds() const override                        { return 0.0; }
+        bool acceptsMidi() const override                                   { return false; }
+        bool producesMidi() const override                                  { return false; }
+        juce::AudioProcessorEditor* createEditor() override                 { return nullptr; }
+        bool hasEditor() const override                                     { return false; }
+        int getNumPrograms() override                                       { return 1; }
+        int getCurrentProgram() override                                    { return 0; }
+        void setCurrentProgram (int) override                               {}
+        const juce::String getProgramName (int) override                    { return {}; }
+        void changeProgramName (int, const juce::String&) override          {}
+        void getStateInformation (juce::MemoryBlock&) override              {}
+        void setStateInformation (const void*, int) override                {}
+
+    private:
+        const int numStages;
+        std::vector<float> states;
+    };
+
+    //==============================================================================
+    using NodeID = juce::AudioProcessorGraph::NodeID;
+    using IOProcessor = juce::AudioProcessorGraph::AudioGraphIOProcessor;
+
+    NodeID addNode (juce::AudioProcessorGraph& graph, std::unique_ptr<juce::AudioProcessor> processor)
+    {
+        return graph.addNode (std::move (processor))->nodeID;
+    }
+
+    void connect (juce::AudioProcessorGraph& graph, NodeID source, NodeID destination)
+    {
+        for (int channel = 0; channel < 2; ++channel)
+            graph.addConnection ({ { source, channel }, { destination, channel } });
+    }
+
+    // Adds a chain of load nodes between the graph input and output.
+    void addChain (juce::AudioProcessorGraph& graph, NodeID input, NodeID output, int length, int load)
+    {
+        auto previous = input;
+
+        for (int i = 0; i < length; ++i)
+        {
+            const auto node = addNode (graph, std::make_unique<LoadProcessor> (load));
+            connect (graph, previous, node);
+            previous = node;
+        }
+
+        connect (graph, previous, output);
+    }
+
+    std::unique_ptr<juce::AudioProcessorGraph> createGraph (const Options& options, int numChains, int chainLength)
+    {
+        auto graph = std::make_unique<juce::AudioProcessorGraph>();
+
+        // the channels of the IO nodes are taken from the graph when they are added
+        graph->setPlayConfigDetails (2, 2, options.sampleRate, options.blockSize);
+
+        const auto input  = addNode (*graph, std::make_unique<IOProcessor> (IOProcessor::audioInputNode));
+        const auto output = addNode (*graph, std::make_unique<IOProcessor> (IOProcessor::audioOutputNode));
+
+        for (int i = 0; i < numChains; ++i)
+            addChain (*graph, input, output, chainLength, options.load);
+
+        return graph;
+    }
+
+    double measureSecondsPerBlock (juce::AudioProcessorGraph& graph, const Options& options, int numRenderThreads)
+    {
+        graph.setNumParallelRenderThreads (numRenderThreads);
+        graph.prepareToPlay (options.sampleRate, options.blockSize);
+
+        juce::AudioBuffer<float> buffer (2, options.blockSize);
+        juce::MidiBuffer midi;
+        juce::Random random;
+
+        const auto renderBlock = [&]
+        {
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = 0; i < options.blockSize; ++i)
+                    buffer.setSample (channel, i, random.nextFloat() - 0.5f);
+
+            midi.clear();
+            graph.processBlock (buffer, midi);
+        };
+
+        // let the worker threads and caches warm up
+        for (int i = 0; i < 10; ++i)
+            renderBlock();
+
+        const auto seconds = measureSeconds ([&]
+        {
+            for (int i = 0; i < options.numBlocks; ++i)
+                renderBlock();
+        });
+
+        graph.releaseResources();
+        return seconds / options.numBlocks;
+    }
+
+    void runGraphBenchmark (const juce::String& title, juce::AudioProcessorGraph& graph, const Options& options)
+    {
+        printSection (title + " (" + juce::String (graph.getNumNodes() - 2) + " nodes)");
+
+        const auto serialSecondsPerBlock = measureSecondsPerBlock (graph, options, 0);
+        printTiming ("serial", serialSecondsPerBlock, serialSecondsPerBlock);
+
+        // powers of two up to the requested number of threads
+        juce::Array<int> threadCounts;
+
+        for (int numThreads = 1; numThreads < options.numRenderThreads; numThreads *= 2)
+            threadCounts.add (numThreads);
+
+        threadCounts.add (options.numRenderThreads);
+
+        for (auto numThreads : threadCounts)
+            printTiming ("parallel, " + juce::String (numThreads) + " worker thread" + (numThreads > 1 ? "s" : ""),
+                         measureSecondsPerBlock (graph, options, numThreads), serialSecondsPerBlock);
+    }
+
+    //==============================================================================
+    // Every edit of a prepared graph rebuilds its rendering sequence synchronously when called on the message thread.
+    double measureSecondsPerEdit (const Options& options, int numNodes)
+    {
+        const auto numChains = juce::jmax (1, numNodes / options.chainLength);
+        const auto graph = createGraph (options, numChains, options.chainLength);
+        graph->prepareToPlay (options.sampleRate, options.blockSize);
+
+        // connect the last node of the graph back into the first chain, and disconnect it again
+        const auto nodes = graph->getNodes();
+        const auto source = nodes.getLast()->nodeID;
+        const auto destination = nodes[2]->nodeID;
+
+        const auto seconds = measureSeconds ([&]
+        {
+            for (int i = 0; i < options.numEdits; ++i)
+            {
+                connect (*graph, source, destination);
+
+                for (int channel = 0; channel < 2; ++channel)
+                    graph->removeConnection ({ { source, channel }, { destination, channel } });
+            }
+        });
+
+        graph->releaseResources();
+
+        // each connection is added and removed one channel at a time
+        return seconds / (4 * options.numEdits);
+    }
+
+    void runEditBenchmark (const Options& options)
+    {
+        printSection ("Editing prepared graphs of " + juce::String (options.chainLength) + " node chains");
+
+        for (auto numNodes : { 16, 64, 256, 1024 })
+            printEditTiming (juce::String (numNodes) + " nodes", measureSecondsPerEdit (options, numNodes));
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList args (argc, argv);
+
+    if (args.containsOption ("--help|-h"))
+    {
+        std::cout << args.executableName << " " << usage;
+        return 0;
+    }
+
+    return juce::ConsoleApplication::invokeCatchingFailures ([&]
+    {
+        const auto options = parseOptions (args);
+
+        // the graph builds its rendering sequence on the message thread
+        juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+        std::cout << "Block size " << options.blockSize << ", " << options.load << " filter stages per node, "
+                  << juce::SystemStats::getNumCpus() << " cores" << std::endl;
+
+        const auto wideGraph = createGraph (options, options.numChains, options.chainLength);
+        runGraphBenchmark ("Wide graph, " + juce::String (options.numChains) + " chains of " + juce::String (options.chainLength) + " nodes",
+                           *wideGraph, options);
+
+        const auto deepGraph = createGraph (options, 1, options.depth);
+        runGraphBenchmark ("Deep graph, a single chain of " + juce::String (options.depth) + " nodes",
+                           *deepGraph, options);
+
+        runEditBenchmark (options);
+
+        return 0;
+    });
+}
@@ -0,0 +1,446 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 6 End-User License
+   Agreement and JUCE Privacy Policy (both effective as of the 16th June 2020).
+
+   End User License Agreement: www.juce.com/juce-6-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+//==============================================================================
+namespace
+{
+    const char* const workerCommandLineID = "pluginscantestworker";
+
+    struct Options
+    {
+        int numPlugins = 32;
+        int numWorkers = juce::jmax (2, juce::SystemStats::getNumCpus());
+        int loadTimeMs = 50;
+        int timeoutMs = 2000;
+        bool keepFiles = false;
+    };
+
+    const char* const usage = R"([options]
+
+Creates a folder of dummy LADSPA plugins and VST3 bundles, including some that
+crash, hang or don't contain any plugins, and scans them with a
+ParallelPluginScanner. Checks that the crashing and hanging plugins are
+blacklisted, that the results match a serial scan of the working plugins with
+a PluginDirectoryScanner, that a rescan is served entirely from the
+PluginScanCache, and that changing a single binary only rescans that binary.
+Exits with an error if any of the checks fail.
+
+    --plugins=N     working dummy plugins of each format (32)
+    --workers=N     worker processes (number of cores, at least 2)
+    --load-time=MS  time that each dummy plugin takes to load (50)
+    --timeout=MS    scan timeout after which a plugin is considered hung (2000)
+    --keep-files    don't delete the dummy plugins and the scan cache
+)";
+
+    Options parseOptions (const juce::ArgumentList& args)
+    {
+        Options options;
+
+        const auto readOption = [&args] (juce::StringRef name, int& value)
+        {
+            if (args.containsOption (name))
+            {
+                const auto string = args.getValueForOption (name);
+
+                if (string.isEmpty())
+                    juce::ConsoleApplication::fail ("Missing value for option " + juce::String (name));
+
+                value = string.getIntValue();
+            }
+        };
+
+        readOption ("--plugins", options.numPlugins);
+        readOption ("--workers", options.numWorkers);
+        readOption ("--load-time", options.loadTimeMs);
+        readOption ("--timeout", options.timeoutMs);
+        options.keepFiles = args.containsOption ("--keep-files");
+
+        if (options.numPlugins < 1 || options.numWorkers < 1 || options.loadTimeMs < 0 || options.timeoutMs < 1)
+            juce::ConsoleApplication::fail ("Invalid option value");
+
+        return options;
+    }
+
+    //==============================================================================
+    /*  A format that "loads" dummy plugins that are laid out like LADSPA plugins or
+        Linux VST3 bundles. Instead of code, each binary contains a line of text that
+        says how the plugin behaves when it is scanned, e.g. "plugins 2 delay 50"
+        for a binary that takes 50 ms to load and contains two plugins, or "crash"
+        and "hang" for plugins that take their scanner down with them.
+    */
+    class DummyPluginFormat  : public juce::AudioPluginFormat
+    {
+    public:
+        DummyPluginFormat (const juce::String& formatName, const juce::String& fileExtension, bool usesBundles)
+            : name (formatName), extension (fileExtension), isBundleFormat (usesBundles)
+        {}
+
+        static void writeBinary (const juce::File& file, const juce::String& behaviour)
+        {
+            if (file.hasFileExtension (".vst3"))
+                return writeBinary (getBinary (file), behaviour);
+
+            file.getParentDirectory().createDirectory();
+            file.replaceWithText (behaviour);
+        }
+
+        juce::String getName() const override                           { return name; }
+
+        void findAllTypesForFile (juce::OwnedArray<juce::PluginDescription>& results,
+                                  const juce::String& fileOrIdentifier) override
+        {
+            const juce::File file (fileOrIdentifier);
+            const auto binary = isBundleFormat ? getBinary (file) : file;
+            const auto behaviour = juce::StringArray::fromTokens (binary.loadFileAsString(), false);
+
+            if (behaviour.contains ("crash"))
+                std::abort();
+
+            if (behaviour.contains ("hang"))
+                for (;;)
+                    juce::Thread::sleep (1000);
+
+            const auto getValue = [&behaviour] (const char* key)
+            {
+                const auto index = behaviour.indexOf (key);
+                return index >= 0 ? behaviour[index + 1].getIntValue() : 0;
+            };
+
+            juce::Thread::sleep (getValue ("delay"));
+
+            for (int i = 0; i < getValue ("plugins"); ++i)
+            {
+                auto* desc = results.add (new juce::PluginDescription());
+                desc->name = file.getFileNameWithoutExtension() + (i > 0 ? " " + juce::String (i + 1) : juce::String());
+                desc->descriptiveName = desc->name;
+                desc->pluginFormatName = name;
+                desc->category = "Effect";
+                desc->manufacturerName = "JUCE";
+                desc->version = "1.0";
+                desc->fileOrIdentifier = fileOrIdentifier;
+                desc->lastFileModTime = binary.getLastModificationTime();
+                desc->lastInfoUpdateTime = juce::Time (0);
+                desc->uid = i + 1;
+                desc->numInputChannels = 2;
+                desc->numOutputChannels = 2;
+            }
+        }
+
+        bool fileMightContainThisPluginType (const juce::String& fileOrIdentifier) override
+        {
+            const juce::File file (fileOrIdentifier);
+            return file.hasFileExtension (extension) && (isBundleFormat ? file.isDirectory() : file.existsAsFile());
+        }
+
+        juce::String getNameOfPluginFromIdentifier (const juce::String& fileOrIdentifier) override
+        {
+            return juce::File (fileOrIdentifier).getFileNameWithoutExtension();
+        }
+
+        bool pluginNeedsRescanning (const juce::PluginDescription& desc) override
+        {
+            const juce::File file (desc.fileOrIdentifier);
+            return (isBundleFormat ? getBinary (file) : file).getLastModificationTime() != desc.lastFileModTime;
+        }
+
+        bool doesPluginStillExist (const juce::PluginDescription& desc) override
+        {
+            return fileMightContainThisPluginType (desc.fileOrIdentifier);
+        }
+
+        bool canScanForPlugins() const override                          { return true; }
+        bool isTrivialToScan() const override                            { return false; }
+
+        juce::StringArray searchPathsForPlugins (const juce::FileSearchPath& directoriesToSearch, bool recursive, bool) override
+        {
+            juce::StringArray results;
+
+            for (int i = 0; i < directoriesToSearch.getNumPaths(); ++i)
+                for (auto& file : directoriesToSearch[i].findChildFiles (isBundleFormat ? juce::File::findDirectories : juce::File::findFiles,
+                                                                         recursive, "*" + extension))
+                    results.add (file.getFullPathName());
+
+            return results;
+        }
+
+        juce::FileSearchPath getDefaultLocationsToSearch() override      { return {}; }
+
+    private:
+        static juce::File getBinary (const juce::File& bundle)
+        {
+            return bundle.getChildFile ("Contents").getChildFile ("x86_64-linux")
+                         .getChildFile (bundle.getFileNameWithoutExtension() + ".so");
+        }
+
+        void createPluginInstance (const juce::PluginDescription&, double, int, PluginCreationCallback callback) override
+        {
+            callback (nullptr, "Dummy plugins can't be instantiated");
+        }
+
+        bool requiresUnblockedMessageThreadDuringCreation (const juce::PluginDescription&) const override   { return false; }
+
+        const juce::String name, extension;
+        const bool isBundleFormat;
+    };
+
+    void addFormats (juce::AudioPluginFormatManager& formatManager)
+    {
+        formatManager.addFormat (new DummyPluginFormat ("DummyLADSPA", ".so", false));
+        formatManager.addFormat (new DummyPluginFormat ("DummyVST3", ".vst3", true));
+        formatManager.addDefaultFormats();
+    }
+
+    //==============================================================================
+    int runWorker (const juce::String& commandLine)
+    {
+        // the worker scans the plugins on its message thread, until the scanner disconnects
+        juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+        juce::AudioPluginFormatManager formatManager;
+        addFormats (formatManager);
+
+        juce::PluginScanWorker worker (formatManager);
+
+        if (! worker.initialiseFromCommandLine (commandLine, workerCommandLineID))
+            return 1;
+
+        juce::MessageManager::getInstance()->runDispatchLoop();
+        return 0;
+    }
+
+    //==============================================================================
+    struct TestFolder
+    {
+        juce::File root, plugins;
+        juce::StringArray workingFiles;
+        juce::File crashingFile, hangingFile, emptyFile;
+        int numPluginsPerFile = 1;
+        int numWorkingTypes = 0;
+    };
+
+    TestFolder createTestFolder (const juce::File& root, const juce::String& extension, int numPluginsPerFile, const Options& options)
+    {
+        TestFolder folder;
+        folder.root = root;
+        folder.plugins = root.getChildFile ("Plugins");
+        folder.numPluginsPerFile = numPluginsPerFile;
+
+        for (int i = 0; i < options.numPlugins; ++i)
+        {
+            // the plugins are spread across a few subfolders, like they are in a real plugin folder
+            const auto file = folder.plugins.getChildFile ("Vendor" + juce::String (i % 4))
+                                            .getChildFile ("Dummy" + juce::String (i) + extension);
+
+            DummyPluginFormat::writeBinary (file, "plugins " + juce::String (numPluginsPerFile) + " delay " + juce::String (options.loadTimeMs));
+            folder.workingFiles.add (file.getFullPathName());
+            folder.numWorkingTypes += numPluginsPerFile;
+        }
+
+        folder.crashingFile = folder.plugins.getChildFile ("Crashing" + extension);
+        folder.hangingFile  = folder.plugins.getChildFile ("Hanging" + extension);
+        folder.emptyFile    = folder.plugins.getChildFile ("Empty" + extension);
+
+        DummyPluginFormat::writeBinary (folder.crashingFile, "crash");
+        DummyPluginFormat::writeBinary (folder.hangingFile, "hang");
+        DummyPluginFormat::writeBinary (folder.emptyFile, "plugins 0");
+
+        return folder;
+    }
+
+    template <typename Function>
+    double measureSeconds (Function&& function)
+    {
+        const auto start = juce::Time::getMillisecondCounterHiRes();
+        function();
+        return (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+    }
+
+    void printTiming (const juce::String& name, double seconds, int numFilesScanned)
+    {
+        std::cout << "  " << name.paddedRight (' ', 44) << juce::String (seconds * 1000.0, 1).paddedLeft (' ', 10) << " ms, "
+                  << numFilesScanned << " files loaded" << std::endl;
+    }
+
+    void check (bool condition, const juce::String& failureMessage)
+    {
+        if (! condition)
+            juce::ConsoleApplication::fail ("FAILED: " + failureMessage);
+    }
+
+    juce::StringArray getSortedIdentifiers (const juce::KnownPluginList& list)
+    {
+        juce::StringArray identifiers;
+
+        for (auto& desc : list.getTypes())
+            identifiers.add (desc.createIdentifierString());
+
+        identifiers.sort (false);
+        return identifiers;
+    }
+
+    //==============================================================================
+    void runTests (juce::AudioPluginFormat& format, const TestFolder& folder, const juce::File& workerExecutable, const Options& options)
+    {
+        std::cout << std::endl << format.getName() << ", " << folder.workingFiles.size() << " working plugins, "
+                  << options.numWorkers << " workers" << std::endl;
+
+        const juce::FileSearchPath searchPath (folder.plugins.getFullPathName());
+        const auto cacheFile = folder.root.getChildFile ("ScanCache.xml");
+
+        // the crashing and hanging plugins would take this process down, so the serial scan leaves them out
+        juce::KnownPluginList serialList;
+
+        const auto serialSeconds = measureSeconds ([&]
+        {
+            juce::PluginDirectoryScanner scanner (serialList, format, searchPath, true, {});
+            scanner.setFilesOrIdentifiersToScan (folder.workingFiles);
+
+            for (juce::String nameOfPluginBeingScanned; scanner.scanNextFile (true, nameOfPluginBeingScanned);)
+            {}
+        });
+
+        printTiming ("Serial scan with PluginDirectoryScanner", serialSeconds, folder.workingFiles.size());
+        check (serialList.getNumTypes() == folder.numWorkingTypes, "the serial scan didn't find all plugins");
+
+        const auto runParallelScan = [&] (const juce::String& name, juce::KnownPluginList& list, juce::PluginScanCache& cache)
+        {
+            juce::ParallelPluginScanner scanner (list, format, workerExecutable, workerCommandLineID, options.numWorkers, &cache);
+            scanner.setScanTimeout (options.timeoutMs);
+
+            bool completed = false;
+            const auto seconds = measureSeconds ([&] { completed = scanner.scanDirectories (searchPath, true, true); });
+
+            printTiming (name, seconds, scanner.getNumFilesScanned());
+            check (completed, "the parallel scan couldn't launch its workers");
+            check (list.getNumTypes() == folder.numWorkingTypes, "the parallel scan didn't find all plugins");
+            check (getSortedIdentifiers (list) == getSortedIdentifiers (serialList), "the parallel scan found different plugins than the serial scan");
+            check (scanner.getCrashedFiles().size() == 2
+                     && scanner.getCrashedFiles().contains (folder.crashingFile.getFullPathName())
+                     && scanner.getCrashedFiles().contains (folder.hangingFile.getFullPathName()),
+                   "the crashing and hanging plugins weren't reported");
+            check (list.getBlacklistedFiles().contains (folder.crashingFile.getFullPathName())
+                     && list.getBlacklistedFiles().contains (folder.hangingFile.getFullPathName()),
+                   "the crashing and hanging plugins weren't blacklisted");
+            check (scanner.getFailedFiles() == juce::StringArray (folder.emptyFile.getFullPathName()),
+                   "the plugin without any types wasn't reported as failed");
+
+            return scanner.getNumFilesScanned();
+        };
+
+        cacheFile.deleteFile();
+
+        {
+            juce::KnownPluginList list;
+            juce::PluginScanCache cache (cacheFile);
+            const auto numFilesScanned = runParallelScan ("Parallel scan with ParallelPluginScanner", list, cache);
+            check (numFilesScanned == folder.workingFiles.size() + 3, "the parallel scan didn't load all files");
+        }
+
+        {
+            juce::KnownPluginList list;
+            juce::PluginScanCache cache (cacheFile);
+            const auto numFilesScanned = runParallelScan ("Rescan from the cache", list, cache);
+            check (numFilesScanned == 0, "the rescan loaded files whose results were cached");
+        }
+
+        {
+            // changing a binary invalidates its cache entry, even inside a bundle
+            DummyPluginFormat::writeBinary (folder.workingFiles[0], "plugins " + juce::String (folder.numPluginsPerFile)
+                                                                + " delay " + juce::String (options.loadTimeMs) + " changed");
+
+            juce::KnownPluginList list;
+            juce::PluginScanCache cache (cacheFile);
+            const auto numFilesScanned = runParallelScan ("Rescan after changing one plugin", list, cache);
+            check (numFilesScanned == 1, "the rescan didn't load exactly the changed file");
+        }
+
+        std::cout << "  passed" << std::endl;
+    }
+
+    void runRealFormatTests (juce::AudioPluginFormat& format, const TestFolder& folder, const juce::File& workerExecutable, const Options& options)
+    {
+        // the dummy binaries aren't loadable, so the format must report all of them as failed without crashing
+        juce::KnownPluginList list;
+        juce::ParallelPluginScanner scanner (list, format, workerExecutable, workerCommandLineID, options.numWorkers);
+        scanner.setScanTimeout (options.timeoutMs);
+
+        const auto seconds = measureSeconds ([&] { scanner.scanDirectories (juce::FileSearchPath (folder.plugins.getFullPathName()), true, false); });
+
+        std::cout << std::endl << format.getName() << std::endl;
+        printTiming ("Parallel scan of the dummy binaries", seconds, scanner.getNumFilesScanned());
+        check (list.getNumTypes() == 0, "found plugins in the dummy binaries");
+        check (scanner.getCrashedFiles().isEmpty(), "the dummy binaries crashed the workers");
+        check (scanner.getFailedFiles().size() == folder.workingFiles.size() + 3, "not all dummy binaries were reported as failed");
+        std::cout << "  passed" << std::endl;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList args (argc, argv);
+
+    if (args.size() > 0 && args[0].text.startsWith ("--" + juce::String (workerCommandLineID) + ":"))
+        return runWorker (args[0].text);
+
+    if (args.containsOption ("--help|-h"))
+    {
+        std::cout << args.executableName << " " << usage;
+        return 0;
+    }
+
+    return juce::ConsoleApplication::invokeCatchingFailures ([&]
+    {
+        const auto options = parseOptions (args);
+
+        juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+        juce::AudioPluginFormatManager formatManager;
+        addFormats (formatManager);
+
+        const auto workerExecutable = juce::File::getSpecialLocation (juce::File::currentExecutableFile);
+        const auto root = juce::File::getSpecialLocation (juce::File::tempDirectory).getNonexistentChildFile ("PluginScanTestHarness", {});
+
+        const auto ladspaFolder = createTestFolder (root.getChildFile ("LADSPA"), ".so", 1, options);
+        const auto vst3Folder   = createTestFolder (root.getChildFile ("VST3"), ".vst3", 2, options);
+
+        for (auto* format : formatManager.getFormats())
+        {
+            if (format->getName() == "DummyLADSPA")     runTests (*format, ladspaFolder, workerExecutable, options);
+            else if (format->getName() == "DummyVST3")  runTests (*format, vst3Folder, workerExecutable, options);
+            else if (format->getName() == "LADSPA")     runRealFormatTests (*format, ladspaFolder, workerExecutable, options);
+            else if (format->getName() == "VST3")       runRealFormatTests (*format, vst3Folder, workerExecutable, options);
+        }
+
+        if (options.keepFiles)
+            std::cout << std::endl << "Test files kept in " << root.getFullPathName() << std::endl;
+        else
+            root.deleteRecursively();
+
+        return 0;
+    });
+}
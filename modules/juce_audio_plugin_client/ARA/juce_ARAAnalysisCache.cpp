@@ -0,0 +1,330 @@
+#include "juce_ARAAnalysisCache.h"
+
+namespace juce
+{
+
+namespace ARAAnalysisCacheHelpers
+{
+    static constexpr int fileMagic = 0x4152414a;  // "JARA"
+    static constexpr int fileVersion = 1;
+    static constexpr const char* fileExtension = ".araanalysis";
+
+    // 64 bit FNV-1a
+    struct Hasher
+    {
+        void add (const void* data, size_t numBytes) noexcept
+        {
+            for (size_t i = 0; i < numBytes; ++i)
+                hash = (hash ^ static_cast<const uint8*> (data)[i]) * 0x100000001b3ULL;
+        }
+
+        template <typename Value>
+        void add (Value value) noexcept   { add (&value, sizeof (value)); }
+
+        uint64 hash { 0xcbf29ce484222325ULL };
+    };
+}
+
+//==============================================================================
+
+ARAAnalysisCache::ARAAnalysisCache (const File& directory)
+    : cacheDirectory (directory)
+{
+    cacheDirectory.createDirectory();
+}
+
+String ARAAnalysisCache::computeContentFingerprint (AudioFormatReader& reader, int numProbeWindows, int probeWindowSize)
+{
+    ARAAnalysisCacheHelpers::Hasher hasher;
+    hasher.add (reader.sampleRate);
+    hasher.add (reader.numChannels);
+    hasher.add (reader.lengthInSamples);
+
+    const auto numChannels = (int) reader.numChannels;
+    const auto windowSize = (int) jmin ((int64) jmax (1, probeWindowSize), reader.lengthInSamples);
+
+    if (numChannels > 0 && windowSize > 0)
+    {
+        AudioBuffer<float> buffer (numChannels, windowSize);
+        const auto numWindows = jmax (1, numProbeWindows);
+
+        for (int i = 0; i < numWindows; ++i)
+        {
+            const auto maxStart = reader.lengthInSamples - windowSize;
+            const auto start = (numWindows > 1) ? (maxStart * i) / (numWindows - 1) : 0;
+
+            if (! reader.read (buffer.getArrayOfWritePointers(), numChannels, start, windowSize))
+                return {};
+
+            for (int c = 0; c < numChannels; ++c)
+                hasher.add (buffer.getReadPointer (c), sizeof (float) * (size_t) windowSize);
+        }
+    }
+
+    return String::toHexString ((int64) hasher.hash);
+}
+
+String ARAAnalysisCache::computeContentFingerprint (ARAAudioSource* audioSource)
+{
+    ARAAudioSourceReader reader (audioSource);
+    return computeContentFingerprint (reader);
+}
+
+//==============================================================================
+
+ARAAnalysisCache::CachedAnalysis::CachedAnalysis (std::unique_ptr<MemoryMappedFile> file, size_t offset, size_t size)
+    : mappedFile (std::move (file)),
+      dataOffset (offset),
+      dataSize (size)
+{
+}
+
+const void* ARAAnalysisCache::CachedAnalysis::getData() const noexcept
+{
+    return addBytesToPointer (mappedFile->getData(), dataOffset);
+}
+
+std::unique_ptr<InputStream> ARAAnalysisCache::CachedAnalysis::createInputStream() const
+{
+    return std::make_unique<MemoryInputStream> (getData(), dataSize, false);
+}
+
+//==============================================================================
+
+File ARAAnalysisCache::getFileForPersistentID (const String& persistentID) const
+{
+    return cacheDirectory.getChildFile (String::toHexString (persistentID.hashCode64()) + ARAAnalysisCacheHelpers::fileExtension);
+}
+
+Array<File> ARAAnalysisCache::getAllEntryFiles() const
+{
+    return cacheDirectory.findChildFiles (File::findFiles, false, String ("*") + ARAAnalysisCacheHelpers::fileExtension);
+}
+
+std::unique_ptr<ARAAnalysisCache::CachedAnalysis> ARAAnalysisCache::findAnalysis (const String& persistentID, const String& fingerprint) const
+{
+    if (fingerprint.isEmpty())
+        return nullptr;
+
+    const auto file = getFileForPersistentID (persistentID);
+    if (! file.existsAsFile())
+        return nullptr;
+
+    auto mappedFile = std::make_unique<MemoryMappedFile> (file, MemoryMappedFile::readOnly);
+    if (mappedFile->getData() == nullptr)
+        return nullptr;
+
+    MemoryInputStream header (mappedFile->getData(), mappedFile->getSize(), false);
+
+    if (header.readInt() != ARAAnalysisCacheHelpers::fileMagic || header.readInt() != ARAAnalysisCacheHelpers::fileVersion)
+        return nullptr;
+
+    // also comparing the ID protects against hash collisions of the file names
+    if (header.readString() != persistentID || header.readString() != fingerprint)
+        return nullptr;
+
+    const auto dataSize = header.readInt64();
+    const auto dataOffset = header.getPosition();
+
+    if (dataSize < 0 || dataOffset + dataSize > (int64) mappedFile->getSize())
+        return nullptr;
+
+    return std::unique_ptr<CachedAnalysis> (new CachedAnalysis (std::move (mappedFile), (size_t) dataOffset, (size_t) dataSize));
+}
+
+bool ARAAnalysisCache::storeAnalysis (const String& persistentID, const String& fingerprint, const void* data, size_t numBytes)
+{
+    if (fingerprint.isEmpty())
+        return false;
+
+    // write to a temporary file first, so that readers never see an incomplete entry
+    TemporaryFile temporaryFile (getFileForPersistentID (persistentID));
+
+    {
+        FileOutputStream output (temporaryFile.getFile());
+        if (! output.openedOk())
+            return false;
+
+        output.writeInt (ARAAnalysisCacheHelpers::fileMagic);
+        output.writeInt (ARAAnalysisCacheHelpers::fileVersion);
+        output.writeString (persistentID);
+        output.writeString (fingerprint);
+        output.writeInt64 ((int64) numBytes);
+
+        if (! output.write (data, numBytes))
+            return false;
+
+        output.flush();
+        if (output.getStatus().failed())
+            return false;
+    }
+
+    return temporaryFile.overwriteTargetFileWithTemporary();
+}
+
+void ARAAnalysisCache::removeAnalysis (const String& persistentID)
+{
+    getFileForPersistentID (persistentID).deleteFile();
+}
+
+void ARAAnalysisCache::trimToSize (int64 maxTotalNumBytes)
+{
+    auto files = getAllEntryFiles();
+
+    std::sort (files.begin(), files.end(), [] (const File& a, const File& b)
+    {
+        return a.getLastModificationTime() > b.getLastModificationTime();
+    });
+
+    int64 totalNumBytes = 0;
+    for (auto& file : files)
+    {
+        totalNumBytes += file.getSize();
+
+        if (totalNumBytes > maxTotalNumBytes)
+            file.deleteFile();
+    }
+}
+
+void ARAAnalysisCache::clear()
+{
+    for (auto& file : getAllEntryFiles())
+        file.deleteFile();
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ARAAnalysisCacheTests  : public UnitTest
+{
+public:
+    ARAAnalysisCacheTests()
+        : UnitTest ("ARAAnalysisCache", UnitTestCategories::audio)
+    {}
+
+    void runTest() override
+    {
+        auto signal = createSignal (2, 44100);
+
+        beginTest ("Fingerprints match for the same signal only");
+        {
+            BufferReader reader (signal, 44100.0), sameReader (signal, 44100.0);
+            const auto fingerprint = ARAAnalysisCache::computeContentFingerprint (reader);
+
+            expect (fingerprint.isNotEmpty());
+            expectEquals (ARAAnalysisCache::computeContentFingerprint (sameReader), fingerprint);
+
+            // the first and last samples are always part of the probe windows
+            auto changedSignal = signal;
+            changedSignal.setSample (1, changedSignal.getNumSamples() - 1, 0.5f);
+            BufferReader changedReader (changedSignal, 44100.0);
+            expect (ARAAnalysisCache::computeContentFingerprint (changedReader) != fingerprint);
+
+            BufferReader resampledReader (signal, 48000.0);
+            expect (ARAAnalysisCache::computeContentFingerprint (resampledReader) != fingerprint);
+        }
+
+        const auto directory = File::getSpecialLocation (File::tempDirectory).getNonexistentChildFile ("ARAAnalysisCacheTests", {});
+
+        beginTest ("Stored results can be looked up");
+        {
+            ARAAnalysisCache cache (directory);
+            expect (directory.isDirectory());
+
+            BufferReader reader (signal, 44100.0);
+            const auto fingerprint = ARAAnalysisCache::computeContentFingerprint (reader);
+            const String result ("analysis result");
+
+            expect (cache.findAnalysis ("source", fingerprint) == nullptr);
+            expect (cache.storeAnalysis ("source", fingerprint, result.toRawUTF8(), result.getNumBytesAsUTF8()));
+
+            auto cached = cache.findAnalysis ("source", fingerprint);
+            expect (cached != nullptr);
+
+            if (cached != nullptr)
+            {
+                expectEquals ((int) cached->getSize(), (int) result.getNumBytesAsUTF8());
+                expectEquals (cached->createInputStream()->readEntireStreamAsString(), result);
+            }
+
+            expect (cache.findAnalysis ("other source", fingerprint) == nullptr);
+
+            // a new cache on the same directory finds the stored result
+            ARAAnalysisCache restoredCache (directory);
+            expect (restoredCache.findAnalysis ("source", fingerprint) != nullptr);
+        }
+
+        beginTest ("Stale fingerprints are rejected");
+        {
+            ARAAnalysisCache cache (directory);
+
+            BufferReader reader (signal, 44100.0);
+            const auto fingerprint = ARAAnalysisCache::computeContentFingerprint (reader);
+
+            auto editedSignal = signal;
+            editedSignal.applyGain (0.5f);
+            BufferReader editedReader (editedSignal, 44100.0);
+            const auto editedFingerprint = ARAAnalysisCache::computeContentFingerprint (editedReader);
+
+            expect (cache.findAnalysis ("source", editedFingerprint) == nullptr);
+            expect (cache.findAnalysis ("source", {}) == nullptr);
+
+            const String editedResult ("edited analysis result");
+            expect (cache.storeAnalysis ("source", editedFingerprint, editedResult.toRawUTF8(), editedResult.getNumBytesAsUTF8()));
+            expect (cache.findAnalysis ("source", fingerprint) == nullptr);
+            expect (cache.findAnalysis ("source", editedFingerprint) != nullptr);
+
+            cache.removeAnalysis ("source");
+            expect (cache.findAnalysis ("source", editedFingerprint) == nullptr);
+        }
+
+        directory.deleteRecursively();
+    }
+
+private:
+    // serves the samples of a buffer, standing in for the host reader of an audio source
+    struct BufferReader  : public AudioFormatReader
+    {
+        BufferReader (const AudioBuffer<float>& source, double rate)
+            : AudioFormatReader (nullptr, "BufferReader"), buffer (source)
+        {
+            sampleRate = rate;
+            numChannels = (unsigned int) buffer.getNumChannels();
+            lengthInSamples = buffer.getNumSamples();
+            bitsPerSample = 32;
+            usesFloatingPointData = true;
+        }
+
+        bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                          int64 startSampleInFile, int numSamples) override
+        {
+            for (int c = 0; c < numDestChannels; ++c)
+                if (destSamples[c] != nullptr)
+                    FloatVectorOperations::copy (reinterpret_cast<float*> (destSamples[c]) + startOffsetInDestBuffer,
+                                                 buffer.getReadPointer (jmin (c, buffer.getNumChannels() - 1), (int) startSampleInFile),
+                                                 numSamples);
+
+            return true;
+        }
+
+        const AudioBuffer<float>& buffer;
+    };
+
+    static AudioBuffer<float> createSignal (int numChannels, int numSamples)
+    {
+        AudioBuffer<float> signal (numChannels, numSamples);
+        Random random (42);
+
+        for (int c = 0; c < numChannels; ++c)
+            for (int i = 0; i < numSamples; ++i)
+                signal.setSample (c, i, random.nextFloat() * 2.0f - 1.0f);
+
+        return signal;
+    }
+};
+
+static ARAAnalysisCacheTests araAnalysisCacheTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "juce_ARAAudioReaders.h"
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A persistent on-disk cache for audio source analysis results.
+
+    Results are keyed by the persistent ID of the audio source plus a content fingerprint,
+    so that when restoring a document, the analysis of any audio source whose samples
+    have not changed since the result was stored can be skipped entirely.
+
+    Each result is stored in a separate file inside the cache directory, and is accessed
+    through a memory-mapped view when being looked up.
+
+    A typical pattern is to look up the cache right after doRestoreObjectsFromStream(),
+    or before scheduling an ARAAnalysisScheduler::AnalysisJob, and to store the results
+    of each successful analysis:
+
+    @code
+    auto& cache = getAnalysisCache();
+    const auto fingerprint = ARAAnalysisCache::computeContentFingerprint (audioSource);
+
+    if (auto cached = cache.findAnalysis (audioSource->getPersistentID(), fingerprint))
+        restoreMyAnalysis (audioSource, cached->createInputStream());
+    else
+        getAnalysisScheduler().scheduleAnalysis (std::make_unique<MyAnalysisJob> (audioSource));
+    @endcode
+
+    All functions are thread-safe, as long as different threads are not writing the same entry.
+
+    @tags{ARA}
+*/
+class JUCE_API  ARAAnalysisCache
+{
+public:
+    /** Creates a cache that stores its entries in the given directory, which will be created if needed. */
+    explicit ARAAnalysisCache (const File& cacheDirectory);
+
+    /** Returns the directory holding the cache entries. */
+    const File& getCacheDirectory() const noexcept { return cacheDirectory; }
+
+    //==============================================================================
+    /** Computes a cheap fingerprint of the audio signal provided by the given reader.
+
+        The fingerprint combines the sample rate, channel and sample count with a hash of
+        a number of short windows of samples that are spread evenly across the signal,
+        so it can be computed quickly even for very long audio sources.
+        Any AudioFormatReader can be used, which allows for testing without an ARA host.
+
+        @returns the fingerprint, or an empty string if reading the samples failed.
+    */
+    static String computeContentFingerprint (AudioFormatReader& reader, int numProbeWindows = 16, int probeWindowSize = 256);
+
+    /** Computes the fingerprint of the given audio source (message thread only).
+        Since this reads samples from the host, the sample access for \p audioSource must be enabled.
+    */
+    static String computeContentFingerprint (ARAAudioSource* audioSource);
+
+    //==============================================================================
+    /**
+        A read-only, memory-mapped view of a cached analysis result.
+
+        @tags{ARA}
+    */
+    class JUCE_API  CachedAnalysis
+    {
+    public:
+        /** Returns a pointer to the cached data. */
+        const void* getData() const noexcept;
+
+        /** Returns the size of the cached data in bytes. */
+        size_t getSize() const noexcept { return dataSize; }
+
+        /** Creates a stream reading the cached data. The stream must not outlive this object. */
+        std::unique_ptr<InputStream> createInputStream() const;
+
+    private:
+        friend class ARAAnalysisCache;
+        CachedAnalysis (std::unique_ptr<MemoryMappedFile> mappedFile, size_t dataOffset, size_t dataSize);
+
+        std::unique_ptr<MemoryMappedFile> mappedFile;
+        size_t dataOffset, dataSize;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CachedAnalysis)
+    };
+
+    /** Looks up the analysis stored for the given persistent ID and fingerprint.
+        @returns the cached data, or nullptr if there is no matching entry.
+    */
+    std::unique_ptr<CachedAnalysis> findAnalysis (const String& persistentID, const String& fingerprint) const;
+
+    /** Stores an analysis result, replacing any previous entry for the persistent ID.
+        @returns true on success.
+    */
+    bool storeAnalysis (const String& persistentID, const String& fingerprint, const void* data, size_t numBytes);
+
+    /** Removes the entry for the given persistent ID, if any. */
+    void removeAnalysis (const String& persistentID);
+
+    /** Removes the least recently written entries until the total size of the cache is below the given limit. */
+    void trimToSize (int64 maxTotalNumBytes);
+
+    /** Removes all entries. */
+    void clear();
+
+private:
+    File getFileForPersistentID (const String& persistentID) const;
+    Array<File> getAllEntryFiles() const;
+
+    const File cacheDirectory;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ARAAnalysisCache)
+};
+
+} // namespace juce
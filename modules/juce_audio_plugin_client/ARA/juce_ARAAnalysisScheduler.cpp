@@ -0,0 +1,248 @@
+#include "juce_ARAAnalysisScheduler.h"
+
+namespace juce
+{
+
+ARAAnalysisScheduler::AnalysisJob::AnalysisJob (ARAAudioSource* source)
+    : audioSource (source),
+      reader (source)
+{
+}
+
+void ARAAnalysisScheduler::AnalysisJob::setProgress (float progress)
+{
+    audioSource->notifyAnalysisProgressUpdated (jlimit (0.0f, 1.0f, progress));
+}
+
+//==============================================================================
+
+ARAAnalysisScheduler::ARAAnalysisScheduler (int numWorkerThreads)
+    : threadPool (jmax (1, numWorkerThreads))
+{
+}
+
+ARAAnalysisScheduler::~ARAAnalysisScheduler()
+{
+    cancelPendingUpdate();
+    cancelAllAnalyses();
+
+    threadPool.removeAllJobs (true, -1);
+
+    for (auto* audioSource : observedAudioSources)
+        audioSource->removeListener (this);
+}
+
+void ARAAnalysisScheduler::scheduleAnalysis (std::unique_ptr<AnalysisJob> job, Priority priority)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    jassert (job != nullptr);
+
+    auto* audioSource = job->getAudioSource();
+    cancelAnalysis (audioSource);
+
+    if (! ARA::contains (observedAudioSources, audioSource))
+    {
+        audioSource->addListener (this);
+        observedAudioSources.push_back (audioSource);
+    }
+
+    job->priority = priority;
+
+    {
+        const ScopedLock sl (lock);
+        pendingJobs.push_back (std::move (job));
+    }
+
+    // each pool job will pick the pending analysis with the highest priority when it starts running
+    threadPool.addJob ([this] { runNextPendingJob(); });
+}
+
+void ARAAnalysisScheduler::cancelAnalysis (ARAAudioSource* audioSource)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    std::vector<std::unique_ptr<AnalysisJob>> cancelledJobs;
+
+    const auto extractJobsForAudioSource = [&] (std::vector<std::unique_ptr<AnalysisJob>>& jobs)
+    {
+        for (auto it = jobs.begin(); it != jobs.end();)
+        {
+            if ((*it)->getAudioSource() == audioSource)
+            {
+                (*it)->succeeded = false;
+                cancelledJobs.push_back (std::move (*it));
+                it = jobs.erase (it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    };
+
+    for (;;)
+    {
+        {
+            const ScopedLock sl (lock);
+
+            extractJobsForAudioSource (pendingJobs);
+            extractJobsForAudioSource (finishedJobs);
+
+            auto isRunning = false;
+            for (auto* job : runningJobs)
+            {
+                if (job->getAudioSource() == audioSource)
+                {
+                    job->shouldExitFlag.store (true);
+                    isRunning = true;
+                }
+            }
+
+            if (! isRunning)
+                break;
+        }
+
+        jobFinishedEvent.wait (10);
+    }
+
+    finishJobs (cancelledJobs);
+}
+
+void ARAAnalysisScheduler::cancelAllAnalyses()
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    std::vector<ARAAudioSource*> audioSources;
+
+    {
+        const ScopedLock sl (lock);
+
+        for (auto* jobList : { &pendingJobs, &finishedJobs })
+            for (auto& job : *jobList)
+                audioSources.push_back (job->getAudioSource());
+
+        for (auto* job : runningJobs)
+            audioSources.push_back (job->getAudioSource());
+    }
+
+    for (auto* audioSource : audioSources)
+        cancelAnalysis (audioSource);
+}
+
+bool ARAAnalysisScheduler::isAnalysing (ARAAudioSource* audioSource) const
+{
+    const ScopedLock sl (lock);
+
+    for (auto& job : pendingJobs)
+        if (job->getAudioSource() == audioSource)
+            return true;
+
+    for (auto* job : runningJobs)
+        if (job->getAudioSource() == audioSource)
+            return true;
+
+    return false;
+}
+
+int ARAAnalysisScheduler::getNumActiveJobs() const
+{
+    const ScopedLock sl (lock);
+    return (int) (pendingJobs.size() + runningJobs.size());
+}
+
+void ARAAnalysisScheduler::setAudioSourcesVisibleInEditor (const std::vector<ARAAudioSource*>& audioSources)
+{
+    const ScopedLock sl (lock);
+    audioSourcesVisibleInEditor = audioSources;
+}
+
+ARAAnalysisScheduler::Priority ARAAnalysisScheduler::getEffectivePriority (const AnalysisJob& job) const
+{
+    if (ARA::contains (audioSourcesVisibleInEditor, job.getAudioSource()))
+        return Priority::visibleInEditor;
+
+    return job.priority;
+}
+
+void ARAAnalysisScheduler::runNextPendingJob()
+{
+    AnalysisJob* job = nullptr;
+
+    {
+        const ScopedLock sl (lock);
+
+        // pick the first pending job of the highest priority
+        auto bestJob = pendingJobs.end();
+        for (auto it = pendingJobs.begin(); it != pendingJobs.end(); ++it)
+            if (bestJob == pendingJobs.end() || getEffectivePriority (**it) > getEffectivePriority (**bestJob))
+                bestJob = it;
+
+        // the job may have been cancelled in the meantime
+        if (bestJob == pendingJobs.end())
+            return;
+
+        job = bestJob->release();
+        pendingJobs.erase (bestJob);
+        runningJobs.push_back (job);
+    }
+
+    auto* audioSource = job->getAudioSource();
+    audioSource->notifyAnalysisProgressStarted();
+
+    const auto succeeded = job->runAnalysis();
+
+    audioSource->notifyAnalysisProgressCompleted();
+
+    {
+        const ScopedLock sl (lock);
+
+        job->succeeded = succeeded && ! job->shouldExit();
+        runningJobs.erase (std::find (runningJobs.begin(), runningJobs.end(), job));
+        finishedJobs.emplace_back (job);
+    }
+
+    jobFinishedEvent.signal();
+    triggerAsyncUpdate();
+}
+
+void ARAAnalysisScheduler::handleAsyncUpdate()
+{
+    std::vector<std::unique_ptr<AnalysisJob>> jobs;
+
+    {
+        const ScopedLock sl (lock);
+        std::swap (jobs, finishedJobs);
+    }
+
+    finishJobs (jobs);
+}
+
+void ARAAnalysisScheduler::finishJobs (std::vector<std::unique_ptr<AnalysisJob>>& jobs)
+{
+    for (auto& job : jobs)
+        job->didFinishAnalysis (job->succeeded);
+
+    jobs.clear();
+}
+
+//==============================================================================
+
+void ARAAnalysisScheduler::willEnableAudioSourceSamplesAccess (ARAAudioSource* audioSource, bool enable)
+{
+    // the analysis can't make any progress without sample access
+    if (! enable)
+        cancelAnalysis (audioSource);
+}
+
+void ARAAnalysisScheduler::willDestroyAudioSource (ARAAudioSource* audioSource)
+{
+    cancelAnalysis (audioSource);
+
+    audioSource->removeListener (this);
+    observedAudioSources.erase (std::remove (observedAudioSources.begin(), observedAudioSources.end(), audioSource), observedAudioSources.end());
+
+    const ScopedLock sl (lock);
+    audioSourcesVisibleInEditor.erase (std::remove (audioSourcesVisibleInEditor.begin(), audioSourcesVisibleInEditor.end(), audioSource), audioSourcesVisibleInEditor.end());
+}
+
+} // namespace juce
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "juce_ARAAudioReaders.h"
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Runs audio source analysis jobs on a bounded pool of worker threads.
+
+    The scheduler is owned by the ARADocumentController (see ARADocumentController::getAnalysisScheduler()).
+    Plug-ins subclass ARAAnalysisScheduler::AnalysisJob to implement their analysis algorithm, and
+    schedule a job per audio source, typically from their override of
+    ARA::PlugIn::DocumentController::doRequestAudioSourceContentAnalysis() or when an audio source
+    has been added to the document.
+
+    Pending jobs are executed in order of their priority: audio sources that are currently selected
+    in any ARAEditorView are analysed first, followed by those explicitly requested by the host,
+    followed by all other sources.
+
+    The scheduler reports the analysis progress of each job to the host and to any
+    ARAAudioSource::Listener through the audio source's analysis progress notifications.
+
+    Jobs are cancelled automatically when their audio source is destroyed or when the host disables
+    access to its samples.
+
+    @tags{ARA}
+*/
+class JUCE_API  ARAAnalysisScheduler  : private ARAAudioSource::Listener,
+                                        private AsyncUpdater
+{
+public:
+    /** The scheduling priority of an analysis job. */
+    enum class Priority
+    {
+        normal = 0,
+        requestedByHost,
+        visibleInEditor
+    };
+
+    //==============================================================================
+    /**
+        Base class for an analysis of a single audio source.
+
+        Jobs are created on the message thread, then runAnalysis() is called on a worker thread.
+        Once the job has finished, didFinishAnalysis() is called on the message thread before
+        the job is deleted.
+
+        @tags{ARA}
+    */
+    class JUCE_API  AnalysisJob
+    {
+    public:
+        /** Creates a job for the given audio source, along with a reader for its samples (message thread only). */
+        explicit AnalysisJob (ARAAudioSource* audioSource);
+        virtual ~AnalysisJob() = default;
+
+        /** Returns the audio source being analysed. */
+        ARAAudioSource* getAudioSource() const noexcept { return audioSource; }
+
+        /** Returns the reader that should be used to access the samples of the audio source. */
+        ARAAudioSourceReader& getReader() noexcept { return reader; }
+
+        /** Performs the analysis, called on a worker thread.
+            Implementations should regularly check shouldExit() and report their progress via setProgress().
+            @returns true if the analysis completed successfully.
+        */
+        virtual bool runAnalysis() = 0;
+
+        /** Called on the message thread after runAnalysis() has returned, or if the job was cancelled.
+            This is the place to publish the analysis results and call ARAAudioSource::notifyContentChanged().
+            @param succeeded True if runAnalysis() returned true and the job has not been cancelled.
+        */
+        virtual void didFinishAnalysis (bool succeeded) { ignoreUnused (succeeded); }
+
+        /** Returns true if the job has been cancelled and runAnalysis() should return as soon as possible. */
+        bool shouldExit() const noexcept { return shouldExitFlag.load(); }
+
+        /** Reports the progress of the analysis, normalized to the 0..1 range (worker thread only). */
+        void setProgress (float progress);
+
+    private:
+        friend class ARAAnalysisScheduler;
+
+        ARAAudioSource* const audioSource;
+        ARAAudioSourceReader reader;
+        Priority priority { Priority::normal };
+        std::atomic<bool> shouldExitFlag { false };
+        bool succeeded { false };
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AnalysisJob)
+    };
+
+    //==============================================================================
+    /** Creates a scheduler.
+        @param numWorkerThreads  The maximum number of analysis jobs that are run concurrently.
+    */
+    explicit ARAAnalysisScheduler (int numWorkerThreads = jmax (1, SystemStats::getNumCpus() - 1));
+
+    ~ARAAnalysisScheduler() override;
+
+    /** Schedules an analysis job (message thread only).
+        Any pending or running analysis of the same audio source is cancelled first.
+    */
+    void scheduleAnalysis (std::unique_ptr<AnalysisJob> job, Priority priority = Priority::normal);
+
+    /** Cancels any pending or running analysis of the given audio source (message thread only).
+        If the analysis is currently running, this will block until runAnalysis() has returned.
+    */
+    void cancelAnalysis (ARAAudioSource* audioSource);
+
+    /** Cancels all pending and running analysis jobs (message thread only). */
+    void cancelAllAnalyses();
+
+    /** Returns true if an analysis of the given audio source is pending or running. */
+    bool isAnalysing (ARAAudioSource* audioSource) const;
+
+    /** Returns the number of analysis jobs that are pending or running. */
+    int getNumActiveJobs() const;
+
+    /** Sets the audio sources that are currently visible in the editor, which will be analysed first.
+        The ARADocumentController calls this whenever the selection of an ARAEditorView changes.
+    */
+    void setAudioSourcesVisibleInEditor (const std::vector<ARAAudioSource*>& audioSources);
+
+private:
+    //==============================================================================
+    void willEnableAudioSourceSamplesAccess (ARAAudioSource* audioSource, bool enable) override;
+    void willDestroyAudioSource (ARAAudioSource* audioSource) override;
+
+    void handleAsyncUpdate() override;
+
+    Priority getEffectivePriority (const AnalysisJob& job) const;
+    void runNextPendingJob();
+    void finishJobs (std::vector<std::unique_ptr<AnalysisJob>>& jobs);
+
+    ThreadPool threadPool;
+
+    CriticalSection lock;
+    std::vector<std::unique_ptr<AnalysisJob>> pendingJobs, finishedJobs;
+    std::vector<AnalysisJob*> runningJobs;
+    std::vector<ARAAudioSource*> audioSourcesVisibleInEditor;
+    WaitableEvent jobFinishedEvent;
+
+    std::vector<ARAAudioSource*> observedAudioSources;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ARAAnalysisScheduler)
+};
+
+} // namespace juce
@@ -3,7 +3,7 @@
 namespace juce
 {
 
-ARAAudioSourceReader::ARAAudioSourceReader (ARAAudioSource* audioSource)
+ARAAudioSourceReader::ARAAudioSourceReader (ARAAudioSource* audioSource, bool useBlockCache)
     : AudioFormatReader (nullptr, "ARAAudioSourceReader"),
       audioSourceBeingRead (audioSource)
 {
@@ -14,11 +14,20 @@ ARAAudioSourceReader::ARAAudioSourceReader (ARAAudioSource* audioSource)
     sampleRate = audioSourceBeingRead->getSampleRate();
     numChannels = (unsigned int) audioSourceBeingRead->getChannelCount();
     lengthInSamples = audioSourceBeingRead->getSampleCount();
+    destPtrs.resize (numChannels);
     tmpPtrs.resize (numChannels);
+    scratchChannel.allocate ((size_t) scratchSize, false);
+
+    if (useBlockCache)
+    {
+        blockCache = &audioSourceBeingRead->getDocumentController()->getAudioSourceBlockCache();
+        blockCacheEntry = blockCache->getEntryForAudioSource (audioSourceBeingRead);
+        cacheScratchPtrs.resize (numChannels);
+    }
 
     audioSourceBeingRead->addListener (this);
     if (audioSourceBeingRead->isSampleAccessEnabled())
-        hostReader.reset (new ARA::PlugIn::HostAudioReader (audioSourceBeingRead));
+        setHostReader (std::make_unique<ARA::PlugIn::HostAudioReader> (audioSourceBeingRead));
 }
 
 ARAAudioSourceReader::~ARAAudioSourceReader()
@@ -26,14 +35,24 @@ ARAAudioSourceReader::~ARAAudioSourceReader()
     invalidate();
 }
 
-void ARAAudioSourceReader::invalidate()
+void ARAAudioSourceReader::setHostReader (std::unique_ptr<ARA::PlugIn::HostAudioReader> newHostReader)
 {
-    ScopedWriteLock scopedLock (lock);
+    std::unique_ptr<ARA::PlugIn::HostAudioReader> previousHostReader (hostReader.exchange (newHostReader.release()));
+
+    // wait until no read call is using the previous reader anymore before deleting it
+    if (previousHostReader != nullptr)
+        readEpoch.synchronise();
+}
 
+void ARAAudioSourceReader::invalidate()
+{
     if (! isValid())
         return;
 
-    hostReader.reset();
+    setHostReader (nullptr);
+
+    // once the host reader is gone, no read call will access the cache entry anymore
+    blockCacheEntry = nullptr;
 
     audioSourceBeingRead->removeListener (this);
     audioSourceBeingRead = nullptr;
@@ -58,16 +77,22 @@ void ARAAudioSourceReader::doUpdateAudioSourceContent (ARAAudioSource* audioSour
         invalidate();
 }
 
+void ARAAudioSourceReader::doUpdateAudioSourceContentInRange (ARAAudioSource* audioSource, Range<double> /*affectedTimeRange*/, ARAContentUpdateScopes /*scopeFlags*/)
+{
+    jassert (audioSourceBeingRead == audioSource);
+    ignoreUnused (audioSource);
+
+    // we're reading directly from the host (or through the block cache, which drops the affected
+    // blocks by itself), so there's no need to invalidate for range-limited updates
+}
+
 void ARAAudioSourceReader::willEnableAudioSourceSamplesAccess (ARAAudioSource* audioSource, bool enable)
 {
     jassert (audioSourceBeingRead == audioSource);
 
     // invalidate our reader if sample access is disabled
     if (! enable)
-    {
-        ScopedWriteLock scopedLock (lock);
-        hostReader.reset();
-    }
+        setHostReader (nullptr);
 }
 
 void ARAAudioSourceReader::didEnableAudioSourceSamplesAccess (ARAAudioSource* audioSource, bool enable)
@@ -76,10 +101,7 @@ void ARAAudioSourceReader::didEnableAudioSourceSamplesAccess (ARAAudioSource* au
 
     // recreate our reader if sample access is enabled
     if (enable && isValid())
-    {
-        ScopedWriteLock scopedLock (lock);
-        hostReader.reset (new ARA::PlugIn::HostAudioReader (audioSourceBeingRead));
-    }
+        setHostReader (std::make_unique<ARA::PlugIn::HostAudioReader> (audioSourceBeingRead));
 }
 
 void ARAAudioSourceReader::willDestroyAudioSource (ARAAudioSource* audioSource)
@@ -95,13 +117,12 @@ bool ARAAudioSourceReader::readSamples (int** destSamples, int numDestChannels,
     const auto destSize = (bitsPerSample / 8) * (size_t) numSamples;
     const auto bufferOffset = (int) (bitsPerSample / 8) * startOffsetInDestBuffer;
 
-    // If we're invalid or can't enter the lock or audio source access is currently disabled, zero samples and return false
-    bool gotReadlock = isValid() ? lock.tryEnterRead() : false;
-    if (! isValid() || ! gotReadlock || (hostReader == nullptr))
-    {
-        if (gotReadlock)
-            lock.exitRead();
+    const ARAReadEpoch::ScopedRead scopedRead (readEpoch);
 
+    // If we're invalid or audio source access is currently disabled, zero samples and return false
+    auto* reader = hostReader.load();
+    if (reader == nullptr)
+    {
         for (int chan_i = 0; chan_i < numDestChannels; ++chan_i)
             if (destSamples[chan_i] != nullptr)
                 zeromem (((uint8_t*) destSamples[chan_i]) + bufferOffset, destSize);
@@ -109,28 +130,79 @@ bool ARAAudioSourceReader::readSamples (int** destSamples, int numDestChannels,
         return false;
     }
 
-    for (size_t chan_i = 0; chan_i < tmpPtrs.size(); ++chan_i)
+    for (size_t chan_i = 0; chan_i < destPtrs.size(); ++chan_i)
+        destPtrs[chan_i] = ((chan_i < (size_t) numDestChannels) && (destSamples[chan_i] != nullptr))
+                                ? reinterpret_cast<float*> (destSamples[chan_i]) + startOffsetInDestBuffer
+                                : nullptr;
+
+    return readChannels (*reader, startSampleInFile, numSamples);
+}
+
+bool ARAAudioSourceReader::readIntoBuffer (AudioBuffer<float>& buffer, int startInBuffer, int64 startSampleInFile, int numSamples)
+{
+    jassert (startInBuffer >= 0 && numSamples >= 0 && startInBuffer + numSamples <= buffer.getNumSamples());
+
+    const ARAReadEpoch::ScopedRead scopedRead (readEpoch);
+
+    auto* reader = hostReader.load();
+    if (reader == nullptr)
+    {
+        buffer.clear (startInBuffer, numSamples);
+        return false;
+    }
+
+    const auto rangeToRead = Range<int64> (0, lengthInSamples).getIntersectionWith (Range<int64>::withStartAndLength (startSampleInFile, numSamples));
+    if (rangeToRead.isEmpty())
     {
-        if ((chan_i < (size_t) numDestChannels) && (destSamples[chan_i] != nullptr))
+        buffer.clear (startInBuffer, numSamples);
+        return true;
+    }
+
+    const auto startInBufferToRead = startInBuffer + (int) (rangeToRead.getStart() - startSampleInFile);
+    const auto numSamplesToRead = (int) rangeToRead.getLength();
+    const auto endInBufferToRead = startInBufferToRead + numSamplesToRead;
+
+    for (int chan_i = 0; chan_i < buffer.getNumChannels(); ++chan_i)
+    {
+        if (chan_i < (int) numChannels)
         {
-            tmpPtrs[chan_i] = ((uint8_t*) destSamples[chan_i]) + bufferOffset;
+            buffer.clear (chan_i, startInBuffer, startInBufferToRead - startInBuffer);
+            buffer.clear (chan_i, endInBufferToRead, startInBuffer + numSamples - endInBufferToRead);
         }
         else
         {
-            // When readSamples is not reading all channels,
-            // we still need to provide pointers to all channels to the ARA read call.
-            // So we'll read the other channels into this dummy buffer.
-            static ThreadLocalValue<std::vector<uint8_t>> dummyBuffer;
-            if (destSize > dummyBuffer.get().size())
-                dummyBuffer.get().resize (destSize);
-
-            tmpPtrs[chan_i] = dummyBuffer.get().data();
+            buffer.clear (chan_i, startInBuffer, numSamples);
         }
     }
 
-    bool success = hostReader->readAudioSamples (startSampleInFile, numSamples, tmpPtrs.data());
+    for (size_t chan_i = 0; chan_i < destPtrs.size(); ++chan_i)
+        destPtrs[chan_i] = ((int) chan_i < buffer.getNumChannels()) ? buffer.getWritePointer ((int) chan_i, startInBufferToRead) : nullptr;
+
+    return readChannels (*reader, rangeToRead.getStart(), numSamplesToRead);
+}
+
+bool ARAAudioSourceReader::readChannels (const ARA::PlugIn::HostAudioReader& reader, int64 startSampleInFile, int numSamples)
+{
+    // The ARA read call needs pointers to all channels, so any channels the caller is not interested in
+    // are read into the scratch channel. Since it has a fixed size, the read is split into chunks then.
+    const auto skipsChannels = std::find (destPtrs.begin(), destPtrs.end(), nullptr) != destPtrs.end();
+    const auto chunkSize = skipsChannels ? scratchSize : numSamples;
+
+    auto success = true;
+
+    for (int offset = 0; offset < numSamples; offset += chunkSize)
+    {
+        const auto numSamplesInChunk = jmin (chunkSize, numSamples - offset);
+
+        for (size_t chan_i = 0; chan_i < tmpPtrs.size(); ++chan_i)
+            tmpPtrs[chan_i] = (destPtrs[chan_i] != nullptr) ? destPtrs[chan_i] + offset : scratchChannel.get();
 
-    lock.exitRead();
+        if (blockCacheEntry != nullptr)
+            success = blockCache->readSamples (*blockCacheEntry, reader, tmpPtrs.data(), cacheScratchPtrs.data(),
+                                               startSampleInFile + offset, numSamplesInChunk) && success;
+        else
+            success = reader.readAudioSamples (startSampleInFile + offset, numSamplesInChunk, tmpPtrs.data()) && success;
+    }
 
     return success;
 }
@@ -203,10 +275,51 @@ void ARAPlaybackRegionReader::invalidate()
     for (auto& playbackRegion : playbackRenderer->getPlaybackRegions())
         playbackRegion->removeListener (this);
 
+    releaseWorkerRenderers();
+
     playbackRenderer->releaseResources();
     playbackRenderer.reset();
 }
 
+void ARAPlaybackRegionReader::releaseWorkerRenderers()
+{
+    workerPool.reset();
+
+    for (auto& workerRenderer : workerRenderers)
+        workerRenderer->releaseResources();
+
+    workerRenderers.clear();
+    preRollBuffers.clear();
+}
+
+void ARAPlaybackRegionReader::setNumParallelRenderThreads (int numWorkerThreads, int preRollSamples)
+{
+    ScopedWriteLock scopedWrite (lock);
+
+    releaseWorkerRenderers();
+
+    if (! isValid() || numWorkerThreads <= 0)
+        return;
+
+    const auto& playbackRegions = playbackRenderer->getPlaybackRegions();
+    auto* documentController = playbackRegions.front()->getDocumentController();
+
+    for (int i = 0; i < numWorkerThreads; ++i)
+    {
+        std::unique_ptr<ARAPlaybackRenderer> workerRenderer (static_cast<ARAPlaybackRenderer*> (documentController->doCreatePlaybackRenderer()));
+
+        for (const auto& playbackRegion : playbackRegions)
+            workerRenderer->addPlaybackRegion (ARA::PlugIn::toRef (playbackRegion));
+
+        workerRenderer->prepareToPlay (sampleRate, maximumBlockSize, (int) numChannels, true);
+        workerRenderers.push_back (std::move (workerRenderer));
+        preRollBuffers.emplace_back ((int) numChannels, maximumBlockSize);
+    }
+
+    numPreRollBlocks = (jmax (0, preRollSamples) + maximumBlockSize - 1) / maximumBlockSize;
+    workerPool.reset (new ThreadPool (numWorkerThreads));
+}
+
 bool ARAPlaybackRegionReader::readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
                                            int64 startSampleInFile, int numSamples)
 {
@@ -218,16 +331,24 @@ bool ARAPlaybackRegionReader::readSamples (int** destSamples, int numDestChannel
         {
             success = true;
             needClearSamples = false;
-            positionInfo.timeInSamples = startSampleInFile + startInSamples;
-            while (numSamples > 0)
+
+            if (workerPool != nullptr && numSamples > maximumBlockSize)
             {
-                int numSliceSamples = jmin (numSamples, maximumBlockSize);
-                AudioBuffer<float> buffer ((float **) destSamples, numDestChannels, startOffsetInDestBuffer, numSliceSamples);
-                positionInfo.timeInSeconds = static_cast<double> (positionInfo.timeInSamples) / sampleRate;
-                success &= playbackRenderer->processBlock (buffer, true, positionInfo);
-                numSamples -= numSliceSamples;
-                startOffsetInDestBuffer += numSliceSamples;
-                positionInfo.timeInSamples += numSliceSamples;
+                success = readSamplesInParallel (destSamples, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples);
+            }
+            else
+            {
+                positionInfo.timeInSamples = startSampleInFile + startInSamples;
+                while (numSamples > 0)
+                {
+                    int numSliceSamples = jmin (numSamples, maximumBlockSize);
+                    AudioBuffer<float> buffer ((float **) destSamples, numDestChannels, startOffsetInDestBuffer, numSliceSamples);
+                    positionInfo.timeInSeconds = static_cast<double> (positionInfo.timeInSamples) / sampleRate;
+                    success &= playbackRenderer->processBlock (buffer, true, positionInfo);
+                    numSamples -= numSliceSamples;
+                    startOffsetInDestBuffer += numSliceSamples;
+                    positionInfo.timeInSamples += numSliceSamples;
+                }
             }
         }
 
@@ -241,6 +362,75 @@ bool ARAPlaybackRegionReader::readSamples (int** destSamples, int numDestChannel
     return success;
 }
 
+bool ARAPlaybackRegionReader::readSamplesInParallel (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                                                     int64 startSampleInFile, int numSamples)
+{
+    // each renderer (including our main renderer on the calling thread) renders a contiguous range of
+    // whole blocks, so that any state it keeps from block to block sees the same continuous time as
+    // in a serial read - the worker renderers start with a pre-roll into a scratch buffer to build it up
+    const auto numBlocks = (numSamples + maximumBlockSize - 1) / maximumBlockSize;
+    const auto numRenderers = jmin ((int) workerRenderers.size() + 1, numBlocks);
+    std::atomic<bool> allBlocksSucceeded { true };
+
+    const auto renderBlocks = [&] (ARAPlaybackRenderer& renderer, AudioBuffer<float>* preRollBuffer, int rangeIndex)
+    {
+        const auto firstBlock = (int) ((int64) numBlocks * rangeIndex / numRenderers);
+        const auto endBlock = (int) ((int64) numBlocks * (rangeIndex + 1) / numRenderers);
+        auto blockPositionInfo = positionInfo;
+
+        const auto renderBlock = [&] (AudioBuffer<float>& buffer, int blockOffset)
+        {
+            blockPositionInfo.timeInSamples = startSampleInFile + startInSamples + blockOffset;
+            blockPositionInfo.timeInSeconds = static_cast<double> (blockPositionInfo.timeInSamples) / sampleRate;
+            return renderer.processBlock (buffer, true, blockPositionInfo);
+        };
+
+        if (preRollBuffer != nullptr)
+        {
+            for (int block = firstBlock - numPreRollBlocks; block < firstBlock; ++block)
+            {
+                AudioBuffer<float> buffer (preRollBuffer->getArrayOfWritePointers(),
+                                           jmin (numDestChannels, preRollBuffer->getNumChannels()), maximumBlockSize);
+                renderBlock (buffer, block * maximumBlockSize);
+            }
+        }
+
+        for (int block = firstBlock; block < endBlock; ++block)
+        {
+            const auto blockOffset = block * maximumBlockSize;
+            const auto numBlockSamples = jmin (maximumBlockSize, numSamples - blockOffset);
+            AudioBuffer<float> buffer ((float **) destSamples, numDestChannels, startOffsetInDestBuffer + blockOffset, numBlockSamples);
+
+            if (! renderBlock (buffer, blockOffset))
+                allBlocksSucceeded = false;
+        }
+    };
+
+    const auto numJobs = numRenderers - 1;
+    std::atomic<int> numPendingJobs { numJobs };
+    WaitableEvent allJobsFinished;
+
+    for (int i = 0; i < numJobs; ++i)
+    {
+        auto* workerRenderer = workerRenderers[(size_t) i].get();
+        auto* preRollBuffer = &preRollBuffers[(size_t) i];
+        workerPool->addJob ([&renderBlocks, &numPendingJobs, &allJobsFinished, workerRenderer, preRollBuffer, i]
+                            {
+                                renderBlocks (*workerRenderer, preRollBuffer, i + 1);
+
+                                if (--numPendingJobs == 0)
+                                    allJobsFinished.signal();
+                            });
+    }
+
+    renderBlocks (*playbackRenderer, nullptr, 0);
+
+    if (numJobs > 0)
+        allJobsFinished.wait();
+
+    return allBlocksSucceeded;
+}
+
 void ARAPlaybackRegionReader::willUpdatePlaybackRegionProperties (ARAPlaybackRegion* playbackRegion, ARAPlaybackRegion::PropertiesPtr newProperties)
 {
     jassert (ARA::contains (playbackRenderer->getPlaybackRegions(), playbackRegion));
@@ -265,6 +455,17 @@ void ARAPlaybackRegionReader::didUpdatePlaybackRegionContent (ARAPlaybackRegion*
         invalidate();
 }
 
+void ARAPlaybackRegionReader::didUpdatePlaybackRegionContentInRange (ARAPlaybackRegion* playbackRegion, Range<double> affectedTimeRange, ARAContentUpdateScopes scopeFlags)
+{
+    jassert (ARA::contains (playbackRenderer->getPlaybackRegions(), playbackRegion));
+    ignoreUnused (playbackRegion);
+
+    // only invalidate if the audio signal is changed within the range we're reading
+    const auto readTimeRange = Range<double>::withStartAndLength ((double) startInSamples / sampleRate, (double) lengthInSamples / sampleRate);
+    if (scopeFlags.affectSamples() && readTimeRange.intersects (affectedTimeRange))
+        invalidate();
+}
+
 void ARAPlaybackRegionReader::willDestroyPlaybackRegion (ARAPlaybackRegion* playbackRegion)
 {
     jassert (ARA::contains (playbackRenderer->getPlaybackRegions(), playbackRegion));
@@ -2,6 +2,7 @@
 
 #include <juce_audio_formats/juce_audio_formats.h>
 #include "juce_ARAModelObjects.h"
+#include "juce_ARAAudioSourceBlockCache.h"
 
 namespace juce
 {
@@ -49,19 +50,49 @@ class AudioProcessor;
         - the audio source sample access is disabled
         - The audio source being read is destroyed
 
+    Content updates that are limited to a range of the audio source do not invalidate the reader:
+    it does not buffer any samples itself, so subsequent reads will see the updated samples, and the
+    block cache only drops the affected blocks. Code that keeps copies of the samples read (such as a
+    BufferingAudioReader) should listen to ARAAudioSource::Listener::doUpdateAudioSourceContentInRange()
+    to refresh the affected range.
+
+    Reading is lock-free: model edits never cause a concurrent read to fail, the read will
+    instead either use the previous or the new state of the reader.
+
+    Optionally, the reader can be routed through the document controller's ARAAudioSourceBlockCache.
+    In this mode, any read will trigger prefetching of the following blocks on background threads,
+    and repeated or sequential reads will be served from memory rather than calling the host.
+
     @tags{ARA}
 */
 class JUCE_API  ARAAudioSourceReader  : public AudioFormatReader,
                                         private ARAAudioSource::Listener
 {
 public:
-    /** Use an ARAAudioSource to construct an audio source reader for the given \p audioSource. */
-    ARAAudioSourceReader (ARAAudioSource* audioSource);
+    /** Use an ARAAudioSource to construct an audio source reader for the given \p audioSource.
+        @param audioSource    The audio source to read.
+        @param useBlockCache  If true, reads are served through ARADocumentController::getAudioSourceBlockCache().
+                              Must be constructed on the message thread in that case.
+    */
+    ARAAudioSourceReader (ARAAudioSource* audioSource, bool useBlockCache = false);
     ~ARAAudioSourceReader() override;
 
     bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
                       int64 startSampleInFile, int numSamples) override;
 
+    /** Reads samples directly into the channels of the given buffer.
+
+        Unlike AudioFormatReader::read(), this hands the channel pointers of the buffer straight to the
+        host without any sample format conversion. Channels of the audio source that the buffer does not
+        provide are read into scratch space allocated by the constructor, and channels of the buffer beyond
+        those of the audio source as well as any samples outside of the audio source are cleared, so this
+        never allocates.
+
+        Returns false if the reader is invalid, if sample access is currently disabled (in which case the
+        range is cleared) or if the host failed to provide the samples.
+    */
+    bool readIntoBuffer (AudioBuffer<float>& buffer, int startInBuffer, int64 startSampleInFile, int numSamples);
+
     /** Returns true as long as the reader's underlying ARAAudioSource remains accessible and its sample content is not changed. */
     bool isValid() const { return audioSourceBeingRead != nullptr; }
     /** Invalidate the reader - the reader will call this internally if needed, but can also be invalidated from the outside (from message thread only!). */
@@ -69,15 +100,28 @@ public:
 
     void willUpdateAudioSourceProperties (ARAAudioSource* audioSource, ARAAudioSource::PropertiesPtr newProperties) override;
     void doUpdateAudioSourceContent (ARAAudioSource* audioSource, ARAContentUpdateScopes scopeFlags) override;
+    void doUpdateAudioSourceContentInRange (ARAAudioSource* audioSource, Range<double> affectedTimeRange, ARAContentUpdateScopes scopeFlags) override;
     void willEnableAudioSourceSamplesAccess (ARAAudioSource* audioSource, bool enable) override;
     void didEnableAudioSourceSamplesAccess (ARAAudioSource* audioSource, bool enable) override;
     void willDestroyAudioSource (ARAAudioSource* audioSource) override;
 
 private:
+    void setHostReader (std::unique_ptr<ARA::PlugIn::HostAudioReader> newHostReader);
+    bool readChannels (const ARA::PlugIn::HostAudioReader& reader, int64 startSampleInFile, int numSamples);
+
+    // the number of samples of the scratch channel, reads that skip channels are split into chunks of this size
+    static constexpr int scratchSize = 4096;
+
     ARAAudioSource* audioSourceBeingRead;
-    std::unique_ptr<ARA::PlugIn::HostAudioReader> hostReader;
-    ReadWriteLock lock;
+    std::atomic<ARA::PlugIn::HostAudioReader*> hostReader { nullptr };
+    ARAReadEpoch readEpoch;
+    std::vector<float*> destPtrs;
     std::vector<void*> tmpPtrs;
+    HeapBlock<float> scratchChannel;
+
+    ARAAudioSourceBlockCache* blockCache { nullptr };
+    ARAAudioSourceBlockCache::SourceEntry::Ptr blockCacheEntry;
+    std::vector<void*> cacheScratchPtrs;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ARAAudioSourceReader)
 };
@@ -95,9 +139,13 @@ private:
     The reader instance will take care of adding all regions being read to the renderer
     and invoke its processBlock function in order to read the region samples.
 
+    For non-realtime workloads such as drawing many waveforms or bouncing long ranges, the reader
+    can render in parallel, see setNumParallelRenderThreads().
+
     The reader becomes invalid if
         - any region properties are updated in a way that would affect its samples
         - any region content is updated in a way that would affect its samples
+          (if the update is limited to a time range, only if that range overlaps the range being read)
         - any of its regions are destroyed
 
     @tags{ARA}
@@ -132,8 +180,32 @@ public:
     bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
                       int64 startSampleInFile, int numSamples) override;
 
+    /** Enables a non-realtime read mode in which any read that spans more than a single render block
+        is split into contiguous ranges that are rendered concurrently on a pool of worker threads, each
+        of which uses its own playback renderer created through the document controller.
+        The calling thread also takes part in rendering, so reads scale with the number of cores used.
+
+        Each renderer renders its range from start to end in the same blocks as a serial read would,
+        so renderers that keep state from one block to the next (e.g. for time stretching or filtering)
+        see continuous time. Since the worker renderers start in the middle of the read, they first
+        render the given pre-roll ahead of their range and discard it, which should cover the time
+        that the renderers' state needs to settle.
+
+        Since the additional renderers are created and prepared here, this must not be called
+        concurrently to readSamples(), and the reader must not be used for realtime rendering
+        while parallel rendering is enabled.
+        @param numWorkerThreads  The number of additional threads used for rendering, 0 disables parallel rendering.
+        @param preRollSamples    The number of samples rendered ahead of each worker's range, which is
+                                 rounded up to a multiple of the render block size.
+    */
+    void setNumParallelRenderThreads (int numWorkerThreads, int preRollSamples = maximumBlockSize);
+
+    /** Returns the number of additional threads used for rendering, see setNumParallelRenderThreads(). */
+    int getNumParallelRenderThreads() const noexcept { return (int) workerRenderers.size(); }
+
     void willUpdatePlaybackRegionProperties (ARAPlaybackRegion* playbackRegion, ARAPlaybackRegion::PropertiesPtr newProperties) override;
     void didUpdatePlaybackRegionContent (ARAPlaybackRegion* playbackRegion, ARAContentUpdateScopes scopeFlags) override;
+    void didUpdatePlaybackRegionContentInRange (ARAPlaybackRegion* playbackRegion, Range<double> affectedTimeRange, ARAContentUpdateScopes scopeFlags) override;
     void willDestroyPlaybackRegion (ARAPlaybackRegion* playbackRegion) override;
 
     /** The starting point of the reader in playback samples */
@@ -143,7 +215,16 @@ private:
     std::unique_ptr<ARAPlaybackRenderer> playbackRenderer;
     AudioPlayHead::CurrentPositionInfo positionInfo;
     ReadWriteLock lock;
-    
+
+    std::vector<std::unique_ptr<ARAPlaybackRenderer>> workerRenderers;
+    std::vector<AudioBuffer<float>> preRollBuffers;
+    std::unique_ptr<ThreadPool> workerPool;
+    int numPreRollBlocks = 0;
+
+    void releaseWorkerRenderers();
+    bool readSamplesInParallel (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                                int64 startSampleInFile, int numSamples);
+
     static constexpr int maximumBlockSize = 4*1024;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ARAPlaybackRegionReader)
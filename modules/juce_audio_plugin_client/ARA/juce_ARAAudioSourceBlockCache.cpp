@@ -0,0 +1,472 @@
+#include "juce_ARAAudioSourceBlockCache.h"
+
+namespace juce
+{
+
+ARAAudioSourceBlockCache::SourceEntry::SourceEntry (ARAAudioSourceBlockCache& owner, ARAAudioSource* source)
+    : cache (owner),
+      audioSource (source),
+      numChannels (source->getChannelCount()),
+      sampleCount (source->getSampleCount()),
+      numBlocks ((source->getSampleCount() + owner.blockSize - 1) / owner.blockSize),
+      blocks (new std::atomic<Block*>[(size_t) numBlocks]()),
+      hostReaderPointers ((size_t) numChannels)
+{
+    if (audioSource->isSampleAccessEnabled())
+        hostReader.reset (new ARA::PlugIn::HostAudioReader (audioSource));
+}
+
+ARAAudioSourceBlockCache::SourceEntry::~SourceEntry()
+{
+    for (int64 i = 0; i < numBlocks; ++i)
+        delete blocks[(size_t) i].exchange (nullptr);
+}
+
+int64 ARAAudioSourceBlockCache::SourceEntry::getNumSamplesInBlock (int64 blockIndex) const noexcept
+{
+    const auto blockStart = blockIndex * cache.blockSize;
+    return jmin ((int64) cache.blockSize, sampleCount - blockStart);
+}
+
+void ARAAudioSourceBlockCache::SourceEntry::requestPrefetch (int64 blockIndex)
+{
+    // only bother the worker threads if anything in the prefetch range is actually missing
+    const auto endIndex = jmin (numBlocks, blockIndex + cache.numPrefetchBlocks);
+    auto needsPrefetch = false;
+    for (auto i = jmax ((int64) 0, blockIndex); i < endIndex && ! needsPrefetch; ++i)
+        needsPrefetch = (blocks[(size_t) i].load (std::memory_order_relaxed) == nullptr);
+
+    if (! needsPrefetch)
+        return;
+
+    // this is called on the audio thread, so it only publishes the request for the polling workers,
+    // since waking them through their WaitableEvent would lock a mutex
+    nextBlockToPrefetch.store (blockIndex);
+
+    if (! prefetchRequested.exchange (true))
+        cache.anyPrefetchRequested.store (true);
+}
+
+void ARAAudioSourceBlockCache::SourceEntry::prefetchBlocks (int64 firstBlockIndex)
+{
+    const auto endIndex = jmin (numBlocks, firstBlockIndex + cache.numPrefetchBlocks);
+
+    for (auto i = jmax ((int64) 0, firstBlockIndex); i < endIndex; ++i)
+    {
+        if (! isValid.load())
+            return;
+
+        if (blocks[(size_t) i].load() != nullptr)
+            continue;
+
+        const auto numSamplesInBlock = getNumSamplesInBlock (i);
+        std::unique_ptr<Block> block (new Block (numChannels, (int) numSamplesInBlock));
+
+        // holding the lock while reading ensures that a concurrent purge after a content
+        // change can not be overtaken by a block read before that change
+        const ScopedLock sl (lock);
+
+        if (hostReader == nullptr || ! isValid.load())
+            return;
+
+        for (int c = 0; c < numChannels; ++c)
+            hostReaderPointers[(size_t) c] = block->samples.getWritePointer (c);
+
+        if (! hostReader->readAudioSamples (i * cache.blockSize, numSamplesInBlock, hostReaderPointers.data()))
+            continue;
+
+        block->lastAccess.store (++cache.accessCounter);
+
+        Block* expected = nullptr;
+        if (blocks[(size_t) i].compare_exchange_strong (expected, block.get()))
+        {
+            block.release();
+            ++cache.numCachedBlocks;
+        }
+    }
+}
+
+void ARAAudioSourceBlockCache::SourceEntry::retireAllBlocks (std::vector<Block*>& retired) noexcept
+{
+    retireBlocks (retired, 0, numBlocks);
+}
+
+void ARAAudioSourceBlockCache::SourceEntry::retireBlocks (std::vector<Block*>& retired, int64 firstBlockIndex, int64 endBlockIndex) noexcept
+{
+    for (auto i = jmax ((int64) 0, firstBlockIndex); i < jmin (numBlocks, endBlockIndex); ++i)
+        if (auto* block = blocks[(size_t) i].exchange (nullptr))
+            retired.push_back (block);
+}
+
+//==============================================================================
+
+class ARAAudioSourceBlockCache::PrefetchThread  : public Thread
+{
+public:
+    explicit PrefetchThread (ARAAudioSourceBlockCache& owner)
+        : Thread ("ARA block cache prefetch"), cache (owner)
+    {}
+
+    void run() override
+    {
+        while (! threadShouldExit())
+            if (! cache.runRequestedPrefetches())
+                wait (pollIntervalMs);
+    }
+
+private:
+    // Readers can't wake the thread without locking, so it polls for requests while idle. The
+    // interval only needs to be short compared to the time it takes to play back the prefetched blocks.
+    static constexpr int pollIntervalMs = 5;
+
+    ARAAudioSourceBlockCache& cache;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PrefetchThread)
+};
+
+//==============================================================================
+
+ARAAudioSourceBlockCache::ARAAudioSourceBlockCache (int blockSizeInSamples, int maxNumBlocks, int numBlocksToPrefetch, int numWorkerThreads)
+    : blockSize (jmax (1, blockSizeInSamples)),
+      maxNumCachedBlocks (jmax (1, maxNumBlocks)),
+      numPrefetchBlocks (jmax (1, numBlocksToPrefetch))
+{
+    for (int i = jmax (1, numWorkerThreads); --i >= 0;)
+        prefetchThreads.add (new PrefetchThread (*this))->startThread();
+}
+
+ARAAudioSourceBlockCache::~ARAAudioSourceBlockCache()
+{
+    std::map<ARAAudioSource*, SourceEntry::Ptr> remainingEntries;
+
+    {
+        const ScopedLock sl (entriesLock);
+        std::swap (remainingEntries, entries);
+    }
+
+    for (auto& entry : remainingEntries)
+    {
+        entry.first->removeListener (this);
+        entry.second->isValid.store (false);
+    }
+
+    readEpoch.synchronise();
+
+    for (auto* thread : prefetchThreads)
+        thread->signalThreadShouldExit();
+
+    for (auto* thread : prefetchThreads)
+        thread->stopThread (-1);
+
+    std::vector<SourceEntry::Block*> retired;
+    for (auto& entry : remainingEntries)
+    {
+        const ScopedLock sl (entry.second->lock);
+        entry.second->hostReader.reset();
+        entry.second->retireAllBlocks (retired);
+    }
+
+    reclaimBlocks (retired);
+}
+
+ARAAudioSourceBlockCache::SourceEntry::Ptr ARAAudioSourceBlockCache::getEntryForAudioSource (ARAAudioSource* audioSource)
+{
+    if (auto entry = findEntry (audioSource))
+        return entry;
+
+    SourceEntry::Ptr entry (new SourceEntry (*this, audioSource));
+
+    {
+        const ScopedLock sl (entriesLock);
+        entries[audioSource] = entry;
+    }
+
+    audioSource->addListener (this);
+    return entry;
+}
+
+ARAAudioSourceBlockCache::SourceEntry::Ptr ARAAudioSourceBlockCache::findEntry (ARAAudioSource* audioSource) const
+{
+    const ScopedLock sl (entriesLock);
+
+    const auto it = entries.find (audioSource);
+    return (it != entries.end()) ? it->second : nullptr;
+}
+
+void ARAAudioSourceBlockCache::removeEntry (ARAAudioSource* audioSource)
+{
+    SourceEntry::Ptr entry;
+
+    {
+        const ScopedLock sl (entriesLock);
+
+        const auto it = entries.find (audioSource);
+        if (it == entries.end())
+            return;
+
+        entry = it->second;
+        entries.erase (it);
+    }
+
+    audioSource->removeListener (this);
+    stopPrefetching (*entry);
+
+    std::vector<SourceEntry::Block*> retired;
+
+    {
+        const ScopedLock sl (entry->lock);
+        entry->hostReader.reset();
+        entry->retireAllBlocks (retired);
+    }
+
+    reclaimBlocks (retired);
+}
+
+void ARAAudioSourceBlockCache::stopPrefetching (SourceEntry& entry)
+{
+    entry.isValid.store (false);
+
+    // after this, no reader can be about to request a new prefetch for the entry
+    readEpoch.synchronise();
+
+    // wait for any prefetch that is currently in progress - pending requests will bail out
+    const ScopedLock sl (entry.lock);
+}
+
+bool ARAAudioSourceBlockCache::runRequestedPrefetches()
+{
+    if (! anyPrefetchRequested.exchange (false))
+        return false;
+
+    Array<SourceEntry::Ptr> requested;
+
+    {
+        const ScopedLock sl (entriesLock);
+
+        for (auto& entry : entries)
+            if (entry.second->prefetchRequested.exchange (false))
+                requested.add (entry.second);
+    }
+
+    for (auto& entry : requested)
+        entry->prefetchBlocks (entry->nextBlockToPrefetch.load());
+
+    trimToSize();
+    return true;
+}
+
+void ARAAudioSourceBlockCache::purgeAudioSource (ARAAudioSource* audioSource)
+{
+    if (auto entry = findEntry (audioSource))
+    {
+        std::vector<SourceEntry::Block*> retired;
+
+        {
+            const ScopedLock sl (entry->lock);
+            entry->retireAllBlocks (retired);
+        }
+
+        reclaimBlocks (retired);
+    }
+}
+
+void ARAAudioSourceBlockCache::purgeAudioSourceRange (ARAAudioSource* audioSource, Range<int64> sampleRange)
+{
+    if (sampleRange.isEmpty())
+        return;
+
+    if (auto entry = findEntry (audioSource))
+    {
+        std::vector<SourceEntry::Block*> retired;
+
+        {
+            const ScopedLock sl (entry->lock);
+            entry->retireBlocks (retired, sampleRange.getStart() / blockSize, (sampleRange.getEnd() + blockSize - 1) / blockSize);
+        }
+
+        reclaimBlocks (retired);
+    }
+}
+
+void ARAAudioSourceBlockCache::reclaimBlocks (std::vector<SourceEntry::Block*>& retired)
+{
+    if (retired.empty())
+        return;
+
+    readEpoch.synchronise();
+
+    for (auto* block : retired)
+        delete block;
+
+    numCachedBlocks -= (int) retired.size();
+    retired.clear();
+}
+
+void ARAAudioSourceBlockCache::trimToSize()
+{
+    if (numCachedBlocks.load() <= maxNumCachedBlocks)
+        return;
+
+    const ScopedTryLock stl (trimLock);
+    if (! stl.isLocked())
+        return;
+
+    struct Candidate
+    {
+        uint32 lastAccess;
+        SourceEntry* entry;
+        int64 blockIndex;
+    };
+
+    std::vector<Candidate> candidates;
+    std::vector<SourceEntry::Block*> retired;
+
+    {
+        const ScopedLock sl (entriesLock);
+
+        for (auto& entry : entries)
+            for (int64 i = 0; i < entry.second->numBlocks; ++i)
+                if (auto* block = entry.second->blocks[(size_t) i].load())
+                    candidates.push_back ({ block->lastAccess.load(), entry.second.get(), i });
+
+        // evict somewhat below the limit so that we're not trimming upon each prefetch
+        const auto numToEvict = (int) candidates.size() - (maxNumCachedBlocks - maxNumCachedBlocks / 8);
+        if (numToEvict <= 0)
+            return;
+
+        std::partial_sort (candidates.begin(), candidates.begin() + numToEvict, candidates.end(),
+                           [] (const Candidate& a, const Candidate& b) { return a.lastAccess < b.lastAccess; });
+
+        for (int i = 0; i < numToEvict; ++i)
+            if (auto* block = candidates[(size_t) i].entry->blocks[(size_t) candidates[(size_t) i].blockIndex].exchange (nullptr))
+                retired.push_back (block);
+    }
+
+    reclaimBlocks (retired);
+}
+
+bool ARAAudioSourceBlockCache::readSamples (SourceEntry& entry, const ARA::PlugIn::HostAudioReader& fallbackReader,
+                                            void* const* destBuffers, void** scratchPointers, int64 startSample, int numSamples)
+{
+    const ARAReadEpoch::ScopedRead scopedRead (readEpoch);
+
+    if (! entry.isValid.load())
+        return fallbackReader.readAudioSamples (startSample, numSamples, destBuffers);
+
+    const auto endSample = startSample + numSamples;
+    auto uncachedStart = endSample;
+    auto success = true;
+
+    // reads any pending range of uncached samples from the host, directly into the destination
+    const auto readUncachedSamples = [&] (int64 uncachedEnd)
+    {
+        if (uncachedStart >= uncachedEnd)
+            return;
+
+        const auto offset = (size_t) (uncachedStart - startSample);
+        for (int c = 0; c < entry.numChannels; ++c)
+            scratchPointers[c] = static_cast<float*> (destBuffers[c]) + offset;
+
+        success = fallbackReader.readAudioSamples (uncachedStart, uncachedEnd - uncachedStart, scratchPointers) && success;
+        uncachedStart = endSample;
+    };
+
+    for (auto position = startSample; position < endSample;)
+    {
+        const auto blockIndex = position / blockSize;
+        const auto blockStart = blockIndex * blockSize;
+        auto* block = isPositiveAndBelow (blockIndex, entry.numBlocks) ? entry.blocks[(size_t) blockIndex].load (std::memory_order_acquire)
+                                                                        : nullptr;
+        const auto blockEnd = blockStart + ((block != nullptr) ? block->samples.getNumSamples() : blockSize);
+        const auto numSamplesInRange = (int) (jmin (endSample, blockEnd) - position);
+
+        if (block != nullptr)
+        {
+            readUncachedSamples (position);
+
+            const auto offset = (size_t) (position - startSample);
+            for (int c = 0; c < entry.numChannels; ++c)
+                FloatVectorOperations::copy (static_cast<float*> (destBuffers[c]) + offset,
+                                             block->samples.getReadPointer (c, (int) (position - blockStart)),
+                                             numSamplesInRange);
+
+            block->lastAccess.store (++accessCounter, std::memory_order_relaxed);
+            ++numBlockHits;
+        }
+        else
+        {
+            if (uncachedStart == endSample)
+                uncachedStart = position;
+
+            ++numBlockMisses;
+        }
+
+        position += numSamplesInRange;
+    }
+
+    readUncachedSamples (endSample);
+
+    entry.requestPrefetch (startSample / blockSize);
+
+    return success;
+}
+
+//==============================================================================
+
+void ARAAudioSourceBlockCache::willUpdateAudioSourceProperties (ARAAudioSource* audioSource, ARAAudioSource::PropertiesPtr newProperties)
+{
+    if (audioSource->getSampleCount() != newProperties->sampleCount ||
+        audioSource->getSampleRate() != newProperties->sampleRate ||
+        audioSource->getChannelCount() != newProperties->channelCount)
+    {
+        removeEntry (audioSource);
+    }
+}
+
+void ARAAudioSourceBlockCache::doUpdateAudioSourceContent (ARAAudioSource* audioSource, ARAContentUpdateScopes scopeFlags)
+{
+    if (scopeFlags.affectSamples())
+        purgeAudioSource (audioSource);
+}
+
+void ARAAudioSourceBlockCache::doUpdateAudioSourceContentInRange (ARAAudioSource* audioSource, Range<double> affectedTimeRange, ARAContentUpdateScopes scopeFlags)
+{
+    if (scopeFlags.affectSamples())
+    {
+        const auto sampleRate = audioSource->getSampleRate();
+        purgeAudioSourceRange (audioSource, { (int64) std::floor (affectedTimeRange.getStart() * sampleRate),
+                                              (int64) std::ceil (affectedTimeRange.getEnd() * sampleRate) });
+    }
+}
+
+void ARAAudioSourceBlockCache::willEnableAudioSourceSamplesAccess (ARAAudioSource* audioSource, bool enable)
+{
+    // the cached samples remain valid while access is disabled, only the host reader must be released
+    if (! enable)
+    {
+        if (auto entry = findEntry (audioSource))
+        {
+            const ScopedLock sl (entry->lock);
+            entry->hostReader.reset();
+        }
+    }
+}
+
+void ARAAudioSourceBlockCache::didEnableAudioSourceSamplesAccess (ARAAudioSource* audioSource, bool enable)
+{
+    if (enable)
+    {
+        if (auto entry = findEntry (audioSource))
+        {
+            const ScopedLock sl (entry->lock);
+            entry->hostReader.reset (new ARA::PlugIn::HostAudioReader (audioSource));
+        }
+    }
+}
+
+void ARAAudioSourceBlockCache::willDestroyAudioSource (ARAAudioSource* audioSource)
+{
+    removeEntry (audioSource);
+}
+
+} // namespace juce
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include "juce_ARAModelObjects.h"
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A document-wide cache of decoded audio source samples, organised in fixed size blocks
+    that are keyed by audio source and block index.
+
+    The cache is owned by the ARADocumentController (see ARADocumentController::getAudioSourceBlockCache())
+    and used by any ARAAudioSourceReader that has been constructed with block caching enabled.
+    Whenever such a reader accesses a range of samples, the cache will prefetch the blocks at and
+    beyond the read position on its own worker threads, so that subsequent reads of the same or
+    following ranges are served from memory without calling the host again. The worker threads
+    are created along with the cache and poll for requests while idle, so a reader only needs to
+    flag a prefetch request in an atomic, which neither allocates nor takes any locks.
+
+    Each audio source is represented by a reference-counted SourceEntry that is shared between
+    the cache and all readers of the source. Cached blocks are published lock-free and reclaimed
+    using an ARAReadEpoch, so that reading threads never need to block or fail while the cache is
+    being trimmed or the model is being edited.
+
+    When the total number of cached blocks exceeds the configured limit, the least recently used
+    blocks are evicted.
+
+    @tags{ARA}
+*/
+class JUCE_API  ARAAudioSourceBlockCache  : private ARAAudioSource::Listener
+{
+public:
+    /** Creates a cache.
+        @param blockSizeInSamples   The number of samples per channel stored in each block.
+        @param maxNumCachedBlocks   The total number of blocks that may be cached across all audio sources.
+        @param numPrefetchBlocks    The number of blocks that are prefetched beginning at each read position.
+        @param numWorkerThreads     The number of threads used for prefetching.
+    */
+    ARAAudioSourceBlockCache (int blockSizeInSamples = 32 * 1024,
+                              int maxNumCachedBlocks = 1024,
+                              int numPrefetchBlocks = 8,
+                              int numWorkerThreads = 2);
+
+    ~ARAAudioSourceBlockCache() override;
+
+    /** Returns the number of samples per channel stored in each block. */
+    int getBlockSize() const noexcept { return blockSize; }
+
+    /** Returns the number of blocks that are currently cached across all audio sources. */
+    int getNumCachedBlocks() const noexcept { return numCachedBlocks.load(); }
+
+    /** Returns the number of blocks served from the cache since its creation. */
+    int64 getNumBlockHits() const noexcept { return numBlockHits.load(); }
+
+    /** Returns the number of blocks that had to be read from the host since its creation. */
+    int64 getNumBlockMisses() const noexcept { return numBlockMisses.load(); }
+
+    /** Drops all cached blocks of the given audio source (message thread only). */
+    void purgeAudioSource (ARAAudioSource* audioSource);
+
+    /** Drops only those cached blocks of the given audio source that overlap the given range of samples (message thread only). */
+    void purgeAudioSourceRange (ARAAudioSource* audioSource, Range<int64> sampleRange);
+
+    //==============================================================================
+    /** @internal
+        The shared per-audio source state of the cache.
+    */
+    class SourceEntry  : public ReferenceCountedObject
+    {
+    public:
+        using Ptr = ReferenceCountedObjectPtr<SourceEntry>;
+
+        ~SourceEntry() override;
+
+    private:
+        friend class ARAAudioSourceBlockCache;
+
+        struct Block
+        {
+            Block (int numChannels, int numSamples)
+                : samples (numChannels, numSamples)
+            {}
+
+            AudioBuffer<float> samples;
+            std::atomic<uint32> lastAccess { 0 };
+        };
+
+        SourceEntry (ARAAudioSourceBlockCache& owner, ARAAudioSource* audioSource);
+
+        int64 getNumSamplesInBlock (int64 blockIndex) const noexcept;
+        void requestPrefetch (int64 blockIndex);
+        void prefetchBlocks (int64 firstBlockIndex);
+        void retireAllBlocks (std::vector<Block*>& retired) noexcept;
+        void retireBlocks (std::vector<Block*>& retired, int64 firstBlockIndex, int64 endBlockIndex) noexcept;
+
+        ARAAudioSourceBlockCache& cache;
+        ARAAudioSource* const audioSource;
+        const int numChannels;
+        const int64 sampleCount;
+        const int64 numBlocks;
+        std::unique_ptr<std::atomic<Block*>[]> blocks;
+
+        // guards the host reader and serialises block insertion against purging
+        CriticalSection lock;
+        std::unique_ptr<ARA::PlugIn::HostAudioReader> hostReader;
+        std::vector<void*> hostReaderPointers;
+
+        std::atomic<bool> isValid { true }, prefetchRequested { false };
+        std::atomic<int64> nextBlockToPrefetch { -1 };
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SourceEntry)
+    };
+
+    /** @internal Returns the shared entry for the given audio source, creating it if needed (message thread only). */
+    SourceEntry::Ptr getEntryForAudioSource (ARAAudioSource* audioSource);
+
+    /** @internal
+        Reads samples through the cache. Cached blocks are copied directly, any uncached ranges are read
+        from the given host reader, and a prefetch of the touched blocks is scheduled.
+        @param scratchPointers  Must provide space for one pointer per channel of the audio source.
+    */
+    bool readSamples (SourceEntry& entry, const ARA::PlugIn::HostAudioReader& fallbackReader,
+                      void* const* destBuffers, void** scratchPointers, int64 startSample, int numSamples);
+
+private:
+    //==============================================================================
+    void willUpdateAudioSourceProperties (ARAAudioSource* audioSource, ARAAudioSource::PropertiesPtr newProperties) override;
+    void doUpdateAudioSourceContent (ARAAudioSource* audioSource, ARAContentUpdateScopes scopeFlags) override;
+    void doUpdateAudioSourceContentInRange (ARAAudioSource* audioSource, Range<double> affectedTimeRange, ARAContentUpdateScopes scopeFlags) override;
+    void willEnableAudioSourceSamplesAccess (ARAAudioSource* audioSource, bool enable) override;
+    void didEnableAudioSourceSamplesAccess (ARAAudioSource* audioSource, bool enable) override;
+    void willDestroyAudioSource (ARAAudioSource* audioSource) override;
+
+    class PrefetchThread;
+
+    bool runRequestedPrefetches();
+
+    SourceEntry::Ptr findEntry (ARAAudioSource* audioSource) const;
+    void removeEntry (ARAAudioSource* audioSource);
+    void stopPrefetching (SourceEntry& entry);
+    void reclaimBlocks (std::vector<SourceEntry::Block*>& retired);
+    void trimToSize();
+
+    const int blockSize, maxNumCachedBlocks, numPrefetchBlocks;
+
+    ARAReadEpoch readEpoch;
+    OwnedArray<PrefetchThread> prefetchThreads;
+    std::atomic<bool> anyPrefetchRequested { false };
+
+    CriticalSection entriesLock;
+    std::map<ARAAudioSource*, SourceEntry::Ptr> entries;
+
+    CriticalSection trimLock;
+    std::atomic<int> numCachedBlocks { 0 };
+    std::atomic<uint32> accessCounter { 0 };
+    std::atomic<int64> numBlockHits { 0 }, numBlockMisses { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ARAAudioSourceBlockCache)
+};
+
+} // namespace juce
@@ -0,0 +1,317 @@
+#include "juce_ARAConvertingAudioReader.h"
+
+namespace juce
+{
+
+namespace ARAConvertingAudioReaderHelpers
+{
+    static constexpr int preferredBlockSize = 4096;
+    static constexpr int64 maxExactBlockSize = 16384;
+
+    // If both sample rates are integers, returns the smallest number of source and target samples
+    // that cover the exact same time span, so that blocks of these sizes can be resampled independently.
+    static bool getConversionUnit (double sourceSampleRate, double targetSampleRate, int64& numSourceSamples, int64& numTargetSamples) noexcept
+    {
+        const auto sourceRate = (int64) std::floor (sourceSampleRate + 0.5);
+        const auto targetRate = (int64) std::floor (targetSampleRate + 0.5);
+
+        if (sourceRate <= 0 || targetRate <= 0 || (double) sourceRate != sourceSampleRate || (double) targetRate != targetSampleRate)
+            return false;
+
+        auto a = sourceRate, b = targetRate;
+        while (b != 0)
+        {
+            const auto remainder = a % b;
+            a = b;
+            b = remainder;
+        }
+
+        numSourceSamples = sourceRate / a;
+        numTargetSamples = targetRate / a;
+        return numTargetSamples <= maxExactBlockSize;
+    }
+
+    static int getInterpolatorLatency (ARAConvertingAudioReader::Quality quality) noexcept
+    {
+        switch (quality)
+        {
+            case ARAConvertingAudioReader::Quality::linear:         return (int) Interpolators::Linear::getBaseLatency();
+            case ARAConvertingAudioReader::Quality::lagrange:       return (int) Interpolators::Lagrange::getBaseLatency();
+            case ARAConvertingAudioReader::Quality::windowedSinc:   return (int) Interpolators::WindowedSinc::getBaseLatency();
+        }
+
+        jassertfalse;
+        return 0;
+    }
+
+    // Restarts the interpolator for each block, so that the result is not depending on any previous reads.
+    template <typename Interpolator>
+    static void resample (double ratio, const float* input, float* preRollOutput, int numPreRollSamples, float* output, int numOutputSamples) noexcept
+    {
+        Interpolator interpolator;
+        const auto numUsed = interpolator.process (ratio, input, preRollOutput, numPreRollSamples);
+        interpolator.process (ratio, input + numUsed, output, numOutputSamples);
+    }
+}
+
+//==============================================================================
+
+ARAConvertingAudioReader::ARAConvertingAudioReader (AudioFormatReader* sourceReader, double targetSampleRate, int targetNumChannels,
+                                                    Quality qualityToUse, int maxNumCachedSamples)
+    : AudioFormatReader (nullptr, sourceReader->getFormatName()),
+      source (sourceReader),
+      quality (qualityToUse),
+      numSourceChannels ((int) sourceReader->numChannels),
+      numMixedChannels (jmin ((int) sourceReader->numChannels, targetNumChannels)),
+      ratio (sourceReader->sampleRate / targetSampleRate)
+{
+    using namespace ARAConvertingAudioReaderHelpers;
+
+    jassert (targetSampleRate > 0.0 && targetNumChannels > 0 && source->sampleRate > 0.0);
+
+    sampleRate = targetSampleRate;
+    numChannels = (unsigned int) targetNumChannels;
+    lengthInSamples = (int64) std::floor ((double) source->lengthInSamples / ratio + 0.5);
+    bitsPerSample = 32;
+    usesFloatingPointData = true;
+    metadataValues = source->metadataValues;
+
+    resampling = (source->sampleRate != targetSampleRate);
+
+    if (! resampling)
+    {
+        blockSize = preferredBlockSize;
+        sourceBuffer.setSize (numSourceChannels, blockSize);
+        if (numMixedChannels < numSourceChannels)
+            mixedBuffer.setSize (numMixedChannels, blockSize);
+        return;
+    }
+
+    // The interpolators need a pre-roll that fills their history, and their output is delayed
+    // by their latency, which is compensated by reading ahead in the source.
+    interpolatorLatency = getInterpolatorLatency (quality);
+    const auto minPreRollSize = (int) std::ceil ((3 * interpolatorLatency + 2) / ratio);
+
+    int64 unitSourceSize = 0, unitSize = 0;
+    if (getConversionUnit (source->sampleRate, targetSampleRate, unitSourceSize, unitSize))
+    {
+        // block borders and pre-roll are multiples of the conversion unit, so each block starts
+        // at an integer source sample position with the same interpolation phase as if the
+        // source was converted continuously
+        const auto numUnitsPerBlock = jmax ((int64) 1, (preferredBlockSize + unitSize / 2) / unitSize);
+        const auto numUnitsInPreRoll = (minPreRollSize + unitSize - 1) / unitSize;
+        blockSize = (int) (numUnitsPerBlock * unitSize);
+        preRollSize = (int) (numUnitsInPreRoll * unitSize);
+        numSourceSamplesPerBlock = (int) (numUnitsPerBlock * unitSourceSize);
+        numSourceSamplesInPreRoll = (int) (numUnitsInPreRoll * unitSourceSize);
+    }
+    else
+    {
+        // each block is starting at the source sample closest to its actual start position
+        blockSize = preferredBlockSize;
+        preRollSize = minPreRollSize;
+        numSourceSamplesPerBlock = 0;
+        numSourceSamplesInPreRoll = roundToInt (preRollSize * ratio);
+    }
+
+    maxNumCachedBlocks = jmax (2, maxNumCachedSamples / blockSize);
+
+    // the interpolators may look one sample ahead of the samples they consume
+    const auto numSourceSamplesToRead = (int) std::ceil ((preRollSize + blockSize) * ratio) + 2;
+    sourceBuffer.setSize (numSourceChannels, numSourceSamplesToRead);
+    if (numMixedChannels < numSourceChannels)
+        mixedBuffer.setSize (numMixedChannels, numSourceSamplesToRead);
+    preRollBuffer.setSize (1, preRollSize);
+}
+
+ARAConvertingAudioReader::~ARAConvertingAudioReader() = default;
+
+bool ARAConvertingAudioReader::needsConversion (const AudioFormatReader& sourceReader, double targetSampleRate, int targetNumChannels) noexcept
+{
+    return (sourceReader.sampleRate != targetSampleRate) || ((int) sourceReader.numChannels != targetNumChannels);
+}
+
+void ARAConvertingAudioReader::clearCache()
+{
+    cachedBlocks.clear();
+    cachedBlocksByIndex.clear();
+}
+
+//==============================================================================
+
+bool ARAConvertingAudioReader::readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                                            int64 startSampleInFile, int numSamples)
+{
+    // the samples are passed in as floats since usesFloatingPointData is set
+    auto destChannels = reinterpret_cast<float* const*> (destSamples);
+
+    if (numMixedChannels <= 0)
+        return false;
+
+    if (! resampling)
+        return readUnconverted (destChannels, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples);
+
+    while (numSamples > 0)
+    {
+        const auto blockIndex = (startSampleInFile >= 0) ? startSampleInFile / blockSize
+                                                         : -((blockSize - 1 - startSampleInFile) / blockSize);
+        const auto startInBlock = (int) (startSampleInFile - blockIndex * blockSize);
+        const auto numSamplesInBlock = jmin (numSamples, blockSize - startInBlock);
+
+        auto* block = getBlock (blockIndex);
+        if (block == nullptr)
+            return false;
+
+        upmix (block->samples, startInBlock, destChannels, numDestChannels, startOffsetInDestBuffer, numSamplesInBlock);
+
+        startSampleInFile += numSamplesInBlock;
+        startOffsetInDestBuffer += numSamplesInBlock;
+        numSamples -= numSamplesInBlock;
+    }
+
+    return true;
+}
+
+bool ARAConvertingAudioReader::readUnconverted (float* const* destChannels, int numDestChannels, int startOffsetInDestBuffer,
+                                                int64 startSampleInFile, int numSamples)
+{
+    while (numSamples > 0)
+    {
+        const auto numSamplesInChunk = jmin (numSamples, sourceBuffer.getNumSamples());
+
+        if (! readSource (startSampleInFile, numSamplesInChunk))
+            return false;
+
+        upmix (mixDown (numSamplesInChunk), 0, destChannels, numDestChannels, startOffsetInDestBuffer, numSamplesInChunk);
+
+        startSampleInFile += numSamplesInChunk;
+        startOffsetInDestBuffer += numSamplesInChunk;
+        numSamples -= numSamplesInChunk;
+    }
+
+    return true;
+}
+
+//==============================================================================
+
+const ARAConvertingAudioReader::CachedBlock* ARAConvertingAudioReader::getBlock (int64 blockIndex)
+{
+    const auto cached = cachedBlocksByIndex.find (blockIndex);
+    if (cached != cachedBlocksByIndex.end())
+    {
+        cached->second->lastUsed = ++useCounter;
+        return cached->second;
+    }
+
+    CachedBlock* block = nullptr;
+
+    if ((int) cachedBlocks.size() < maxNumCachedBlocks)
+    {
+        cachedBlocks.push_back (std::make_unique<CachedBlock>());
+        block = cachedBlocks.back().get();
+        block->samples.setSize (numMixedChannels, blockSize);
+    }
+    else
+    {
+        // recycle the least recently used block
+        block = std::min_element (cachedBlocks.begin(), cachedBlocks.end(), [] (const std::unique_ptr<CachedBlock>& a, const std::unique_ptr<CachedBlock>& b)
+        {
+            return a->lastUsed < b->lastUsed;
+        })->get();
+
+        cachedBlocksByIndex.erase (block->blockIndex);
+    }
+
+    if (! computeBlock (blockIndex, block->samples))
+    {
+        // leave the block unused, so it will be recycled first
+        block->lastUsed = 0;
+        return nullptr;
+    }
+
+    block->blockIndex = blockIndex;
+    block->lastUsed = ++useCounter;
+    cachedBlocksByIndex[blockIndex] = block;
+    ++numComputedBlocks;
+    return block;
+}
+
+bool ARAConvertingAudioReader::computeBlock (int64 blockIndex, AudioBuffer<float>& destBlock)
+{
+    using namespace ARAConvertingAudioReaderHelpers;
+
+    const auto blockStartInSource = (numSourceSamplesPerBlock > 0) ? blockIndex * numSourceSamplesPerBlock
+                                                                   : (int64) std::floor ((double) (blockIndex * blockSize) * ratio + 0.5);
+
+    // output sample i of the interpolator matches its input sample i * ratio - latency
+    const auto numSourceSamples = sourceBuffer.getNumSamples();
+    if (! readSource (blockStartInSource - numSourceSamplesInPreRoll + interpolatorLatency, numSourceSamples))
+        return false;
+
+    const auto& mixed = mixDown (numSourceSamples);
+
+    for (int c = 0; c < numMixedChannels; ++c)
+    {
+        const auto input = mixed.getReadPointer (c);
+        const auto preRollOutput = preRollBuffer.getWritePointer (0);
+        const auto output = destBlock.getWritePointer (c);
+
+        switch (quality)
+        {
+            case Quality::linear:       resample<Interpolators::Linear>       (ratio, input, preRollOutput, preRollSize, output, blockSize); break;
+            case Quality::lagrange:     resample<Interpolators::Lagrange>     (ratio, input, preRollOutput, preRollSize, output, blockSize); break;
+            case Quality::windowedSinc: resample<Interpolators::WindowedSinc> (ratio, input, preRollOutput, preRollSize, output, blockSize); break;
+        }
+    }
+
+    return true;
+}
+
+bool ARAConvertingAudioReader::readSource (int64 startSampleInSource, int numSamples)
+{
+    // the base class takes care of any samples before the start of the source, but not after its end
+    const auto numSamplesAvailable = (int) jlimit ((int64) 0, (int64) numSamples, source->lengthInSamples - startSampleInSource);
+
+    if (numSamplesAvailable < numSamples)
+        sourceBuffer.clear (numSamplesAvailable, numSamples - numSamplesAvailable);
+
+    if (numSamplesAvailable <= 0)
+        return true;
+
+    return source->read (sourceBuffer.getArrayOfWritePointers(), numSourceChannels, startSampleInSource, numSamplesAvailable);
+}
+
+//==============================================================================
+
+const AudioBuffer<float>& ARAConvertingAudioReader::mixDown (int numSamples) noexcept
+{
+    if (numMixedChannels == numSourceChannels)
+        return sourceBuffer;
+
+    // average all source channels that map to the same mixed channel
+    for (int m = 0; m < numMixedChannels; ++m)
+    {
+        auto* dest = mixedBuffer.getWritePointer (m);
+        FloatVectorOperations::copy (dest, sourceBuffer.getReadPointer (m), numSamples);
+
+        int numChannelsMixed = 1;
+        for (int c = m + numMixedChannels; c < numSourceChannels; c += numMixedChannels, ++numChannelsMixed)
+            FloatVectorOperations::add (dest, sourceBuffer.getReadPointer (c), numSamples);
+
+        if (numChannelsMixed > 1)
+            FloatVectorOperations::multiply (dest, 1.0f / (float) numChannelsMixed, numSamples);
+    }
+
+    return mixedBuffer;
+}
+
+void ARAConvertingAudioReader::upmix (const AudioBuffer<float>& sourceSamples, int startInSource, float* const* destChannels,
+                                      int numDestChannels, int startInDest, int numSamples) const noexcept
+{
+    // there are never more mixed channels than target channels, so each target channel is a copy
+    for (int c = 0; c < numDestChannels; ++c)
+        if (auto* dest = destChannels[c])
+            FloatVectorOperations::copy (dest + startInDest, sourceSamples.getReadPointer (c % numMixedChannels, startInSource), numSamples);
+}
+
+} // namespace juce
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <unordered_map>
+#include "juce_ARAAudioReaders.h"
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Subclass of AudioFormatReader that converts the sample rate and channel count of another reader.
+
+    This is used by the ARAPlaybackRenderer to provide the samples of audio sources in the format
+    passed to prepareToPlay(), but it can wrap any reader, typically an ARAAudioSourceReader.
+
+    Sample rate conversion uses one of the interpolators of juce_audio_basics, and its output is
+    computed in blocks that are kept in a least-recently-used cache, so that playing back the same
+    range repeatedly (e.g. when looping) only resamples it once. Each block is computed independently
+    of its neighbours: the interpolators are re-started with a pre-roll ahead of each block, and their
+    latency is compensated. If the ratio between the two sample rates can be expressed as a ratio of
+    integers that is not too large (as it is the case for all common sample rates), the block borders
+    are placed so that the output is identical to a continuous conversion of the entire source.
+
+    Channels are mixed with FloatVectorOperations: mono sources are copied to all target channels,
+    down-mixing to mono averages all source channels, and other layouts are mapped modulo the channel
+    count, averaging all source channels that are mapped to the same target channel.
+    Since the channels are mixed before resampling when down-mixing and after resampling when
+    up-mixing, only the smaller number of channels is resampled and cached.
+
+    Like other readers, this is not thread-safe, and can be wrapped in a BufferingAudioReader for
+    realtime use. Since the converted samples are cached, the reader must be recreated (or the
+    cache must be cleared) when the samples of the source reader change.
+
+    @tags{ARA}
+*/
+class JUCE_API  ARAConvertingAudioReader  : public AudioFormatReader
+{
+public:
+    /** The interpolation algorithm used for sample rate conversion. */
+    enum class Quality
+    {
+        linear,         /**< Linear interpolation, cheap but with audible aliasing. */
+        lagrange,       /**< 4-point Lagrange interpolation. */
+        windowedSinc    /**< Windowed sinc interpolation, for best quality. */
+    };
+
+    /** Creates a reader that converts the output of another reader.
+        @param sourceReader         The reader to convert - this will be deleted by this object.
+        @param targetSampleRate     The sample rate of the samples produced by this reader.
+        @param targetNumChannels    The channel count of the samples produced by this reader.
+        @param quality              The interpolation algorithm to use for sample rate conversion.
+        @param maxNumCachedSamples  The maximum number of converted samples per channel that are cached.
+    */
+    ARAConvertingAudioReader (AudioFormatReader* sourceReader, double targetSampleRate, int targetNumChannels,
+                              Quality quality = Quality::windowedSinc, int maxNumCachedSamples = defaultMaxNumCachedSamples);
+
+    ~ARAConvertingAudioReader() override;
+
+    bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                      int64 startSampleInFile, int numSamples) override;
+
+    /** Returns the reader being converted. */
+    AudioFormatReader& getSourceReader() const noexcept { return *source; }
+
+    /** Returns true if the given format differs from the format of the given reader, so conversion is needed. */
+    static bool needsConversion (const AudioFormatReader& sourceReader, double targetSampleRate, int targetNumChannels) noexcept;
+
+    /** Discards all cached blocks. Must not be called concurrently to readSamples(). */
+    void clearCache();
+
+    /** Returns the number of converted blocks that are currently cached. */
+    int getNumCachedBlocks() const noexcept { return (int) cachedBlocks.size(); }
+
+    /** Returns the number of converted blocks that have been computed since the reader was created. */
+    int64 getNumComputedBlocks() const noexcept { return numComputedBlocks; }
+
+    /** The default cache size, which amounts to a few seconds at common sample rates. */
+    static constexpr int defaultMaxNumCachedSamples = 256 * 1024;
+
+private:
+    struct CachedBlock
+    {
+        int64 blockIndex;
+        uint32 lastUsed;
+        AudioBuffer<float> samples;
+    };
+
+    const CachedBlock* getBlock (int64 blockIndex);
+    bool computeBlock (int64 blockIndex, AudioBuffer<float>& destBlock);
+    bool readSource (int64 startSampleInSource, int numSamples);
+    bool readUnconverted (float* const* destChannels, int numDestChannels, int startOffsetInDestBuffer,
+                          int64 startSampleInFile, int numSamples);
+
+    const AudioBuffer<float>& mixDown (int numSamples) noexcept;
+    void upmix (const AudioBuffer<float>& sourceSamples, int startInSource, float* const* destChannels,
+                int numDestChannels, int startInDest, int numSamples) const noexcept;
+
+    std::unique_ptr<AudioFormatReader> source;
+    const Quality quality;
+    const int numSourceChannels, numMixedChannels;
+    const double ratio;   // source samples per target sample
+
+    // the layout of the converted blocks, see the constructor
+    int blockSize { 0 }, preRollSize { 0 }, interpolatorLatency { 0 };
+    int numSourceSamplesPerBlock { 0 }, numSourceSamplesInPreRoll { 0 };
+    bool resampling { false };
+
+    std::vector<std::unique_ptr<CachedBlock>> cachedBlocks;
+    std::unordered_map<int64, CachedBlock*> cachedBlocksByIndex;
+    int maxNumCachedBlocks { 1 };
+    uint32 useCounter { 0 };
+    int64 numComputedBlocks { 0 };
+
+    AudioBuffer<float> sourceBuffer, mixedBuffer, preRollBuffer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ARAConvertingAudioReader)
+};
+
+} // namespace juce
@@ -41,12 +41,144 @@ ARADocumentController::FactoryConfig::FactoryConfig() noexcept
             supportedPlaybackTransformationFlags |= playbackTransformationFlags[i];
 }
 
+ARADocumentController::~ARADocumentController()
+{
+    cancelPendingUpdate();
+    stopTimer();
+}
+
+//==============================================================================
+
+// Records the notifications that are batched during an edit cycle, merged per model object.
+struct ARADocumentController::NotificationBatch
+{
+    enum ObjectType
+    {
+        document,
+        musicalContext,
+        regionSequence,
+        audioSource,
+        audioModification,
+        playbackRegion
+    };
+
+    enum Change
+    {
+        propertiesUpdated           = 1 << 0,
+        contentUpdated              = 1 << 1,
+        musicalContextsReordered    = 1 << 2,
+        regionSequencesReordered    = 1 << 3
+    };
+
+    struct Entry
+    {
+        Entry (void* object, int type) : modelObject (object), objectType (type) {}
+
+        void* modelObject;
+        int objectType;
+        int changes { 0 };
+        ARAContentUpdateScopes contentScopes { ARAContentUpdateScopes::nothingIsAffected() };
+        Range<double> contentTimeRange;
+        bool contentUpdateIsRanged { true };
+    };
+
+    Entry& getEntry (void* modelObject, int objectType)
+    {
+        const auto it = entryIndices.find (modelObject);
+        if (it != entryIndices.end())
+            return entries[it->second];
+
+        entryIndices.emplace (modelObject, entries.size());
+        entries.emplace_back (modelObject, objectType);
+        return entries.back();
+    }
+
+    void addContentUpdate (void* modelObject, int objectType, const ARA::ARAContentTimeRange* range, ARAContentUpdateScopes scopeFlags)
+    {
+        auto& entry = getEntry (modelObject, objectType);
+        const auto isFirstContentUpdate = (entry.changes & contentUpdated) == 0;
+
+        entry.changes |= contentUpdated;
+        entry.contentScopes = entry.contentScopes + scopeFlags;
+
+        // the merged update is only limited to a time range if all of the individual updates were
+        if (range == nullptr)
+        {
+            entry.contentUpdateIsRanged = false;
+        }
+        else if (entry.contentUpdateIsRanged)
+        {
+            const auto timeRange = Range<double>::withStartAndLength (range->start, range->duration);
+            entry.contentTimeRange = isFirstContentUpdate ? timeRange : entry.contentTimeRange.getUnionWith (timeRange);
+        }
+    }
+
+    void discard (const void* modelObject)
+    {
+        const auto it = entryIndices.find (modelObject);
+        if (it == entryIndices.end())
+            return;
+
+        // keep the entry to not invalidate the indices of the others, but skip it upon delivery
+        entries[it->second].modelObject = nullptr;
+        entryIndices.erase (it);
+    }
+
+    std::vector<Entry> entries;     // in order of the first notification of each object
+    std::unordered_map<const void*, size_t> entryIndices;
+};
+
+void ARADocumentController::setBatchedListenerNotificationsEnabled (bool shouldBeEnabled)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    if (shouldBeEnabled == areBatchedListenerNotificationsEnabled())
+        return;
+
+    if (shouldBeEnabled)
+    {
+        notificationBatch = std::make_unique<NotificationBatch>();
+        resetBatchedNotificationStats();
+    }
+    else
+    {
+        deliverBatchedNotifications();
+        notificationBatch.reset();
+    }
+}
+
+bool ARADocumentController::batchNotification (void* modelObject, int objectType, int change)
+{
+    if (notificationBatch == nullptr || ! isEditingDocument)
+        return false;
+
+    notificationBatch->getEntry (modelObject, objectType).changes |= change;
+    ++batchedNotificationStats.numNotificationsReceived;
+    return true;
+}
+
+bool ARADocumentController::batchContentUpdate (void* modelObject, int objectType, const ARA::ARAContentTimeRange* range, ARAContentUpdateScopes scopeFlags)
+{
+    if (notificationBatch == nullptr || ! isEditingDocument)
+        return false;
+
+    notificationBatch->addContentUpdate (modelObject, objectType, range, scopeFlags);
+    ++batchedNotificationStats.numNotificationsReceived;
+    return true;
+}
+
+void ARADocumentController::discardBatchedNotifications (const void* modelObject)
+{
+    if (notificationBatch != nullptr)
+        notificationBatch->discard (modelObject);
+}
+
 //==============================================================================
 
 void ARADocumentController::internalNotifyAudioSourceAnalysisProgressStarted (ARAAudioSource* audioSource)
 {
     if (audioSource->internalAnalysisProgressTracker.updateProgress (ARA::kARAAnalysisProgressStarted, 0.0f))
-        internalAnalysisProgressIsSynced.clear (std::memory_order_release);
+        queueAnalysisProgress (audioSource);
 
     DocumentController::notifyAudioSourceAnalysisProgressStarted (audioSource);
 }
@@ -54,7 +186,7 @@ void ARADocumentController::internalNotifyAudioSourceAnalysisProgressStarted (AR
 void ARADocumentController::internalNotifyAudioSourceAnalysisProgressUpdated (ARAAudioSource* audioSource, float progress)
 {
     if (audioSource->internalAnalysisProgressTracker.updateProgress (ARA::kARAAnalysisProgressUpdated,  progress))
-        internalAnalysisProgressIsSynced.clear (std::memory_order_release);
+        queueAnalysisProgress (audioSource);
 
     DocumentController::notifyAudioSourceAnalysisProgressUpdated (audioSource, progress);
 }
@@ -62,7 +194,7 @@ void ARADocumentController::internalNotifyAudioSourceAnalysisProgressUpdated (AR
 void ARADocumentController::internalNotifyAudioSourceAnalysisProgressCompleted (ARAAudioSource* audioSource)
 {
     if (audioSource->internalAnalysisProgressTracker.updateProgress (ARA::kARAAnalysisProgressCompleted, 1.0f))
-        internalAnalysisProgressIsSynced.clear (std::memory_order_release);
+        queueAnalysisProgress (audioSource);
 
     DocumentController::notifyAudioSourceAnalysisProgressCompleted (audioSource);
 }
@@ -73,6 +205,30 @@ void ARADocumentController::internalDidUpdateAudioSourceAnalysisProgress (ARAAud
     didUpdateAudioSourceAnalyisProgress (audioSource, state, progress);
 }
 
+void ARADocumentController::internalDidUpdateEditorViewSelection (const ARAViewSelection& viewSelection)
+{
+    // prioritise the analysis of all audio sources that are visible in the current selection
+    if (analysisScheduler == nullptr)
+        return;
+
+    std::vector<ARAAudioSource*> audioSources;
+    const auto addAudioSource = [&audioSources] (ARAPlaybackRegion* playbackRegion)
+    {
+        auto* audioSource = playbackRegion->getAudioModification()->getAudioSource();
+        if (! ARA::contains (audioSources, audioSource))
+            audioSources.push_back (audioSource);
+    };
+
+    for (auto* playbackRegion : viewSelection.getPlaybackRegions<ARAPlaybackRegion>())
+        addAudioSource (playbackRegion);
+
+    for (auto* regionSequence : viewSelection.getRegionSequences<ARARegionSequence>())
+        for (auto* playbackRegion : regionSequence->getPlaybackRegions())
+            addAudioSource (playbackRegion);
+
+    analysisScheduler->setAudioSourcesVisibleInEditor (audioSources);
+}
+
 //==============================================================================
 
 // some helper macros to ease repeated declaration & implementation of notification functions below:
@@ -104,26 +260,61 @@ JUCE_BEGIN_IGNORE_WARNINGS_GCC_LIKE ("-Wgnu-zero-variadic-macro-arguments")
         notify_listeners (function, ARA##ModelObjectPtrType, modelObject, argument); \
     }
 
+// no notification arguments, batched until the end of the edit cycle if enabled
+#define OVERRIDE_TO_NOTIFY_BATCHED(function, ModelObjectPtrType, modelObject, objectType, change) \
+    void ARADocumentController::function (ARA::PlugIn::ModelObjectPtrType modelObject) noexcept \
+    { \
+        if (! batchNotification (static_cast<ARA##ModelObjectPtrType> (modelObject), NotificationBatch::objectType, NotificationBatch::change)) \
+        { \
+            notify_listeners (function, ARA##ModelObjectPtrType, modelObject); \
+        } \
+    }
+
+// no notification arguments, discarding any batched notifications of the object being destroyed
+#define OVERRIDE_TO_NOTIFY_DESTRUCTION(function, ModelObjectPtrType, modelObject) \
+    void ARADocumentController::function (ARA::PlugIn::ModelObjectPtrType modelObject) noexcept \
+    { \
+        discardBatchedNotifications (static_cast<ARA##ModelObjectPtrType> (modelObject)); \
+        notify_listeners (function, ARA##ModelObjectPtrType, modelObject); \
+    }
+
+// delivers a batched notification if the given change has been recorded for the object of the current entry
+#define deliver_batched_notification(change, function, ModelObjectPtrType, ...) \
+    if ((entry.changes & NotificationBatch::change) != 0) \
+    { \
+        notify_listeners (function, ModelObjectPtrType, entry.modelObject, ##__VA_ARGS__); \
+        ++batchedNotificationStats.numNotificationsDelivered; \
+    }
+
 //==============================================================================
 
+void ARADocumentController::setModelObjectPoolEnabled (bool shouldBeEnabled)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    if (shouldBeEnabled == (modelObjectPool != nullptr))
+        return;
+
+    modelObjectPool = shouldBeEnabled ? new ARAModelObjectPool() : nullptr;
+}
+
 ARA::PlugIn::Document* ARADocumentController::doCreateDocument() noexcept
 {
-    return new ARADocument (this);
+    return new (getModelObjectPool()) ARADocument (this);
 }
 
 void ARADocumentController::willBeginEditing() noexcept
 {
+    isEditingDocument = true;
     notify_listeners (willBeginEditing, ARADocument*, getDocument());
 }
 
 void ARADocumentController::didEndEditing() noexcept
 {
-    notify_listeners (didEndEditing, ARADocument*, getDocument());
+    isEditingDocument = false;
+    deliverBatchedNotifications();
 
-    if (isTimerRunning() && (activeAudioSourcesCount == 0))
-        stopTimer();
-    else if (! isTimerRunning() && (activeAudioSourcesCount > 0))
-        startTimerHz (20);
+    notify_listeners (didEndEditing, ARADocument*, getDocument());
 }
 
 void ARADocumentController::willNotifyModelUpdates() noexcept
@@ -136,6 +327,67 @@ void ARADocumentController::didNotifyModelUpdates() noexcept
     notify_listeners (didNotifyModelUpdates, ARADocument*, getDocument());
 }
 
+void ARADocumentController::deliverBatchedNotifications()
+{
+    if (notificationBatch == nullptr || notificationBatch->entries.empty())
+        return;
+
+    auto entries = std::move (notificationBatch->entries);
+    notificationBatch->entries.clear();
+    notificationBatch->entryIndices.clear();
+
+    for (auto& entry : entries)
+    {
+        // the object has been destroyed in the meantime
+        if (entry.modelObject == nullptr)
+            continue;
+
+        switch (entry.objectType)
+        {
+            case NotificationBatch::document:
+                deliver_batched_notification (propertiesUpdated, didUpdateDocumentProperties, ARADocument*)
+                deliver_batched_notification (musicalContextsReordered, didReorderMusicalContextsInDocument, ARADocument*)
+                deliver_batched_notification (regionSequencesReordered, didReorderRegionSequencesInDocument, ARADocument*)
+                break;
+
+            case NotificationBatch::musicalContext:
+                deliver_batched_notification (propertiesUpdated, didUpdateMusicalContextProperties, ARAMusicalContext*)
+                deliver_batched_notification (contentUpdated, doUpdateMusicalContextContent, ARAMusicalContext*, entry.contentScopes)
+                deliver_batched_notification (regionSequencesReordered, didReorderRegionSequencesInMusicalContext, ARAMusicalContext*)
+                break;
+
+            case NotificationBatch::regionSequence:
+                deliver_batched_notification (propertiesUpdated, didUpdateRegionSequenceProperties, ARARegionSequence*)
+                break;
+
+            case NotificationBatch::audioSource:
+                deliver_batched_notification (propertiesUpdated, didUpdateAudioSourceProperties, ARAAudioSource*)
+
+                if (entry.contentUpdateIsRanged)
+                {
+                    deliver_batched_notification (contentUpdated, doUpdateAudioSourceContentInRange, ARAAudioSource*, entry.contentTimeRange, entry.contentScopes)
+                }
+                else
+                {
+                    deliver_batched_notification (contentUpdated, doUpdateAudioSourceContent, ARAAudioSource*, entry.contentScopes)
+                }
+                break;
+
+            case NotificationBatch::audioModification:
+                deliver_batched_notification (propertiesUpdated, didUpdateAudioModificationProperties, ARAAudioModification*)
+                break;
+
+            case NotificationBatch::playbackRegion:
+                deliver_batched_notification (propertiesUpdated, didUpdatePlaybackRegionProperties, ARAPlaybackRegion*)
+                break;
+
+            default:
+                jassertfalse;
+                break;
+        }
+    }
+}
+
 //==============================================================================
 
 bool ARADocumentController::doRestoreObjectsFromArchive (ARA::PlugIn::HostArchiveReader* archiveReader, const ARA::PlugIn::RestoreObjectsFilter* filter) noexcept
@@ -147,113 +399,137 @@ bool ARADocumentController::doRestoreObjectsFromArchive (ARA::PlugIn::HostArchiv
 bool ARADocumentController::doStoreObjectsToArchive (ARA::PlugIn::HostArchiveWriter* archiveWriter, const ARA::PlugIn::StoreObjectsFilter* filter) noexcept
 {
     ARAOutputStream writer (archiveWriter);
-    return doStoreObjectsToStream (writer, filter);
+    const auto succeeded = doStoreObjectsToStream (writer, filter);
+
+    writer.flush();
+    return succeeded && ! writer.failed();
 }
 
 //==============================================================================
 
 OVERRIDE_TO_NOTIFY_3 (willUpdateDocumentProperties, Document*, document, ARADocument::PropertiesPtr, newProperties)
-OVERRIDE_TO_NOTIFY_1 (didUpdateDocumentProperties, Document*, document)
-OVERRIDE_TO_NOTIFY_2 (didAddMusicalContextToDocument, Document*, document, MusicalContext*, musicalContext)
+OVERRIDE_TO_NOTIFY_BATCHED (didUpdateDocumentProperties, Document*, document, document, propertiesUpdated)
 OVERRIDE_TO_NOTIFY_2 (willRemoveMusicalContextFromDocument, Document*, document, MusicalContext*, musicalContext)
-OVERRIDE_TO_NOTIFY_1 (didReorderMusicalContextsInDocument, Document*, document)
+OVERRIDE_TO_NOTIFY_BATCHED (didReorderMusicalContextsInDocument, Document*, document, document, musicalContextsReordered)
 OVERRIDE_TO_NOTIFY_2 (didAddRegionSequenceToDocument, Document*, document, RegionSequence*, regionSequence)
 OVERRIDE_TO_NOTIFY_2 (willRemoveRegionSequenceFromDocument, Document*, document, RegionSequence*, regionSequence)
-OVERRIDE_TO_NOTIFY_1 (didReorderRegionSequencesInDocument, Document*, document)
+OVERRIDE_TO_NOTIFY_BATCHED (didReorderRegionSequencesInDocument, Document*, document, document, regionSequencesReordered)
 OVERRIDE_TO_NOTIFY_2 (didAddAudioSourceToDocument, Document*, document, AudioSource*, audioSource)
 OVERRIDE_TO_NOTIFY_2 (willRemoveAudioSourceFromDocument, Document*, document, AudioSource*, audioSource)
-OVERRIDE_TO_NOTIFY_1 (willDestroyDocument, Document*, document)
+OVERRIDE_TO_NOTIFY_DESTRUCTION (willDestroyDocument, Document*, document)
 
 //==============================================================================
 
 ARA::PlugIn::MusicalContext* ARADocumentController::doCreateMusicalContext (ARA::PlugIn::Document* document, ARA::ARAMusicalContextHostRef hostRef) noexcept
 {
-    return new ARAMusicalContext (static_cast<ARADocument*> (document), hostRef);
+    return new (getModelObjectPool()) ARAMusicalContext (static_cast<ARADocument*> (document), hostRef);
 }
 
-void ARADocumentController::doUpdateMusicalContextContent (ARA::PlugIn::MusicalContext* musicalContext, const ARA::ARAContentTimeRange* /*range*/, ARA::ContentUpdateScopes flags) noexcept
+void ARADocumentController::didAddMusicalContextToDocument (ARA::PlugIn::Document* document, ARA::PlugIn::MusicalContext* musicalContext) noexcept
 {
+    static_cast<ARAMusicalContext*> (musicalContext)->updateTempoMap();
+
+    notify_listeners (didAddMusicalContextToDocument, ARADocument*, document, static_cast<ARAMusicalContext*> (musicalContext));
+}
+
+void ARADocumentController::doUpdateMusicalContextContent (ARA::PlugIn::MusicalContext* musicalContext, const ARA::ARAContentTimeRange* range, ARA::ContentUpdateScopes flags) noexcept
+{
+    // rebuild the tempo map right away, so that any listener will see the new one
+    if (flags.affectTimeline())
+        static_cast<ARAMusicalContext*> (musicalContext)->updateTempoMap();
+
+    if (batchContentUpdate (static_cast<ARAMusicalContext*> (musicalContext), NotificationBatch::musicalContext, range, flags))
+        return;
+
     notify_listeners (doUpdateMusicalContextContent, ARAMusicalContext*, musicalContext, flags);
 }
 
 OVERRIDE_TO_NOTIFY_3 (willUpdateMusicalContextProperties, MusicalContext*, musicalContext, ARAMusicalContext::PropertiesPtr, newProperties)
-OVERRIDE_TO_NOTIFY_1 (didUpdateMusicalContextProperties, MusicalContext*, musicalContext)
+OVERRIDE_TO_NOTIFY_BATCHED (didUpdateMusicalContextProperties, MusicalContext*, musicalContext, musicalContext, propertiesUpdated)
 OVERRIDE_TO_NOTIFY_2 (didAddRegionSequenceToMusicalContext, MusicalContext*, musicalContext, RegionSequence*, regionSequence)
 OVERRIDE_TO_NOTIFY_2 (willRemoveRegionSequenceFromMusicalContext, MusicalContext*, musicalContext, RegionSequence*, regionSequence)
-OVERRIDE_TO_NOTIFY_1 (didReorderRegionSequencesInMusicalContext, MusicalContext*, musicalContext)
-OVERRIDE_TO_NOTIFY_1 (willDestroyMusicalContext, MusicalContext*, musicalContext)
+OVERRIDE_TO_NOTIFY_BATCHED (didReorderRegionSequencesInMusicalContext, MusicalContext*, musicalContext, musicalContext, regionSequencesReordered)
+OVERRIDE_TO_NOTIFY_DESTRUCTION (willDestroyMusicalContext, MusicalContext*, musicalContext)
 
 //==============================================================================
 
 ARA::PlugIn::RegionSequence* ARADocumentController::doCreateRegionSequence (ARA::PlugIn::Document* document, ARA::ARARegionSequenceHostRef hostRef) noexcept
 {
-    return new ARARegionSequence (static_cast<ARADocument*> (document), hostRef);
+    return new (getModelObjectPool()) ARARegionSequence (static_cast<ARADocument*> (document), hostRef);
 }
 
 OVERRIDE_TO_NOTIFY_3 (willUpdateRegionSequenceProperties, RegionSequence*, regionSequence, ARARegionSequence::PropertiesPtr, newProperties)
-OVERRIDE_TO_NOTIFY_1 (didUpdateRegionSequenceProperties, RegionSequence*, regionSequence)
+OVERRIDE_TO_NOTIFY_BATCHED (didUpdateRegionSequenceProperties, RegionSequence*, regionSequence, regionSequence, propertiesUpdated)
 OVERRIDE_TO_NOTIFY_2 (didAddPlaybackRegionToRegionSequence, RegionSequence*, regionSequence, PlaybackRegion*, playbackRegion)
 OVERRIDE_TO_NOTIFY_2 (willRemovePlaybackRegionFromRegionSequence, RegionSequence*, regionSequence, PlaybackRegion*, playbackRegion)
-OVERRIDE_TO_NOTIFY_1 (willDestroyRegionSequence, RegionSequence*, regionSequence)
+OVERRIDE_TO_NOTIFY_DESTRUCTION (willDestroyRegionSequence, RegionSequence*, regionSequence)
 
 //==============================================================================
 
 ARA::PlugIn::AudioSource* ARADocumentController::doCreateAudioSource (ARA::PlugIn::Document* document, ARA::ARAAudioSourceHostRef hostRef) noexcept
 {
-    ++activeAudioSourcesCount;
-    return new ARAAudioSource (static_cast<ARADocument*> (document), hostRef);
+    return new (getModelObjectPool()) ARAAudioSource (static_cast<ARADocument*> (document), hostRef);
 }
 
-void ARADocumentController::doUpdateAudioSourceContent (ARA::PlugIn::AudioSource* audioSource, const ARA::ARAContentTimeRange* /*range*/, ARA::ContentUpdateScopes flags) noexcept
+void ARADocumentController::doUpdateAudioSourceContent (ARA::PlugIn::AudioSource* audioSource, const ARA::ARAContentTimeRange* range, ARA::ContentUpdateScopes flags) noexcept
 {
-    notify_listeners (doUpdateAudioSourceContent, ARAAudioSource*, audioSource, flags);
+    if (batchContentUpdate (static_cast<ARAAudioSource*> (audioSource), NotificationBatch::audioSource, range, flags))
+        return;
+
+    if (range != nullptr)
+    {
+        const auto affectedTimeRange = Range<double>::withStartAndLength (range->start, range->duration);
+        notify_listeners (doUpdateAudioSourceContentInRange, ARAAudioSource*, audioSource, affectedTimeRange, flags);
+    }
+    else
+    {
+        notify_listeners (doUpdateAudioSourceContent, ARAAudioSource*, audioSource, flags);
+    }
 }
 
 OVERRIDE_TO_NOTIFY_3 (willUpdateAudioSourceProperties, AudioSource*, audioSource, ARAAudioSource::PropertiesPtr, newProperties)
-OVERRIDE_TO_NOTIFY_1 (didUpdateAudioSourceProperties, AudioSource*, audioSource)
+OVERRIDE_TO_NOTIFY_BATCHED (didUpdateAudioSourceProperties, AudioSource*, audioSource, audioSource, propertiesUpdated)
 OVERRIDE_TO_NOTIFY_3 (willEnableAudioSourceSamplesAccess, AudioSource*, audioSource, bool, enable)
 OVERRIDE_TO_NOTIFY_3 (didEnableAudioSourceSamplesAccess, AudioSource*, audioSource, bool, enable)
 OVERRIDE_TO_NOTIFY_2 (didAddAudioModificationToAudioSource, AudioSource*, audioSource, AudioModification*, audioModification)
 OVERRIDE_TO_NOTIFY_2 (willRemoveAudioModificationFromAudioSource, AudioSource*, audioSource, AudioModification*, audioModification)
 OVERRIDE_TO_NOTIFY_3 (willDeactivateAudioSourceForUndoHistory, AudioSource*, audioSource, bool, deactivate)
-
-void ARADocumentController::didDeactivateAudioSourceForUndoHistory (ARA::PlugIn::AudioSource* audioSource, bool deactivate) noexcept
-{
-    activeAudioSourcesCount += (deactivate ? -1 : 1);
-    notify_listeners (didDeactivateAudioSourceForUndoHistory, ARAAudioSource*, audioSource, deactivate);
-}
+OVERRIDE_TO_NOTIFY_3 (didDeactivateAudioSourceForUndoHistory, AudioSource*, audioSource, bool, deactivate)
 
 void ARADocumentController::willDestroyAudioSource (ARA::PlugIn::AudioSource* audioSource) noexcept
 {
-    if (! audioSource->isDeactivatedForUndoHistory())
-        --activeAudioSourcesCount;
+    discardBatchedNotifications (static_cast<ARAAudioSource*> (audioSource));
     notify_listeners (willDestroyAudioSource, ARAAudioSource*, audioSource);
+
+    // any analysis of the audio source has been cancelled by now, but it may still be queued
+    if (static_cast<ARAAudioSource*> (audioSource)->internalHasPendingProgress.load (std::memory_order_acquire))
+        deliverAnalysisProgress (static_cast<ARAAudioSource*> (audioSource));
 }
 //==============================================================================
 
 ARA::PlugIn::AudioModification* ARADocumentController::doCreateAudioModification (ARA::PlugIn::AudioSource* audioSource, ARA::ARAAudioModificationHostRef hostRef, const ARA::PlugIn::AudioModification* optionalModificationToClone) noexcept
 {
-    return new ARAAudioModification (static_cast<ARAAudioSource*> (audioSource), hostRef, static_cast<const ARAAudioModification*> (optionalModificationToClone));
+    return new (getModelObjectPool()) ARAAudioModification (static_cast<ARAAudioSource*> (audioSource), hostRef, static_cast<const ARAAudioModification*> (optionalModificationToClone));
 }
 
 OVERRIDE_TO_NOTIFY_3 (willUpdateAudioModificationProperties, AudioModification*, audioModification, ARAAudioModification::PropertiesPtr, newProperties)
-OVERRIDE_TO_NOTIFY_1 (didUpdateAudioModificationProperties, AudioModification*, audioModification)
+OVERRIDE_TO_NOTIFY_BATCHED (didUpdateAudioModificationProperties, AudioModification*, audioModification, audioModification, propertiesUpdated)
 OVERRIDE_TO_NOTIFY_2 (didAddPlaybackRegionToAudioModification, AudioModification*, audioModification, PlaybackRegion*, playbackRegion)
 OVERRIDE_TO_NOTIFY_2 (willRemovePlaybackRegionFromAudioModification, AudioModification*, audioModification, PlaybackRegion*, playbackRegion)
 OVERRIDE_TO_NOTIFY_3 (willDeactivateAudioModificationForUndoHistory, AudioModification*, audioModification, bool, deactivate)
 OVERRIDE_TO_NOTIFY_3 (didDeactivateAudioModificationForUndoHistory, AudioModification*, audioModification, bool, deactivate)
-OVERRIDE_TO_NOTIFY_1 (willDestroyAudioModification, AudioModification*, audioModification)
+OVERRIDE_TO_NOTIFY_DESTRUCTION (willDestroyAudioModification, AudioModification*, audioModification)
 
 //==============================================================================
 
 ARA::PlugIn::PlaybackRegion* ARADocumentController::doCreatePlaybackRegion (ARA::PlugIn::AudioModification* modification, ARA::ARAPlaybackRegionHostRef hostRef) noexcept
 {
-    return new ARAPlaybackRegion (static_cast<ARAAudioModification*> (modification), hostRef);
+    return new (getModelObjectPool()) ARAPlaybackRegion (static_cast<ARAAudioModification*> (modification), hostRef);
 }
 
 OVERRIDE_TO_NOTIFY_3 (willUpdatePlaybackRegionProperties, PlaybackRegion*, playbackRegion, ARAPlaybackRegion::PropertiesPtr, newProperties)
-OVERRIDE_TO_NOTIFY_1 (didUpdatePlaybackRegionProperties, PlaybackRegion*, playbackRegion)
-OVERRIDE_TO_NOTIFY_1 (willDestroyPlaybackRegion, PlaybackRegion*, playbackRegion)
+OVERRIDE_TO_NOTIFY_BATCHED (didUpdatePlaybackRegionProperties, PlaybackRegion*, playbackRegion, playbackRegion, propertiesUpdated)
+OVERRIDE_TO_NOTIFY_DESTRUCTION (willDestroyPlaybackRegion, PlaybackRegion*, playbackRegion)
 
 //==============================================================================
 
@@ -264,6 +540,13 @@ void ARADocumentController::internalNotifyAudioSourceContentChanged (ARAAudioSou
     notify_listeners (doUpdateAudioSourceContent, ARAAudioSource*, audioSource, scopeFlags);
 }
 
+void ARADocumentController::internalNotifyAudioSourceContentChanged (ARAAudioSource* audioSource, Range<double> affectedTimeRange, ARAContentUpdateScopes scopeFlags, bool notifyARAHost)
+{
+    if (notifyARAHost)
+        DocumentController::notifyAudioSourceContentChanged (audioSource, scopeFlags);
+    notify_listeners (doUpdateAudioSourceContentInRange, ARAAudioSource*, audioSource, affectedTimeRange, scopeFlags);
+}
+
 void ARADocumentController::internalNotifyAudioModificationContentChanged (ARAAudioModification* audioModification, ARAContentUpdateScopes scopeFlags, bool notifyARAHost)
 {
     if (notifyARAHost)
@@ -278,6 +561,13 @@ void ARADocumentController::internalNotifyPlaybackRegionContentChanged (ARAPlayb
     notify_listeners (didUpdatePlaybackRegionContent, ARAPlaybackRegion*, playbackRegion, scopeFlags);
 }
 
+void ARADocumentController::internalNotifyPlaybackRegionContentChanged (ARAPlaybackRegion* playbackRegion, Range<double> affectedTimeRange, ARAContentUpdateScopes scopeFlags, bool notifyARAHost)
+{
+    if (notifyARAHost)
+        DocumentController::notifyPlaybackRegionContentChanged (playbackRegion, scopeFlags);
+    notify_listeners (didUpdatePlaybackRegionContentInRange, ARAPlaybackRegion*, playbackRegion, affectedTimeRange, scopeFlags);
+}
+
 //==============================================================================
 
 JUCE_END_IGNORE_WARNINGS_GCC_LIKE
@@ -286,6 +576,9 @@ JUCE_END_IGNORE_WARNINGS_GCC_LIKE
 #undef OVERRIDE_TO_NOTIFY_1
 #undef OVERRIDE_TO_NOTIFY_2
 #undef OVERRIDE_TO_NOTIFY_3
+#undef OVERRIDE_TO_NOTIFY_BATCHED
+#undef OVERRIDE_TO_NOTIFY_DESTRUCTION
+#undef deliver_batched_notification
 
 //==============================================================================
 
@@ -299,9 +592,73 @@ ARA::PlugIn::EditorView* ARADocumentController::doCreateEditorView() noexcept
     return new ARAEditorView (this);
 }
 
+ARAAudioSourceBlockCache* ARADocumentController::doCreateAudioSourceBlockCache() noexcept
+{
+    return new ARAAudioSourceBlockCache();
+}
+
+ARAAudioSourceBlockCache& ARADocumentController::getAudioSourceBlockCache()
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    if (audioSourceBlockCache == nullptr)
+        audioSourceBlockCache.reset (doCreateAudioSourceBlockCache());
+
+    return *audioSourceBlockCache;
+}
+
+ARAAnalysisScheduler* ARADocumentController::doCreateAnalysisScheduler() noexcept
+{
+    return new ARAAnalysisScheduler();
+}
+
+ARAAnalysisScheduler& ARADocumentController::getAnalysisScheduler()
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    if (analysisScheduler == nullptr)
+        analysisScheduler.reset (doCreateAnalysisScheduler());
+
+    return *analysisScheduler;
+}
+
+ARAAnalysisCache* ARADocumentController::doCreateAnalysisCache() noexcept
+{
+    return new ARAAnalysisCache (File::getSpecialLocation (File::userApplicationDataDirectory)
+                                    .getChildFile (JucePlugin_Manufacturer)
+                                    .getChildFile (JucePlugin_Name)
+                                    .getChildFile ("ARA Analysis Cache"));
+}
+
+ARAAnalysisCache& ARADocumentController::getAnalysisCache()
+{
+    // unlike the other lazily created helpers, the cache may be accessed from analysis threads
+    const ScopedLock sl (analysisCacheLock);
+
+    if (analysisCache == nullptr)
+        analysisCache.reset (doCreateAnalysisCache());
+
+    return *analysisCache;
+}
+
+ARAWaveformOverviewManager* ARADocumentController::doCreateWaveformOverviewManager() noexcept
+{
+    return new ARAWaveformOverviewManager();
+}
+
+ARAWaveformOverviewManager& ARADocumentController::getWaveformOverviewManager()
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    if (waveformOverviewManager == nullptr)
+        waveformOverviewManager.reset (doCreateWaveformOverviewManager());
+
+    return *waveformOverviewManager;
+}
+
 //==============================================================================
 
-// helper code for ARADocumentController::timerCallback() to rewire the host-related ARA SDK's progress tracker to our internal update mechanism
+// helper code for ARADocumentController::deliverAnalysisProgress() to rewire the host-related ARA SDK's progress tracker to our internal update mechanism
 namespace ModelUpdateControllerProgressAdapter
 {
     using namespace ARA;
@@ -350,31 +707,278 @@ namespace ModelUpdateControllerProgressAdapter
     }
 }
 
-void ARADocumentController::timerCallback()
+void ARADocumentController::setAnalysisProgressCoalescingInterval (int milliseconds)
 {
-    if (! internalAnalysisProgressIsSynced.test_and_set (std::memory_order_release))
-        for (auto& audioSource : getDocument()->getAudioSources())
+    JUCE_ASSERT_MESSAGE_THREAD
+    analysisProgressCoalescingInterval = jmax (0, milliseconds);
+}
+
+void ARADocumentController::queueAnalysisProgress (ARAAudioSource* audioSource)
+{
+    // each audio source is queued only once until its progress has been delivered
+    if (audioSource->internalHasPendingProgress.exchange (true, std::memory_order_acq_rel))
+        return;
+
+    auto* head = audioSourcesWithPendingProgress.load (std::memory_order_relaxed);
+    do
+    {
+        audioSource->internalNextAudioSourceWithPendingProgress.store (head, std::memory_order_relaxed);
+    }
+    while (! audioSourcesWithPendingProgress.compare_exchange_weak (head, audioSource, std::memory_order_release, std::memory_order_relaxed));
+
+    // only the first audio source queued after a delivery needs to wake up the message thread
+    if (head == nullptr)
+        triggerAsyncUpdate();
+}
+
+void ARADocumentController::deliverAnalysisProgress (const ARAAudioSource* audioSourceToSkip)
+{
+    lastAnalysisProgressDeliveryTime = Time::getMillisecondCounter();
+
+    // take the entire queue at once and reverse it, so that sources are visited in the order they were queued
+    ARAAudioSource* audioSources = nullptr;
+    for (auto* audioSource = audioSourcesWithPendingProgress.exchange (nullptr, std::memory_order_acquire); audioSource != nullptr;)
+    {
+        auto* next = audioSource->internalNextAudioSourceWithPendingProgress.load (std::memory_order_relaxed);
+        audioSource->internalNextAudioSourceWithPendingProgress.store (audioSources, std::memory_order_relaxed);
+        audioSources = audioSource;
+        audioSource = next;
+    }
+
+    while (audioSources != nullptr)
+    {
+        auto* audioSource = audioSources;
+        audioSources = audioSource->internalNextAudioSourceWithPendingProgress.load (std::memory_order_relaxed);
+
+        // clearing the flag before reading the progress ensures that no concurrent update is lost,
+        // at worst the source is queued again and its latest progress is delivered twice
+        audioSource->internalHasPendingProgress.store (false, std::memory_order_release);
+
+        if (audioSource != audioSourceToSkip)
             audioSource->internalAnalysisProgressTracker.notifyProgress (ModelUpdateControllerProgressAdapter::get(), reinterpret_cast<ARA::ARAAudioSourceHostRef> (audioSource));
+    }
+}
+
+void ARADocumentController::handleAsyncUpdate()
+{
+    const auto elapsed = (int) (Time::getMillisecondCounter() - lastAnalysisProgressDeliveryTime);
+
+    // coalesce any further updates until the interval has passed
+    if (elapsed < analysisProgressCoalescingInterval)
+        startTimer (analysisProgressCoalescingInterval - elapsed);
+    else
+        deliverAnalysisProgress();
+}
+
+void ARADocumentController::timerCallback()
+{
+    stopTimer();
+    deliverAnalysisProgress();
+}
+
+//==============================================================================
+
+namespace ARAArchiveHelpers
+{
+    // frame header: magic, flags, original size, stored size
+    static constexpr int frameMagic = 0x46415241;  // "ARAF"
+    static constexpr int64 frameHeaderSize = 2 * sizeof (int32) + 2 * sizeof (int64);
+
+    enum FrameFlags
+    {
+        frameIsUncompressed = 0,
+        frameIsCompressed = 1
+    };
+
+    // zlib can't compress by more than about 1:1032, which allows for rejecting corrupted sizes early
+    static constexpr int64 maxCompressionRatio = 1032;
+
+    // spawning threads only pays off if there's a reasonable amount of work for each of them
+    static constexpr size_t minNumTasksPerThread = 64;
+
+    struct StoredFrame
+    {
+        int flags { frameIsUncompressed };
+        int64 originalSize { 0 };
+        MemoryBlock data;
+    };
+
+    static bool encodeFrame (const void* data, size_t numBytes, bool compress, OutputStream& dest)
+    {
+        MemoryOutputStream compressedData;
+
+        if (compress)
+        {
+            GZIPCompressorOutputStream compressor (compressedData);
+            compressor.write (data, numBytes);
+            compressor.flush();
+        }
+
+        // fall back to storing the data if it can't be compressed
+        const auto isCompressed = compress && compressedData.getDataSize() < numBytes;
+
+        return dest.writeInt (frameMagic)
+            && dest.writeInt (isCompressed ? frameIsCompressed : frameIsUncompressed)
+            && dest.writeInt64 ((int64) numBytes)
+            && dest.writeInt64 ((int64) (isCompressed ? compressedData.getDataSize() : numBytes))
+            && (isCompressed ? dest.write (compressedData.getData(), compressedData.getDataSize())
+                             : dest.write (data, numBytes));
+    }
+
+    static bool readFrame (InputStream& input, StoredFrame& frame)
+    {
+        if (input.getNumBytesRemaining() < frameHeaderSize || input.readInt() != frameMagic)
+            return false;
+
+        frame.flags = input.readInt();
+        frame.originalSize = input.readInt64();
+        const auto storedSize = input.readInt64();
+
+        if (storedSize < 0 || storedSize > input.getNumBytesRemaining()
+            || frame.originalSize < 0 || frame.originalSize > std::numeric_limits<int>::max())
+            return false;
+
+        if (frame.flags == frameIsUncompressed ? (frame.originalSize != storedSize)
+                                               : (frame.flags != frameIsCompressed || frame.originalSize > storedSize * maxCompressionRatio))
+            return false;
+
+        frame.data.setSize ((size_t) storedSize);
+        return input.read (frame.data.getData(), (int) storedSize) == (int) storedSize;
+    }
+
+    static bool decodeFrame (StoredFrame& frame, MemoryBlock& destData)
+    {
+        if (frame.flags == frameIsUncompressed)
+        {
+            destData.swapWith (frame.data);
+            return true;
+        }
+
+        MemoryInputStream compressedData (frame.data, false);
+        GZIPDecompressorInputStream decompressor (compressedData);
+
+        destData.setSize ((size_t) frame.originalSize);
+        return decompressor.read (destData.getData(), (int) frame.originalSize) == (int) frame.originalSize;
+    }
+
+    // Runs the given task for each index, distributing them across a number of worker threads
+    // and the calling thread. Returns false as soon as any of the tasks has failed.
+    static bool runInParallel (size_t numTasks, const std::function<bool (size_t)>& task)
+    {
+        std::atomic<size_t> nextTask { 0 };
+        std::atomic<bool> succeeded { true };
+
+        const auto runTasks = [&]
+        {
+            for (auto i = nextTask++; i < numTasks && succeeded.load(); i = nextTask++)
+                if (! task (i))
+                    succeeded = false;
+        };
+
+        const auto numWorkerThreads = jmin (SystemStats::getNumCpus() - 1, (int) (numTasks / minNumTasksPerThread));
+
+        if (numWorkerThreads <= 0)
+        {
+            runTasks();
+            return succeeded.load();
+        }
+
+        ThreadPool threadPool (numWorkerThreads);
+
+        for (int i = 0; i < numWorkerThreads; ++i)
+            threadPool.addJob (runTasks);
+
+        runTasks();
+
+        // any job that hasn't started yet is obsolete at this point, the others must be waited for
+        threadPool.removeAllJobs (false, -1);
+
+        return succeeded.load();
+    }
+
+    // Forwards progress notifications to the host in reasonably sized steps only.
+    struct ProgressReporter
+    {
+        explicit ProgressReporter (const std::function<void (float)>& callbackToUse)
+            : callback (callbackToUse)
+        {
+            report (0.0f);
+        }
+
+        void report (float progress)
+        {
+            if (callback != nullptr && (progress >= lastProgress + 0.01f || progress >= 1.0f))
+            {
+                callback (progress);
+                lastProgress = progress;
+            }
+        }
+
+        const std::function<void (float)>& callback;
+        float lastProgress { -1.0f };
+    };
 }
 
 //==============================================================================
 
-ARAInputStream::ARAInputStream (ARA::PlugIn::HostArchiveReader* reader)
+ARAInputStream::ARAInputStream (ARA::PlugIn::HostArchiveReader* reader, int bufferSizeToUse)
 : archiveReader (reader), 
-  size ((int64) reader->getArchiveSize())
+  size ((int64) reader->getArchiveSize()),
+  buffer ((size_t) jmax (1, bufferSizeToUse)),
+  bufferSize (jmax (1, bufferSizeToUse))
 {}
 
+bool ARAInputStream::readFromArchive (int64 archivePosition, int64 numBytes, void* dest)
+{
+    if (! archiveReader->readBytesFromArchive ((ARA::ARASize) archivePosition, (ARA::ARASize) numBytes, (ARA::ARAByte*) dest))
+    {
+        failure = true;
+        return false;
+    }
+
+    return true;
+}
+
 int ARAInputStream::read (void* destBuffer, int maxBytesToRead)
 {
     const auto bytesToRead = jmin ((int64) maxBytesToRead, size - position);
-    if (! archiveReader->readBytesFromArchive ((ARA::ARASize) position, (ARA::ARASize) bytesToRead, (ARA::ARAByte*) destBuffer))
+    auto* dest = static_cast<char*> (destBuffer);
+    auto numBytesLeft = bytesToRead;
+
+    while (numBytesLeft > 0)
     {
-        failure = true;
-        return 0;
+        if (position >= bufferStart && position < bufferStart + numBufferedBytes)
+        {
+            const auto numBytes = jmin (numBytesLeft, bufferStart + numBufferedBytes - position);
+            memcpy (dest, buffer + (position - bufferStart), (size_t) numBytes);
+
+            dest += numBytes;
+            position += numBytes;
+            numBytesLeft -= numBytes;
+        }
+        else if (numBytesLeft >= bufferSize)
+        {
+            // large reads bypass the buffer
+            if (! readFromArchive (position, numBytesLeft, dest))
+                break;
+
+            position += numBytesLeft;
+            numBytesLeft = 0;
+        }
+        else
+        {
+            const auto numBytes = jmin ((int64) bufferSize, size - position);
+            numBufferedBytes = 0;
+
+            if (! readFromArchive (position, numBytes, buffer))
+                break;
+
+            bufferStart = position;
+            numBufferedBytes = numBytes;
+        }
     }
 
-    position += bytesToRead;
-    return (int) bytesToRead;
+    return (int) (bytesToRead - numBytesLeft);
 }
 
 bool ARAInputStream::setPosition (int64 newPosition)
@@ -390,16 +994,115 @@ bool ARAInputStream::isExhausted()
     return position >= size;
 }
 
-ARAOutputStream::ARAOutputStream (ARA::PlugIn::HostArchiveWriter* writer)
-: archiveWriter (writer)
+bool ARAInputStream::readFrame (MemoryBlock& destData)
+{
+    ARAArchiveHelpers::StoredFrame frame;
+
+    if (! ARAArchiveHelpers::readFrame (*this, frame) || ! ARAArchiveHelpers::decodeFrame (frame, destData))
+    {
+        failure = true;
+        return false;
+    }
+
+    return true;
+}
+
+bool ARAInputStream::readFramesInParallel (const std::function<bool (size_t, InputStream&)>& readFrameData,
+                                           const std::function<void (float)>& progressCallback)
+{
+    ARAArchiveHelpers::ProgressReporter progress (progressCallback);
+
+    const auto numFrames = readInt64();
+    if (numFrames < 0 || numFrames > getNumBytesRemaining() / ARAArchiveHelpers::frameHeaderSize)
+    {
+        failure = true;
+        return false;
+    }
+
+    // reading from the host happens on this thread, only the decoding is distributed
+    std::vector<ARAArchiveHelpers::StoredFrame> frames ((size_t) numFrames);
+
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        if (! ARAArchiveHelpers::readFrame (*this, frames[i]))
+        {
+            failure = true;
+            return false;
+        }
+
+        progress.report (0.5f * (float) i / (float) frames.size());
+    }
+
+    const auto succeeded = ARAArchiveHelpers::runInParallel (frames.size(), [&] (size_t i)
+    {
+        MemoryBlock frameData;
+        if (! ARAArchiveHelpers::decodeFrame (frames[i], frameData))
+            return false;
+
+        frames[i].data.reset();
+
+        MemoryInputStream frameDataStream (frameData, false);
+        return readFrameData (i, frameDataStream);
+    });
+
+    progress.report (1.0f);
+
+    return succeeded;
+}
+
+//==============================================================================
+
+ARAOutputStream::ARAOutputStream (ARA::PlugIn::HostArchiveWriter* writer, int bufferSizeToUse)
+: archiveWriter (writer),
+  buffer ((size_t) jmax (1, bufferSizeToUse)),
+  bufferSize (jmax (1, bufferSizeToUse))
 {}
 
+ARAOutputStream::~ARAOutputStream()
+{
+    // any failure here goes unnoticed - call flush() and check failed() before the stream is destroyed
+    flush();
+}
+
+bool ARAOutputStream::writeToArchive (const void* data, size_t numBytes)
+{
+    if (failure)
+        return false;
+
+    if (! archiveWriter->writeBytesToArchive ((ARA::ARASize) bufferStart, numBytes, (const ARA::ARAByte*) data))
+    {
+        failure = true;
+        return false;
+    }
+
+    bufferStart += (int64) numBytes;
+    return true;
+}
+
+void ARAOutputStream::flush()
+{
+    if (numBufferedBytes > 0)
+    {
+        const auto numBytes = (size_t) numBufferedBytes;
+        numBufferedBytes = 0;
+        writeToArchive (buffer, numBytes);
+    }
+}
+
 bool ARAOutputStream::write (const void* dataToWrite, size_t numberOfBytes)
 {
-    if (! archiveWriter->writeBytesToArchive ((ARA::ARASize) position, numberOfBytes, (const ARA::ARAByte*) dataToWrite))
+    if (numBufferedBytes + (int64) numberOfBytes > bufferSize)
+        flush();
+
+    if (failure)
         return false;
 
-    position += numberOfBytes;
+    // large writes bypass the buffer
+    if (numberOfBytes >= (size_t) bufferSize)
+        return writeToArchive (dataToWrite, numberOfBytes);
+
+    memcpy (buffer + numBufferedBytes, dataToWrite, numberOfBytes);
+    numBufferedBytes += (int64) numberOfBytes;
     return true;
 }
 
@@ -407,7 +1110,51 @@ bool ARAOutputStream::setPosition (int64 newPosition)
 {
     if (newPosition > (int64) std::numeric_limits<size_t>::max())
         return false;
-    position = newPosition;
+
+    flush();
+    bufferStart = newPosition;
+    return true;
+}
+
+bool ARAOutputStream::writeFrame (const void* data, size_t numBytes, bool compress)
+{
+    return ARAArchiveHelpers::encodeFrame (data, numBytes, compress, *this);
+}
+
+bool ARAOutputStream::writeFramesInParallel (size_t numFrames,
+                                             const std::function<bool (size_t, OutputStream&)>& writeFrameData,
+                                             bool compress,
+                                             const std::function<void (float)>& progressCallback)
+{
+    ARAArchiveHelpers::ProgressReporter progress (progressCallback);
+
+    std::vector<MemoryBlock> encodedFrames (numFrames);
+
+    const auto succeeded = ARAArchiveHelpers::runInParallel (numFrames, [&] (size_t i)
+    {
+        MemoryOutputStream frameData;
+        if (! writeFrameData (i, frameData))
+            return false;
+
+        MemoryOutputStream encodedFrame (encodedFrames[i], false);
+        return ARAArchiveHelpers::encodeFrame (frameData.getData(), frameData.getDataSize(), compress, encodedFrame);
+    });
+
+    if (! succeeded || ! writeInt64 ((int64) numFrames))
+        return false;
+
+    // writing to the host happens on this thread, in order of the frames
+    for (size_t i = 0; i < numFrames; ++i)
+    {
+        if (! write (encodedFrames[i].getData(), encodedFrames[i].getSize()))
+            return false;
+
+        encodedFrames[i].reset();
+        progress.report (0.5f + 0.5f * (float) i / (float) numFrames);
+    }
+
+    progress.report (1.0f);
+
     return true;
 }
 
@@ -10,6 +10,10 @@ class ARAEditorRenderer;
 class ARAEditorView;
 class ARAInputStream;
 class ARAOutputStream;
+class ARAAudioSourceBlockCache;
+class ARAAnalysisScheduler;
+class ARAAnalysisCache;
+class ARAWaveformOverviewManager;
 
 //==============================================================================
 /**
@@ -34,6 +38,7 @@ class JUCE_API  ARADocumentController     : public ARA::PlugIn::DocumentControll
                                             private ARAAudioSource::Listener,
                                             private ARAAudioModification::Listener,
                                             private ARAPlaybackRegion::Listener,
+                                            private juce::AsyncUpdater,
                                             private juce::Timer
 {
 private:
@@ -79,6 +84,7 @@ public:
     }
 
     using ARA::PlugIn::DocumentController::DocumentController;
+    ~ARADocumentController() override;
 
     // overloading inherited templated getters to default to juce versions of the returned classes
     template <typename Document_t = ARADocument>
@@ -90,6 +96,111 @@ public:
     template <typename EditorView_t = ARAEditorView>
     std::vector<EditorView_t*> const& getEditorViews () const noexcept { return ARA::PlugIn::DocumentController::getEditorViews<EditorView_t>(); }
 
+    /** Returns the document-wide cache of audio source samples that is shared by all
+        ARAAudioSourceReader instances that use block caching.
+        The cache is created upon first use via doCreateAudioSourceBlockCache() (message thread only).
+    */
+    ARAAudioSourceBlockCache& getAudioSourceBlockCache();
+
+    /** Returns the scheduler that runs audio source analysis jobs for this document.
+        The scheduler is created upon first use via doCreateAnalysisScheduler() (message thread only).
+    */
+    ARAAnalysisScheduler& getAnalysisScheduler();
+
+    /** Returns the persistent cache for analysis results, which allows for skipping the analysis of
+        unchanged audio sources when restoring documents.
+        The cache is created upon first use via doCreateAnalysisCache().
+    */
+    ARAAnalysisCache& getAnalysisCache();
+
+    /** Returns the manager of the waveform overviews of the audio sources in this document.
+        The manager is created upon first use via doCreateWaveformOverviewManager() (message thread only).
+    */
+    ARAWaveformOverviewManager& getWaveformOverviewManager();
+
+    //==============================================================================
+    /** Enables batching of listener notifications during host edit cycles (message thread only).
+
+        When enabled, the following notifications are recorded while the host is editing the
+        document, and delivered only once per object when the edit cycle ends, right before
+        ARADocument::Listener::didEndEditing():
+            - the didUpdate...Properties() notifications of all model objects
+            - content updates of musical contexts and audio sources, with their scopes and
+              time ranges merged
+            - the didReorder...() notifications of documents and musical contexts
+
+        This avoids redundant work in listeners when the host edits many objects at once, and
+        matches ARA's notion of model changes becoming effective when the edit cycle ends.
+        All other notifications, most notably the will...() notifications and those about
+        objects being added, removed or destroyed, are still delivered immediately.
+        Any batched notifications of an object are discarded if it is destroyed before the
+        edit cycle ends.
+
+        Disabled by default. Disabling it during an edit cycle delivers all pending notifications.
+    */
+    void setBatchedListenerNotificationsEnabled (bool shouldBeEnabled);
+
+    /** Returns true if batching of listener notifications is enabled, see setBatchedListenerNotificationsEnabled(). */
+    bool areBatchedListenerNotificationsEnabled() const noexcept { return notificationBatch != nullptr; }
+
+    /** Statistics about the effect of batching listener notifications. */
+    struct BatchedNotificationStats
+    {
+        /** The number of notifications that were recorded during edit cycles. */
+        int64 numNotificationsReceived = 0;
+        /** The number of notifications that were delivered at the end of edit cycles. */
+        int64 numNotificationsDelivered = 0;
+
+        /** Returns the number of notifications that were collapsed into others. */
+        int64 getNumNotificationsCollapsed() const noexcept { return numNotificationsReceived - numNotificationsDelivered; }
+    };
+
+    /** Returns the statistics about batched notifications since batching was enabled or the statistics were reset. */
+    const BatchedNotificationStats& getBatchedNotificationStats() const noexcept { return batchedNotificationStats; }
+
+    /** Resets the statistics about batched notifications. */
+    void resetBatchedNotificationStats() noexcept { batchedNotificationStats = {}; }
+
+    //==============================================================================
+    /** Sets the minimum interval between two deliveries of analysis progress to the
+        ARAAudioSource::Listener::didUpdateAudioSourceAnalyisProgress() callbacks (message thread only).
+
+        Progress reported by analysis threads is recorded in a lock-free queue that holds each
+        audio source at most once, and the message thread only visits the audio sources in
+        that queue. Any updates reported within the interval are coalesced, so that listeners
+        see at most one update per audio source and interval.
+        An interval of 0 delivers the progress as soon as the message thread gets to it.
+
+        The default interval is 50 milliseconds.
+    */
+    void setAnalysisProgressCoalescingInterval (int milliseconds);
+
+    /** Returns the interval set via setAnalysisProgressCoalescingInterval(). */
+    int getAnalysisProgressCoalescingInterval() const noexcept { return analysisProgressCoalescingInterval; }
+
+    //==============================================================================
+    /** Enables allocating the model objects of the document from an ARAModelObjectPool (message thread only).
+
+        This speeds up creating and destroying large documents and avoids fragmenting the heap, at the
+        expense of keeping the memory of destroyed objects reserved for new objects until the document
+        controller is destroyed.
+        It only affects objects created after the call, so it is typically called from the constructor
+        of the document controller subclass. Objects that have been allocated from the pool keep it
+        alive, so pooling can be disabled at any time.
+
+        The default doCreate...() implementations allocate from the pool when it is enabled, overrides
+        that create custom subclasses should do so as well:
+        @code
+        return new (getModelObjectPool()) MyAudioSource (static_cast<ARADocument*> (document), hostRef);
+        @endcode
+
+        Disabled by default.
+    */
+    void setModelObjectPoolEnabled (bool shouldBeEnabled);
+
+    /** Returns the pool that model objects should be allocated from, or nullptr if pooling is disabled. */
+    ARAModelObjectPool* getModelObjectPool() const noexcept { return modelObjectPool.get(); }
+
 protected:
     //==============================================================================
     // Override document controller methods here
@@ -125,6 +236,21 @@ protected:
     ARA::PlugIn::EditorRenderer* doCreateEditorRenderer() noexcept override;
     ARA::PlugIn::EditorView* doCreateEditorView() noexcept override;
 
+    /** Override to configure the document-wide audio source block cache, e.g. its block size or memory limit. */
+    virtual ARAAudioSourceBlockCache* doCreateAudioSourceBlockCache() noexcept;
+
+    /** Override to configure the analysis scheduler, e.g. the number of worker threads. */
+    virtual ARAAnalysisScheduler* doCreateAnalysisScheduler() noexcept;
+
+    /** Override to customise the analysis cache, e.g. its location.
+        By default, the cache is located in the user application data directory, in a subfolder named
+        after the plug-in manufacturer and name.
+    */
+    virtual ARAAnalysisCache* doCreateAnalysisCache() noexcept;
+
+    /** Override to configure the waveform overview manager, e.g. the resolution of the overviews. */
+    virtual ARAWaveformOverviewManager* doCreateWaveformOverviewManager() noexcept;
+
     // ARADocument::Listener callbacks
     using ARADocument::Listener::willBeginEditing;
     using ARADocument::Listener::didEndEditing;
@@ -162,6 +288,7 @@ protected:
     using ARAAudioSource::Listener::willUpdateAudioSourceProperties;
     using ARAAudioSource::Listener::didUpdateAudioSourceProperties;
     using ARAAudioSource::Listener::doUpdateAudioSourceContent;
+    using ARAAudioSource::Listener::doUpdateAudioSourceContentInRange;
     using ARAAudioSource::Listener::willEnableAudioSourceSamplesAccess;
     using ARAAudioSource::Listener::didEnableAudioSourceSamplesAccess;
     using ARAAudioSource::Listener::didAddAudioModificationToAudioSource;
@@ -275,7 +402,8 @@ protected:
     void willDestroyPlaybackRegion (ARA::PlugIn::PlaybackRegion* playbackRegion) noexcept override;
 
     //==============================================================================
-    // juce::Timer overrides
+    // juce::AsyncUpdater and juce::Timer overrides
+    void handleAsyncUpdate() override;
     void timerCallback() override;
 
 public:
@@ -289,23 +417,51 @@ public:
     void internalNotifyAudioSourceAnalysisProgressCompleted (ARAAudioSource* audioSource);
     /** @internal */
     void internalDidUpdateAudioSourceAnalysisProgress (ARAAudioSource* audioSource, ARAAudioSource::ARAAnalysisProgressState state, float progress);
+    /** @internal */
+    void internalDidUpdateEditorViewSelection (const ARAViewSelection& viewSelection);
 
     //==============================================================================
     /** @internal */
     void internalNotifyAudioSourceContentChanged (ARAAudioSource* audioSource, ARAContentUpdateScopes scopeFlags, bool notifyARAHost);
     /** @internal */
+    void internalNotifyAudioSourceContentChanged (ARAAudioSource* audioSource, Range<double> affectedTimeRange, ARAContentUpdateScopes scopeFlags, bool notifyARAHost);
+    /** @internal */
     void internalNotifyAudioModificationContentChanged (ARAAudioModification* audioModification, ARAContentUpdateScopes scopeFlags, bool notifyARAHost);
     /** @internal */
     void internalNotifyPlaybackRegionContentChanged (ARAPlaybackRegion* playbackRegion, ARAContentUpdateScopes scopeFlags, bool notifyARAHost);
+    /** @internal */
+    void internalNotifyPlaybackRegionContentChanged (ARAPlaybackRegion* playbackRegion, Range<double> affectedTimeRange, ARAContentUpdateScopes scopeFlags, bool notifyARAHost);
 
 #endif
 
 private:
-    std::atomic_flag internalAnalysisProgressIsSynced { true };
+    struct NotificationBatch;
+
+    bool batchNotification (void* modelObject, int objectType, int change);
+    bool batchContentUpdate (void* modelObject, int objectType, const ARA::ARAContentTimeRange* range, ARAContentUpdateScopes scopeFlags);
+    void discardBatchedNotifications (const void* modelObject);
+    void deliverBatchedNotifications();
+
+    void queueAnalysisProgress (ARAAudioSource* audioSource);
+    void deliverAnalysisProgress (const ARAAudioSource* audioSourceToSkip = nullptr);
+
+    std::atomic<ARAAudioSource*> audioSourcesWithPendingProgress { nullptr };
+    int analysisProgressCoalescingInterval { 50 };
+    uint32 lastAnalysisProgressDeliveryTime { 0 };
 
     ScopedJuceInitialiser_GUI libraryInitialiser;
 
-    int activeAudioSourcesCount { 0 };
+    std::unique_ptr<ARAAudioSourceBlockCache> audioSourceBlockCache;
+    std::unique_ptr<ARAAnalysisScheduler> analysisScheduler;
+    std::unique_ptr<ARAAnalysisCache> analysisCache;
+    CriticalSection analysisCacheLock;
+    std::unique_ptr<ARAWaveformOverviewManager> waveformOverviewManager;
+
+    std::unique_ptr<NotificationBatch> notificationBatch;
+    BatchedNotificationStats batchedNotificationStats;
+    bool isEditingDocument { false };
+
+    ARAModelObjectPool::Ptr modelObjectPool;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ARADocumentController)
 };
@@ -314,13 +470,20 @@ private:
 //==============================================================================
 /**
     Used to read persisted ARA archives - see doRestoreObjectsFromStream() for details. 
-    
+
+    The stream reads from the host in large chunks, so reading many small values such as
+    via readInt() or readString() does not cause a call into the host for each value.
+
+    Archives that were written as a sequence of frames via ARAOutputStream::writeFrame()
+    or ARAOutputStream::writeFramesInParallel() must be read through readFrame() or
+    readFramesInParallel() respectively.
+
     @tags{ARA}
 */
 class ARAInputStream  : public InputStream
 {
 public:
-    ARAInputStream (ARA::PlugIn::HostArchiveReader*);
+    ARAInputStream (ARA::PlugIn::HostArchiveReader*, int bufferSize = defaultBufferSize);
 
     int64 getPosition() override { return position; }
     int64 getTotalLength() override { return size; }
@@ -331,11 +494,38 @@ public:
 
     bool failed() const { return failure; }
 
+    /** Reads a single frame written by ARAOutputStream::writeFrame(), decompressing it if needed.
+        @returns true on success, in which case \p destData holds the data of the frame.
+    */
+    bool readFrame (MemoryBlock& destData);
+
+    /** Reads a sequence of frames written by ARAOutputStream::writeFramesInParallel().
+
+        The frames are read from the host on the calling thread, then decompressed and passed to
+        \p readFrameData concurrently on a number of worker threads (and the calling thread).
+        The callback thus must not modify the ARA model graph, but should decode the data into
+        some plug-in owned storage which is then applied to the model once this returns.
+        @param readFrameData     Called with the index and the data of each frame, returning false on failure.
+        @param progressCallback  Optionally called on the calling thread with the progress of the operation.
+        @returns true if all frames were read and decoded successfully.
+    */
+    bool readFramesInParallel (const std::function<bool (size_t frameIndex, InputStream& frameData)>& readFrameData,
+                               const std::function<void (float progress)>& progressCallback = {});
+
+    /** The default size of the chunks read from the host. */
+    static constexpr int defaultBufferSize = 64 * 1024;
+
 private:
+    bool readFromArchive (int64 archivePosition, int64 numBytes, void* dest);
+
     ARA::PlugIn::HostArchiveReader* archiveReader;
     int64 position { 0 };
     int64 size;
     bool failure { false };
+
+    HeapBlock<char> buffer;
+    const int bufferSize;
+    int64 bufferStart { 0 }, numBufferedBytes { 0 };
 };
 
 
@@ -343,21 +533,66 @@ private:
 /**
     Used to write persistent ARA archives - see doStoreObjectsToStream() for details.
 
+    The stream collects the data being written into large chunks before passing it on
+    to the host, so writing many small values such as via writeInt() or writeString()
+    does not cause a call into the host for each value.
+
+    Besides plain streaming, the archive can be written as a sequence of frames via
+    writeFrame(), each of which can optionally be GZIP compressed. If the persistent
+    state consists of many independent objects such as audio modifications, they can
+    be encoded (and compressed) concurrently via writeFramesInParallel().
+
     @tags{ARA}
 */
 class ARAOutputStream     : public OutputStream
 {
 public:
-    ARAOutputStream (ARA::PlugIn::HostArchiveWriter*);
+    ARAOutputStream (ARA::PlugIn::HostArchiveWriter*, int bufferSize = defaultBufferSize);
+    ~ARAOutputStream() override;
 
-    int64 getPosition() override { return position; }
-    void flush() override {}
+    int64 getPosition() override { return bufferStart + numBufferedBytes; }
+    void flush() override;
 
     bool write (const void*, size_t) override;
     bool setPosition (int64) override;
 
+    /** Returns true if writing any data to the host has failed. */
+    bool failed() const { return failure; }
+
+    /** Writes a block of data as a single frame, optionally compressing it.
+        Use ARAInputStream::readFrame() to read the frame when restoring.
+    */
+    bool writeFrame (const void* data, size_t numBytes, bool compress);
+
+    /** Writes a sequence of frames, encoding (and optionally compressing) each of them concurrently.
+
+        \p writeFrameData is called for each frame index on a number of worker threads (and the
+        calling thread), so it must be safe to call concurrently. Since the host will not edit the
+        document while archiving, it can safely read from the ARA model graph.
+        The frames are then written to the archive in order of their index on the calling thread.
+        Use ARAInputStream::readFramesInParallel() to read the frames when restoring.
+        @param numFrames         The number of frames to write.
+        @param writeFrameData    Called to write the data of each frame, returning false on failure.
+        @param compress          If true, each frame is GZIP compressed.
+        @param progressCallback  Optionally called on the calling thread with the progress of the operation.
+        @returns true if all frames were written successfully.
+    */
+    bool writeFramesInParallel (size_t numFrames,
+                                const std::function<bool (size_t frameIndex, OutputStream& frameData)>& writeFrameData,
+                                bool compress,
+                                const std::function<void (float progress)>& progressCallback = {});
+
+    /** The default size of the chunks passed to the host. */
+    static constexpr int defaultBufferSize = 64 * 1024;
+
 private:
+    bool writeToArchive (const void* data, size_t numBytes);
+
     ARA::PlugIn::HostArchiveWriter* archiveWriter;
-    int64 position { 0 };
+    bool failure { false };
+
+    HeapBlock<char> buffer;
+    const int bufferSize;
+    int64 bufferStart { 0 }, numBufferedBytes { 0 };
 };
 } // namespace juce
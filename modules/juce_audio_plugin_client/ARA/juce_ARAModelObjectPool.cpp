@@ -0,0 +1,103 @@
+#include "juce_ARAModelObjectPool.h"
+
+namespace juce
+{
+
+ARAModelObjectPool::ARAModelObjectPool (size_t slabSizeInBytes)
+    : slabSize ((jmax (slabSizeInBytes, (size_t) 4096) + alignment - 1) & ~(alignment - 1))
+{
+}
+
+ARAModelObjectPool::~ARAModelObjectPool()
+{
+    // each object keeps its pool alive, so no objects should be left when the pool is destroyed
+    jassert (numObjects == 0);
+}
+
+void* ARAModelObjectPool::allocateObject (size_t numBytes, ARAModelObjectPool* pool)
+{
+    const auto blockSize = (headerSize + numBytes + alignment - 1) & ~(alignment - 1);
+
+    Header header { pool, 0 };
+    void* block;
+
+    if (pool != nullptr && blockSize <= pool->slabSize / 8)
+    {
+        block = pool->allocateBlock (blockSize);
+        header.blockSize = blockSize;
+    }
+    else
+    {
+        block = std::malloc (headerSize + numBytes);
+
+        if (block == nullptr)
+            throw std::bad_alloc();
+    }
+
+    if (pool != nullptr)
+    {
+        pool->incReferenceCount();
+        ++pool->numObjects;
+    }
+
+    new (block) Header (header);
+    return static_cast<char*> (block) + headerSize;
+}
+
+void ARAModelObjectPool::deallocateObject (void* object) noexcept
+{
+    if (object == nullptr)
+        return;
+
+    auto* block = static_cast<char*> (object) - headerSize;
+    const auto header = *reinterpret_cast<Header*> (block);
+
+    if (header.blockSize != 0)
+        header.pool->releaseBlock (block, header.blockSize);
+    else
+        std::free (block);
+
+    if (header.pool != nullptr)
+    {
+        --header.pool->numObjects;
+        header.pool->decReferenceCount();
+    }
+}
+
+void* ARAModelObjectPool::allocateBlock (size_t blockSize)
+{
+    const auto freeListIndex = blockSize / alignment;
+
+    // the free list is created along with the first block of each size, so that releasing blocks never allocates
+    if (freeListIndex >= freeLists.size())
+        freeLists.resize (freeListIndex + 1, nullptr);
+
+    if (freeLists[freeListIndex] != nullptr)
+    {
+        auto* freeBlock = freeLists[freeListIndex];
+        freeLists[freeListIndex] = freeBlock->next;
+        return freeBlock;
+    }
+
+    if ((size_t) (slabEnd - slabPosition) < blockSize)
+    {
+        // any remainder of the current slab is left unused
+        slabs.emplace_back (slabSize);
+        slabPosition = slabs.back().get();
+        slabEnd = slabPosition + slabSize;
+    }
+
+    auto* block = slabPosition;
+    slabPosition += blockSize;
+    return block;
+}
+
+void ARAModelObjectPool::releaseBlock (void* block, size_t blockSize) noexcept
+{
+    const auto freeListIndex = blockSize / alignment;
+    jassert (freeListIndex < freeLists.size());
+
+    freeLists[freeListIndex] = new (block) FreeBlock { freeLists[freeListIndex] };
+}
+
+} // namespace juce
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    An arena that the ARA model objects of a document can be allocated from, see
+    ARADocumentController::setModelObjectPoolEnabled().
+
+    Memory is taken from large slabs, and the blocks of destroyed objects are kept in free lists
+    per block size for reuse by objects of the same size. Since documents typically consist of many
+    objects of the same few classes, this turns the creation of large documents into a sequence of
+    pointer bumps, keeps the objects close together in memory and avoids fragmenting the heap when
+    the document is torn down. The slabs are only returned to the system when the pool is destroyed.
+
+    All model object classes route their operator new and delete through allocateObject() and
+    deallocateObject(), which store the pool that an object was allocated from in front of the object.
+    Each object holds a reference to its pool, so the pool stays alive until all of its objects have
+    been deleted, regardless of the order in which the document controller and the document are torn down.
+
+    Since ARA model objects are only created and destroyed on the document controller thread,
+    the pool is not thread-safe.
+
+    @tags{ARA}
+*/
+class JUCE_API  ARAModelObjectPool  : public ReferenceCountedObject
+{
+public:
+    using Ptr = ReferenceCountedObjectPtr<ARAModelObjectPool>;
+
+    /** Creates a pool that allocates memory in slabs of the given size.
+        Objects larger than an eighth of the slab size are allocated from the heap.
+    */
+    explicit ARAModelObjectPool (size_t slabSizeInBytes = defaultSlabSize);
+    ~ARAModelObjectPool() override;
+
+    /** Allocates memory for an object of the given size from the given pool, or from the heap if pool is nullptr. */
+    static void* allocateObject (size_t numBytes, ARAModelObjectPool* pool);
+
+    /** Releases the memory of an object that was allocated through allocateObject(). */
+    static void deallocateObject (void* object) noexcept;
+
+    /** Returns the number of objects that are currently allocated from the pool. */
+    int getNumObjects() const noexcept                  { return numObjects; }
+
+    /** Returns the total size of the slabs allocated by the pool. */
+    size_t getNumBytesReserved() const noexcept         { return slabs.size() * slabSize; }
+
+    static constexpr size_t defaultSlabSize = 256 * 1024;
+
+private:
+    struct Header
+    {
+        ARAModelObjectPool* pool;
+        size_t blockSize;       // 0 if the block was allocated from the heap
+    };
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    static constexpr size_t alignment = alignof (std::max_align_t);
+    static constexpr size_t headerSize = (sizeof (Header) + alignment - 1) & ~(alignment - 1);
+
+    void* allocateBlock (size_t blockSize);
+    void releaseBlock (void* block, size_t blockSize) noexcept;
+
+    const size_t slabSize;
+    std::vector<HeapBlock<char, true>> slabs;
+    char* slabPosition { nullptr };
+    char* slabEnd { nullptr };
+    std::vector<FreeBlock*> freeLists;
+    int numObjects { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ARAModelObjectPool)
+};
+
+} // namespace juce
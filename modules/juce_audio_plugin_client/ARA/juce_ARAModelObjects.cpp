@@ -15,6 +15,37 @@ ARAMusicalContext::ARAMusicalContext (ARADocument* document, ARA::ARAMusicalCont
     : ARA::PlugIn::MusicalContext (document, hostRef)
 {}
 
+ARAMusicalContext::~ARAMusicalContext()
+{
+    delete tempoMap.exchange (nullptr);
+}
+
+void ARAMusicalContext::updateTempoMap()
+{
+    std::vector<ARA::ARAContentTempoEntry> tempoEntries;
+    const ARA::PlugIn::HostContentReader<ARA::kARAContentTypeTempoEntries> tempoReader (this);
+    if (tempoReader)
+    {
+        tempoEntries.reserve ((size_t) tempoReader.getEventCount());
+        for (ARA::ARAInt32 i = 0; i < tempoReader.getEventCount(); ++i)
+            tempoEntries.push_back (*tempoReader.getDataForEvent (i));
+    }
+
+    std::vector<ARA::ARAContentBarSignature> barSignatures;
+    const ARA::PlugIn::HostContentReader<ARA::kARAContentTypeBarSignatures> barSignaturesReader (this);
+    if (barSignaturesReader)
+    {
+        barSignatures.reserve ((size_t) barSignaturesReader.getEventCount());
+        for (ARA::ARAInt32 i = 0; i < barSignaturesReader.getEventCount(); ++i)
+            barSignatures.push_back (*barSignaturesReader.getDataForEvent (i));
+    }
+
+    std::unique_ptr<const ARATempoMap> previousTempoMap (tempoMap.exchange (new ARATempoMap (tempoEntries, barSignatures)));
+
+    // wait until no ScopedTempoMapAccess is using the previous map anymore before deleting it
+    tempoMapEpoch.synchronise();
+}
+
 //==============================================================================
 
 ARARegionSequence::ARARegionSequence (ARADocument* document, ARA::ARARegionSequenceHostRef hostRef)
@@ -77,6 +108,11 @@ void ARAAudioSource::notifyContentChanged (ARAContentUpdateScopes scopeFlags, bo
     getDocumentController()->internalNotifyAudioSourceContentChanged (this, scopeFlags, notifyARAHost);
 }
 
+void ARAAudioSource::notifyContentChanged (Range<double> affectedTimeRange, ARAContentUpdateScopes scopeFlags, bool notifyARAHost)
+{
+    getDocumentController()->internalNotifyAudioSourceContentChanged (this, affectedTimeRange, scopeFlags, notifyARAHost);
+}
+
 //==============================================================================
 
 ARAAudioModification::ARAAudioModification (ARAAudioSource* audioSource, ARA::ARAAudioModificationHostRef hostRef, const ARAAudioModification* optionalModificationToClone)
@@ -136,4 +172,9 @@ void ARAPlaybackRegion::notifyContentChanged (ARAContentUpdateScopes scopeFlags,
     getDocumentController()->internalNotifyPlaybackRegionContentChanged (this, scopeFlags, notifyARAHost);
 }
 
+void ARAPlaybackRegion::notifyContentChanged (Range<double> affectedTimeRange, ARAContentUpdateScopes scopeFlags, bool notifyARAHost)
+{
+    getDocumentController()->internalNotifyPlaybackRegionContentChanged (this, affectedTimeRange, scopeFlags, notifyARAHost);
+}
+
 } // namespace juce
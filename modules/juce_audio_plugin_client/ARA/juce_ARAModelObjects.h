@@ -1,6 +1,9 @@
 #pragma once
 
 #include <juce_audio_plugin_client/juce_audio_plugin_client.h>
+#include "juce_ARAReadEpoch.h"
+#include "juce_ARATempoMap.h"
+#include "juce_ARAModelObjectPool.h"
 
 namespace juce
 {
@@ -32,21 +35,123 @@ public:
     /** Subscribe \p l to notified by changes to the object.
         @param l The listener instance. 
     */
-    inline void addListener (Listener* l) { listeners.add (l); }
+    inline void addListener (Listener* l)
+    {
+        jassert (l != nullptr); // Listeners can't be null pointers!
+
+        if (l != nullptr && ! listeners.contains (l))
+            listeners.add (l);
+    }
 
     /** Unsubscribe \p l from object notifications.
         @param l The listener instance.
     */
     inline void removeListener (Listener* l) { listeners.remove (l); }
 
+    /** Calls the given function for each listener, allowing listeners to safely add or remove
+        themselves or other listeners from within the callback.
+    */
     template<typename Callback>
     inline void notifyListeners (Callback&& callback)
     {
-        reinterpret_cast<ListenerList<typename ModelClassType::Listener>*> (&listeners)->callExpectingUnregistration (callback);
+        const auto numListeners = listeners.size();
+
+        if (numListeners == 0)
+            return;
+
+        // if there's but one listener, we can skip copying
+        if (numListeners == 1)
+        {
+            callback (static_cast<typename ModelClassType::Listener&> (**listeners.begin()));
+            return;
+        }
+
+        // iterate over a copy, skipping any listeners that are removed in the meantime -
+        // for the common case of only a few listeners, the copy is kept on the stack
+        Listener* stackCopy[numStackCopyListeners];
+        std::vector<Listener*> heapCopy;
+        Listener* const* listenersCopy = stackCopy;
+
+        if (numListeners <= numStackCopyListeners)
+        {
+            std::copy (listeners.begin(), listeners.end(), stackCopy);
+        }
+        else
+        {
+            heapCopy.assign (listeners.begin(), listeners.end());
+            listenersCopy = heapCopy.data();
+        }
+
+        for (int i = 0; i < numListeners; ++i)
+            if (listeners.contains (listenersCopy[i]))
+                callback (static_cast<typename ModelClassType::Listener&> (*listenersCopy[i]));
     }
 
+    //==============================================================================
+    // Model objects can be allocated from an ARAModelObjectPool by passing it as placement argument,
+    // see ARADocumentController::setModelObjectPoolEnabled(). Objects created through a plain new
+    // expression are allocated from the heap.
+    static void* operator new (size_t size)                                     { return ARAModelObjectPool::allocateObject (size, nullptr); }
+    static void* operator new (size_t size, ARAModelObjectPool* pool)           { return ARAModelObjectPool::allocateObject (size, pool); }
+    static void operator delete (void* object) noexcept                         { ARAModelObjectPool::deallocateObject (object); }
+    static void operator delete (void* object, ARAModelObjectPool*) noexcept    { ARAModelObjectPool::deallocateObject (object); }
+
 private:
-    ListenerList<Listener> listeners;
+    // Stores the first few listeners inline, since most model objects only have very few of them,
+    // so that adding those does not allocate.
+    class ListenerStorage
+    {
+    public:
+        ListenerStorage() = default;
+
+        int size() const noexcept                           { return numListeners; }
+        Listener* const* begin() const noexcept             { return getListeners(); }
+        Listener* const* end() const noexcept               { return getListeners() + numListeners; }
+        bool contains (Listener* l) const noexcept          { return std::find (begin(), end(), l) != end(); }
+
+        void add (Listener* l)
+        {
+            if (numListeners == capacity)
+            {
+                HeapBlock<Listener*> newHeapListeners ((size_t) capacity * 2);
+                std::copy (begin(), end(), newHeapListeners.get());
+                heapListeners = std::move (newHeapListeners);
+                capacity *= 2;
+            }
+
+            getListeners()[numListeners++] = l;
+        }
+
+        void remove (Listener* l) noexcept
+        {
+            auto* listenersBegin = getListeners();
+            auto* listenersEnd = listenersBegin + numListeners;
+            auto* it = std::find (listenersBegin, listenersEnd, l);
+
+            if (it != listenersEnd)
+            {
+                std::move (it + 1, listenersEnd, it);
+                --numListeners;
+            }
+        }
+
+    private:
+        Listener** getListeners() noexcept                  { return (capacity > numInlineListeners) ? heapListeners.get() : inlineListeners; }
+        Listener* const* getListeners() const noexcept      { return (capacity > numInlineListeners) ? heapListeners.get() : inlineListeners; }
+
+        static constexpr int numInlineListeners = 2;
+
+        Listener* inlineListeners[numInlineListeners] {};
+        HeapBlock<Listener*> heapListeners;
+        int numListeners = 0;
+        int capacity = numInlineListeners;
+
+        JUCE_DECLARE_NON_COPYABLE (ListenerStorage)
+    };
+
+    static constexpr int numStackCopyListeners = 8;
+
+    ListenerStorage listeners;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ARAListenableModelClass)
 };
@@ -179,6 +284,10 @@ public:
 /**
     Base class representing an ARA musical context.
 
+    The tempo entries and bar signatures of the musical context are cached in an ARATempoMap,
+    which is rebuilt whenever the host updates the timeline content of the musical context, so
+    that conversions between time and musical positions do not need to query the host.
+
     @tags{ARA}
 */
 class JUCE_API  ARAMusicalContext     : public ARA::PlugIn::MusicalContext,
@@ -188,6 +297,7 @@ public:
     using PropertiesPtr = ARA::PlugIn::PropertiesPtr<ARA::ARAMusicalContextProperties>;
 
     ARAMusicalContext (ARADocument* document, ARA::ARAMusicalContextHostRef hostRef);
+    ~ARAMusicalContext() override;
 
     // overloading inherited templated getters to default to juce versions of the returned classes
     template <typename DocumentController_t = ARADocumentController>
@@ -197,6 +307,45 @@ public:
     template <typename RegionSequence_t = ARARegionSequence>
     std::vector<RegionSequence_t*> const& getRegionSequences() const noexcept { return ARA::PlugIn::MusicalContext::getRegionSequences<RegionSequence_t>(); }
 
+    /** Returns the current tempo map of the musical context.
+        The map is replaced whenever the timeline content of the musical context is updated, so the
+        returned reference must only be used on the document controller thread, and only until the
+        next update - use a ScopedTempoMapAccess on any other thread.
+    */
+    const ARATempoMap& getTempoMap() const noexcept                     { return *tempoMap.load(); }
+
+    /** Provides lock-free access to the tempo map of a musical context from any thread, e.g. from
+        processBlock().
+
+        The map that is current when the object is constructed remains valid for the lifetime of the
+        object, so it should only be kept for short periods such as a single render call: updates of
+        the tempo map wait until all accesses to the previous map have ended before deleting it.
+    */
+    class JUCE_API  ScopedTempoMapAccess
+    {
+    public:
+        explicit ScopedTempoMapAccess (const ARAMusicalContext& musicalContext) noexcept
+            : scopedRead (musicalContext.tempoMapEpoch),
+              tempoMap (musicalContext.tempoMap.load())
+        {}
+
+        const ARATempoMap& operator*() const noexcept                   { return *tempoMap; }
+        const ARATempoMap* operator->() const noexcept                  { return tempoMap; }
+
+    private:
+        const ARAReadEpoch::ScopedRead scopedRead;
+        const ARATempoMap* tempoMap;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedTempoMapAccess)
+    };
+
+    /** @internal
+        Rebuilds the tempo map from the content provided by the host. This is called by the
+        ARADocumentController when the musical context is added to the document, and whenever
+        its timeline content is updated.
+    */
+    void updateTempoMap();
+
     class JUCE_API  Listener  : public ARAListenableModelClass<ARAMusicalContext>::Listener
     {
     public:
@@ -251,6 +400,10 @@ public:
 
        ARA_DISABLE_UNREFERENCED_PARAMETER_WARNING_END
     };
+
+private:
+    std::atomic<const ARATempoMap*> tempoMap { new ARATempoMap() };
+    ARAReadEpoch tempoMapEpoch;
 };
 
 
@@ -377,6 +530,18 @@ public:
         */
         virtual void doUpdateAudioSourceContent (ARAAudioSource* audioSource, ARAContentUpdateScopes scopeFlags) {}
 
+        /** Called instead of doUpdateAudioSourceContent() when the content update is limited to a range of the audio source.
+            The default implementation forwards to doUpdateAudioSourceContent(), listeners that can handle
+            partial updates efficiently (such as readers or caches) can override this to only refresh the affected range.
+            @param audioSource The audio source with updated content.
+            @param affectedTimeRange The range of the update in audio source time (seconds).
+            @param scopeFlags The scope of the content update.
+        */
+        virtual void doUpdateAudioSourceContentInRange (ARAAudioSource* audioSource, Range<double> affectedTimeRange, ARAContentUpdateScopes scopeFlags)
+        {
+            doUpdateAudioSourceContent (audioSource, scopeFlags);
+        }
+
         /** Called to notify progress when an audio source is being analyzed.
             @param audioSource The audio source being analyzed.
             @param state Indicates start, intermediate update or completion of the analysis.
@@ -456,9 +621,23 @@ public:
     */
     void notifyContentChanged (ARAContentUpdateScopes scopeFlags, bool notifyARAHost);
 
+    /** Notify the ARA host and any listeners of a content update initiated by the plug-in that is
+        limited to the given range of the audio source, see notifyContentChanged().
+        Listeners will receive doUpdateAudioSourceContentInRange().
+
+        @param affectedTimeRange The range of the update in audio source time (seconds).
+        @param scopeFlags The scope of the content update.
+        @param notifyARAHost If true, the ARA host will be notified of the content change.
+    */
+    void notifyContentChanged (Range<double> affectedTimeRange, ARAContentUpdateScopes scopeFlags, bool notifyARAHost);
+
 private:
     friend ARADocumentController;
     ARA::PlugIn::AnalysisProgressTracker internalAnalysisProgressTracker;
+
+    // intrusive link and flag for the document controller's queue of pending analysis progress updates
+    std::atomic<ARAAudioSource*> internalNextAudioSourceWithPendingProgress { nullptr };
+    std::atomic<bool> internalHasPendingProgress { false };
 };
 
 
@@ -602,6 +781,17 @@ public:
         */
         virtual void didUpdatePlaybackRegionContent (ARAPlaybackRegion* playbackRegion, ARAContentUpdateScopes scopeFlags) {}
 
+        /** Called instead of didUpdatePlaybackRegionContent() when the content update is limited to a range of the playback region.
+            The default implementation forwards to didUpdatePlaybackRegionContent().
+            @param playbackRegion The playback region with updated content.
+            @param affectedTimeRange The range of the update in playback time (seconds).
+            @param scopeFlags The scope of the content update.
+        */
+        virtual void didUpdatePlaybackRegionContentInRange (ARAPlaybackRegion* playbackRegion, Range<double> affectedTimeRange, ARAContentUpdateScopes scopeFlags)
+        {
+            didUpdatePlaybackRegionContent (playbackRegion, scopeFlags);
+        }
+
         /** Called before the playback region is destroyed.
             @param playbackRegion The playback region that will be destoyed.
         */
@@ -638,6 +828,16 @@ public:
         @param notifyARAHost If true, the ARA host will be notified of the content change.
     */
     void notifyContentChanged (ARAContentUpdateScopes scopeFlags, bool notifyARAHost);
+
+    /** Notify the ARA host and any listeners of a content update initiated by the plug-in that is
+        limited to the given range of the playback region, see notifyContentChanged().
+        Listeners will receive didUpdatePlaybackRegionContentInRange().
+
+        @param affectedTimeRange The range of the update in playback time (seconds).
+        @param scopeFlags The scope of the content update.
+        @param notifyARAHost If true, the ARA host will be notified of the content change.
+    */
+    void notifyContentChanged (Range<double> affectedTimeRange, ARAContentUpdateScopes scopeFlags, bool notifyARAHost);
 };
 
 
@@ -5,37 +5,829 @@ namespace juce
 
 //==============================================================================
 
-#if ARA_VALIDATE_API_CALLS
+void ARARenderer::prepareToPlay (double sampleRate, int maximumSamplesPerBlock, int numChannels, bool alwaysNonRealtime,
+                                 AudioProcessor::ProcessingPrecision precision)
+{
+    ignoreUnused (sampleRate, alwaysNonRealtime);
+
+    processingPrecision = precision;
+
+    if (precision == AudioProcessor::doublePrecision)
+        doublePrecisionConversionBuffer.setSize (numChannels, maximumSamplesPerBlock);
+    else
+        doublePrecisionConversionBuffer.setSize (0, 0);
+}
+
+void ARARenderer::releaseResources()
+{
+    doublePrecisionConversionBuffer.setSize (0, 0);
+}
+
+bool ARARenderer::processBlock (AudioBuffer<double>& buffer, bool isNonRealtime, const AudioPlayHead::CurrentPositionInfo& positionInfo) noexcept
+{
+    const auto numChannels = buffer.getNumChannels();
+    const auto numSamples = buffer.getNumSamples();
+
+    // the renderer must be prepared for double precision processing in order to call this
+    if (! isPositiveAndNotGreaterThan (numChannels, doublePrecisionConversionBuffer.getNumChannels())
+        || ! isPositiveAndNotGreaterThan (numSamples, doublePrecisionConversionBuffer.getNumSamples()))
+    {
+        jassertfalse;
+        return false;
+    }
+
+    // refer to the preallocated samples, so that no allocation happens here
+    AudioBuffer<float> floatBuffer (doublePrecisionConversionBuffer.getArrayOfWritePointers(), numChannels, numSamples);
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        auto* dest = floatBuffer.getWritePointer (c);
+        auto* src = buffer.getReadPointer (c);
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = (float) src[i];
+    }
+
+    const auto result = processBlock (floatBuffer, isNonRealtime, positionInfo);
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        auto* dest = buffer.getWritePointer (c);
+        auto* src = floatBuffer.getReadPointer (c);
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = (double) src[i];
+    }
+
+    return result;
+}
+
+//==============================================================================
+
+ARAPlaybackRenderer::SharedReadThread::SharedReadThread()
+    : TimeSliceThread (String (JucePlugin_Name) + " ARA Sample Reading Thread")
+{
+    startThread (7);   // above "default" priority so playback is fluent, but below realtime
+}
+
+//==============================================================================
+
+ARAPlaybackRenderer::~ARAPlaybackRenderer()
+{
+    cancelPendingUpdate();
+
+    for (auto* playbackRegion : getPlaybackRegions())
+        playbackRegion->removeListener (this);
+
+    releaseAudioSourceReaders();
+
+    delete playbackRegionIndex.exchange (nullptr);
+}
+
+void ARAPlaybackRenderer::prepareToPlay (double sampleRate, int maximumSamplesPerBlock, int numChannels, bool alwaysNonRealtime,
+                                         AudioProcessor::ProcessingPrecision precision)
+{
+    ARARenderer::prepareToPlay (sampleRate, maximumSamplesPerBlock, numChannels, alwaysNonRealtime, precision);
+
+    playbackRegionIndexSampleRate = sampleRate;
+    preparedMaximumSamplesPerBlock = maximumSamplesPerBlock;
+    preparedNumChannels = numChannels;
+    preparedAlwaysNonRealtime = alwaysNonRealtime;
+    rebuildPlaybackRegionIndex();
+}
+
+void ARAPlaybackRenderer::releaseResources()
+{
+    ARARenderer::releaseResources();
+
+    releaseAudioSourceReaders();
+}
+
+//==============================================================================
+
+void ARAPlaybackRenderer::prepareAudioSourceReaders()
+{
+    jassert (playbackRegionIndexSampleRate > 0.0);   // must be called from prepareToPlay()
+
+    releaseAudioSourceReaders();
+
+    for (auto* playbackRegion : getPlaybackRegions())
+    {
+        auto* audioSource = playbackRegion->getAudioModification()->getAudioSource();
+
+        if (std::none_of (preparedAudioSourceReaders.begin(), preparedAudioSourceReaders.end(),
+                          [audioSource] (const PreparedAudioSourceReader& r) { return r.audioSource == audioSource; }))
+        {
+            preparedAudioSourceReaders.push_back ({ audioSource, nullptr, nullptr, nullptr, false, false, 0 });
+            createAudioSourceReader (preparedAudioSourceReaders.back());
+            audioSource->addListener (this);
+        }
+    }
+
+    rebuildPlaybackRegionIndex();
+}
+
+void ARAPlaybackRenderer::createAudioSourceReader (PreparedAudioSourceReader& preparedReader)
+{
+    auto sourceReader = std::make_unique<ARAAudioSourceReader> (preparedReader.audioSource);
+    preparedReader.sourceReader = sourceReader.get();
+    preparedReader.needsUpdate = false;
+
+    static std::atomic<uint32> nextReaderVersion { 0 };
+    preparedReader.version = ++nextReaderVersion;
+
+    std::unique_ptr<AudioFormatReader> reader (std::move (sourceReader));
+
+    // Convert sources that don't match the render format - the converted blocks are cached, so
+    // this is cheap when playing back the same range repeatedly.
+    preparedReader.isConverted = ARAConvertingAudioReader::needsConversion (*reader, playbackRegionIndexSampleRate, preparedNumChannels);
+    if (preparedReader.isConverted)
+        reader = std::make_unique<ARAConvertingAudioReader> (reader.release(), playbackRegionIndexSampleRate, preparedNumChannels);
+
+    if (preparedAlwaysNonRealtime)
+    {
+        preparedReader.bufferingReader = nullptr;
+        preparedReader.reader = std::move (reader);
+        return;
+    }
+
+    // If we're being used in real-time, wrap our source reader in a buffering
+    // reader to avoid blocking while reading samples in processBlock.
+    if (sharedReadThread == nullptr)
+        sharedReadThread = std::make_unique<SharedResourcePointer<SharedReadThread>>();
+
+    const auto readAheadSize = jmax (4 * preparedMaximumSamplesPerBlock, roundToInt (2.0 * playbackRegionIndexSampleRate));
+    auto bufferingReader = std::make_unique<BufferingAudioReader> (reader.release(), **sharedReadThread, readAheadSize);
+    preparedReader.bufferingReader = bufferingReader.get();
+    preparedReader.reader = std::move (bufferingReader);
+}
+
+void ARAPlaybackRenderer::releaseAudioSourceReaders()
+{
+    if (preparedAudioSourceReaders.empty())
+        return;
+
+    // an offline render job refers to the prepared readers
+    jassert (offlineRenderJob == nullptr);
+
+    auto previousReaders = std::move (preparedAudioSourceReaders);
+    preparedAudioSourceReaders.clear();
+
+    for (auto& preparedReader : previousReaders)
+        if (preparedReader.audioSource != nullptr)
+            preparedReader.audioSource->removeListener (this);
+
+    // make sure the render thread no longer uses the readers before deleting them
+    rebuildPlaybackRegionIndex();
+}
+
+void ARAPlaybackRenderer::didUpdateAudioSourceProperties (ARAAudioSource*)
+{
+    // the readers invalidate themselves if the properties change in a relevant way
+    triggerAsyncUpdate();
+}
+
+void ARAPlaybackRenderer::doUpdateAudioSourceContent (ARAAudioSource*, ARAContentUpdateScopes scopeFlags)
+{
+    // the readers invalidate themselves if the samples change - since they only do so while the
+    // notification is being sent, replacing them must be deferred
+    if (scopeFlags.affectSamples())
+        triggerAsyncUpdate();
+}
+
+void ARAPlaybackRenderer::doUpdateAudioSourceContentInRange (ARAAudioSource* audioSource, Range<double>, ARAContentUpdateScopes scopeFlags)
+{
+    // unlike the source readers, the buffering and converting readers would hold on to the previous samples
+    if (! scopeFlags.affectSamples())
+        return;
+
+    for (auto& preparedReader : preparedAudioSourceReaders)
+        if (preparedReader.audioSource == audioSource && (preparedReader.bufferingReader != nullptr || preparedReader.isConverted))
+            preparedReader.needsUpdate = true;
+
+    triggerAsyncUpdate();
+}
+
+void ARAPlaybackRenderer::willDestroyAudioSource (ARAAudioSource* audioSource)
+{
+    // the host must not destroy audio sources that are still being played back, but the reader
+    // would become invalid anyways, and must not be recreated
+    for (auto& preparedReader : preparedAudioSourceReaders)
+    {
+        if (preparedReader.audioSource == audioSource)
+        {
+            audioSource->removeListener (this);
+            preparedReader.audioSource = nullptr;
+        }
+    }
+}
+
+void ARAPlaybackRenderer::handleAsyncUpdate()
+{
+    std::vector<std::unique_ptr<AudioFormatReader>> previousReaders;
+
+    for (auto& preparedReader : preparedAudioSourceReaders)
+    {
+        if (preparedReader.audioSource != nullptr && (preparedReader.needsUpdate || ! preparedReader.sourceReader->isValid()))
+        {
+            previousReaders.push_back (std::move (preparedReader.reader));
+            createAudioSourceReader (preparedReader);
+        }
+    }
+
+    // publish the new readers, then the previous ones can be deleted safely
+    if (! previousReaders.empty() || playbackRegionIndexNeedsRebuild)
+        rebuildPlaybackRegionIndex();
+}
+
 void ARAPlaybackRenderer::addPlaybackRegion (ARA::ARAPlaybackRegionRef playbackRegionRef) noexcept
 {
+#if ARA_VALIDATE_API_CALLS
     if (araExtension)
         ARA_VALIDATE_API_STATE (! araExtension->isPrepared);
+#endif
     ARA::PlugIn::PlaybackRenderer::addPlaybackRegion (playbackRegionRef);
+
+    getPlaybackRegions().back()->addListener (this);
+    rebuildPlaybackRegionIndex();
 }
 
 void ARAPlaybackRenderer::removePlaybackRegion (ARA::ARAPlaybackRegionRef playbackRegionRef) noexcept
 {
+#if ARA_VALIDATE_API_CALLS
     if (araExtension)
         ARA_VALIDATE_API_STATE (! araExtension->isPrepared);
+#endif
+    for (auto* playbackRegion : getPlaybackRegions())
+        if (ARA::PlugIn::toRef (playbackRegion) == playbackRegionRef)
+            playbackRegion->removeListener (this);
+
     ARA::PlugIn::PlaybackRenderer::removePlaybackRegion (playbackRegionRef);
+    rebuildPlaybackRegionIndex();
+}
+
+void ARAPlaybackRenderer::didUpdatePlaybackRegionProperties (ARAPlaybackRegion*)
+{
+    // a host edit may update many regions in a row, so the index is rebuilt only once afterwards
+    playbackRegionIndexNeedsRebuild = true;
+    triggerAsyncUpdate();
+}
+
+void ARAPlaybackRenderer::didUpdatePlaybackRegionContent (ARAPlaybackRegion*, ARAContentUpdateScopes)
+{
+    // head and tail times may change along with the content
+    playbackRegionIndexNeedsRebuild = true;
+    triggerAsyncUpdate();
+}
+
+void ARAPlaybackRenderer::rebuildPlaybackRegionIndex()
+{
+    if (playbackRegionIndexSampleRate <= 0.0)
+        return;
+
+    playbackRegionIndexNeedsRebuild = false;
+
+    std::vector<AudioFormatReader*> prefetchedReaders;
+    if (offlineRenderJob != nullptr)
+        prefetchedReaders = offlineRenderJob->getPrefetchedReaders();
+
+    std::unique_ptr<PlaybackRegionIndex> previousIndex (playbackRegionIndex.exchange (new PlaybackRegionIndex (getPlaybackRegions(), playbackRegionIndexSampleRate,
+                                                                                                           preparedAudioSourceReaders, prefetchedReaders)));
+
+    // wait until the render thread no longer uses the previous index before deleting it
+    if (previousIndex != nullptr)
+        playbackRegionIndexEpoch.synchronise();
+}
+
+ARAPlaybackRenderer::PlaybackRegionIndex::PlaybackRegionIndex (const std::vector<ARAPlaybackRegion*>& playbackRegions, double sampleRate,
+                                                                const std::vector<PreparedAudioSourceReader>& preparedAudioSourceReaders,
+                                                                const std::vector<AudioFormatReader*>& prefetchedReaders)
+{
+    entries.reserve (playbackRegions.size());
+
+    for (auto& preparedReader : preparedAudioSourceReaders)
+        if (preparedReader.bufferingReader != nullptr)
+            bufferingReaders.push_back (preparedReader.bufferingReader);
+
+    for (auto* playbackRegion : playbackRegions)
+    {
+        auto* audioSource = playbackRegion->getAudioModification()->getAudioSource();
+
+        PreparedPlaybackRegion preparedRegion;
+        preparedRegion.playbackRegion = playbackRegion;
+        preparedRegion.sampleRange = playbackRegion->getSampleRange (sampleRate, true);
+        preparedRegion.playbackSampleRange = playbackRegion->getSampleRange (sampleRate, false);
+        preparedRegion.modificationSampleRange = { playbackRegion->getStartInAudioModificationSamples(), playbackRegion->getEndInAudioModificationSamples() };
+        preparedRegion.modificationSampleOffset = preparedRegion.modificationSampleRange.getStart() - preparedRegion.playbackSampleRange.getStart();
+        preparedRegion.reader = nullptr;
+        preparedRegion.readerIndex = -1;
+        preparedRegion.isConverted = false;
+        preparedRegion.readerVersion = 0;
+
+        for (size_t i = 0; i < preparedAudioSourceReaders.size(); ++i)
+        {
+            if (preparedAudioSourceReaders[i].audioSource == audioSource)
+            {
+                preparedRegion.reader = (i < prefetchedReaders.size() && prefetchedReaders[i] != nullptr) ? prefetchedReaders[i]
+                                                                                                           : preparedAudioSourceReaders[i].reader.get();
+                preparedRegion.readerIndex = (int) i;
+                preparedRegion.isConverted = preparedAudioSourceReaders[i].isConverted;
+                preparedRegion.readerVersion = preparedAudioSourceReaders[i].version;
+                break;
+            }
+        }
+
+        // converting readers provide the modification samples at the render sample rate
+        if (preparedRegion.isConverted)
+        {
+            preparedRegion.modificationSampleRange = { ARA::samplePositionAtTime (playbackRegion->getStartInAudioModificationTime(), sampleRate),
+                                                       ARA::samplePositionAtTime (playbackRegion->getEndInAudioModificationTime(), sampleRate) };
+            preparedRegion.modificationSampleOffset = preparedRegion.modificationSampleRange.getStart() - preparedRegion.playbackSampleRange.getStart();
+        }
+
+        // comparing the durations in time avoids stretching regions whose sample ranges only differ due to rounding
+        preparedRegion.timeStretchFactor = 1.0;
+        if (playbackRegion->isTimestretchEnabled()
+            && playbackRegion->getDurationInPlaybackTime() != playbackRegion->getDurationInAudioModificationTime()
+            && ! preparedRegion.modificationSampleRange.isEmpty())
+        {
+            preparedRegion.timeStretchFactor = (double) preparedRegion.playbackSampleRange.getLength()
+                                             / (double) preparedRegion.modificationSampleRange.getLength();
+        }
+
+        entries.push_back ({ preparedRegion, 0 });
+    }
+
+    std::sort (entries.begin(), entries.end(), [] (const Entry& a, const Entry& b)
+    {
+        return a.preparedRegion.sampleRange.getStart() < b.preparedRegion.sampleRange.getStart();
+    });
+
+    updateMaxEnd (0, (int) entries.size());
+}
+
+void ARAPlaybackRenderer::PlaybackRegionIndex::setReadTimeout (int timeoutMs) const noexcept
+{
+    // only touch the readers if the render mode actually changes
+    if (timeoutMs == readTimeoutMs)
+        return;
+
+    for (auto* bufferingReader : bufferingReaders)
+        bufferingReader->setReadTimeout (timeoutMs);
+
+    readTimeoutMs = timeoutMs;
+}
+
+int64 ARAPlaybackRenderer::PlaybackRegionIndex::updateMaxEnd (int begin, int end) noexcept
+{
+    if (begin >= end)
+        return std::numeric_limits<int64>::lowest();
+
+    const auto mid = begin + (end - begin) / 2;
+    auto& entry = entries[(size_t) mid];
+    entry.maxEndInSubtree = jmax (entry.preparedRegion.sampleRange.getEnd(), updateMaxEnd (begin, mid), updateMaxEnd (mid + 1, end));
+    return entry.maxEndInSubtree;
+}
+
+//==============================================================================
+
+struct ARAPlaybackRenderer::OfflineRenderJob::PrefetchSource
+{
+    int readerIndex;
+    uint32 readerVersion;
+    std::unique_ptr<AudioFormatReader> reader;
+    ARAAudioSourceReader* sourceReader;      // nullptr if the reader is converting
+    std::unique_ptr<PrefetchedReader> prefetchedReader;
+    CriticalSection readLock;                // the reads of different windows may run concurrently
+};
+
+struct ARAPlaybackRenderer::OfflineRenderJob::SourceRead
+{
+    PrefetchSource* source;
+    Range<int64> range;
+    AudioBuffer<float> samples;
+    bool succeeded;
+};
+
+struct ARAPlaybackRenderer::OfflineRenderJob::Window
+{
+    Range<int64> sampleRange;
+    std::vector<SourceRead> reads;
+    std::atomic<int> numPendingReads { 0 };
+    WaitableEvent readsFinished;
+    bool isInstalled = false;
+};
+
+// Serves the samples of the windows that are currently installed, and forwards everything
+// else to the prepared reader. The installed windows are only changed between blocks.
+class ARAPlaybackRenderer::OfflineRenderJob::PrefetchedReader  : public AudioFormatReader
+{
+public:
+    PrefetchedReader (AudioFormatReader& fallbackReaderToUse, std::atomic<int>& numMissesToUpdate, int maxNumInstalledReads)
+        : AudioFormatReader (nullptr, "ARA Prefetched Reader"),
+          fallbackReader (fallbackReaderToUse),
+          numMisses (numMissesToUpdate)
+    {
+        bitsPerSample = 32;
+        usesFloatingPointData = true;
+        sampleRate = fallbackReader.sampleRate;
+        numChannels = fallbackReader.numChannels;
+        lengthInSamples = fallbackReader.lengthInSamples;
+        installedReads.reserve ((size_t) maxNumInstalledReads);
+    }
+
+    void install (const SourceRead& read)
+    {
+        installedReads.push_back (&read);
+    }
+
+    void uninstall (const SourceRead& read)
+    {
+        installedReads.erase (std::remove (installedReads.begin(), installedReads.end(), &read), installedReads.end());
+    }
+
+    bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                      int64 startSampleInFile, int numSamples) override
+    {
+        while (numSamples > 0)
+        {
+            const SourceRead* read = nullptr;
+            int numSamplesToCopy;
+
+            if (startSampleInFile < 0 || startSampleInFile >= lengthInSamples)
+            {
+                // samples outside of the audio source are silent
+                numSamplesToCopy = (startSampleInFile < 0) ? (int) jmin ((int64) numSamples, -startSampleInFile) : numSamples;
+            }
+            else
+            {
+                read = findInstalledRead (startSampleInFile);
+
+                if (read == nullptr)
+                {
+                    ++numMisses;
+                    return fallbackReader.readSamples (destSamples, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples);
+                }
+
+                numSamplesToCopy = (int) jmin ((int64) numSamples, read->range.getEnd() - startSampleInFile);
+            }
+
+            for (int c = 0; c < numDestChannels; ++c)
+            {
+                if (auto* dest = reinterpret_cast<float*> (destSamples[c]))
+                {
+                    if (read != nullptr && c < read->samples.getNumChannels())
+                        FloatVectorOperations::copy (dest + startOffsetInDestBuffer,
+                                                     read->samples.getReadPointer (c, (int) (startSampleInFile - read->range.getStart())),
+                                                     numSamplesToCopy);
+                    else
+                        FloatVectorOperations::clear (dest + startOffsetInDestBuffer, numSamplesToCopy);
+                }
+            }
+
+            startOffsetInDestBuffer += numSamplesToCopy;
+            startSampleInFile += numSamplesToCopy;
+            numSamples -= numSamplesToCopy;
+        }
+
+        return true;
+    }
+
+private:
+    const SourceRead* findInstalledRead (int64 samplePosition) const noexcept
+    {
+        for (auto* read : installedReads)
+            if (read->range.contains (samplePosition))
+                return read;
+
+        return nullptr;
+    }
+
+    AudioFormatReader& fallbackReader;
+    std::atomic<int>& numMisses;
+    std::vector<const SourceRead*> installedReads;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PrefetchedReader)
+};
+
+ARAPlaybackRenderer::OfflineRenderJob::OfflineRenderJob (ARAPlaybackRenderer& rendererToUse, Range<int64> sampleRangeToRender)
+    : OfflineRenderJob (rendererToUse, sampleRangeToRender, Options())
+{
+}
+
+ARAPlaybackRenderer::OfflineRenderJob::OfflineRenderJob (ARAPlaybackRenderer& rendererToUse, Range<int64> sampleRangeToRender, const Options& options)
+    : renderer (rendererToUse),
+      sampleRange (sampleRangeToRender),
+      nextSamplePosition (sampleRangeToRender.getStart())
+{
+    // the renderer must be prepared, and can only run one job at a time
+    jassert (renderer.playbackRegionIndexSampleRate > 0.0);
+    jassert (renderer.offlineRenderJob == nullptr);
+
+    positionInfo.resetToDefault();
+    positionInfo.isPlaying = true;
+
+    createSchedule (options);
+
+    if (numPrefetchedAudioSources > 0)
+        prefetchPool = std::make_unique<ThreadPool> (jmax (1, options.numPrefetchThreads));
+
+    // the prefetch threads can start working right away, rendering will only wait for the window being rendered
+    scheduleWindows (numWindowsAhead);
+
+    renderer.offlineRenderJob = this;
+    renderer.rebuildPlaybackRegionIndex();
+}
+
+ARAPlaybackRenderer::OfflineRenderJob::~OfflineRenderJob()
+{
+    // switch back to the prepared readers before the prefetched readers are deleted
+    renderer.offlineRenderJob = nullptr;
+    renderer.rebuildPlaybackRegionIndex();
+
+    // pending reads are discarded, but reads in progress must finish before their buffers are deleted
+    prefetchPool.reset();
+}
+
+void ARAPlaybackRenderer::OfflineRenderJob::createSchedule (const Options& options)
+{
+    const auto sampleRate = renderer.playbackRegionIndexSampleRate;
+    const auto maximumBlockSize = (int64) renderer.preparedMaximumSamplesPerBlock;
+
+    windowLength = jmax (maximumBlockSize, (int64) (options.windowLengthInSeconds * sampleRate));
+    numWindowsAhead = jmax (0, options.numWindowsAhead);
+
+    // the reads are extended by a margin, so that reading slightly ahead or behind the region as needed
+    // for sample rate conversion or time stretching is still served from the prefetched samples
+    const auto readMargin = jmax (maximumBlockSize, (int64) (0.1 * sampleRate));
+
+    const auto& preparedReaders = renderer.preparedAudioSourceReaders;
+    prefetchSources.resize (preparedReaders.size());
+
+    auto* index = renderer.playbackRegionIndex.load();
+    if (index == nullptr)
+        return;
+
+    for (auto windowStart = sampleRange.getStart(); windowStart < sampleRange.getEnd(); windowStart += windowLength)
+    {
+        auto window = std::make_unique<Window>();
+        window->sampleRange = { windowStart, jmin (windowStart + windowLength, sampleRange.getEnd()) };
+
+        auto addRead = [this, &window, &preparedReaders, readMargin] (const PreparedPlaybackRegion& preparedRegion)
+        {
+            if (preparedRegion.readerIndex < 0 || preparedReaders[(size_t) preparedRegion.readerIndex].audioSource == nullptr)
+                return;
+
+            const auto& preparedReader = preparedReaders[(size_t) preparedRegion.readerIndex];
+
+            // map the part of the region within the window to the modification samples it is playing back
+            const auto playbackRange = window->sampleRange.getIntersectionWith (preparedRegion.sampleRange);
+            const auto toModificationSample = [&preparedRegion] (int64 playbackSample)
+            {
+                return preparedRegion.modificationSampleRange.getStart()
+                       + (int64) std::floor ((double) (playbackSample - preparedRegion.playbackSampleRange.getStart()) / preparedRegion.timeStretchFactor);
+            };
+
+            const auto readRange = Range<int64> (toModificationSample (playbackRange.getStart()) - readMargin,
+                                                 toModificationSample (playbackRange.getEnd()) + readMargin)
+                                       .getIntersectionWith ({ 0, preparedReader.reader->lengthInSamples });
+
+            if (readRange.isEmpty())
+                return;
+
+            auto& source = prefetchSources[(size_t) preparedRegion.readerIndex];
+
+            if (source == nullptr)
+            {
+                source = std::make_unique<PrefetchSource>();
+                source->readerIndex = preparedRegion.readerIndex;
+                source->readerVersion = preparedReader.version;
+
+                // the prefetch threads use their own readers, so that they never contend with the prepared ones
+                auto sourceReader = std::make_unique<ARAAudioSourceReader> (preparedReader.audioSource);
+                source->sourceReader = preparedReader.isConverted ? nullptr : sourceReader.get();
+                source->reader = std::move (sourceReader);
+
+                if (preparedReader.isConverted)
+                    source->reader = std::make_unique<ARAConvertingAudioReader> (source->reader.release(), renderer.playbackRegionIndexSampleRate,
+                                                                                 renderer.preparedNumChannels);
+
+                source->prefetchedReader = std::make_unique<PrefetchedReader> (*preparedReader.reader, numPrefetchMisses, numWindowsAhead + 1);
+                ++numPrefetchedAudioSources;
+            }
+
+            // all regions of an audio source within the window are covered by a single sequential read
+            auto existingRead = std::find_if (window->reads.begin(), window->reads.end(),
+                                              [&source] (const SourceRead& read) { return read.source == source.get(); });
+
+            if (existingRead != window->reads.end())
+                existingRead->range = existingRead->range.getUnionWith (readRange);
+            else
+                window->reads.push_back ({ source.get(), readRange, {}, false });
+        };
+
+        index->forEachOverlapping (window->sampleRange, addRead);
+        windows.push_back (std::move (window));
+    }
+}
+
+void ARAPlaybackRenderer::OfflineRenderJob::scheduleWindows (int lastWindowIndex)
+{
+    for (; numScheduledWindows <= jmin (lastWindowIndex, (int) windows.size() - 1); ++numScheduledWindows)
+    {
+        auto& window = *windows[(size_t) numScheduledWindows];
+        window.numPendingReads = (int) window.reads.size();
+
+        if (window.reads.empty())
+            window.readsFinished.signal();
+
+        for (auto& read : window.reads)
+        {
+            prefetchPool->addJob ([&window, &read]
+                                  {
+                                      auto& source = *read.source;
+                                      const auto numSamples = (int) read.range.getLength();
+                                      read.samples.setSize ((int) source.reader->numChannels, numSamples);
+
+                                      {
+                                          const ScopedLock scopedLock (source.readLock);
+
+                                          if (source.sourceReader != nullptr)
+                                              read.succeeded = source.sourceReader->readIntoBuffer (read.samples, 0, read.range.getStart(), numSamples);
+                                          else
+                                              read.succeeded = source.reader->read (read.samples.getArrayOfWritePointers(), read.samples.getNumChannels(),
+                                                                                    read.range.getStart(), numSamples);
+                                      }
+
+                                      if (--window.numPendingReads == 0)
+                                          window.readsFinished.signal();
+                                  });
+        }
+    }
+}
+
+void ARAPlaybackRenderer::OfflineRenderJob::updateWindows()
+{
+    const auto windowIndex = (int) ((nextSamplePosition - sampleRange.getStart()) / windowLength);
+
+    scheduleWindows (windowIndex + numWindowsAhead);
+
+    // release the samples of the windows that have been rendered
+    for (; numReleasedWindows < windowIndex; ++numReleasedWindows)
+    {
+        auto& window = *windows[(size_t) numReleasedWindows];
+        window.readsFinished.wait();
+
+        for (auto& read : window.reads)
+        {
+            if (window.isInstalled && read.succeeded)
+                read.source->prefetchedReader->uninstall (read);
+
+            read.samples = AudioBuffer<float>();
+        }
+
+        window.isInstalled = false;
+    }
+
+    // the window being rendered must be available, the following windows are used as soon as their reads have finished
+    windows[(size_t) windowIndex]->readsFinished.wait();
+
+    for (auto i = windowIndex; i < numScheduledWindows; ++i)
+    {
+        auto& window = *windows[(size_t) i];
+
+        if (window.isInstalled || window.numPendingReads.load() != 0)
+            continue;
+
+        for (auto& read : window.reads)
+            if (read.succeeded)
+                read.source->prefetchedReader->install (read);
+
+        window.isInstalled = true;
+    }
+}
+
+bool ARAPlaybackRenderer::OfflineRenderJob::renderNextBlock (AudioBuffer<float>& buffer)
+{
+    jassert (buffer.getNumSamples() <= renderer.preparedMaximumSamplesPerBlock);
+
+    if (isFinished())
+    {
+        buffer.clear();
+        return false;
+    }
+
+    const auto numSamples = (int) jmin ((int64) buffer.getNumSamples(), sampleRange.getEnd() - nextSamplePosition);
+
+    if (numSamples < buffer.getNumSamples())
+        buffer.clear (numSamples, buffer.getNumSamples() - numSamples);
+
+    if (! windows.empty())
+        updateWindows();
+
+    AudioBuffer<float> blockBuffer (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), numSamples);
+    positionInfo.timeInSamples = nextSamplePosition;
+    positionInfo.timeInSeconds = static_cast<double> (nextSamplePosition) / renderer.playbackRegionIndexSampleRate;
+
+    const auto result = renderer.processBlock (blockBuffer, true, positionInfo);
+
+    nextSamplePosition += numSamples;
+    return result;
+}
+
+std::vector<AudioFormatReader*> ARAPlaybackRenderer::OfflineRenderJob::getPrefetchedReaders() const
+{
+    std::vector<AudioFormatReader*> prefetchedReaders (renderer.preparedAudioSourceReaders.size(), nullptr);
+
+    // if a reader has been recreated since the job was created, the prefetched samples may be outdated
+    for (auto& source : prefetchSources)
+        if (source != nullptr && renderer.preparedAudioSourceReaders[(size_t) source->readerIndex].version == source->readerVersion)
+            prefetchedReaders[(size_t) source->readerIndex] = source->prefetchedReader.get();
+
+    return prefetchedReaders;
 }
-#endif
 
 //==============================================================================
 
+ARAEditorView::SelectionSnapshot::SelectionSnapshot (const ARAViewSelection& viewSelection)
+    : playbackRegions (viewSelection.getPlaybackRegions<ARAPlaybackRegion>()),
+      regionSequences (viewSelection.getRegionSequences<ARARegionSequence>()),
+      playbackRegionSet (playbackRegions.begin(), playbackRegions.end()),
+      regionSequenceSet (regionSequences.begin(), regionSequences.end())
+{
+    if (auto* selectedTimeRange = viewSelection.getTimeRange())
+    {
+        timeRange = *selectedTimeRange;
+        hasTimeRange = true;
+    }
+}
+
 void ARAEditorView::doNotifySelection (const ARA::PlugIn::ViewSelection* viewSelection) noexcept
 {
+    getDocumentController()->internalDidUpdateEditorViewSelection (*viewSelection);
+
+    // the difference is computed once here, so each listener only needs to process the change
+    const auto previousSnapshot = std::move (selectionSnapshot);
+    selectionSnapshot = std::make_shared<const SelectionSnapshot> (*viewSelection);
+
+    SelectionChange change { *previousSnapshot, *selectionSnapshot, {}, {}, {}, {}, false };
+
+    for (auto* playbackRegion : selectionSnapshot->getPlaybackRegions())
+        if (! previousSnapshot->isSelected (playbackRegion))
+            change.addedPlaybackRegions.push_back (playbackRegion);
+
+    for (auto* playbackRegion : previousSnapshot->getPlaybackRegions())
+        if (! selectionSnapshot->isSelected (playbackRegion))
+            change.removedPlaybackRegions.push_back (playbackRegion);
+
+    for (auto* regionSequence : selectionSnapshot->getRegionSequences())
+        if (! previousSnapshot->isSelected (regionSequence))
+            change.addedRegionSequences.push_back (regionSequence);
+
+    for (auto* regionSequence : previousSnapshot->getRegionSequences())
+        if (! selectionSnapshot->isSelected (regionSequence))
+            change.removedRegionSequences.push_back (regionSequence);
+
+    const auto* previousTimeRange = previousSnapshot->getTimeRange();
+    const auto* currentTimeRange = selectionSnapshot->getTimeRange();
+    change.timeRangeChanged = (previousTimeRange == nullptr) != (currentTimeRange == nullptr)
+                           || (currentTimeRange != nullptr && (previousTimeRange->start != currentTimeRange->start
+                                                               || previousTimeRange->duration != currentTimeRange->duration));
+
     listeners.callExpectingUnregistration ([&] (Listener& l)
     {
         l.onNewSelection (*viewSelection);
     });
+
+    listeners.callExpectingUnregistration ([&] (Listener& l)
+    {
+        l.onSelectionChanged (change);
+    });
 }
 
 void ARAEditorView::doNotifyHideRegionSequences (std::vector<ARA::PlugIn::RegionSequence*> const& regionSequences) noexcept
 {
+    const auto hiddenRegionSequences = ARA::vector_cast<ARARegionSequence*> (regionSequences);
+    std::unordered_set<ARARegionSequence*> newHiddenRegionSequenceSet (hiddenRegionSequences.begin(), hiddenRegionSequences.end());
+
+    HiddenRegionSequencesChange change;
+
+    for (auto* regionSequence : hiddenRegionSequences)
+        if (hiddenRegionSequenceSet.count (regionSequence) == 0)
+            change.hiddenRegionSequences.push_back (regionSequence);
+
+    for (auto* regionSequence : hiddenRegionSequenceSet)
+        if (newHiddenRegionSequenceSet.count (regionSequence) == 0)
+            change.shownRegionSequences.push_back (regionSequence);
+
+    hiddenRegionSequenceSet = std::move (newHiddenRegionSequenceSet);
+
+    listeners.callExpectingUnregistration ([&] (Listener& l)
+    {
+        l.onHideRegionSequences (hiddenRegionSequences);
+    });
+
     listeners.callExpectingUnregistration ([&] (Listener& l)
     {
-        l.onHideRegionSequences (ARA::vector_cast<ARARegionSequence*> (regionSequences));
+        l.onHiddenRegionSequencesChanged (change);
     });
 }
 
@@ -22,12 +22,21 @@ public:
         @param maximumSamplesPerBlock   The maximum number of samples that will be in the blocks sent to process() method.
         @param numChannels              The number of channels that the process() method will be expected to handle.
         @param alwaysNonRealtime        True if this renderer is never used in realtime (e.g. if providing data for views only).
+        @param precision                The precision of the buffers that will be sent to the process() method.
+                                        If overriding this, make sure you call the base class implementation,
+                                        which prepares the conversion used by the default double precision processBlock().
     */
-    // TODO JUCE_ARA if adding 64 bit support, we need to add bool doublePrecisionProcessing here.
-    virtual void prepareToPlay (double sampleRate, int maximumSamplesPerBlock, int numChannels, bool alwaysNonRealtime = false) { ignoreUnused (sampleRate, maximumSamplesPerBlock, numChannels, alwaysNonRealtime); }
+    virtual void prepareToPlay (double sampleRate, int maximumSamplesPerBlock, int numChannels, bool alwaysNonRealtime = false,
+                                AudioProcessor::ProcessingPrecision precision = AudioProcessor::singlePrecision);
 
     /** Frees render ressources allocated in prepareToPlay(). */
-    virtual void releaseResources() {}
+    virtual void releaseResources();
+
+    /** Returns the precision that was passed to prepareToPlay(). */
+    AudioProcessor::ProcessingPrecision getProcessingPrecision() const noexcept { return processingPrecision; }
+
+    /** Returns true if the renderer has been prepared for double precision processing. */
+    bool isUsingDoublePrecision() const noexcept { return processingPrecision == AudioProcessor::doublePrecision; }
 
     /** Resets the internal state variables of the renderer. */
     virtual void reset() {}
@@ -45,11 +54,21 @@ public:
     // TODO JUCE_ARA There is an API in VST3 now to skip costly calculations for those members of positionInfo
     //               which we do not need in ARA, but this is not yet supported in JUCE...
     virtual bool processBlock (AudioBuffer<float>& buffer, bool isNonRealtime, const AudioPlayHead::CurrentPositionInfo& positionInfo) noexcept = 0;
-    
-    // TODO JUCE_ARA: should we support 64 bit precision? If so, we should require clients to do both
-    //                variants or offer a default implementation of for double that falls back to float
-    //                (this might need to allocate a buffer for conversion during prepareToPlay...)?
-//  virtual bool processBlock (AudioBuffer<double>& buffer, bool isNonRealtime, const AudioPlayHead::CurrentPositionInfo& positionInfo) = 0;
+
+    /** Renders the output into the given double precision buffer, see the float variant for details.
+
+        The default implementation converts the buffer to single precision, using a buffer that is allocated
+        in prepareToPlay() if double precision has been requested, calls the float variant and converts
+        the result back. Renderers should override this to process double precision buffers natively,
+        which avoids both the copies and the loss of precision.
+        Note that since this is an overload, subclasses overriding only one of the variants may need
+        a using declaration to keep the other one visible.
+    */
+    virtual bool processBlock (AudioBuffer<double>& buffer, bool isNonRealtime, const AudioPlayHead::CurrentPositionInfo& positionInfo) noexcept;
+
+private:
+    AudioProcessor::ProcessingPrecision processingPrecision { AudioProcessor::singlePrecision };
+    AudioBuffer<float> doublePrecisionConversionBuffer;
 };
 
 //==============================================================================
@@ -62,10 +81,14 @@ public:
     @tags{ARA}
 */
 class JUCE_API  ARAPlaybackRenderer   : public ARA::PlugIn::PlaybackRenderer,
-                                        public ARARenderer
+                                        public ARARenderer,
+                                        private ARAPlaybackRegion::Listener,
+                                        private ARAAudioSource::Listener,
+                                        private AsyncUpdater
 {
 public:
     using ARA::PlugIn::PlaybackRenderer::PlaybackRenderer;
+    ~ARAPlaybackRenderer() override;
 
     // overloading inherited templated getters to default to juce versions of the returned classes
     template <typename DocumentController_t = ARADocumentController>
@@ -73,13 +96,341 @@ public:
     template <typename PlaybackRegion_t = ARAPlaybackRegion>
     std::vector<PlaybackRegion_t*> const& getPlaybackRegions() const noexcept { return ARA::PlugIn::PlaybackRenderer::getPlaybackRegions<PlaybackRegion_t>(); }
 
-#if ARA_VALIDATE_API_CALLS
+    void prepareToPlay (double sampleRate, int maximumSamplesPerBlock, int numChannels, bool alwaysNonRealtime = false,
+                        AudioProcessor::ProcessingPrecision precision = AudioProcessor::singlePrecision) override;
+    void releaseResources() override;
+
+    using ARARenderer::processBlock;
+
     void addPlaybackRegion (ARA::ARAPlaybackRegionRef playbackRegionRef) noexcept override;
     void removePlaybackRegion (ARA::ARAPlaybackRegionRef playbackRegionRef) noexcept override;
+#if ARA_VALIDATE_API_CALLS
     AudioProcessorARAExtension* araExtension {};
 #endif
 
+    /** Calls the given function for each playback region that overlaps the given range of playback
+        samples, in the order of the regions' start positions.
+
+        The callback is invoked as callback (ARAPlaybackRegion*, Range<int64> regionSampleRange), where
+        the region sample range is the result of getSampleRange (sampleRate, true) as of the last update.
+
+        This is realtime safe and only touches the regions that are actually overlapping, so it should
+        be used instead of iterating over getPlaybackRegions() in processBlock(). It relies on an index
+        of the region sample ranges that is rebuilt on the message thread whenever regions are added or
+        removed, and once after any number of changes to their properties or content, and that is
+        updated lock-free.
+        Since sample ranges depend on the sample rate, the index is only available after prepareToPlay().
+    */
+    template <typename Callback>
+    void forEachPlaybackRegionOverlapping (Range<int64> sampleRange, Callback&& callback) const
+    {
+        const ARAReadEpoch::ScopedRead scopedRead (playbackRegionIndexEpoch);
+
+        auto forwardToCallback = [&callback] (const PreparedPlaybackRegion& preparedRegion)
+        {
+            callback (preparedRegion.playbackRegion, preparedRegion.sampleRange);
+        };
+
+        if (auto* index = playbackRegionIndex.load())
+            index->forEachOverlapping (sampleRange, forwardToCallback);
+    }
+
+    //==============================================================================
+    /** The state of a playback region that is resolved on the message thread for rendering,
+        see forEachPreparedPlaybackRegionOverlapping().
+    */
+    struct PreparedPlaybackRegion
+    {
+        /** The playback region. */
+        ARAPlaybackRegion* playbackRegion;
+
+        /** The range of playback samples covered by the region, including head and tail time. */
+        Range<int64> sampleRange;
+
+        /** The range of playback samples covered by the region, excluding head and tail time. */
+        Range<int64> playbackSampleRange;
+
+        /** The range of audio modification samples played back by the region, in samples of the reader:
+            if the reader converts the sample rate, this is using the sample rate passed to prepareToPlay(),
+            otherwise the sample rate of the audio source.
+        */
+        Range<int64> modificationSampleRange;
+
+        /** The offset to add to a playback sample position to obtain the matching audio modification sample position. */
+        int64 modificationSampleOffset;
+
+        /** The reader for the samples of the region's audio source, or nullptr if prepareAudioSourceReaders() has not been called.
+            While an OfflineRenderJob is rendering, this may be a reader serving the samples prefetched by the job.
+        */
+        AudioFormatReader* reader;
+
+        /** The index of the reader in the dense table of prepared readers, in the range 0 to getNumPreparedAudioSourceReaders(),
+            or -1 if there is no reader. This can be used to look up any per audio source state of the renderer.
+        */
+        int readerIndex;
+
+        /** True if the sample rate or channel count of the audio source differ from the values passed to
+            prepareToPlay(), and the reader is converting the samples accordingly.
+        */
+        bool isConverted;
+
+        /** A number that changes whenever the reader is recreated, i.e. whenever the samples of the audio
+            source may have changed. This can be used to invalidate any state derived from the samples.
+        */
+        uint32 readerVersion;
+
+        /** The ratio of the region's duration in playback time to its duration in audio modification time if
+            ARAPlaybackRegion::isTimestretchEnabled() is true and the durations differ, 1.0 otherwise.
+            It is derived from the sample ranges, so that stretching modificationSampleRange by this factor
+            exactly covers playbackSampleRange. See ARATimeStretchStage for rendering stretched regions.
+        */
+        double timeStretchFactor;
+    };
+
+    /** Creates a reader for each audio source that is played back by the renderer's playback regions.
+
+        This should be called from prepareToPlay() overrides after calling the base class implementation.
+        If the sample rate or channel count of an audio source differ from the values passed to prepareToPlay(),
+        its reader is wrapped in an ARAConvertingAudioReader, so all readers provide samples in the render format.
+        Unless prepareToPlay() was called with alwaysNonRealtime set to true, each reader is wrapped in a
+        BufferingAudioReader that is fed by a thread shared by all renderers.
+        The readers are released in releaseResources(), and are recreated as needed if the samples of their
+        audio source change.
+    */
+    void prepareAudioSourceReaders();
+
+    /** Returns the number of readers created by prepareAudioSourceReaders(). */
+    int getNumPreparedAudioSourceReaders() const noexcept { return (int) preparedAudioSourceReaders.size(); }
+
+    /** Like forEachPlaybackRegionOverlapping(), but calls back with the PreparedPlaybackRegion of each region.
+
+        This allows for rendering without looking up any per-region or per-audio source state: the sample
+        ranges, offsets and readers are resolved on the message thread whenever the regions change, and are
+        updated lock-free. The timeout of the buffering readers is only updated if isNonRealtime changes.
+        Intended to be called from processBlock() only.
+    */
+    template <typename Callback>
+    void forEachPreparedPlaybackRegionOverlapping (Range<int64> sampleRange, bool isNonRealtime, Callback&& callback) const
+    {
+        const ARAReadEpoch::ScopedRead scopedRead (playbackRegionIndexEpoch);
+
+        if (auto* index = playbackRegionIndex.load())
+        {
+            index->setReadTimeout (isNonRealtime ? nonRealtimeReadTimeoutMs : 0);
+            index->forEachOverlapping (sampleRange, callback);
+        }
+    }
+
+    //==============================================================================
+    /**
+        Renders a range of the renderer's playback samples offline, with the samples of the audio
+        sources being prefetched ahead of the rendering.
+
+        When bouncing, processBlock() is called block by block without any knowledge of the range being
+        rendered, so the readers have to request the samples of each block from the host while the block
+        is rendered. A render job instead precomputes a schedule for the entire range upfront: the range
+        is split into windows, and for each window the playback regions overlapping it are resolved into
+        a single contiguous range per audio source, covering all regions of that source in the window.
+        These ranges are read with one large sequential read each on a pool of prefetch threads, a few
+        windows ahead of the rendering, so that the bounce is limited by the throughput of the host's
+        sample access and of the rendering rather than by the latency of many small reads.
+
+        While the job exists, the PreparedPlaybackRegion::reader of each region that is part of the
+        schedule serves the prefetched samples, falling back to the prepared reader for any samples
+        outside of them (see getNumPrefetchMisses()). If the samples of an audio source change while
+        the job is rendering, its reader is recreated as usual and the prefetched samples are ignored.
+        Since the job only replaces the readers, the rendering is done by the renderer's regular
+        processBlock() implementation.
+
+        The renderer must have been prepared, including prepareAudioSourceReaders(), and must not be used
+        for any other rendering while the job exists. The job must be created and destroyed on the message
+        thread, and renderNextBlock() can be called from any single thread.
+
+        @tags{ARA}
+    */
+    class JUCE_API  OfflineRenderJob
+    {
+    public:
+        struct Options
+        {
+            /** The number of threads reading the samples of the audio sources. */
+            int numPrefetchThreads = 4;
+
+            /** The length of the windows that the samples are prefetched for. */
+            double windowLengthInSeconds = 4.0;
+
+            /** The number of windows that are prefetched ahead of the window being rendered. At most
+                numWindowsAhead + 1 windows of samples are held in memory at any time.
+            */
+            int numWindowsAhead = 2;
+        };
+
+        /** Creates a job for rendering the given range of playback samples, and starts prefetching. */
+        OfflineRenderJob (ARAPlaybackRenderer& renderer, Range<int64> sampleRange);
+        OfflineRenderJob (ARAPlaybackRenderer& renderer, Range<int64> sampleRange, const Options& options);
+        ~OfflineRenderJob();
+
+        /** Renders the next samples of the range into the given buffer, which must not exceed the
+            maximum block size and channel count that the renderer was prepared with.
+
+            If fewer samples than the size of the buffer remain, the rest of the buffer is cleared.
+            Returns the result of processBlock(), or false if the job is already finished.
+        */
+        bool renderNextBlock (AudioBuffer<float>& buffer);
+
+        /** Returns true once the entire range has been rendered. */
+        bool isFinished() const noexcept                    { return nextSamplePosition >= sampleRange.getEnd(); }
+
+        /** Returns the range of playback samples being rendered. */
+        Range<int64> getSampleRange() const noexcept        { return sampleRange; }
+
+        /** Returns the playback sample position that the next call to renderNextBlock() will render. */
+        int64 getNextSamplePosition() const noexcept        { return nextSamplePosition; }
+
+        /** Returns the number of audio sources that samples are prefetched for. */
+        int getNumPrefetchedAudioSources() const noexcept   { return numPrefetchedAudioSources; }
+
+        /** Returns the number of reads that could not be served from the prefetched samples so far. */
+        int getNumPrefetchMisses() const noexcept           { return numPrefetchMisses.load(); }
+
+    private:
+        struct PrefetchSource;
+        struct SourceRead;
+        struct Window;
+        class PrefetchedReader;
+
+        void createSchedule (const Options& options);
+        void scheduleWindows (int lastWindowIndex);
+        void updateWindows();
+        std::vector<AudioFormatReader*> getPrefetchedReaders() const;
+
+        ARAPlaybackRenderer& renderer;
+        const Range<int64> sampleRange;
+        int64 nextSamplePosition;
+        int64 windowLength { 0 };
+        int numWindowsAhead { 0 };
+        int numPrefetchedAudioSources { 0 };
+        std::atomic<int> numPrefetchMisses { 0 };
+
+        std::vector<std::unique_ptr<PrefetchSource>> prefetchSources;
+        std::vector<std::unique_ptr<Window>> windows;
+        int numScheduledWindows { 0 };
+        int numReleasedWindows { 0 };
+        std::unique_ptr<ThreadPool> prefetchPool;
+        AudioPlayHead::CurrentPositionInfo positionInfo;
+
+        friend class ARAPlaybackRenderer;
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineRenderJob)
+    };
+
 private:
+    //==============================================================================
+    struct PreparedAudioSourceReader
+    {
+        ARAAudioSource* audioSource;
+        std::unique_ptr<AudioFormatReader> reader;
+        ARAAudioSourceReader* sourceReader;
+        BufferingAudioReader* bufferingReader;
+        bool isConverted;
+        bool needsUpdate;
+        uint32 version;
+    };
+
+    // We're subclassing here only to provide a proper default c'tor for our shared ressource
+    class SharedReadThread   : public TimeSliceThread
+    {
+    public:
+        SharedReadThread();
+    };
+
+    //==============================================================================
+    // An immutable interval tree of region sample ranges, implicitly stored in a flat array
+    // that is sorted by start sample, with each element also storing the maximum end sample
+    // of its subtree.
+    // The readers of the prepared regions are owned by the renderer or by its offline render job.
+    class PlaybackRegionIndex
+    {
+    public:
+        PlaybackRegionIndex (const std::vector<ARAPlaybackRegion*>& playbackRegions, double sampleRate,
+                             const std::vector<PreparedAudioSourceReader>& preparedAudioSourceReaders,
+                             const std::vector<AudioFormatReader*>& prefetchedReaders);
+
+        template <typename Callback>
+        void forEachOverlapping (Range<int64> range, Callback& callback) const
+        {
+            visit (0, (int) entries.size(), range, callback);
+        }
+
+        void setReadTimeout (int timeoutMs) const noexcept;
+
+    private:
+        struct Entry
+        {
+            PreparedPlaybackRegion preparedRegion;
+            int64 maxEndInSubtree;
+        };
+
+        int64 updateMaxEnd (int begin, int end) noexcept;
+
+        template <typename Callback>
+        void visit (int begin, int end, Range<int64> range, Callback& callback) const
+        {
+            while (begin < end)
+            {
+                const auto mid = begin + (end - begin) / 2;
+                const auto& entry = entries[(size_t) mid];
+
+                if (entry.maxEndInSubtree <= range.getStart())
+                    return;
+
+                visit (begin, mid, range, callback);
+
+                if (entry.preparedRegion.sampleRange.getStart() >= range.getEnd())
+                    return;
+
+                if (entry.preparedRegion.sampleRange.getEnd() > range.getStart())
+                    callback (entry.preparedRegion);
+
+                begin = mid + 1;
+            }
+        }
+
+        std::vector<Entry> entries;
+        std::vector<BufferingAudioReader*> bufferingReaders;
+        mutable int readTimeoutMs { -1 };
+    };
+
+    void rebuildPlaybackRegionIndex();
+
+    void createAudioSourceReader (PreparedAudioSourceReader& preparedReader);
+    void releaseAudioSourceReaders();
+
+    void didUpdatePlaybackRegionProperties (ARAPlaybackRegion* playbackRegion) override;
+    void didUpdatePlaybackRegionContent (ARAPlaybackRegion* playbackRegion, ARAContentUpdateScopes scopeFlags) override;
+
+    void didUpdateAudioSourceProperties (ARAAudioSource* audioSource) override;
+    void doUpdateAudioSourceContent (ARAAudioSource* audioSource, ARAContentUpdateScopes scopeFlags) override;
+    void doUpdateAudioSourceContentInRange (ARAAudioSource* audioSource, Range<double> affectedTimeRange, ARAContentUpdateScopes scopeFlags) override;
+    void willDestroyAudioSource (ARAAudioSource* audioSource) override;
+
+    void handleAsyncUpdate() override;
+
+    double playbackRegionIndexSampleRate { 0.0 };
+    int preparedMaximumSamplesPerBlock { 0 };
+    int preparedNumChannels { 0 };
+    bool preparedAlwaysNonRealtime { false };
+
+    std::atomic<PlaybackRegionIndex*> playbackRegionIndex { nullptr };
+    ARAReadEpoch playbackRegionIndexEpoch;
+    bool playbackRegionIndexNeedsRebuild { false };
+
+    // the thread must outlive the buffering readers it is serving
+    std::unique_ptr<SharedResourcePointer<SharedReadThread>> sharedReadThread;
+    std::vector<PreparedAudioSourceReader> preparedAudioSourceReaders;
+    OfflineRenderJob* offlineRenderJob { nullptr };
+
+    static constexpr int nonRealtimeReadTimeoutMs = 100;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ARAPlaybackRenderer)
 };
 
@@ -110,6 +461,7 @@ public:
     // If you're overriding this to implement actual audio preview, remember to test
     // isNonRealtime of the process context - typically preview is limited to realtime!
     bool processBlock (AudioBuffer<float>& /*buffer*/, bool /*isNonRealtime*/, const AudioPlayHead::CurrentPositionInfo& /*positionInfo*/) noexcept override { return true; }
+    bool processBlock (AudioBuffer<double>& /*buffer*/, bool /*isNonRealtime*/, const AudioPlayHead::CurrentPositionInfo& /*positionInfo*/) noexcept override { return true; }
 
 private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ARAEditorRenderer)
@@ -139,6 +491,83 @@ public:
     void doNotifySelection (const ARA::PlugIn::ViewSelection* currentSelection) noexcept override;
     void doNotifyHideRegionSequences (std::vector<ARA::PlugIn::RegionSequence*> const& regionSequences) noexcept override;
 
+    //==============================================================================
+    /** An immutable copy of a selection of the host, with hash sets for testing in constant time
+        whether a playback region or region sequence is selected.
+
+        The editor view creates a new snapshot whenever the host changes the selection, see
+        getSelectionSnapshot(). Since snapshots are never modified, they can be kept around and
+        shared without copying, e.g. to compare a later selection against.
+    */
+    class JUCE_API  SelectionSnapshot
+    {
+    public:
+        /** Creates an empty selection. */
+        SelectionSnapshot() = default;
+
+        /** Creates a snapshot of the given selection. */
+        explicit SelectionSnapshot (const ARAViewSelection& viewSelection);
+
+        /** Returns the selected playback regions, in the order provided by the host. */
+        const std::vector<ARAPlaybackRegion*>& getPlaybackRegions() const noexcept     { return playbackRegions; }
+
+        /** Returns the selected region sequences, in the order provided by the host. */
+        const std::vector<ARARegionSequence*>& getRegionSequences() const noexcept     { return regionSequences; }
+
+        /** Returns the selected time range, or nullptr if the selection does not include a time range. */
+        const ARA::ARAContentTimeRange* getTimeRange() const noexcept                   { return hasTimeRange ? &timeRange : nullptr; }
+
+        /** Returns true if the playback region is part of the selection. */
+        bool isSelected (ARAPlaybackRegion* playbackRegion) const                       { return playbackRegionSet.count (playbackRegion) != 0; }
+
+        /** Returns true if the region sequence is part of the selection. */
+        bool isSelected (ARARegionSequence* regionSequence) const                       { return regionSequenceSet.count (regionSequence) != 0; }
+
+    private:
+        std::vector<ARAPlaybackRegion*> playbackRegions;
+        std::vector<ARARegionSequence*> regionSequences;
+        std::unordered_set<ARAPlaybackRegion*> playbackRegionSet;
+        std::unordered_set<ARARegionSequence*> regionSequenceSet;
+        ARA::ARAContentTimeRange timeRange { 0.0, 0.0 };
+        bool hasTimeRange { false };
+    };
+
+    /** Returns the current selection of the host. */
+    std::shared_ptr<const SelectionSnapshot> getSelectionSnapshot() const noexcept      { return selectionSnapshot; }
+
+    /** The difference between two consecutive selections, see Listener::onSelectionChanged().
+
+        The objects in the removed lists may have been destroyed by the host since they were
+        selected, so they must only be used for looking up any state kept for them.
+    */
+    struct SelectionChange
+    {
+        const SelectionSnapshot& previousSelection;
+        const SelectionSnapshot& currentSelection;
+
+        std::vector<ARAPlaybackRegion*> addedPlaybackRegions;
+        std::vector<ARAPlaybackRegion*> removedPlaybackRegions;
+        std::vector<ARARegionSequence*> addedRegionSequences;
+        std::vector<ARARegionSequence*> removedRegionSequences;
+
+        /** True if the selected time range has been added, removed or changed. */
+        bool timeRangeChanged;
+    };
+
+    /** Returns true if the region sequence is currently hidden in the host UI. */
+    bool isHidden (ARARegionSequence* regionSequence) const                             { return hiddenRegionSequenceSet.count (regionSequence) != 0; }
+
+    /** The difference between two consecutive sets of hidden region sequences, see
+        Listener::onHiddenRegionSequencesChanged(). As for SelectionChange, the shown region
+        sequences may have been destroyed since they were hidden.
+    */
+    struct HiddenRegionSequencesChange
+    {
+        std::vector<ARARegionSequence*> hiddenRegionSequences;
+        std::vector<ARARegionSequence*> shownRegionSequences;
+    };
+
+    //==============================================================================
     class JUCE_API  Listener
     {
     public:
@@ -150,10 +579,25 @@ public:
         */
         virtual void onNewSelection (const ARA::PlugIn::ViewSelection& viewSelection) {}
 
+        /** Called when the editor view's selection changes, after onNewSelection().
+
+            Rather than rescanning the entire selection, listeners can update only the objects
+            that have been added to or removed from the selection, or test their own objects
+            against the hash sets of SelectionChange::currentSelection.
+            @param change The difference between the previous and the current selection.
+        */
+        virtual void onSelectionChanged (const SelectionChange& change) {}
+
         /** Called when region sequences are flagged as hidden in the host UI.
             @param regionSequences A vector containing all hidden region sequences. 
         */
         virtual void onHideRegionSequences (std::vector<ARARegionSequence*> const& regionSequences) {}
+
+        /** Called when region sequences are flagged as hidden in the host UI, after onHideRegionSequences().
+            Use ARAEditorView::isHidden() for testing whether a region sequence is hidden.
+            @param change The region sequences that have been hidden or shown.
+        */
+        virtual void onHiddenRegionSequencesChanged (const HiddenRegionSequencesChange& change) {}
        ARA_DISABLE_UNREFERENCED_PARAMETER_WARNING_END
     };
 
@@ -165,6 +609,8 @@ public:
 
 private:
     ListenerList<Listener> listeners;
+    std::shared_ptr<const SelectionSnapshot> selectionSnapshot { std::make_shared<const SelectionSnapshot>() };
+    std::unordered_set<ARARegionSequence*> hiddenRegionSequenceSet;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ARAEditorView)
 };
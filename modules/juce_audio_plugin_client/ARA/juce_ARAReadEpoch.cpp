@@ -0,0 +1,18 @@
+#include "juce_ARAReadEpoch.h"
+
+namespace juce
+{
+
+void ARAReadEpoch::synchronise() noexcept
+{
+    const ScopedLock sl (writerLock);
+
+    // new readers will enter the other slot from now on, so we only need to wait
+    // for those readers that entered before the epoch was advanced
+    const auto previousSlot = currentEpoch.fetch_add (1) & 1;
+
+    while (readerCounts[previousSlot].load() != 0)
+        Thread::yield();
+}
+
+} // namespace juce
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A minimal epoch based reclamation scheme (a simple form of RCU) used by the ARA readers.
+
+    Reading threads wrap their access to shared state in a ScopedRead, which never blocks.
+    Writing threads publish a replacement of the shared state (typically by exchanging an atomic
+    pointer), then call synchronise() before reclaiming the previous state: this waits until all
+    reads that might still be using the previous state have finished.
+
+    Unlike a ReadWriteLock, readers therefore never fail just because a writer is active - they
+    will either see the old or the new state.
+
+    @tags{ARA}
+*/
+class JUCE_API  ARAReadEpoch
+{
+public:
+    ARAReadEpoch() = default;
+
+    /** RAII helper that marks the calling thread as reading for the lifetime of the object. */
+    class ScopedRead
+    {
+    public:
+        explicit ScopedRead (const ARAReadEpoch& owner) noexcept
+            : epoch (owner)
+        {
+            for (;;)
+            {
+                slot = epoch.currentEpoch.load() & 1;
+                epoch.readerCounts[slot].fetch_add (1);
+
+                if ((epoch.currentEpoch.load() & 1) == slot)
+                    break;
+
+                epoch.readerCounts[slot].fetch_sub (1);
+            }
+        }
+
+        ~ScopedRead() noexcept
+        {
+            epoch.readerCounts[slot].fetch_sub (1);
+        }
+
+    private:
+        const ARAReadEpoch& epoch;
+        uint32 slot;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedRead)
+    };
+
+    /** Waits until all readers that may have observed state prior to this call have finished.
+        Must not be called from inside a ScopedRead of the same epoch.
+    */
+    void synchronise() noexcept;
+
+private:
+    CriticalSection writerLock;
+    mutable std::atomic<uint32> currentEpoch { 0 };
+    mutable std::atomic<int> readerCounts[2] { { 0 }, { 0 } };
+
+    JUCE_DECLARE_NON_COPYABLE (ARAReadEpoch)
+};
+
+} // namespace juce
@@ -0,0 +1,255 @@
+#include "juce_ARATempoMap.h"
+
+namespace juce
+{
+
+ARATempoMap::ARATempoMap()
+    : ARATempoMap ({}, {})
+{}
+
+ARATempoMap::ARATempoMap (const std::vector<ARA::ARAContentTempoEntry>& tempoEntriesToUse,
+                          const std::vector<ARA::ARAContentBarSignature>& barSignaturesToUse)
+{
+    if (tempoEntriesToUse.size() >= 2)
+    {
+        tempoEntries = tempoEntriesToUse;
+        tempoEntriesAvailable = true;
+    }
+    else
+    {
+        tempoEntries = { { 0.0, 0.0 }, { 0.5, 1.0 } };
+    }
+
+    if (! barSignaturesToUse.empty())
+    {
+        barSignatures.reserve (barSignaturesToUse.size());
+
+        for (const auto& barSignature : barSignaturesToUse)
+        {
+            jassert (barSignature.numerator > 0 && barSignature.denominator > 0);
+
+            // the beat position is accumulated from the previous bar signature, or extrapolated back to quarter 0
+            const auto beatPosition = barSignatures.empty() ? barSignature.position * barSignature.denominator / 4.0
+                                                            : barSignatures.back().beatPosition + (barSignature.position - barSignatures.back().quarterPosition)
+                                                                                                    * barSignatures.back().denominator / 4.0;
+
+            barSignatures.push_back ({ (int) barSignature.numerator, (int) barSignature.denominator, barSignature.position, beatPosition });
+        }
+
+        barSignaturesAvailable = true;
+    }
+    else
+    {
+        barSignatures = { { 4, 4, 0.0, 0.0 } };
+    }
+}
+
+//==============================================================================
+
+const ARA::ARAContentTempoEntry* ARATempoMap::getTempoSegmentForTime (double timePosition) const noexcept
+{
+    // segments are formed by consecutive entries, so the search only needs to consider the inner entries
+    const auto it = std::upper_bound (tempoEntries.begin() + 1, tempoEntries.end() - 1, timePosition,
+                                      [] (double position, const ARA::ARAContentTempoEntry& entry) { return position < entry.timePosition; });
+    return &*(it - 1);
+}
+
+const ARA::ARAContentTempoEntry* ARATempoMap::getTempoSegmentForQuarter (double quarterPosition) const noexcept
+{
+    const auto it = std::upper_bound (tempoEntries.begin() + 1, tempoEntries.end() - 1, quarterPosition,
+                                      [] (double position, const ARA::ARAContentTempoEntry& entry) { return position < entry.quarterPosition; });
+    return &*(it - 1);
+}
+
+double ARATempoMap::getQuarterForTime (double timePosition) const noexcept
+{
+    const auto* segment = getTempoSegmentForTime (timePosition);
+    const auto* next = segment + 1;
+
+    return segment->quarterPosition + (timePosition - segment->timePosition) * (next->quarterPosition - segment->quarterPosition)
+                                                                             / (next->timePosition - segment->timePosition);
+}
+
+double ARATempoMap::getTimeForQuarter (double quarterPosition) const noexcept
+{
+    const auto* segment = getTempoSegmentForQuarter (quarterPosition);
+    const auto* next = segment + 1;
+
+    return segment->timePosition + (quarterPosition - segment->quarterPosition) * (next->timePosition - segment->timePosition)
+                                                                                / (next->quarterPosition - segment->quarterPosition);
+}
+
+double ARATempoMap::getTempoForTime (double timePosition) const noexcept
+{
+    const auto* segment = getTempoSegmentForTime (timePosition);
+    const auto* next = segment + 1;
+
+    return 60.0 * (next->quarterPosition - segment->quarterPosition) / (next->timePosition - segment->timePosition);
+}
+
+//==============================================================================
+
+const ARATempoMap::BarSignature& ARATempoMap::getBarSignatureForQuarter (double quarterPosition) const noexcept
+{
+    const auto it = std::upper_bound (barSignatures.begin() + 1, barSignatures.end(), quarterPosition,
+                                      [] (double position, const BarSignature& barSignature) { return position < barSignature.quarterPosition; });
+    return *(it - 1);
+}
+
+double ARATempoMap::getBeatForQuarter (double quarterPosition) const noexcept
+{
+    const auto& barSignature = getBarSignatureForQuarter (quarterPosition);
+    return barSignature.beatPosition + (quarterPosition - barSignature.quarterPosition) * barSignature.denominator / 4.0;
+}
+
+double ARATempoMap::getQuarterForBeat (double beatPosition) const noexcept
+{
+    const auto it = std::upper_bound (barSignatures.begin() + 1, barSignatures.end(), beatPosition,
+                                      [] (double position, const BarSignature& barSignature) { return position < barSignature.beatPosition; });
+    const auto& barSignature = *(it - 1);
+
+    return barSignature.quarterPosition + (beatPosition - barSignature.beatPosition) * 4.0 / barSignature.denominator;
+}
+
+double ARATempoMap::getBarStartForQuarter (double quarterPosition) const noexcept
+{
+    const auto& barSignature = getBarSignatureForQuarter (quarterPosition);
+    const auto barLength = barSignature.numerator * 4.0 / barSignature.denominator;
+
+    return barSignature.quarterPosition + std::floor ((quarterPosition - barSignature.quarterPosition) / barLength) * barLength;
+}
+
+double ARATempoMap::getBeatDistanceFromBarStartForQuarter (double quarterPosition) const noexcept
+{
+    const auto& barSignature = getBarSignatureForQuarter (quarterPosition);
+    return (quarterPosition - getBarStartForQuarter (quarterPosition)) * barSignature.denominator / 4.0;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ARATempoMapTests  : public UnitTest
+{
+public:
+    ARATempoMapTests()
+        : UnitTest ("ARATempoMap", UnitTestCategories::audio)
+    {}
+
+    void runTest() override
+    {
+        // 120 BPM for 2 seconds, then 60 BPM for 2 seconds, then 180 BPM
+        const std::vector<ARA::ARAContentTempoEntry> tempoEntries { { 0.0, 0.0 }, { 2.0, 4.0 }, { 4.0, 6.0 }, { 5.0, 9.0 } };
+
+        // 4/4, then a single bar of 6/8, then 3/4
+        const std::vector<ARA::ARAContentBarSignature> barSignatures { { 4, 4, 0.0 }, { 6, 8, 4.0 }, { 3, 4, 7.0 } };
+
+        beginTest ("Tempo changes");
+        {
+            const ARATempoMap map (tempoEntries, barSignatures);
+
+            expect (map.hasTempoEntries());
+            expect (map.hasBarSignatures());
+
+            expectWithinAbsoluteError (map.getQuarterForTime (1.0), 2.0, tolerance);
+            expectWithinAbsoluteError (map.getQuarterForTime (3.0), 5.0, tolerance);
+            expectWithinAbsoluteError (map.getQuarterForTime (4.5), 7.5, tolerance);
+
+            expectWithinAbsoluteError (map.getTempoForTime (1.0), 120.0, tolerance);
+            expectWithinAbsoluteError (map.getTempoForTime (3.0), 60.0, tolerance);
+            expectWithinAbsoluteError (map.getTempoForTime (4.5), 180.0, tolerance);
+
+            expectWithinAbsoluteError (map.getBeatForQuarter (5.0), 6.0, tolerance);
+            expectWithinAbsoluteError (map.getBeatForQuarter (8.0), 11.0, tolerance);
+            expectWithinAbsoluteError (map.getQuarterForBeat (10.0), 7.0, tolerance);
+
+            expectWithinAbsoluteError (map.getBarStartForQuarter (5.5), 4.0, tolerance);
+            expectWithinAbsoluteError (map.getBeatDistanceFromBarStartForQuarter (5.5), 3.0, tolerance);
+            expectWithinAbsoluteError (map.getBarStartForQuarter (9.5), 7.0, tolerance);
+        }
+
+        beginTest ("Round trips across tempo changes");
+        {
+            const ARATempoMap map (tempoEntries, barSignatures);
+            constexpr double sampleRate = 44100.0;
+
+            for (double time = -2.0; time < 8.0; time += 0.125)
+            {
+                const auto quarter = map.getQuarterForTime (time);
+                expectWithinAbsoluteError (map.getTimeForQuarter (quarter), time, tolerance);
+
+                const auto beat = map.getBeatForTime (time);
+                expectWithinAbsoluteError (map.getTimeForBeat (beat), time, tolerance);
+                expectWithinAbsoluteError (map.getQuarterForBeat (beat), quarter, tolerance);
+
+                const auto sample = time * sampleRate;
+                expectWithinAbsoluteError (map.getQuarterForSample (sample, sampleRate), quarter, tolerance);
+                expectWithinAbsoluteError (map.getSampleForQuarter (quarter, sampleRate), sample, tolerance * sampleRate);
+            }
+        }
+
+        beginTest ("Positions outside of the entries are extrapolated");
+        {
+            const ARATempoMap map (tempoEntries, barSignatures);
+
+            // the first and last tempo segments are continued
+            expectWithinAbsoluteError (map.getQuarterForTime (-1.0), -2.0, tolerance);
+            expectWithinAbsoluteError (map.getTimeForQuarter (-2.0), -1.0, tolerance);
+            expectWithinAbsoluteError (map.getTempoForTime (-1.0), 120.0, tolerance);
+
+            expectWithinAbsoluteError (map.getQuarterForTime (6.0), 12.0, tolerance);
+            expectWithinAbsoluteError (map.getTimeForQuarter (12.0), 6.0, tolerance);
+            expectWithinAbsoluteError (map.getTempoForTime (6.0), 180.0, tolerance);
+
+            // the first bar signature is extrapolated backwards, the last one forwards
+            expect (map.getBarSignatureForQuarter (-3.0).numerator == 4);
+            expectWithinAbsoluteError (map.getBeatForQuarter (-3.0), -3.0, tolerance);
+            expectWithinAbsoluteError (map.getBarStartForQuarter (-3.0), -4.0, tolerance);
+
+            expect (map.getBarSignatureForQuarter (20.0).numerator == 3);
+            expectWithinAbsoluteError (map.getBeatForQuarter (20.0), 23.0, tolerance);
+            expectWithinAbsoluteError (map.getBarStartForQuarter (20.0), 19.0, tolerance);
+        }
+
+        beginTest ("Single entries");
+        {
+            // a single tempo entry does not define a tempo, so the default is used
+            const ARATempoMap map ({ { 1.0, 1.0 } }, { { 3, 4, 2.0 } });
+
+            expect (! map.hasTempoEntries());
+            expect (map.hasBarSignatures());
+
+            expectWithinAbsoluteError (map.getTempoForTime (-10.0), 120.0, tolerance);
+            expectWithinAbsoluteError (map.getTempoForTime (10.0), 120.0, tolerance);
+            expectWithinAbsoluteError (map.getQuarterForTime (1.5), 3.0, tolerance);
+            expectWithinAbsoluteError (map.getTimeForQuarter (-3.0), -1.5, tolerance);
+
+            // the only bar signature applies everywhere, with its bars continued back to quarter 0
+            expect (map.getBarSignatureForQuarter (0.0).numerator == 3);
+            expectWithinAbsoluteError (map.getBeatForQuarter (0.5), 0.5, tolerance);
+            expectWithinAbsoluteError (map.getBarStartForQuarter (0.5), -1.0, tolerance);
+            expectWithinAbsoluteError (map.getBarStartForQuarter (10.0), 8.0, tolerance);
+            expectWithinAbsoluteError (map.getBeatDistanceFromBarStartForQuarter (10.0), 2.0, tolerance);
+        }
+
+        beginTest ("Default map");
+        {
+            const ARATempoMap map;
+
+            expect (! map.hasTempoEntries());
+            expect (! map.hasBarSignatures());
+
+            expectWithinAbsoluteError (map.getQuarterForTime (3.0), 6.0, tolerance);
+            expectWithinAbsoluteError (map.getBarStartForQuarter (6.0), 4.0, tolerance);
+            expectWithinAbsoluteError (map.getBeatForTime (-0.5), -1.0, tolerance);
+        }
+    }
+
+private:
+    static constexpr double tolerance = 1.0e-9;
+};
+
+static ARATempoMapTests araTempoMapTests;
+
+#endif
+
+} // namespace juce
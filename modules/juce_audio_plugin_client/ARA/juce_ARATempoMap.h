@@ -0,0 +1,101 @@
+#pragma once
+
+#include <juce_audio_plugin_client/juce_audio_plugin_client.h>
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    An immutable snapshot of the tempo entries and bar signatures of an ARA musical context,
+    prepared for converting between time, samples, quarters and beats in O(log n).
+
+    Tempo entries map time positions to quarter positions, with a constant tempo between
+    consecutive entries. Positions outside of the entries are extrapolated using the tempo of
+    the first or last pair of entries respectively, matching ARA::TempoConverter.
+
+    Beats are counted in units of the denominator of the bar signature in effect at a given
+    position, i.e. a beat is a quarter note for 4/4, but an eighth note for 6/8. Beat 0 is at
+    quarter 0, as extrapolated backwards from the first bar signature, and the beat position of
+    each bar signature is accumulated when the map is built.
+
+    If the host does not provide tempo entries or bar signatures, the map falls back to a constant
+    tempo of 120 BPM and a 4/4 bar signature starting at quarter 0, see hasTempoEntries() and
+    hasBarSignatures().
+
+    Instances are typically obtained from ARAMusicalContext, which rebuilds its map whenever the
+    host updates the musical context content. Since a map is never changed after construction,
+    all functions can be called from any thread, including the audio thread.
+
+    @tags{ARA}
+*/
+class JUCE_API  ARATempoMap
+{
+public:
+    /** A bar signature, along with the beat position at which it starts. */
+    struct BarSignature
+    {
+        int numerator;
+        int denominator;
+        double quarterPosition;
+        double beatPosition;
+    };
+
+    /** Creates a map of 120 BPM in 4/4. */
+    ARATempoMap();
+
+    /** Creates a map from the given content, which is expected to be sorted by position as ARA
+        requires. Tempo entries are only used if there are at least two of them.
+    */
+    ARATempoMap (const std::vector<ARA::ARAContentTempoEntry>& tempoEntries,
+                 const std::vector<ARA::ARAContentBarSignature>& barSignatures);
+
+    /** Returns false if the map is using the default tempo because no tempo entries were available. */
+    bool hasTempoEntries() const noexcept                   { return tempoEntriesAvailable; }
+
+    /** Returns false if the map is using the default bar signature because no bar signatures were available. */
+    bool hasBarSignatures() const noexcept                  { return barSignaturesAvailable; }
+
+    //==============================================================================
+    double getQuarterForTime (double timePosition) const noexcept;
+    double getTimeForQuarter (double quarterPosition) const noexcept;
+
+    double getQuarterForSample (double samplePosition, double sampleRate) const noexcept    { return getQuarterForTime (samplePosition / sampleRate); }
+    double getSampleForQuarter (double quarterPosition, double sampleRate) const noexcept   { return getTimeForQuarter (quarterPosition) * sampleRate; }
+
+    /** Returns the tempo in quarters per minute at the given time position. */
+    double getTempoForTime (double timePosition) const noexcept;
+
+    //==============================================================================
+    double getBeatForQuarter (double quarterPosition) const noexcept;
+    double getQuarterForBeat (double beatPosition) const noexcept;
+
+    double getBeatForTime (double timePosition) const noexcept          { return getBeatForQuarter (getQuarterForTime (timePosition)); }
+    double getTimeForBeat (double beatPosition) const noexcept          { return getTimeForQuarter (getQuarterForBeat (beatPosition)); }
+
+    /** Returns the bar signature in effect at the given position, extrapolating the first one for earlier positions. */
+    const BarSignature& getBarSignatureForQuarter (double quarterPosition) const noexcept;
+
+    /** Returns the quarter position of the start of the bar that contains the given position. */
+    double getBarStartForQuarter (double quarterPosition) const noexcept;
+
+    /** Returns the distance of the given position from the start of its bar, in beats. */
+    double getBeatDistanceFromBarStartForQuarter (double quarterPosition) const noexcept;
+
+    //==============================================================================
+    const std::vector<ARA::ARAContentTempoEntry>& getTempoEntries() const noexcept     { return tempoEntries; }
+    const std::vector<BarSignature>& getBarSignatures() const noexcept                { return barSignatures; }
+
+private:
+    const ARA::ARAContentTempoEntry* getTempoSegmentForTime (double timePosition) const noexcept;
+    const ARA::ARAContentTempoEntry* getTempoSegmentForQuarter (double quarterPosition) const noexcept;
+
+    std::vector<ARA::ARAContentTempoEntry> tempoEntries;
+    std::vector<BarSignature> barSignatures;
+    bool tempoEntriesAvailable { false };
+    bool barSignaturesAvailable { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ARATempoMap)
+};
+
+} // namespace juce
@@ -0,0 +1,876 @@
+#include "juce_ARATimeStretcher.h"
+
+namespace juce
+{
+
+namespace ARATimeStretcherHelpers
+{
+    static int64 floorDiv (int64 numerator, int64 denominator) noexcept
+    {
+        return (numerator >= 0) ? numerator / denominator
+                                : -((denominator - 1 - numerator) / denominator);
+    }
+
+    // Rotates the unit phasor (re, im) by the phase of the given complex number, keeping its length
+    // at 1. If the number is too small to have a meaningful phase, the phasor is left unchanged.
+    static inline void rotatePhasor (float& re, float& im, float rotationRe, float rotationIm) noexcept
+    {
+        const auto rotatedRe = re * rotationRe - im * rotationIm;
+        const auto rotatedIm = re * rotationIm + im * rotationRe;
+        const auto norm = rotatedRe * rotatedRe + rotatedIm * rotatedIm;
+
+        // the results are blended rather than selected, so that loops calling this can be vectorised
+        const auto weight = (norm > std::numeric_limits<float>::min()) ? 1.0f : 0.0f;
+        const auto scale = 1.0f / std::sqrt (norm + std::numeric_limits<float>::min());
+
+        re += weight * (rotatedRe * scale - re);
+        im += weight * (rotatedIm * scale - im);
+    }
+}
+
+//==============================================================================
+
+void ARATimeStretcher::prepare (int newNumChannels, Mode newMode)
+{
+    mode = newMode;
+    numChannels = newNumChannels;
+
+    const auto fftOrder = (mode == Mode::offline) ? 12 : 10;
+    const auto overlap = (mode == Mode::offline) ? 8 : 4;
+    windowSize = 1 << fftOrder;
+    hopSize = windowSize / overlap;
+    numBins = windowSize / 2 + 1;
+
+    fft = std::make_unique<dsp::FFT> (fftOrder);
+
+    analysisWindow.resize ((size_t) windowSize);
+    dsp::WindowingFunction<float>::fillWindowingTables (analysisWindow.data(), (size_t) windowSize,
+                                                        dsp::WindowingFunction<float>::hann, false);
+
+    // analysis and synthesis use the same Hann window, the squares of which add up to 3/8 of the overlap
+    synthesisWindow = analysisWindow;
+    FloatVectorOperations::multiply (synthesisWindow.data(), 8.0f / (3.0f * (float) overlap), windowSize);
+
+    // each input frame is preceded by hopSize samples for measuring the phase advance of the bins
+    inputFrame.setSize (numChannels, windowSize + hopSize);
+    outputAccumulator.setSize (numChannels, windowSize);
+    synthesisPhasors.setSize (numChannels, 2 * numBins);
+    resampleBuffer.setSize (numChannels, (int) std::ceil (maxResampledChunkSize * maxPitchRatio) + 4);
+
+    fftData.assign ((size_t) (2 * windowSize), 0.0f);
+    previousFftData.assign ((size_t) (2 * windowSize), 0.0f);
+
+    magnitudes.assign ((size_t) numBins, 0.0f);
+
+    peakBins.assign ((size_t) numBins, 0);
+
+    reset();
+}
+
+void ARATimeStretcher::releaseResources()
+{
+    fft.reset();
+
+    analysisWindow = {};
+    synthesisWindow = {};
+
+    inputFrame.setSize (0, 0);
+    outputAccumulator.setSize (0, 0);
+    synthesisPhasors.setSize (0, 0);
+    resampleBuffer.setSize (0, 0);
+
+    for (auto* scratch : { &fftData, &previousFftData, &magnitudes })
+        *scratch = {};
+
+    peakBins = {};
+}
+
+void ARATimeStretcher::setTimeMapping (double newInputStart, double newStretchFactor, double newPitchRatio, bool newReadReversed) noexcept
+{
+    jassert (newStretchFactor > 0.0);
+    jassert (newPitchRatio >= minPitchRatio && newPitchRatio <= maxPitchRatio);
+    newPitchRatio = jlimit (minPitchRatio, maxPitchRatio, newPitchRatio);
+
+    if (newInputStart != inputStart || newStretchFactor != stretchFactor || newPitchRatio != pitchRatio || newReadReversed != readReversed)
+    {
+        inputStart = newInputStart;
+        stretchFactor = newStretchFactor;
+        pitchRatio = newPitchRatio;
+        readReversed = newReadReversed;
+        reset();
+    }
+}
+
+void ARATimeStretcher::reset() noexcept
+{
+    needsSeek = true;
+    resampleBufferStart = resampleBufferEnd = std::numeric_limits<int64>::max();
+}
+
+//==============================================================================
+
+bool ARATimeStretcher::render (AudioFormatReader& reader, AudioBuffer<float>& buffer, int startInBuffer,
+                               int64 outputPosition, int numSamples) noexcept
+{
+    jassert (fft != nullptr);                               // must be prepared first
+    jassert (buffer.getNumChannels() == numChannels);
+
+    if (fft == nullptr)
+    {
+        buffer.clear (startInBuffer, numSamples);
+        return false;
+    }
+
+    for (int c = numChannels; c < buffer.getNumChannels(); ++c)
+        buffer.clear (c, startInBuffer, numSamples);
+
+    if (pitchRatio == 1.0)
+        return renderStretched (reader, buffer, startInBuffer, outputPosition, numSamples);
+
+    // Pitch shifting stretches by the pitch ratio in addition, and then resamples the stretched signal
+    // back to the requested duration. The stretched samples around the current position are kept in
+    // resampleBuffer, so that consecutive calls continue the stretched signal.
+    auto success = true;
+
+    while (numSamples > 0)
+    {
+        const auto numSamplesInChunk = jmin (numSamples, maxResampledChunkSize);
+        const auto firstPosition = (double) outputPosition * pitchRatio;
+        const auto stretchedStart = (int64) std::floor (firstPosition) - 1;
+        const auto stretchedEnd = (int64) std::floor ((double) (outputPosition + numSamplesInChunk - 1) * pitchRatio) + 3;
+
+        if (resampleBufferStart > stretchedStart || stretchedStart > resampleBufferEnd)
+        {
+            resampleBufferStart = stretchedStart;
+            resampleBufferEnd = stretchedStart;
+        }
+        else if (resampleBufferStart < stretchedStart)
+        {
+            const auto numSamplesToDiscard = (int) (stretchedStart - resampleBufferStart);
+            const auto numSamplesToKeep = (int) (resampleBufferEnd - stretchedStart);
+
+            for (int c = 0; c < numChannels; ++c)
+            {
+                auto* samples = resampleBuffer.getWritePointer (c);
+                std::memmove (samples, samples + numSamplesToDiscard, sizeof (float) * (size_t) numSamplesToKeep);
+            }
+
+            resampleBufferStart = stretchedStart;
+        }
+
+        if (resampleBufferEnd < stretchedEnd)
+        {
+            const auto numValidSamples = (int) (resampleBufferEnd - resampleBufferStart);
+            jassert (numValidSamples + stretchedEnd - resampleBufferEnd <= resampleBuffer.getNumSamples());
+
+            success = renderStretched (reader, resampleBuffer, numValidSamples, resampleBufferEnd, (int) (stretchedEnd - resampleBufferEnd)) && success;
+            resampleBufferEnd = stretchedEnd;
+        }
+
+        // 4-point Hermite interpolation
+        for (int c = 0; c < numChannels; ++c)
+        {
+            const auto* stretched = resampleBuffer.getReadPointer (c);
+            auto* dest = buffer.getWritePointer (c, startInBuffer);
+
+            for (int i = 0; i < numSamplesInChunk; ++i)
+            {
+                const auto position = (double) (outputPosition + i) * pitchRatio - (double) resampleBufferStart;
+                const auto index = (int) position;
+                const auto t = (float) (position - (double) index);
+                const auto* x = stretched + index;
+
+                const auto c1 = 0.5f * (x[1] - x[-1]);
+                const auto c2 = x[-1] - 2.5f * x[0] + 2.0f * x[1] - 0.5f * x[2];
+                const auto c3 = 0.5f * (x[2] - x[-1]) + 1.5f * (x[0] - x[1]);
+                dest[i] = ((c3 * t + c2) * t + c1) * t + x[0];
+            }
+        }
+
+        startInBuffer += numSamplesInChunk;
+        outputPosition += numSamplesInChunk;
+        numSamples -= numSamplesInChunk;
+    }
+
+    return success;
+}
+
+bool ARATimeStretcher::renderStretched (AudioFormatReader& reader, AudioBuffer<float>& buffer, int startInBuffer,
+                                        int64 outputPosition, int numSamples) noexcept
+{
+    if (needsSeek || outputPosition != nextOutputPosition)
+        seek (outputPosition);
+
+    const auto numChannelsToRender = jmin (numChannels, buffer.getNumChannels());
+    auto success = true;
+
+    while (numSamples > 0)
+    {
+        // all frames that overlap the samples before the start of the next frame have been added
+        const auto numCompleteSamples = getFrameStart (nextFrameIndex) - nextOutputPosition;
+
+        if (numCompleteSamples <= 0)
+        {
+            success = synthesiseNextFrame (reader) && success;
+            continue;
+        }
+
+        const auto numSamplesToCopy = (int) jmin ((int64) numSamples, numCompleteSamples);
+        const auto offsetInAccumulator = (int) (nextOutputPosition - accumulatorStart);
+
+        for (int c = 0; c < numChannelsToRender; ++c)
+            buffer.copyFrom (c, startInBuffer, outputAccumulator, c, offsetInAccumulator, numSamplesToCopy);
+
+        startInBuffer += numSamplesToCopy;
+        numSamples -= numSamplesToCopy;
+        nextOutputPosition += numSamplesToCopy;
+    }
+
+    return success;
+}
+
+void ARATimeStretcher::seek (int64 outputPosition) noexcept
+{
+    // start with the first frame that overlaps the position, and initialise the synthesis phases from its analysis
+    nextFrameIndex = ARATimeStretcherHelpers::floorDiv (outputPosition - windowSize / 2, hopSize) + 1;
+    accumulatorStart = getFrameStart (nextFrameIndex);
+    nextOutputPosition = outputPosition;
+    outputAccumulator.clear();
+    needsSeek = false;
+    isFirstFrame = true;
+}
+
+bool ARATimeStretcher::synthesiseNextFrame (AudioFormatReader& reader) noexcept
+{
+    // discard the samples before the frame, they have all been rendered
+    const auto frameStart = getFrameStart (nextFrameIndex);
+    const auto numSamplesToDiscard = (int) (frameStart - accumulatorStart);
+    jassert (isPositiveAndNotGreaterThan (numSamplesToDiscard, windowSize));
+
+    if (numSamplesToDiscard > 0)
+    {
+        const auto numSamplesToKeep = windowSize - numSamplesToDiscard;
+
+        for (int c = 0; c < numChannels; ++c)
+        {
+            auto* accumulator = outputAccumulator.getWritePointer (c);
+            std::memmove (accumulator, accumulator + numSamplesToDiscard, sizeof (float) * (size_t) numSamplesToKeep);
+            FloatVectorOperations::clear (accumulator + numSamplesToKeep, numSamplesToDiscard);
+        }
+
+        accumulatorStart = frameStart;
+    }
+
+    // when pitch shifting, the frames are stretched by the pitch ratio in addition
+    const auto inputCentre = inputStart + (double) (nextFrameIndex * hopSize) / (stretchFactor * pitchRatio);
+    const auto success = readInputFrame (reader, (int64) std::floor (inputCentre + 0.5) - windowSize / 2 - hopSize);
+
+    for (int c = 0; c < numChannels; ++c)
+        synthesiseChannel (c);
+
+    isFirstFrame = false;
+    ++nextFrameIndex;
+
+    return success;
+}
+
+bool ARATimeStretcher::readInputFrame (AudioFormatReader& reader, int64 startSample) noexcept
+{
+    const auto numSamples = inputFrame.getNumSamples();
+
+    if (readReversed)
+        startSample = reader.lengthInSamples - startSample - numSamples;
+
+    if (! reader.read (inputFrame.getArrayOfWritePointers(), numChannels, startSample, numSamples))
+    {
+        inputFrame.clear();
+        return false;
+    }
+
+    if (readReversed)
+        inputFrame.reverse (0, numSamples);
+
+    return true;
+}
+
+void ARATimeStretcher::synthesiseChannel (int channel) noexcept
+{
+    const auto* input = inputFrame.getReadPointer (channel);
+    auto* phasors = synthesisPhasors.getWritePointer (channel);
+
+    // transform the frame, and the frame preceding it by hopSize samples
+    FloatVectorOperations::multiply (previousFftData.data(), input, analysisWindow.data(), windowSize);
+    FloatVectorOperations::multiply (fftData.data(), input + hopSize, analysisWindow.data(), windowSize);
+    fft->performRealOnlyForwardTransform (previousFftData.data(), true);
+    fft->performRealOnlyForwardTransform (fftData.data(), true);
+
+    // As the analysed frames are hopSize samples apart just like the synthesised ones, the phase of
+    // each bin advances by the difference of its analysis phases. Rather than computing the phases
+    // with atan2 and the bins with sin and cos, the synthesis phasors are rotated by the product of
+    // each bin and its conjugated predecessor, so these loops only need arithmetic and square roots
+    // and can be vectorised by the compiler, as long as std::sqrt isn't required to set errno.
+    auto* bins = fftData.data();
+    const auto* previousBins = previousFftData.data();
+    auto* mags = magnitudes.data();
+
+    for (int k = 0; k < numBins; ++k)
+        mags[k] = std::sqrt (bins[2 * k] * bins[2 * k] + bins[2 * k + 1] * bins[2 * k + 1]);
+
+    if (isFirstFrame)
+    {
+        for (int k = 0; k < numBins; ++k)
+        {
+            phasors[2 * k] = 1.0f;
+            phasors[2 * k + 1] = 0.0f;
+            ARATimeStretcherHelpers::rotatePhasor (phasors[2 * k], phasors[2 * k + 1], bins[2 * k], bins[2 * k + 1]);
+        }
+    }
+    else
+    {
+        for (int k = 0; k < numBins; ++k)
+        {
+            const auto re = bins[2 * k], im = bins[2 * k + 1];
+            const auto previousRe = previousBins[2 * k], previousIm = previousBins[2 * k + 1];
+
+            ARATimeStretcherHelpers::rotatePhasor (phasors[2 * k], phasors[2 * k + 1], re * previousRe + im * previousIm, im * previousRe - re * previousIm);
+        }
+    }
+
+    // when shifting up, the bins that would alias after resampling are removed
+    if (pitchRatio > 1.0)
+    {
+        const auto numBinsToKeep = (int) ((double) numBins / pitchRatio);
+        FloatVectorOperations::clear (mags + numBinsToKeep, numBins - numBinsToKeep);
+    }
+
+    if (mode == Mode::offline && ! isFirstFrame)
+        lockPhasesToPeaks (phasors);
+
+    for (int k = 0; k < numBins; ++k)
+    {
+        bins[2 * k]     = mags[k] * phasors[2 * k];
+        bins[2 * k + 1] = mags[k] * phasors[2 * k + 1];
+    }
+
+    // the DC and Nyquist bins of a real signal have no imaginary part
+    fftData[1] = 0.0f;
+    fftData[(size_t) (2 * numBins - 1)] = 0.0f;
+
+    fft->performRealOnlyInverseTransform (fftData.data());
+
+    FloatVectorOperations::addWithMultiply (outputAccumulator.getWritePointer (channel), fftData.data(), synthesisWindow.data(), windowSize);
+}
+
+void ARATimeStretcher::lockPhasesToPeaks (float* phasors) noexcept
+{
+    // Identity phase locking (Laroche & Dolson): each bin keeps the phase relation to the nearest
+    // peak of the magnitude spectrum that it had in the analysis, which reduces the "phasiness"
+    // of the stretched signal. The relation is applied by rotating the phasor of the peak by the
+    // product of the bin and the conjugated peak of the analysed frame.
+    int numPeaks = 0;
+
+    for (int k = 2; k < numBins - 2; ++k)
+    {
+        const auto* m = magnitudes.data() + k;
+
+        if (m[0] > m[-1] && m[0] > m[-2] && m[0] >= m[1] && m[0] >= m[2])
+        {
+            peakBins[(size_t) numPeaks++] = k;
+        }
+    }
+
+    const auto* bins = fftData.data();
+
+    for (int i = 0; i < numPeaks; ++i)
+    {
+        const auto peak = peakBins[(size_t) i];
+        const auto begin = (i == 0) ? 0 : (peakBins[(size_t) i - 1] + peak) / 2 + 1;
+        const auto end = (i == numPeaks - 1) ? numBins : (peak + peakBins[(size_t) i + 1]) / 2 + 1;
+
+        const auto peakPhasorRe = phasors[2 * peak], peakPhasorIm = phasors[2 * peak + 1];
+        const auto peakRe = bins[2 * peak], peakIm = bins[2 * peak + 1];
+
+        for (int k = begin; k < end; ++k)
+        {
+            const auto re = bins[2 * k], im = bins[2 * k + 1];
+            auto phasorRe = peakPhasorRe, phasorIm = peakPhasorIm;
+
+            ARATimeStretcherHelpers::rotatePhasor (phasorRe, phasorIm, re * peakRe + im * peakIm, im * peakRe - re * peakIm);
+
+            phasors[2 * k] = phasorRe;
+            phasors[2 * k + 1] = phasorIm;
+        }
+    }
+}
+
+//==============================================================================
+
+bool ARATimeStretchStage::RegionKey::operator== (const RegionKey& other) const noexcept
+{
+    return playbackRegion == other.playbackRegion
+        && playbackSampleRange == other.playbackSampleRange
+        && modificationSampleRange == other.modificationSampleRange
+        && reader == other.reader
+        && readerVersion == other.readerVersion
+        && timeStretchFactor == other.timeStretchFactor
+        && pitchRatio == other.pitchRatio
+        && playReversed == other.playReversed;
+}
+
+void ARATimeStretchStage::prepare (int newNumChannels, ARATimeStretcher::Mode mode, int numVoices, size_t cacheSizeInBytes)
+{
+    jassert (numVoices > 0);
+
+    numChannels = newNumChannels;
+
+    voices.clear();
+    for (int i = 0; i < numVoices; ++i)
+    {
+        voices.push_back (std::make_unique<Voice>());
+        voices.back()->stretcher.prepare (numChannels, mode);
+    }
+
+    const auto numBytesPerSlot = (size_t) numChannels * (size_t) cacheBlockSize * sizeof (float);
+    const auto numSlots = (numBytesPerSlot > 0) ? (int) (cacheSizeInBytes / numBytesPerSlot) : 0;
+    cacheSlots.assign ((size_t) numSlots, {});
+    cacheBuckets.assign (numSlots > 0 ? (size_t) nextPowerOfTwo (2 * numSlots) : 0, -1);
+    cacheSamples.setSize (numChannels, numSlots * cacheBlockSize);
+    clearCache();
+
+    useCounter = 0;
+    numCachedSamplesRendered = 0;
+    numStretchedSamplesRendered = 0;
+}
+
+void ARATimeStretchStage::releaseResources()
+{
+    voices.clear();
+    cacheSlots.clear();
+    cacheBuckets.clear();
+    mostRecentlyUsedSlot = leastRecentlyUsedSlot = -1;
+    cacheSamples.setSize (0, 0);
+}
+
+void ARATimeStretchStage::clearCache() noexcept
+{
+    std::fill (cacheBuckets.begin(), cacheBuckets.end(), -1);
+
+    const auto numSlots = (int) cacheSlots.size();
+
+    for (int i = 0; i < numSlots; ++i)
+    {
+        auto& slot = cacheSlots[(size_t) i];
+        slot.numValidSamples = 0;
+        slot.isInTable = false;
+        slot.nextInBucket = -1;
+        slot.moreRecentlyUsed = i - 1;
+        slot.lessRecentlyUsed = (i + 1 < numSlots) ? i + 1 : -1;
+    }
+
+    mostRecentlyUsedSlot = (numSlots > 0) ? 0 : -1;
+    leastRecentlyUsedSlot = numSlots - 1;
+}
+
+bool ARATimeStretchStage::needsStretching (const PreparedPlaybackRegion& preparedRegion, double pitchRatio) noexcept
+{
+    return preparedRegion.timeStretchFactor != 1.0 || pitchRatio != 1.0;
+}
+
+//==============================================================================
+
+bool ARATimeStretchStage::renderPlaybackRegion (const PreparedPlaybackRegion& preparedRegion, AudioBuffer<float>& buffer, int startInBuffer,
+                                                int64 startInPlayback, int numSamples, double pitchRatio, bool playReversed) noexcept
+{
+    jassert (! voices.empty());                             // must be prepared first
+    jassert (buffer.getNumChannels() == numChannels);
+
+    if (preparedRegion.reader == nullptr || voices.empty())
+        return false;
+
+    const RegionKey key { preparedRegion.playbackRegion, preparedRegion.playbackSampleRange, preparedRegion.modificationSampleRange,
+                          preparedRegion.reader, preparedRegion.readerVersion, preparedRegion.timeStretchFactor, pitchRatio, playReversed };
+
+    const auto numChannelsToCache = jmin (numChannels, buffer.getNumChannels());
+    auto position = startInPlayback - preparedRegion.playbackSampleRange.getStart();
+    auto success = true;
+
+    while (numSamples > 0)
+    {
+        const auto blockIndex = ARATimeStretcherHelpers::floorDiv (position, cacheBlockSize);
+        const auto offsetInBlock = (int) (position - blockIndex * cacheBlockSize);
+        auto numSamplesToRender = jmin (numSamples, cacheBlockSize - offsetInBlock);
+        auto* slot = findCacheSlot (key, blockIndex);
+
+        if (slot != nullptr && slot->numValidSamples > offsetInBlock)
+        {
+            numSamplesToRender = jmin (numSamplesToRender, slot->numValidSamples - offsetInBlock);
+
+            for (int c = 0; c < numChannelsToCache; ++c)
+                buffer.copyFrom (c, startInBuffer, getCacheSlotSamples (*slot, c) + offsetInBlock, numSamplesToRender);
+
+            for (int c = numChannelsToCache; c < buffer.getNumChannels(); ++c)
+                buffer.clear (c, startInBuffer, numSamplesToRender);
+
+            numCachedSamplesRendered.fetch_add (numSamplesToRender, std::memory_order_relaxed);
+        }
+        else
+        {
+            auto& stretcher = getStretcherForRegion (key);
+            const auto didRead = stretcher.render (*preparedRegion.reader, buffer, startInBuffer, position, numSamplesToRender);
+            numStretchedSamplesRendered.fetch_add (numSamplesToRender, std::memory_order_relaxed);
+
+            // only output that could be read completely is cached, and only if it continues the samples cached for its block
+            if (didRead)
+            {
+                if (slot == nullptr && offsetInBlock == 0)
+                    slot = allocateCacheSlot (key, blockIndex);
+
+                if (slot != nullptr && slot->numValidSamples == offsetInBlock)
+                {
+                    for (int c = 0; c < numChannelsToCache; ++c)
+                        FloatVectorOperations::copy (getCacheSlotSamples (*slot, c) + offsetInBlock, buffer.getReadPointer (c, startInBuffer), numSamplesToRender);
+
+                    slot->numValidSamples += numSamplesToRender;
+                }
+            }
+
+            success = didRead && success;
+        }
+
+        startInBuffer += numSamplesToRender;
+        position += numSamplesToRender;
+        numSamples -= numSamplesToRender;
+    }
+
+    return success;
+}
+
+ARATimeStretcher& ARATimeStretchStage::getStretcherForRegion (const RegionKey& key) noexcept
+{
+    ++useCounter;
+
+    Voice* leastRecentlyUsedVoice = nullptr;
+
+    for (auto& voice : voices)
+    {
+        if (voice->lastUsed != 0 && voice->key == key)
+        {
+            voice->lastUsed = useCounter;
+            return voice->stretcher;
+        }
+
+        if (leastRecentlyUsedVoice == nullptr || voice->lastUsed < leastRecentlyUsedVoice->lastUsed)
+            leastRecentlyUsedVoice = voice.get();
+    }
+
+    leastRecentlyUsedVoice->key = key;
+    leastRecentlyUsedVoice->lastUsed = useCounter;
+    leastRecentlyUsedVoice->stretcher.setTimeMapping ((double) key.modificationSampleRange.getStart(), key.timeStretchFactor,
+                                                      key.pitchRatio, key.playReversed);
+    leastRecentlyUsedVoice->stretcher.reset();
+    return leastRecentlyUsedVoice->stretcher;
+}
+
+size_t ARATimeStretchStage::getCacheHash (const RegionKey& key, int64 blockIndex) noexcept
+{
+    // the remaining properties of the key rarely differ between regions, so they are only compared
+    auto hash = (size_t) blockIndex;
+
+    for (auto value : { (size_t) key.playbackRegion, (size_t) key.reader, (size_t) key.readerVersion,
+                        (size_t) key.playbackSampleRange.getStart(), (size_t) key.modificationSampleRange.getStart() })
+        hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+
+    return hash;
+}
+
+ARATimeStretchStage::CacheSlot* ARATimeStretchStage::findCacheSlot (const RegionKey& key, int64 blockIndex) noexcept
+{
+    if (cacheBuckets.empty())
+        return nullptr;
+
+    const auto hash = getCacheHash (key, blockIndex);
+
+    for (auto i = cacheBuckets[hash & (cacheBuckets.size() - 1)]; i >= 0; i = cacheSlots[(size_t) i].nextInBucket)
+    {
+        auto& slot = cacheSlots[(size_t) i];
+
+        if (slot.hash == hash && slot.blockIndex == blockIndex && slot.key == key)
+        {
+            moveToMostRecentlyUsed (i);
+            return &slot;
+        }
+    }
+
+    return nullptr;
+}
+
+ARATimeStretchStage::CacheSlot* ARATimeStretchStage::allocateCacheSlot (const RegionKey& key, int64 blockIndex) noexcept
+{
+    if (leastRecentlyUsedSlot < 0)
+        return nullptr;
+
+    const auto slotIndex = leastRecentlyUsedSlot;
+    auto& slot = cacheSlots[(size_t) slotIndex];
+
+    if (slot.isInTable)
+        removeFromBucket (slotIndex);
+
+    slot.key = key;
+    slot.blockIndex = blockIndex;
+    slot.numValidSamples = 0;
+    slot.hash = getCacheHash (key, blockIndex);
+    slot.isInTable = true;
+
+    auto& bucket = cacheBuckets[slot.hash & (cacheBuckets.size() - 1)];
+    slot.nextInBucket = bucket;
+    bucket = slotIndex;
+
+    moveToMostRecentlyUsed (slotIndex);
+    return &slot;
+}
+
+void ARATimeStretchStage::removeFromBucket (int slotIndex) noexcept
+{
+    auto& slot = cacheSlots[(size_t) slotIndex];
+    auto* link = &cacheBuckets[slot.hash & (cacheBuckets.size() - 1)];
+
+    while (*link != slotIndex)
+    {
+        jassert (*link >= 0);
+        link = &cacheSlots[(size_t) *link].nextInBucket;
+    }
+
+    *link = slot.nextInBucket;
+    slot.nextInBucket = -1;
+    slot.isInTable = false;
+}
+
+void ARATimeStretchStage::moveToMostRecentlyUsed (int slotIndex) noexcept
+{
+    if (slotIndex == mostRecentlyUsedSlot)
+        return;
+
+    auto& slot = cacheSlots[(size_t) slotIndex];
+
+    // unlink the slot, it can't be the most recently used one here
+    cacheSlots[(size_t) slot.moreRecentlyUsed].lessRecentlyUsed = slot.lessRecentlyUsed;
+
+    if (slot.lessRecentlyUsed >= 0)
+        cacheSlots[(size_t) slot.lessRecentlyUsed].moreRecentlyUsed = slot.moreRecentlyUsed;
+    else
+        leastRecentlyUsedSlot = slot.moreRecentlyUsed;
+
+    slot.moreRecentlyUsed = -1;
+    slot.lessRecentlyUsed = mostRecentlyUsedSlot;
+    cacheSlots[(size_t) mostRecentlyUsedSlot].moreRecentlyUsed = slotIndex;
+    mostRecentlyUsedSlot = slotIndex;
+}
+
+float* ARATimeStretchStage::getCacheSlotSamples (const CacheSlot& slot, int channel) noexcept
+{
+    const auto slotIndex = (int) (&slot - cacheSlots.data());
+    return cacheSamples.getWritePointer (channel, slotIndex * cacheBlockSize);
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ARATimeStretcherTests  : public UnitTest
+{
+public:
+    ARATimeStretcherTests()
+        : UnitTest ("ARATimeStretcher", UnitTestCategories::audio)
+    {}
+
+    void runTest() override
+    {
+        SineReader reader;
+
+        for (auto mode : { ARATimeStretcher::Mode::realtime, ARATimeStretcher::Mode::offline })
+        {
+            const String modeName (mode == ARATimeStretcher::Mode::realtime ? " (realtime)" : " (offline)");
+
+            beginTest ("A stretch factor of 1 reproduces the input" + modeName);
+            {
+                ARATimeStretcher stretcher;
+                stretcher.prepare (1, mode);
+                stretcher.setTimeMapping (0.0, 1.0);
+
+                for (auto outputStart : { (int64) 0, (int64) 100000 })
+                {
+                    const auto output = render (stretcher, reader, outputStart, 4 * stretcher.getWindowSize());
+                    auto maxError = 0.0f;
+
+                    for (int i = 0; i < output.getNumSamples(); ++i)
+                        maxError = jmax (maxError, std::abs (output.getSample (0, i) - reader.getSample (outputStart + i)));
+
+                    expectLessThan (maxError, 0.01f);
+                }
+            }
+
+            beginTest ("Stretching keeps the frequency" + modeName);
+            {
+                for (auto stretchFactor : { 0.6, 1.5, 2.5 })
+                {
+                    ARATimeStretcher stretcher;
+                    stretcher.prepare (1, mode);
+                    stretcher.setTimeMapping (1000.0, stretchFactor);
+
+                    const auto output = render (stretcher, reader, 0, 8 * stretcher.getWindowSize());
+                    expectWithinAbsoluteError (measureFrequency (output, stretcher.getWindowSize()), SineReader::frequency, SineReader::frequency * 0.005);
+                }
+            }
+
+            beginTest ("Pitch shifting scales the frequency" + modeName);
+            {
+                for (auto pitchRatio : { 0.75, 1.5 })
+                {
+                    ARATimeStretcher stretcher;
+                    stretcher.prepare (1, mode);
+                    stretcher.setTimeMapping (1000.0, 1.25, pitchRatio);
+
+                    const auto output = render (stretcher, reader, 0, 8 * stretcher.getWindowSize());
+                    const auto expectedFrequency = SineReader::frequency * pitchRatio;
+                    expectWithinAbsoluteError (measureFrequency (output, stretcher.getWindowSize()), expectedFrequency, expectedFrequency * 0.005);
+                }
+            }
+        }
+
+        beginTest ("Stretched output is cached per region");
+        {
+            constexpr auto numBlocks = 3;
+            constexpr auto stretchFactor = 1.5;
+            const auto duration = (int64) ARATimeStretchStage::cacheBlockSize * numBlocks;
+
+            // room for 4 blocks
+            ARATimeStretchStage stage;
+            stage.prepare (1, ARATimeStretcher::Mode::realtime, 2, 4 * ARATimeStretchStage::cacheBlockSize * sizeof (float));
+
+            auto createRegion = [&] (int64 playbackStart, uint32 readerVersion)
+            {
+                const Range<int64> playbackRange (playbackStart, playbackStart + duration);
+                const Range<int64> modificationRange (0, (int64) ((double) duration / stretchFactor));
+
+                return ARATimeStretchStage::PreparedPlaybackRegion { nullptr, playbackRange, playbackRange, modificationRange,
+                                                                     -playbackStart, &reader, 0, false, readerVersion, stretchFactor };
+            };
+
+            const auto regionA = createRegion (0, 1);
+            const auto regionB = createRegion (duration, 2);
+            const auto regionC = createRegion (2 * duration, 3);
+
+            auto renderRegion = [&] (const ARATimeStretchStage::PreparedPlaybackRegion& region, int numBlocksToRender)
+            {
+                AudioBuffer<float> buffer (1, numBlocksToRender * ARATimeStretchStage::cacheBlockSize);
+
+                for (int start = 0; start < buffer.getNumSamples(); start += 512)
+                    expect (stage.renderPlaybackRegion (region, buffer, start, region.playbackSampleRange.getStart() + start, 512));
+
+                return buffer;
+            };
+
+            auto expectRendered = [&] (const ARATimeStretchStage::PreparedPlaybackRegion& region, int numBlocksToRender, int numCachedBlocks)
+            {
+                const auto numCachedBefore = stage.getNumCachedSamplesRendered();
+                const auto numStretchedBefore = stage.getNumStretchedSamplesRendered();
+                const auto output = renderRegion (region, numBlocksToRender);
+
+                expectEquals (stage.getNumCachedSamplesRendered() - numCachedBefore, (int64) numCachedBlocks * ARATimeStretchStage::cacheBlockSize);
+                expectEquals (stage.getNumStretchedSamplesRendered() - numStretchedBefore, (int64) (numBlocksToRender - numCachedBlocks) * ARATimeStretchStage::cacheBlockSize);
+
+                return output;
+            };
+
+            const auto stretched = expectRendered (regionA, numBlocks, 0);
+            const auto cached = expectRendered (regionA, numBlocks, numBlocks);
+
+            for (int i = 0; i < stretched.getNumSamples(); ++i)
+                expectEquals (cached.getSample (0, i), stretched.getSample (0, i));
+
+            // B fills the cache, and as A is then used again, C replaces B
+            expectRendered (regionB, 1, 0);
+            expectRendered (regionA, numBlocks, numBlocks);
+            expectRendered (regionC, 1, 0);
+            expectRendered (regionA, numBlocks, numBlocks);
+            expectRendered (regionB, 1, 0);
+
+            // a new reader version invalidates the cached blocks of the region
+            expectRendered (createRegion (0, 4), 1, 0);
+
+            stage.clearCache();
+            expectRendered (regionA, 1, 0);
+        }
+    }
+
+private:
+    // an endless sine, so that the stretcher can read beyond any range
+    struct SineReader  : public AudioFormatReader
+    {
+        static constexpr double frequency = 440.0;
+
+        SineReader()
+            : AudioFormatReader (nullptr, "SineReader")
+        {
+            sampleRate = 44100.0;
+            numChannels = 1;
+            lengthInSamples = std::numeric_limits<int>::max();
+            bitsPerSample = 32;
+            usesFloatingPointData = true;
+        }
+
+        float getSample (int64 position) const noexcept
+        {
+            return 0.5f * (float) std::sin (MathConstants<double>::twoPi * frequency * (double) position / sampleRate);
+        }
+
+        bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                          int64 startSampleInFile, int numSamples) override
+        {
+            for (int c = 0; c < numDestChannels; ++c)
+                if (auto* dest = reinterpret_cast<float*> (destSamples[c]))
+                    for (int i = 0; i < numSamples; ++i)
+                        dest[startOffsetInDestBuffer + i] = getSample (startSampleInFile + i);
+
+            return true;
+        }
+    };
+
+    static AudioBuffer<float> render (ARATimeStretcher& stretcher, AudioFormatReader& reader, int64 outputStart, int numSamples)
+    {
+        AudioBuffer<float> output (1, numSamples);
+
+        for (int start = 0; start < numSamples; start += 512)
+            stretcher.render (reader, output, start, outputStart + start, jmin (512, numSamples - start));
+
+        return output;
+    }
+
+    // measures the frequency from the rising zero crossings after the given number of samples
+    static double measureFrequency (const AudioBuffer<float>& output, int startSample)
+    {
+        const auto* samples = output.getReadPointer (0);
+        double firstCrossing = -1.0, lastCrossing = -1.0;
+        int numCrossings = 0;
+
+        for (int i = startSample + 1; i < output.getNumSamples(); ++i)
+        {
+            if (samples[i - 1] < 0.0f && samples[i] >= 0.0f)
+            {
+                const auto crossing = (i - 1) + (double) samples[i - 1] / (double) (samples[i - 1] - samples[i]);
+
+                if (numCrossings++ == 0)
+                    firstCrossing = crossing;
+
+                lastCrossing = crossing;
+            }
+        }
+
+        return numCrossings > 1 ? 44100.0 * (numCrossings - 1) / (lastCrossing - firstCrossing) : 0.0;
+    }
+};
+
+static ARATimeStretcherTests araTimeStretcherTests;
+
+#endif
+
+} // namespace juce
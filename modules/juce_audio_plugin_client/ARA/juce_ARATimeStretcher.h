@@ -0,0 +1,276 @@
+#pragma once
+
+#include "juce_ARAPlugInInstanceRoles.h"
+
+namespace juce
+{
+
+//==============================================================================
+/** A phase vocoder that renders a time stretched and pitch shifted version of the samples
+    provided by an AudioFormatReader.
+
+    Output samples are mapped linearly to the input, i.e. output sample n is synthesised from
+    the input around sample inputStart + n / stretchFactor. Since the input is read with random
+    access, no latency is added. Consecutive calls to render() continue the stretched signal
+    seamlessly, while any call that does not continue the previous one causes the stretcher to
+    seek, resynthesising the frames that overlap the new position.
+
+    Pitch shifting is performed by stretching the input by the pitch ratio in addition, and
+    resampling the result to the requested duration.
+
+    All buffers are allocated in prepare(), so render() is realtime safe if the reader is.
+
+    @tags{ARA}
+*/
+class JUCE_API  ARATimeStretcher
+{
+public:
+    /** The quality settings of the stretcher. */
+    enum class Mode
+    {
+        /** A window of 1024 samples with 4x overlap, for low CPU load and fast seeking during realtime playback. */
+        realtime,
+
+        /** A window of 4096 samples with 8x overlap and phase locking, for best quality when rendering offline. */
+        offline
+    };
+
+    ARATimeStretcher() = default;
+
+    /** The range of supported pitch ratios, two octaves down or up. */
+    static constexpr double minPitchRatio = 0.25;
+    static constexpr double maxPitchRatio = 4.0;
+
+    /** Allocates all buffers for rendering the given number of channels in the given mode. */
+    void prepare (int numChannels, Mode mode);
+
+    /** Frees the buffers allocated in prepare(). */
+    void releaseResources();
+
+    /** Returns the mode that was passed to prepare(). */
+    Mode getMode() const noexcept                       { return mode; }
+
+    /** Returns the number of samples in each frame. */
+    int getWindowSize() const noexcept                  { return windowSize; }
+
+    /** Returns the number of output samples between the starts of consecutive frames. */
+    int getHopSize() const noexcept                     { return hopSize; }
+
+    /** Sets the mapping of output samples to input samples.
+
+        @param inputStart       The input sample position that corresponds to output sample 0.
+        @param stretchFactor    The ratio of output duration to input duration, i.e. values above 1
+                                slow the input down, values below 1 speed it up.
+        @param pitchRatio       The ratio of output to input frequencies, i.e. 2.0 shifts one octave up.
+                                Must be between minPitchRatio and maxPitchRatio.
+        @param readReversed     If true, the input is read backwards through the entire reader, so that
+                                input sample n is the reader's sample (lengthInSamples - 1 - n).
+
+        If any of the values change, the next call to render() will seek.
+    */
+    void setTimeMapping (double inputStart, double stretchFactor, double pitchRatio = 1.0, bool readReversed = false) noexcept;
+
+    /** Discards the current state, so that the next call to render() will seek. */
+    void reset() noexcept;
+
+    /** Renders the given range of output samples into the buffer, replacing its contents.
+        Returns false if reading the input failed, in which case the output is rendered as
+        if the samples that could not be read were silent.
+    */
+    bool render (AudioFormatReader& reader, AudioBuffer<float>& buffer, int startInBuffer,
+                 int64 outputPosition, int numSamples) noexcept;
+
+private:
+    int64 getFrameStart (int64 frameIndex) const noexcept   { return frameIndex * hopSize - windowSize / 2; }
+
+    void seek (int64 outputPosition) noexcept;
+    bool synthesiseNextFrame (AudioFormatReader& reader) noexcept;
+    bool renderStretched (AudioFormatReader& reader, AudioBuffer<float>& buffer, int startInBuffer,
+                          int64 outputPosition, int numSamples) noexcept;
+    bool readInputFrame (AudioFormatReader& reader, int64 startSample) noexcept;
+    void synthesiseChannel (int channel) noexcept;
+    void lockPhasesToPeaks (float* phasors) noexcept;
+
+    static constexpr int maxResampledChunkSize = 256;
+
+    Mode mode { Mode::realtime };
+    int numChannels { 0 };
+    int windowSize { 0 };
+    int hopSize { 0 };
+    int numBins { 0 };
+
+    double inputStart { 0.0 };
+    double stretchFactor { 1.0 };
+    double pitchRatio { 1.0 };
+    bool readReversed { false };
+
+    std::unique_ptr<dsp::FFT> fft;
+    std::vector<float> analysisWindow, synthesisWindow;
+
+    // per channel state: the input of the current frame, the overlap-add accumulator of the
+    // output starting at accumulatorStart, and the phases of the previous synthesised frame,
+    // stored as interleaved unit phasors in the same layout as the FFT data
+    AudioBuffer<float> inputFrame, outputAccumulator, synthesisPhasors;
+
+    // scratch buffers shared by all channels
+    std::vector<float> fftData, previousFftData;
+    std::vector<float> magnitudes;
+    std::vector<int> peakBins;
+
+    // the stretched samples from resampleBufferStart to resampleBufferEnd, when pitch shifting
+    AudioBuffer<float> resampleBuffer;
+    int64 resampleBufferStart { 0 }, resampleBufferEnd { 0 };
+
+    int64 nextFrameIndex { 0 };
+    int64 accumulatorStart { 0 };
+    int64 nextOutputPosition { 0 };
+    bool needsSeek { true };
+    bool isFirstFrame { true };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ARATimeStretcher)
+};
+
+//==============================================================================
+/** A stage that ARAPlaybackRenderer subclasses can use to render playback regions with time
+    stretching, i.e. regions for which ARAPlaybackRegion::isTimestretchEnabled() is true and whose
+    duration in playback time differs from their duration in audio modification time.
+
+    Call prepare() from prepareToPlay(), typically after prepareAudioSourceReaders(), and
+    releaseResources() from releaseResources(). In processBlock(), render each prepared region
+    for which needsStretching() returns true through renderPlaybackRegion() instead of reading
+    its samples directly.
+
+    The stretch is distributed evenly across the region. If
+    ARAPlaybackRegion::isTimeStretchReflectingTempo() is set, this matches the musical timing of
+    the audio modification as long as it has a constant tempo - plug-ins that analyse the tempo
+    of their audio sources may want to use ARATimeStretcher directly to follow it more closely.
+
+    Regions are rendered by a fixed number of ARATimeStretcher voices, which are assigned to the
+    regions as needed. The stretched output is cached in blocks per region, so that playing back
+    an unchanged region again does not need to stretch it again. The cache is keyed by all the
+    properties of the PreparedPlaybackRegion that affect the output, so it does not need to be
+    invalidated explicitly when regions or audio sources change - outdated blocks are simply no
+    longer used, and are eventually replaced with new ones.
+
+    Apart from prepare(), releaseResources() and clearCache(), which must not be called while
+    rendering, all functions are intended to be called from processBlock() only.
+
+    @tags{ARA}
+*/
+class JUCE_API  ARATimeStretchStage
+{
+public:
+    using PreparedPlaybackRegion = ARAPlaybackRenderer::PreparedPlaybackRegion;
+
+    ARATimeStretchStage() = default;
+
+    /** Allocates the voices and the cache.
+
+        @param numChannels          The number of channels that will be rendered.
+        @param mode                 The quality of the stretching, typically ARATimeStretcher::Mode::offline
+                                    if the renderer has been prepared with alwaysNonRealtime set to true,
+                                    and ARATimeStretcher::Mode::realtime otherwise.
+        @param numVoices            The number of regions that can be stretched concurrently without
+                                    seeking whenever switching between regions.
+        @param cacheSizeInBytes     The amount of memory used for caching the stretched output,
+                                    0 disables caching.
+    */
+    void prepare (int numChannels, ARATimeStretcher::Mode mode, int numVoices = 8, size_t cacheSizeInBytes = 32 * 1024 * 1024);
+
+    /** Frees the voices and the cache. */
+    void releaseResources();
+
+    /** Discards all cached output. */
+    void clearCache() noexcept;
+
+    /** Returns true if the region needs to be rendered through the stage, i.e. if it is time
+        stretched, or if a pitch ratio other than 1.0 will be applied.
+    */
+    static bool needsStretching (const PreparedPlaybackRegion& preparedRegion, double pitchRatio = 1.0) noexcept;
+
+    /** Renders the samples of the region that are played back in the given range of playback samples
+        into the buffer, replacing its contents.
+
+        @param preparedRegion       The region to render, as provided by
+                                    ARAPlaybackRenderer::forEachPreparedPlaybackRegionOverlapping().
+        @param buffer               The buffer to render into.
+        @param startInBuffer        The first sample of the buffer to render into.
+        @param startInPlayback      The playback sample position that corresponds to startInBuffer.
+        @param numSamples           The number of samples to render.
+        @param pitchRatio           The ratio of output to input frequencies.
+        @param playReversed         If true, the audio source is played back reversed, see ARATimeStretcher::setTimeMapping().
+
+        Returns false if the region has no prepared reader, or if reading its samples failed.
+    */
+    bool renderPlaybackRegion (const PreparedPlaybackRegion& preparedRegion, AudioBuffer<float>& buffer, int startInBuffer,
+                               int64 startInPlayback, int numSamples, double pitchRatio = 1.0, bool playReversed = false) noexcept;
+
+    /** Returns the number of samples that have been rendered from the cache since prepare() was called. */
+    int64 getNumCachedSamplesRendered() const noexcept      { return numCachedSamplesRendered.load (std::memory_order_relaxed); }
+
+    /** Returns the number of samples that have been stretched since prepare() was called. */
+    int64 getNumStretchedSamplesRendered() const noexcept   { return numStretchedSamplesRendered.load (std::memory_order_relaxed); }
+
+    /** The number of samples in each cached block. */
+    static constexpr int cacheBlockSize = 4096;
+
+private:
+    // all properties of a region that affect the stretched output
+    struct RegionKey
+    {
+        bool operator== (const RegionKey& other) const noexcept;
+        bool operator!= (const RegionKey& other) const noexcept     { return ! operator== (other); }
+
+        const ARAPlaybackRegion* playbackRegion;
+        Range<int64> playbackSampleRange;
+        Range<int64> modificationSampleRange;
+        const AudioFormatReader* reader;
+        uint32 readerVersion;
+        double timeStretchFactor;
+        double pitchRatio;
+        bool playReversed;
+    };
+
+    struct Voice
+    {
+        ARATimeStretcher stretcher;
+        RegionKey key {};
+        uint32 lastUsed { 0 };
+    };
+
+    // The cache slots are linked into the chains of a fixed size hash table keyed by region and
+    // block index, and into a list ordered by use, so that lookups and evictions take constant time.
+    struct CacheSlot
+    {
+        RegionKey key {};
+        int64 blockIndex { 0 };
+        int numValidSamples { 0 };
+        size_t hash { 0 };
+        bool isInTable { false };
+        int nextInBucket { -1 };
+        int moreRecentlyUsed { -1 }, lessRecentlyUsed { -1 };
+    };
+
+    static size_t getCacheHash (const RegionKey& key, int64 blockIndex) noexcept;
+
+    ARATimeStretcher& getStretcherForRegion (const RegionKey& key) noexcept;
+    CacheSlot* findCacheSlot (const RegionKey& key, int64 blockIndex) noexcept;
+    CacheSlot* allocateCacheSlot (const RegionKey& key, int64 blockIndex) noexcept;
+    void removeFromBucket (int slotIndex) noexcept;
+    void moveToMostRecentlyUsed (int slotIndex) noexcept;
+    float* getCacheSlotSamples (const CacheSlot& slot, int channel) noexcept;
+
+    int numChannels { 0 };
+    std::vector<std::unique_ptr<Voice>> voices;
+    std::vector<CacheSlot> cacheSlots;
+    std::vector<int> cacheBuckets;
+    int mostRecentlyUsedSlot { -1 }, leastRecentlyUsedSlot { -1 };
+    AudioBuffer<float> cacheSamples;
+    uint32 useCounter { 0 };
+
+    std::atomic<int64> numCachedSamplesRendered { 0 }, numStretchedSamplesRendered { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ARATimeStretchStage)
+};
+
+} // namespace juce
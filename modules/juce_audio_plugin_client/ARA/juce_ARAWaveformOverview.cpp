@@ -0,0 +1,612 @@
+#include "juce_ARAWaveformOverview.h"
+
+namespace juce
+{
+
+namespace ARAWaveformOverviewHelpers
+{
+    static constexpr int streamMagic = 0x4a574f56;  // "JWOV"
+    static constexpr int streamVersion = 1;
+}
+
+//==============================================================================
+
+ARAWaveformOverview::ARAWaveformOverview (double newSampleRate, int newNumChannels, int64 newLengthInSamples,
+                                          int samplesPerBin, int factor)
+    : baseSamplesPerBin (jmax (1, samplesPerBin)),
+      levelFactor (jmax (2, factor))
+{
+    reset (newSampleRate, newNumChannels, newLengthInSamples);
+}
+
+void ARAWaveformOverview::reset (double newSampleRate, int newNumChannels, int64 newLengthInSamples)
+{
+    const ScopedWriteLock swl (lock);
+
+    sampleRate = newSampleRate;
+    numChannels = jmax (0, newNumChannels);
+    lengthInSamples = jmax ((int64) 0, newLengthInSamples);
+
+    levels.clear();
+
+    // the first level is always present, each following level combines levelFactor bins of its predecessor
+    for (int64 samplesPerBin = baseSamplesPerBin;; samplesPerBin *= levelFactor)
+    {
+        const auto numBins = (int) ((lengthInSamples + samplesPerBin - 1) / samplesPerBin);
+        levels.push_back ({ samplesPerBin, numBins, std::vector<Bin> ((size_t) (numBins * numChannels), Bin { 0.0f, 0.0f, 0.0f }) });
+
+        if (numBins <= 1)
+            break;
+    }
+
+    invalidBaseBins.clear();
+    if (levels[0].numBins > 0)
+        invalidBaseBins.addRange ({ 0, levels[0].numBins });
+
+    ++formatCounter;
+    binsBeingBuiltWereInvalidated = true;
+}
+
+double ARAWaveformOverview::getSampleRate() const
+{
+    const ScopedReadLock srl (lock);
+    return sampleRate;
+}
+
+int ARAWaveformOverview::getNumChannels() const
+{
+    const ScopedReadLock srl (lock);
+    return numChannels;
+}
+
+int64 ARAWaveformOverview::getLengthInSamples() const
+{
+    const ScopedReadLock srl (lock);
+    return lengthInSamples;
+}
+
+int ARAWaveformOverview::getNumLevels() const
+{
+    const ScopedReadLock srl (lock);
+    return (int) levels.size();
+}
+
+int64 ARAWaveformOverview::getSamplesPerBin (int level) const
+{
+    const ScopedReadLock srl (lock);
+    jassert (isPositiveAndBelow (level, (int) levels.size()));
+    return levels[(size_t) jlimit (0, (int) levels.size() - 1, level)].samplesPerBin;
+}
+
+//==============================================================================
+
+bool ARAWaveformOverview::getBins (int channel, Range<double> timeRange, Bin* destBins, int numBins) const
+{
+    const ScopedReadLock srl (lock);
+
+    if (numBins <= 0)
+        return true;
+
+    if (! isPositiveAndBelow (channel, numChannels))
+    {
+        jassertfalse;
+        std::fill (destBins, destBins + numBins, Bin { 0.0f, 0.0f, 0.0f });
+        return false;
+    }
+
+    // pick the coarsest level that still has at least one bin per destination bin
+    const auto samplesPerDestBin = timeRange.getLength() * sampleRate / numBins;
+    size_t levelIndex = 0;
+    while (levelIndex + 1 < levels.size() && (double) levels[levelIndex + 1].samplesPerBin <= samplesPerDestBin)
+        ++levelIndex;
+
+    const auto& level = levels[levelIndex];
+    const auto* channelBins = level.bins.data() + (size_t) channel * (size_t) level.numBins;
+    auto isComplete = true;
+
+    for (int i = 0; i < numBins; ++i)
+    {
+        const auto startSample = jmax ((int64) 0, (int64) std::floor ((timeRange.getStart() + timeRange.getLength() * i / numBins) * sampleRate));
+        const auto endSample = jmin (lengthInSamples, (int64) std::ceil ((timeRange.getStart() + timeRange.getLength() * (i + 1) / numBins) * sampleRate));
+
+        if (startSample >= endSample)
+        {
+            destBins[i] = { 0.0f, 0.0f, 0.0f };
+            continue;
+        }
+
+        const auto startBin = (int) (startSample / level.samplesPerBin);
+        const auto endBin = jmin (level.numBins, (int) ((endSample + level.samplesPerBin - 1) / level.samplesPerBin));
+
+        auto minValue = channelBins[startBin].minValue;
+        auto maxValue = channelBins[startBin].maxValue;
+        auto sumOfSquares = 0.0;
+        int64 numSamples = 0;
+
+        for (auto b = startBin; b < endBin; ++b)
+        {
+            const auto numBinSamples = jmin (level.samplesPerBin, lengthInSamples - b * level.samplesPerBin);
+
+            minValue = jmin (minValue, channelBins[b].minValue);
+            maxValue = jmax (maxValue, channelBins[b].maxValue);
+            sumOfSquares += (double) channelBins[b].rms * channelBins[b].rms * (double) numBinSamples;
+            numSamples += numBinSamples;
+        }
+
+        destBins[i] = { minValue, maxValue, (float) std::sqrt (sumOfSquares / (double) numSamples) };
+
+        const auto baseBinsPerBin = (int) (level.samplesPerBin / baseSamplesPerBin);
+        if (invalidBaseBins.overlapsRange ({ startBin * baseBinsPerBin, endBin * baseBinsPerBin }))
+            isComplete = false;
+    }
+
+    return isComplete;
+}
+
+bool ARAWaveformOverview::isFullyBuilt() const
+{
+    const ScopedReadLock srl (lock);
+    return invalidBaseBins.isEmpty();
+}
+
+double ARAWaveformOverview::getBuildProgress() const
+{
+    const ScopedReadLock srl (lock);
+
+    if (levels[0].numBins == 0)
+        return 1.0;
+
+    return 1.0 - (double) invalidBaseBins.size() / levels[0].numBins;
+}
+
+//==============================================================================
+
+void ARAWaveformOverview::invalidate (Range<int64> sampleRange)
+{
+    const ScopedWriteLock swl (lock);
+
+    sampleRange = sampleRange.getIntersectionWith ({ 0, lengthInSamples });
+    if (sampleRange.isEmpty())
+        return;
+
+    // the previous values of the bins are kept until they have been rebuilt, so that views don't flicker
+    const Range<int> binRange { (int) (sampleRange.getStart() / baseSamplesPerBin),
+                                (int) ((sampleRange.getEnd() + baseSamplesPerBin - 1) / baseSamplesPerBin) };
+    invalidBaseBins.addRange (binRange);
+
+    if (binRange.intersects (binsBeingBuilt))
+        binsBeingBuiltWereInvalidated = true;
+}
+
+void ARAWaveformOverview::invalidateAll()
+{
+    invalidate ({ 0, std::numeric_limits<int64>::max() });
+}
+
+bool ARAWaveformOverview::buildNextChunk (AudioFormatReader& reader, int maxNumBins)
+{
+    Range<int> binRange;
+    int64 startSample, endSample;
+    int numChannelsToBuild;
+    uint32 counter;
+
+    {
+        const ScopedWriteLock swl (lock);
+
+        if (invalidBaseBins.isEmpty())
+            return true;
+
+        binRange = invalidBaseBins.getRange (0);
+        binRange.setLength (jmin (binRange.getLength(), jmax (1, maxNumBins)));
+
+        startSample = (int64) binRange.getStart() * baseSamplesPerBin;
+        endSample = jmin (lengthInSamples, (int64) binRange.getEnd() * baseSamplesPerBin);
+        numChannelsToBuild = numChannels;
+        counter = formatCounter;
+
+        binsBeingBuilt = binRange;
+        binsBeingBuiltWereInvalidated = false;
+    }
+
+    // read and analyse the samples without holding the lock, so that views are not blocked
+    const auto numSamples = (int) (endSample - startSample);
+    if (buildBuffer.getNumChannels() < numChannelsToBuild || buildBuffer.getNumSamples() < numSamples)
+        buildBuffer.setSize (jmax (numChannelsToBuild, buildBuffer.getNumChannels()), jmax (numSamples, buildBuffer.getNumSamples()), false, false, true);
+
+    if (numChannelsToBuild > 0 && ! reader.read (buildBuffer.getArrayOfWritePointers(), numChannelsToBuild, startSample, numSamples))
+    {
+        const ScopedWriteLock swl (lock);
+        binsBeingBuilt = {};
+        return false;
+    }
+
+    builtBins.resize ((size_t) (numChannelsToBuild * binRange.getLength()));
+
+    for (int c = 0; c < numChannelsToBuild; ++c)
+    {
+        const auto* samples = buildBuffer.getReadPointer (c);
+
+        for (int b = 0; b < binRange.getLength(); ++b)
+        {
+            const auto offset = b * baseSamplesPerBin;
+            const auto numBinSamples = jmin (baseSamplesPerBin, numSamples - offset);
+            const auto minMax = FloatVectorOperations::findMinAndMax (samples + offset, numBinSamples);
+
+            auto sumOfSquares = 0.0;
+            for (int i = 0; i < numBinSamples; ++i)
+                sumOfSquares += (double) samples[offset + i] * samples[offset + i];
+
+            builtBins[(size_t) (c * binRange.getLength() + b)] = { minMax.getStart(), minMax.getEnd(),
+                                                                   (float) std::sqrt (sumOfSquares / numBinSamples) };
+        }
+    }
+
+    {
+        const ScopedWriteLock swl (lock);
+
+        // drop the results if the format has changed in the meantime
+        if (counter != formatCounter)
+            return true;
+
+        auto& level = levels[0];
+        for (int c = 0; c < numChannelsToBuild; ++c)
+            std::copy_n (builtBins.begin() + c * binRange.getLength(), binRange.getLength(),
+                         level.bins.begin() + c * level.numBins + binRange.getStart());
+
+        // if the range has been invalidated while reading, keep it pending so it will be rebuilt
+        if (! binsBeingBuiltWereInvalidated)
+            invalidBaseBins.removeRange (binRange);
+
+        binsBeingBuilt = {};
+
+        updateParentBins (binRange);
+    }
+
+    sendChangeMessage();
+    return true;
+}
+
+void ARAWaveformOverview::updateParentBins (Range<int> baseBinRange)
+{
+    auto childRange = baseBinRange;
+
+    for (size_t l = 1; l < levels.size(); ++l)
+    {
+        const auto& childLevel = levels[l - 1];
+        auto& level = levels[l];
+
+        const Range<int> range { childRange.getStart() / levelFactor,
+                                 jmin (level.numBins, (childRange.getEnd() + levelFactor - 1) / levelFactor) };
+
+        for (int c = 0; c < numChannels; ++c)
+        {
+            const auto* childBins = childLevel.bins.data() + (size_t) c * (size_t) childLevel.numBins;
+            auto* bins = level.bins.data() + (size_t) c * (size_t) level.numBins;
+
+            for (auto b = range.getStart(); b < range.getEnd(); ++b)
+            {
+                const auto firstChild = b * levelFactor;
+                const auto endChild = jmin (childLevel.numBins, firstChild + levelFactor);
+
+                auto bin = childBins[firstChild];
+                auto sumOfSquares = 0.0;
+                int64 numSamples = 0;
+
+                // the last bin of each level may be shorter, so the RMS values are weighted by their length
+                for (auto child = firstChild; child < endChild; ++child)
+                {
+                    const auto numChildSamples = jmin (childLevel.samplesPerBin, lengthInSamples - child * childLevel.samplesPerBin);
+
+                    bin.minValue = jmin (bin.minValue, childBins[child].minValue);
+                    bin.maxValue = jmax (bin.maxValue, childBins[child].maxValue);
+                    sumOfSquares += (double) childBins[child].rms * childBins[child].rms * (double) numChildSamples;
+                    numSamples += numChildSamples;
+                }
+
+                bin.rms = (numSamples > 0) ? (float) std::sqrt (sumOfSquares / (double) numSamples) : 0.0f;
+                bins[b] = bin;
+            }
+        }
+
+        childRange = range;
+    }
+}
+
+//==============================================================================
+
+void ARAWaveformOverview::writeToStream (OutputStream& output) const
+{
+    const ScopedReadLock srl (lock);
+
+    output.writeInt (ARAWaveformOverviewHelpers::streamMagic);
+    output.writeInt (ARAWaveformOverviewHelpers::streamVersion);
+    output.writeDouble (sampleRate);
+    output.writeInt (numChannels);
+    output.writeInt64 (lengthInSamples);
+    output.writeInt (baseSamplesPerBin);
+
+    // only the first level is stored, the others are recomputed when restoring
+    for (auto& bin : levels[0].bins)
+    {
+        output.writeFloat (bin.minValue);
+        output.writeFloat (bin.maxValue);
+        output.writeFloat (bin.rms);
+    }
+}
+
+bool ARAWaveformOverview::readFromStream (InputStream& input)
+{
+    if (input.readInt() != ARAWaveformOverviewHelpers::streamMagic || input.readInt() != ARAWaveformOverviewHelpers::streamVersion)
+        return false;
+
+    const auto storedSampleRate = input.readDouble();
+    const auto storedNumChannels = input.readInt();
+    const auto storedLengthInSamples = input.readInt64();
+    const auto storedSamplesPerBin = input.readInt();
+
+    std::vector<Bin> bins;
+    uint32 counter;
+
+    {
+        const ScopedReadLock srl (lock);
+
+        if (storedSampleRate != sampleRate || storedNumChannels != numChannels
+             || storedLengthInSamples != lengthInSamples || storedSamplesPerBin != baseSamplesPerBin)
+            return false;
+
+        bins.resize (levels[0].bins.size());
+        counter = formatCounter;
+    }
+
+    const auto numBytesRemaining = input.getNumBytesRemaining();
+    if (numBytesRemaining >= 0 && numBytesRemaining < (int64) (bins.size() * 3 * sizeof (float)))
+        return false;
+
+    for (auto& bin : bins)
+    {
+        bin.minValue = input.readFloat();
+        bin.maxValue = input.readFloat();
+        bin.rms = input.readFloat();
+    }
+
+    {
+        const ScopedWriteLock swl (lock);
+
+        if (counter != formatCounter)
+            return false;
+
+        levels[0].bins = std::move (bins);
+        updateParentBins ({ 0, levels[0].numBins });
+
+        invalidBaseBins.clear();
+        binsBeingBuiltWereInvalidated = true;
+    }
+
+    sendChangeMessage();
+    return true;
+}
+
+//==============================================================================
+
+ARAWaveformOverviewManager::Builder::Builder (ARAAudioSource* source, int samplesPerBin, int factor)
+    : audioSource (source),
+      overview (source->getSampleRate(), (int) source->getChannelCount(), source->getSampleCount(), samplesPerBin, factor)
+{
+    recreateReader();
+}
+
+void ARAWaveformOverviewManager::Builder::recreateReader()
+{
+    auto newReader = std::make_unique<ARAAudioSourceReader> (audioSource);
+
+    const ScopedLock sl (readerLock);
+    std::swap (reader, newReader);
+}
+
+bool ARAWaveformOverviewManager::Builder::needsNewReader()
+{
+    const ScopedLock sl (readerLock);
+    return ! reader->isValid();
+}
+
+int ARAWaveformOverviewManager::Builder::useTimeSlice()
+{
+    // when idle, check back regularly - any invalidation will wake us up immediately anyways
+    static constexpr int idleIntervalMs = 500;
+
+    const ScopedLock sl (readerLock);
+
+    if (! reader->isValid() || overview.isFullyBuilt())
+        return idleIntervalMs;
+
+    // reading fails while the host has disabled sample access, so retry later
+    if (! overview.buildNextChunk (*reader))
+        return idleIntervalMs;
+
+    return 0;
+}
+
+//==============================================================================
+
+ARAWaveformOverviewManager::ARAWaveformOverviewManager (int samplesPerBin, int factor)
+    : baseSamplesPerBin (samplesPerBin),
+      levelFactor (factor),
+      thread ("ARA Waveform Overview Thread")
+{
+}
+
+ARAWaveformOverviewManager::~ARAWaveformOverviewManager()
+{
+    cancelPendingUpdate();
+    thread.stopThread (-1);
+
+    for (auto& builder : builders)
+        builder->audioSource->removeListener (this);
+}
+
+ARAWaveformOverviewManager::Builder* ARAWaveformOverviewManager::getBuilder (ARAAudioSource* audioSource) const
+{
+    for (auto& builder : builders)
+        if (builder->audioSource == audioSource)
+            return builder.get();
+
+    return nullptr;
+}
+
+ARAWaveformOverview& ARAWaveformOverviewManager::getOverview (ARAAudioSource* audioSource)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    if (auto* builder = getBuilder (audioSource))
+        return builder->overview;
+
+    audioSource->addListener (this);
+    builders.push_back (std::make_unique<Builder> (audioSource, baseSamplesPerBin, levelFactor));
+
+    auto* builder = builders.back().get();
+    thread.addTimeSliceClient (builder);
+
+    if (! thread.isThreadRunning())
+        thread.startThread (3);   // below "default" priority, since the overviews are only needed for drawing
+
+    return builder->overview;
+}
+
+void ARAWaveformOverviewManager::prioritiseOverview (ARAAudioSource* audioSource)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    if (auto* builder = getBuilder (audioSource))
+        thread.moveToFrontOfQueue (builder);
+}
+
+//==============================================================================
+
+bool ARAWaveformOverviewManager::storeOverviews (ARAOutputStream& output, const ARAStoreObjectsFilter* filter)
+{
+    // partially built overviews are not stored, they will be rebuilt after restoring
+    std::vector<Builder*> buildersToStore;
+    for (auto* audioSource : filter->getAudioSourcesToStore<ARAAudioSource>())
+        if (auto* builder = getBuilder (const_cast<ARAAudioSource*> (audioSource)))
+            if (builder->overview.isFullyBuilt())
+                buildersToStore.push_back (builder);
+
+    auto success = output.writeInt64 ((int64) buildersToStore.size());
+
+    for (auto* builder : buildersToStore)
+    {
+        MemoryOutputStream data;
+        builder->overview.writeToStream (data);
+
+        success = success && output.writeString (builder->audioSource->getPersistentID());
+        success = success && output.writeFrame (data.getData(), data.getDataSize(), true);
+    }
+
+    return success;
+}
+
+bool ARAWaveformOverviewManager::restoreOverviews (ARAInputStream& input, const ARARestoreObjectsFilter* filter)
+{
+    const auto numOverviews = input.readInt64();
+
+    for (int64 i = 0; i < numOverviews; ++i)
+    {
+        const auto persistentID = input.readString();
+
+        MemoryBlock data;
+        if (! input.readFrame (data))
+            return false;
+
+        if (auto* audioSource = filter->getAudioSourceToRestoreStateWithID<ARAAudioSource> (persistentID.getCharPointer()))
+        {
+            MemoryInputStream stream (data, false);
+            getOverview (audioSource).readFromStream (stream);
+        }
+    }
+
+    return ! input.failed();
+}
+
+//==============================================================================
+
+void ARAWaveformOverviewManager::wakeUpBuilder (Builder& builder)
+{
+    thread.moveToFrontOfQueue (&builder);
+}
+
+void ARAWaveformOverviewManager::handleAsyncUpdate()
+{
+    // readers are not recreated from within the notifications that invalidated them,
+    // since the new reader would then receive the remaining part of that notification
+    for (auto& builder : builders)
+    {
+        if (builder->needsNewReader())
+        {
+            builder->recreateReader();
+            wakeUpBuilder (*builder);
+        }
+    }
+}
+
+void ARAWaveformOverviewManager::didUpdateAudioSourceProperties (ARAAudioSource* audioSource)
+{
+    if (auto* builder = getBuilder (audioSource))
+    {
+        auto& overview = builder->overview;
+
+        if (overview.getSampleRate() != audioSource->getSampleRate()
+             || overview.getNumChannels() != (int) audioSource->getChannelCount()
+             || overview.getLengthInSamples() != audioSource->getSampleCount())
+        {
+            overview.reset (audioSource->getSampleRate(), (int) audioSource->getChannelCount(), audioSource->getSampleCount());
+            triggerAsyncUpdate();
+        }
+    }
+}
+
+void ARAWaveformOverviewManager::doUpdateAudioSourceContent (ARAAudioSource* audioSource, ARAContentUpdateScopes scopeFlags)
+{
+    if (scopeFlags.affectSamples())
+    {
+        if (auto* builder = getBuilder (audioSource))
+        {
+            builder->overview.invalidateAll();
+            triggerAsyncUpdate();
+        }
+    }
+}
+
+void ARAWaveformOverviewManager::doUpdateAudioSourceContentInRange (ARAAudioSource* audioSource, Range<double> affectedTimeRange, ARAContentUpdateScopes scopeFlags)
+{
+    if (scopeFlags.affectSamples())
+    {
+        if (auto* builder = getBuilder (audioSource))
+        {
+            const auto sampleRate = audioSource->getSampleRate();
+            builder->overview.invalidate ({ (int64) std::floor (affectedTimeRange.getStart() * sampleRate),
+                                            (int64) std::ceil (affectedTimeRange.getEnd() * sampleRate) });
+            wakeUpBuilder (*builder);
+        }
+    }
+}
+
+void ARAWaveformOverviewManager::didEnableAudioSourceSamplesAccess (ARAAudioSource* audioSource, bool enable)
+{
+    if (enable)
+        if (auto* builder = getBuilder (audioSource))
+            wakeUpBuilder (*builder);
+}
+
+void ARAWaveformOverviewManager::willDestroyAudioSource (ARAAudioSource* audioSource)
+{
+    if (auto* builder = getBuilder (audioSource))
+    {
+        // this blocks until any chunk currently being built has been finished
+        thread.removeTimeSliceClient (builder);
+
+        audioSource->removeListener (this);
+        builders.erase (std::find_if (builders.begin(), builders.end(), [builder] (const auto& b) { return b.get() == builder; }));
+    }
+}
+
+} // namespace juce
@@ -0,0 +1,234 @@
+#pragma once
+
+#include "juce_ARAAudioReaders.h"
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A multi-resolution overview of the samples of an audio source, as used for drawing waveforms.
+
+    The overview stores the minimum, maximum and RMS value of each channel for consecutive bins of
+    samples, in a number of levels of decreasing resolution: the first level uses bins of
+    getSamplesPerBin (0) samples, and each following level combines a fixed number of bins of the
+    previous level into one.
+    Any time range of the audio source can be mapped to bins via getBins(), which picks the level
+    that best matches the requested resolution. Since the overview covers the entire audio source,
+    the view of a playback region can be derived from it by mapping the region's time range into
+    the audio source, so moving or trimming regions does not require to read any samples.
+
+    Overviews are typically obtained from the ARAWaveformOverviewManager of the document
+    controller, which builds them in the background and keeps them up to date, but they can also
+    be built from any AudioFormatReader via buildNextChunk().
+
+    Bins that have not been built yet are reported as silence, while bins that have been invalidated
+    keep their previous values until they have been rebuilt, so that views don't flicker when the
+    samples are edited. Registered ChangeListeners are notified whenever bins have been (re)built.
+
+    All functions are thread-safe.
+
+    @tags{ARA}
+*/
+class JUCE_API  ARAWaveformOverview  : public ChangeBroadcaster
+{
+public:
+    /** The values of a single bin of samples of one channel. */
+    struct Bin
+    {
+        float minValue, maxValue, rms;
+    };
+
+    /** Creates an overview for a signal of the given format.
+        @param sampleRate           The sample rate of the signal.
+        @param numChannels          The number of channels of the signal.
+        @param lengthInSamples      The length of the signal.
+        @param baseSamplesPerBin    The number of samples per bin of the level with the highest resolution.
+        @param levelFactor          The number of bins of each level that are combined into one bin of the next level.
+    */
+    ARAWaveformOverview (double sampleRate, int numChannels, int64 lengthInSamples,
+                         int baseSamplesPerBin = defaultBaseSamplesPerBin, int levelFactor = defaultLevelFactor);
+
+    /** Changes the format of the signal, which invalidates all bins. */
+    void reset (double sampleRate, int numChannels, int64 lengthInSamples);
+
+    double getSampleRate() const;
+    int getNumChannels() const;
+    int64 getLengthInSamples() const;
+
+    /** Returns the number of levels, the first one having the highest resolution. */
+    int getNumLevels() const;
+
+    /** Returns the number of samples that are combined into a single bin of the given level. */
+    int64 getSamplesPerBin (int level) const;
+
+    //==============================================================================
+    /** Computes the bins for a time range of the signal, e.g. for drawing one bin per pixel.
+
+        Each of the \p numBins destination bins covers an equal part of \p timeRange, and is
+        combined from the bins of the level that best matches that duration. If the duration is
+        shorter than the bins of the first level, consecutive destination bins may be identical.
+        Parts of the range outside of the signal are reported as silence.
+        @returns true if all bins covering the range have been built.
+    */
+    bool getBins (int channel, Range<double> timeRange, Bin* destBins, int numBins) const;
+
+    /** Returns true if all bins have been built. */
+    bool isFullyBuilt() const;
+
+    /** Returns the fraction of the bins of the first level that have been built. */
+    double getBuildProgress() const;
+
+    //==============================================================================
+    /** Marks the bins covering the given range of samples as needing to be rebuilt. */
+    void invalidate (Range<int64> sampleRange);
+
+    /** Marks all bins as needing to be rebuilt. */
+    void invalidateAll();
+
+    /** Builds up to \p maxNumBins bins of the first level (and their parents in all other levels)
+        that need to be rebuilt, reading the samples from the given reader.
+        This must not be called concurrently from several threads.
+        @returns false if reading the samples failed.
+    */
+    bool buildNextChunk (AudioFormatReader& reader, int maxNumBins = 256);
+
+    //==============================================================================
+    /** Writes the overview to a stream, see readFromStream(). Only bins that are built are valid
+        when restored, so this is typically only called if isFullyBuilt() returns true.
+    */
+    void writeToStream (OutputStream& output) const;
+
+    /** Restores an overview written by writeToStream().
+        @returns false if the data is invalid or was written for a different signal format or
+                 number of samples per bin, in which case the overview is unchanged.
+    */
+    bool readFromStream (InputStream& input);
+
+    /** The default number of samples per bin of the first level. */
+    static constexpr int defaultBaseSamplesPerBin = 256;
+
+    /** The default number of bins that are combined into one bin of the next level. */
+    static constexpr int defaultLevelFactor = 4;
+
+private:
+    struct Level
+    {
+        int64 samplesPerBin;
+        int numBins;
+        std::vector<Bin> bins;   // all bins of channel 0, followed by those of channel 1 etc.
+    };
+
+    void updateParentBins (Range<int> baseBinRange);
+
+    const int baseSamplesPerBin, levelFactor;
+
+    mutable ReadWriteLock lock;
+    double sampleRate { 0.0 };
+    int numChannels { 0 };
+    int64 lengthInSamples { 0 };
+    std::vector<Level> levels;
+    SparseSet<int> invalidBaseBins;
+    uint32 formatCounter { 0 };
+    Range<int> binsBeingBuilt;
+    bool binsBeingBuiltWereInvalidated { false };
+
+    AudioBuffer<float> buildBuffer;
+    std::vector<Bin> builtBins;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ARAWaveformOverview)
+};
+
+//==============================================================================
+/**
+    Creates and maintains an ARAWaveformOverview for each audio source of a document.
+
+    The manager is owned by the ARADocumentController (see ARADocumentController::getWaveformOverviewManager()).
+    Overviews are created upon first request and built on a shared background thread. They are
+    updated as needed when the samples of their audio source change: content updates that are
+    limited to a time range only rebuild the bins in that range.
+
+    The overviews can be persisted alongside the document, by calling storeOverviews() and
+    restoreOverviews() from ARADocumentController::doStoreObjectsToStream() and
+    ARADocumentController::doRestoreObjectsFromStream() respectively.
+
+    @tags{ARA}
+*/
+class JUCE_API  ARAWaveformOverviewManager  : private ARAAudioSource::Listener,
+                                              private AsyncUpdater
+{
+public:
+    /** Creates a manager.
+        @param baseSamplesPerBin    The number of samples per bin of the first level of each overview.
+        @param levelFactor          The number of bins that are combined into one bin of the next level.
+    */
+    explicit ARAWaveformOverviewManager (int baseSamplesPerBin = ARAWaveformOverview::defaultBaseSamplesPerBin,
+                                         int levelFactor = ARAWaveformOverview::defaultLevelFactor);
+
+    ~ARAWaveformOverviewManager() override;
+
+    /** Returns the overview of the given audio source, creating it and starting to build it if needed
+        (message thread only).
+        The overview remains valid until the audio source is destroyed.
+    */
+    ARAWaveformOverview& getOverview (ARAAudioSource* audioSource);
+
+    /** Moves building the overview of the given audio source to the front of the queue,
+        e.g. because it is visible in the editor (message thread only).
+    */
+    void prioritiseOverview (ARAAudioSource* audioSource);
+
+    //==============================================================================
+    /** Writes the fully built overviews of the audio sources to be stored to an archive.
+        Call this from your override of ARADocumentController::doStoreObjectsToStream().
+    */
+    bool storeOverviews (ARAOutputStream& output, const ARAStoreObjectsFilter* filter);
+
+    /** Restores the overviews written by storeOverviews() for all audio sources to be restored.
+        Call this from your override of ARADocumentController::doRestoreObjectsFromStream().
+        Overviews that don't match the current state of their audio source are dropped, and
+        will be rebuilt from the audio source samples.
+    */
+    bool restoreOverviews (ARAInputStream& input, const ARARestoreObjectsFilter* filter);
+
+private:
+    //==============================================================================
+    // Builds an overview on the background thread, using a reader of its audio source.
+    class Builder  : public TimeSliceClient
+    {
+    public:
+        Builder (ARAAudioSource* audioSource, int baseSamplesPerBin, int levelFactor);
+
+        int useTimeSlice() override;
+
+        void recreateReader();
+        bool needsNewReader();
+
+        ARAAudioSource* const audioSource;
+        ARAWaveformOverview overview;
+
+    private:
+        CriticalSection readerLock;
+        std::unique_ptr<ARAAudioSourceReader> reader;
+    };
+
+    Builder* getBuilder (ARAAudioSource* audioSource) const;
+    void wakeUpBuilder (Builder& builder);
+
+    void handleAsyncUpdate() override;
+
+    void didUpdateAudioSourceProperties (ARAAudioSource* audioSource) override;
+    void doUpdateAudioSourceContent (ARAAudioSource* audioSource, ARAContentUpdateScopes scopeFlags) override;
+    void doUpdateAudioSourceContentInRange (ARAAudioSource* audioSource, Range<double> affectedTimeRange, ARAContentUpdateScopes scopeFlags) override;
+    void didEnableAudioSourceSamplesAccess (ARAAudioSource* audioSource, bool enable) override;
+    void willDestroyAudioSource (ARAAudioSource* audioSource) override;
+
+    const int baseSamplesPerBin, levelFactor;
+
+    TimeSliceThread thread;
+    std::vector<std::unique_ptr<Builder>> builders;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ARAWaveformOverviewManager)
+};
+
+} // namespace juce
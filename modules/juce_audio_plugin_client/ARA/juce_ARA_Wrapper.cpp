@@ -15,10 +15,21 @@ JUCE_BEGIN_IGNORE_WARNINGS_MSVC (4100)
 #include <ARA_Library/Utilities/ARAPitchInterpretation.cpp>
 
 // Include these source files directly for now
+#include "juce_ARAReadEpoch.cpp"
+#include "juce_ARATempoMap.cpp"
+#include "juce_ARAModelObjectPool.cpp"
 #include "juce_ARAModelObjects.cpp"
 #include "juce_ARADocumentController.cpp"
+#include "juce_ARAAudioSourceBlockCache.cpp"
 #include "juce_ARAAudioReaders.cpp"
+#include "juce_ARAConvertingAudioReader.cpp"
+#include "juce_ARAAnalysisScheduler.cpp"
+#include "juce_ARAAnalysisCache.cpp"
+#include "juce_ARAWaveformOverview.cpp"
 #include "juce_ARAPlugInInstanceRoles.cpp"
+#if JUCE_MODULE_AVAILABLE_juce_dsp
+ #include "juce_ARATimeStretcher.cpp"
+#endif
 #include "juce_AudioProcessor_ARAExtensions.cpp"
 
 JUCE_END_IGNORE_WARNINGS_MSVC
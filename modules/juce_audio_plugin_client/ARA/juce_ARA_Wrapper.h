@@ -47,10 +47,24 @@
  } // namespace juce
 
  // Include JUCE_ARA integration headers
+ #include <juce_audio_plugin_client/ARA/juce_ARAReadEpoch.h>
+ #include <juce_audio_plugin_client/ARA/juce_ARATempoMap.h>
+ #include <juce_audio_plugin_client/ARA/juce_ARAModelObjectPool.h>
  #include <juce_audio_plugin_client/ARA/juce_ARAModelObjects.h>
  #include <juce_audio_plugin_client/ARA/juce_ARADocumentController.h>
  #include <juce_audio_plugin_client/ARA/juce_AudioProcessor_ARAExtensions.h>
+ #include <juce_audio_plugin_client/ARA/juce_ARAAudioSourceBlockCache.h>
  #include <juce_audio_plugin_client/ARA/juce_ARAAudioReaders.h>
+ #include <juce_audio_plugin_client/ARA/juce_ARAConvertingAudioReader.h>
+ #include <juce_audio_plugin_client/ARA/juce_ARAAnalysisScheduler.h>
+ #include <juce_audio_plugin_client/ARA/juce_ARAAnalysisCache.h>
+ #include <juce_audio_plugin_client/ARA/juce_ARAWaveformOverview.h>
  #include <juce_audio_plugin_client/ARA/juce_ARAPlugInInstanceRoles.h>
 
+ // The time stretching utilities are only available if the juce_dsp module is used
+ #if JUCE_MODULE_AVAILABLE_juce_dsp
+  #include <juce_dsp/juce_dsp.h>
+  #include <juce_audio_plugin_client/ARA/juce_ARATimeStretcher.h>
+ #endif
+
 #endif
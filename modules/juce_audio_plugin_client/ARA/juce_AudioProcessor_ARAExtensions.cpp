@@ -16,7 +16,8 @@ bool AudioProcessorARAExtension::getTailLengthSecondsForARA (double& tailLength)
     return true;
 }
 
-bool AudioProcessorARAExtension::prepareToPlayForARA (double sampleRate, int samplesPerBlock, int numChannels)
+bool AudioProcessorARAExtension::prepareToPlayForARA (double sampleRate, int samplesPerBlock, int numChannels,
+                                                      AudioProcessor::ProcessingPrecision precision)
 {
 #if ARA_VALIDATE_API_CALLS
     isPrepared = true;
@@ -26,10 +27,10 @@ bool AudioProcessorARAExtension::prepareToPlayForARA (double sampleRate, int sam
         return false;
 
     if (auto playbackRenderer = getPlaybackRenderer())
-        playbackRenderer->prepareToPlay (sampleRate, samplesPerBlock, numChannels);
+        playbackRenderer->prepareToPlay (sampleRate, samplesPerBlock, numChannels, false, precision);
 
     if (auto editorRenderer = getEditorRenderer())
-        editorRenderer->prepareToPlay (sampleRate, samplesPerBlock, numChannels);
+        editorRenderer->prepareToPlay (sampleRate, samplesPerBlock, numChannels, false, precision);
 
     return true;
 }
@@ -52,7 +53,8 @@ bool AudioProcessorARAExtension::releaseResourcesForARA()
     return true;
 }
 
-bool AudioProcessorARAExtension::processBlockForARA (AudioBuffer<float>& buffer, bool isNonRealtime, const AudioPlayHead::CurrentPositionInfo& positionInfo)
+template <typename FloatType>
+bool AudioProcessorARAExtension::processBlockForARAImpl (AudioBuffer<FloatType>& buffer, bool isNonRealtime, const AudioPlayHead::CurrentPositionInfo& positionInfo)
 {
     // validate that the host has prepared us before processing
     ARA_VALIDATE_API_STATE (isPrepared);
@@ -73,13 +75,34 @@ bool AudioProcessorARAExtension::processBlockForARA (AudioBuffer<float>& buffer,
     return true;
 }
 
-bool AudioProcessorARAExtension::processBlockForARA (AudioBuffer<float>& buffer, bool isNonRealtime, AudioPlayHead* playhead)
+template <typename FloatType>
+bool AudioProcessorARAExtension::processBlockForARAImpl (AudioBuffer<FloatType>& buffer, bool isNonRealtime, AudioPlayHead* playhead)
 {
     AudioPlayHead::CurrentPositionInfo positionInfo;
     if (! isBoundToARA() || ! playhead || ! playhead->getCurrentPosition (positionInfo))
         positionInfo.resetToDefault();
 
-    return processBlockForARA(buffer, isNonRealtime, positionInfo);
+    return processBlockForARAImpl (buffer, isNonRealtime, positionInfo);
+}
+
+bool AudioProcessorARAExtension::processBlockForARA (AudioBuffer<float>& buffer, bool isNonRealtime, const AudioPlayHead::CurrentPositionInfo& positionInfo)
+{
+    return processBlockForARAImpl (buffer, isNonRealtime, positionInfo);
+}
+
+bool AudioProcessorARAExtension::processBlockForARA (AudioBuffer<float>& buffer, bool isNonRealtime, AudioPlayHead* playhead)
+{
+    return processBlockForARAImpl (buffer, isNonRealtime, playhead);
+}
+
+bool AudioProcessorARAExtension::processBlockForARA (AudioBuffer<double>& buffer, bool isNonRealtime, const AudioPlayHead::CurrentPositionInfo& positionInfo)
+{
+    return processBlockForARAImpl (buffer, isNonRealtime, positionInfo);
+}
+
+bool AudioProcessorARAExtension::processBlockForARA (AudioBuffer<double>& buffer, bool isNonRealtime, AudioPlayHead* playhead)
+{
+    return processBlockForARAImpl (buffer, isNonRealtime, playhead);
 }
 
 //==============================================================================
@@ -62,8 +62,11 @@ protected:
     /** Implementation helper for AudioProcessor::prepareToPlay():
         If bound to ARA, this traverses the instance roles to prepare them for play
         and returns true. Otherwise returns false and does nothing.
+        Pass the AudioProcessor's getProcessingPrecision() if the processor supports double precision
+        processing, so that the instance roles can prepare for it.
     */
-    bool prepareToPlayForARA (double sampleRate, int samplesPerBlock, int numChannels);
+    bool prepareToPlayForARA (double sampleRate, int samplesPerBlock, int numChannels,
+                              AudioProcessor::ProcessingPrecision precision = AudioProcessor::singlePrecision);
 
     /** Implementation helper for AudioProcessor::releaseResources():
         If bound to ARA, this traverses the instance roles to let them release ressources
@@ -85,6 +88,18 @@ protected:
     */
     bool processBlockForARA (AudioBuffer<float>& buffer, bool isNonRealtime, AudioPlayHead* playhead);
 
+    /** Implementation helper for the double precision variant of AudioProcessor::processBlock(),
+        see the float variant for details.
+        The instance roles must have been prepared for double precision via prepareToPlayForARA().
+    */
+    bool processBlockForARA (AudioBuffer<double>& buffer, bool isNonRealtime, const AudioPlayHead::CurrentPositionInfo& positionInfo);
+
+    /** Implementation helper for the double precision variant of AudioProcessor::processBlock(),
+        see the float variant for details.
+        The instance roles must have been prepared for double precision via prepareToPlayForARA().
+    */
+    bool processBlockForARA (AudioBuffer<double>& buffer, bool isNonRealtime, AudioPlayHead* playhead);
+
     //==============================================================================
     /** Optional hook for derived classes to perform any additional initialization that may be needed.
         If overriding this, make sure you call the base class implementation from your override.
@@ -92,6 +107,12 @@ protected:
     void didBindToARA() noexcept override;
     
 private:
+    template <typename FloatType>
+    bool processBlockForARAImpl (AudioBuffer<FloatType>& buffer, bool isNonRealtime, const AudioPlayHead::CurrentPositionInfo& positionInfo);
+
+    template <typename FloatType>
+    bool processBlockForARAImpl (AudioBuffer<FloatType>& buffer, bool isNonRealtime, AudioPlayHead* playhead);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioProcessorARAExtension)
 };
 
@@ -149,6 +149,8 @@ struct AutoResizingNSViewComponentWithParent  : public AutoResizingNSViewCompone
 #include "format_types/juce_AudioUnitPluginFormat.mm"
 #include "scanning/juce_KnownPluginList.cpp"
 #include "scanning/juce_PluginDirectoryScanner.cpp"
+#include "scanning/juce_PluginScanCache.cpp"
+#include "scanning/juce_ParallelPluginScanner.cpp"
 #include "scanning/juce_PluginListComponent.cpp"
 #include "processors/juce_AudioProcessorParameterGroup.cpp"
 #include "utilities/juce_AudioProcessorParameterWithID.cpp"
@@ -34,6 +34,386 @@ static void updateOnMessageThread (AsyncUpdater& updater)
         updater.triggerAsyncUpdate();
 }
 
+//==============================================================================
+/*  A fixed set of realtime threads that help the audio thread to render a block of a
+    GraphRenderSequence in parallel, see AudioProcessorGraph::setNumParallelRenderThreads().
+
+    Between blocks, the workers sleep on their thread events. run() wakes them up, executes
+    the job on the calling thread as well and returns once all workers have left the job, so
+    that the job can live on the stack of the audio thread. Workers that wake up too late for
+    a block simply go back to sleep.
+*/
+class GraphRenderThreadPool
+{
+public:
+    struct Job
+    {
+        virtual ~Job() = default;
+
+        /** Called on each thread, with 0 being the thread calling run(). */
+        virtual void execute (int threadIndex) = 0;
+    };
+
+    explicit GraphRenderThreadPool (int numThreads)
+    {
+        for (int i = 0; i < numThreads; ++i)
+            workers.add (new Worker (*this, i + 1))->startThread (Thread::realtimeAudioPriority);
+    }
+
+    ~GraphRenderThreadPool()
+    {
+        for (auto* worker : workers)
+        {
+            worker->signalThreadShouldExit();
+            worker->notify();
+        }
+
+        workers.clear();
+    }
+
+    int getNumThreads() const noexcept      { return workers.size(); }
+
+    void run (Job& job)
+    {
+        currentJob = &job;
+        acceptingWorkers = true;
+
+        for (auto* worker : workers)
+            worker->notify();
+
+        job.execute (0);
+
+        // no worker can enter the job after this, so only wait for the ones that are still in it
+        acceptingWorkers = false;
+
+        while (numActiveWorkers.load() > 0)
+            Thread::yield();
+
+        currentJob = nullptr;
+    }
+
+private:
+    struct Worker  : public Thread
+    {
+        Worker (GraphRenderThreadPool& p, int index)
+            : Thread ("Graph Render Worker"), pool (p), threadIndex (index)
+        {}
+
+        ~Worker() override
+        {
+            stopThread (-1);
+        }
+
+        void run() override
+        {
+            const ScopedNoDenormals noDenormals;
+
+            while (! threadShouldExit())
+            {
+                wait (-1);
+
+                ++pool.numActiveWorkers;
+
+                if (pool.acceptingWorkers)
+                    pool.currentJob.load()->execute (threadIndex);
+
+                --pool.numActiveWorkers;
+            }
+        }
+
+        GraphRenderThreadPool& pool;
+        const int threadIndex;
+
+        JUCE_DECLARE_NON_COPYABLE (Worker)
+    };
+
+    OwnedArray<Worker> workers;
+    std::atomic<Job*> currentJob { nullptr };
+    std::atomic<bool> acceptingWorkers { false };
+    std::atomic<int> numActiveWorkers { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (GraphRenderThreadPool)
+};
+
+struct AudioProcessorGraph::ParallelRenderPool  : public GraphRenderThreadPool
+{
+    using GraphRenderThreadPool::GraphRenderThreadPool;
+};
+
+//==============================================================================
+/*  A lock-free work-stealing deque of task indices, after Chase and Lev. The owning thread
+    pushes and pops tasks at the bottom, other threads steal them from the top.
+
+    Since each task of a render sequence becomes ready exactly once per block, the queue never
+    holds more entries than there are tasks, so it is allocated once with that capacity and
+    simply rewound before each block instead of wrapping around.
+*/
+class GraphRenderTaskQueue
+{
+public:
+    explicit GraphRenderTaskQueue (int capacity)
+        : tasks (new std::atomic<int>[(size_t) capacity])
+    {}
+
+    /** Must only be called while no other thread is accessing the queue. */
+    void clear() noexcept
+    {
+        top.store (0, std::memory_order_relaxed);
+        bottom.store (0, std::memory_order_relaxed);
+    }
+
+    /** Must only be called by the owning thread. */
+    void push (int task) noexcept
+    {
+        const auto b = bottom.load (std::memory_order_relaxed);
+        tasks[(size_t) b].store (task, std::memory_order_relaxed);
+        bottom.store (b + 1, std::memory_order_release);
+    }
+
+    /** Must only be called by the owning thread, returns -1 if the queue is empty. */
+    int pop() noexcept
+    {
+        const auto b = bottom.load (std::memory_order_relaxed) - 1;
+        bottom.store (b, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+        auto t = top.load (std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            bottom.store (b + 1, std::memory_order_relaxed);
+            return -1;
+        }
+
+        auto task = tasks[(size_t) b].load (std::memory_order_relaxed);
+
+        if (t == b)
+        {
+            // last entry, so race against any thieves for it
+            if (! top.compare_exchange_strong (t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                task = -1;
+
+            bottom.store (b + 1, std::memory_order_relaxed);
+        }
+
+        return task;
+    }
+
+    /** Can be called by any thread, returns -1 if the queue is empty or another thread won the entry. */
+    int steal() noexcept
+    {
+        auto t = top.load (std::memory_order_acquire);
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+        const auto b = bottom.load (std::memory_order_acquire);
+
+        if (t >= b)
+            return -1;
+
+        const auto task = tasks[(size_t) t].load (std::memory_order_relaxed);
+
+        if (! top.compare_exchange_strong (t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return -1;
+
+        return task;
+    }
+
+private:
+    std::unique_ptr<std::atomic<int>[]> tasks;
+    std::atomic<int> top { 0 }, bottom { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (GraphRenderTaskQueue)
+};
+
+//==============================================================================
+/*  The measurements of a node, see AudioProcessorGraph::setNodeProfilingEnabled().
+
+    Only the audio thread writes them, once per block, so any other thread can read them
+    at any time.
+*/
+struct AudioProcessorGraph::Node::ProfileData
+{
+    ProfileData() noexcept      { reset(); }
+
+    void reset() noexcept
+    {
+        for (auto* value : { &numBlocks, &totalTicks, &maxTicks, &numOverruns, &overrunTicks })
+            value->store (0, std::memory_order_relaxed);
+
+        for (auto& count : histogram)
+            count.store (0, std::memory_order_relaxed);
+    }
+
+    std::atomic<int64> numBlocks, totalTicks, maxTicks, numOverruns, overrunTicks;
+    std::atomic<int64> histogram[NodeProfile::numHistogramBuckets];
+};
+
+//==============================================================================
+/*  Collects the processing times of the nodes of a graph while node profiling is enabled.
+
+    The process ops of the render sequence only take the high resolution ticks before and after
+    calling their node, so that the workers of a parallel render don't touch any shared state.
+    Once the block is done, the audio thread adds the time of each node to its measurements,
+    and attributes the block to its most expensive node if it took longer than its duration.
+
+    Since there is only one writer, the measurements are stored without read-modify-write
+    operations, and a reset requested by another thread is carried out by the audio thread.
+*/
+class GraphRenderProfiler
+{
+public:
+    GraphRenderProfiler()
+        : microsecondsPerTick (1.0e6 / (double) Time::getHighResolutionTicksPerSecond())
+    {
+        resetTotals();
+    }
+
+    void setEnabled (bool shouldBeEnabled) noexcept     { enabled = shouldBeEnabled; }
+    bool isEnabled() const noexcept                     { return enabled; }
+
+    void requestReset() noexcept                        { resetPending = true; }
+
+    /** Must be called on the audio thread before rendering a profiled block. */
+    void beginBlock() noexcept
+    {
+        blockStartTicks = Time::getHighResolutionTicks();
+    }
+
+    /** Must be called on the audio thread after the given sequence has rendered a profiled block. */
+    template <typename RenderSequence>
+    void endBlock (RenderSequence& sequence, int numSamples, double sampleRate) noexcept
+    {
+        const auto blockTicks = Time::getHighResolutionTicks() - blockStartTicks;
+        const auto availableTicks = sampleRate > 0.0 ? Time::secondsToHighResolutionTicks (numSamples / sampleRate) : (int64) 0;
+        const auto isOverrun = availableTicks > 0 && blockTicks > availableTicks;
+        const auto shouldReset = resetPending.exchange (false);
+
+        if (shouldReset)
+            resetTotals();
+
+        AudioProcessorGraph::Node* mostExpensiveNode = nullptr;
+        int64 mostExpensiveTicks = -1;
+
+        sequence.forEachProfiledNode ([&] (AudioProcessorGraph::Node& node, int64 ticks)
+        {
+            auto& data = *node.profileData;
+
+            if (shouldReset)
+                data.reset();
+
+            add (data.numBlocks, 1);
+            add (data.totalTicks, ticks);
+            add (data.histogram[getHistogramBucket (ticks)], 1);
+            storeMax (data.maxTicks, ticks);
+
+            if (isOverrun)
+                add (data.overrunTicks, ticks);
+
+            if (ticks > mostExpensiveTicks)
+            {
+                mostExpensiveNode = &node;
+                mostExpensiveTicks = ticks;
+            }
+        });
+
+        if (isOverrun)
+        {
+            add (numOverruns, 1);
+
+            if (mostExpensiveNode != nullptr)
+                add (mostExpensiveNode->profileData->numOverruns, 1);
+        }
+
+        add (numBlocks, 1);
+        add (totalTicks, blockTicks);
+        add (totalAvailableTicks, availableTicks);
+        storeMax (maxTicks, blockTicks);
+    }
+
+    /** Can be called on any thread, while the audio thread keeps adding to the measurements. */
+    AudioProcessorGraph::RenderProfile createProfile (const ReferenceCountedArray<AudioProcessorGraph::Node>& nodes) const
+    {
+        AudioProcessorGraph::RenderProfile profile;
+
+        if (resetPending)
+            return profile;
+
+        const auto load = [] (const std::atomic<int64>& value)     { return value.load (std::memory_order_relaxed); };
+        const auto loadSeconds = [&] (const std::atomic<int64>& value)  { return Time::highResolutionTicksToSeconds (load (value)); };
+
+        profile.numBlocks        = load (numBlocks);
+        profile.totalSeconds     = loadSeconds (totalTicks);
+        profile.availableSeconds = loadSeconds (totalAvailableTicks);
+        profile.maxSeconds       = loadSeconds (maxTicks);
+        profile.numOverruns      = load (numOverruns);
+
+        for (auto* node : nodes)
+        {
+            const auto& data = *node->profileData;
+
+            AudioProcessorGraph::NodeProfile nodeProfile;
+            nodeProfile.numBlocks = load (data.numBlocks);
+
+            if (nodeProfile.numBlocks == 0)
+                continue;
+
+            nodeProfile.nodeID         = node->nodeID;
+            nodeProfile.name           = node->getProcessor()->getName();
+            nodeProfile.latencySamples = node->getProcessor()->getLatencySamples();
+            nodeProfile.totalSeconds   = loadSeconds (data.totalTicks);
+            nodeProfile.maxSeconds     = loadSeconds (data.maxTicks);
+            nodeProfile.numOverruns    = load (data.numOverruns);
+            nodeProfile.overrunSeconds = loadSeconds (data.overrunTicks);
+
+            for (auto& count : data.histogram)
+                nodeProfile.histogram.add (load (count));
+
+            profile.nodes.add (nodeProfile);
+        }
+
+        std::stable_sort (profile.nodes.begin(), profile.nodes.end(),
+                          [] (const AudioProcessorGraph::NodeProfile& a, const AudioProcessorGraph::NodeProfile& b)
+                          {
+                              return a.totalSeconds > b.totalSeconds;
+                          });
+
+        return profile;
+    }
+
+private:
+    static void add (std::atomic<int64>& value, int64 amount) noexcept
+    {
+        value.store (value.load (std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    static void storeMax (std::atomic<int64>& value, int64 candidate) noexcept
+    {
+        if (candidate > value.load (std::memory_order_relaxed))
+            value.store (candidate, std::memory_order_relaxed);
+    }
+
+    // bucket n counts the times below 2^n microseconds, see NodeProfile::getHistogramBucketLimitSeconds()
+    int getHistogramBucket (int64 ticks) const noexcept
+    {
+        const auto microseconds = (uint32) jlimit (0.0, (double) (1 << 30), (double) ticks * microsecondsPerTick);
+        return microseconds == 0 ? 0 : jmin (AudioProcessorGraph::NodeProfile::numHistogramBuckets - 1, findHighestSetBit (microseconds) + 1);
+    }
+
+    void resetTotals() noexcept
+    {
+        for (auto* value : { &numBlocks, &totalTicks, &totalAvailableTicks, &maxTicks, &numOverruns })
+            value->store (0, std::memory_order_relaxed);
+    }
+
+    const double microsecondsPerTick;
+    std::atomic<bool> enabled { false }, resetPending { false };
+    std::atomic<int64> numBlocks, totalTicks, totalAvailableTicks, maxTicks, numOverruns;
+    int64 blockStartTicks = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (GraphRenderProfiler)
+};
+
+struct AudioProcessorGraph::RenderProfiler  : public GraphRenderProfiler {};
+
+//==============================================================================
 template <typename FloatType>
 struct GraphRenderSequence
 {
@@ -45,9 +425,11 @@ struct GraphRenderSequence
         MidiBuffer* midiBuffers;
         AudioPlayHead* audioPlayHead;
         int numSamples;
+        bool profileNodes;
     };
 
-    void perform (AudioBuffer<FloatType>& buffer, MidiBuffer& midiMessages, AudioPlayHead* audioPlayHead)
+    void perform (AudioBuffer<FloatType>& buffer, MidiBuffer& midiMessages, AudioPlayHead* audioPlayHead,
+                  GraphRenderThreadPool* threadPool = nullptr, bool profileNodes = false)
     {
         auto numSamples = buffer.getNumSamples();
         auto maxSamples = renderingBuffer.getNumSamples();
@@ -64,7 +446,7 @@ struct GraphRenderSequence
                 midiChunk.clear();
                 midiChunk.addEvents (midiMessages, chunkStartSample, chunkSize, -chunkStartSample);
 
-                perform (audioChunk, midiChunk, audioPlayHead);
+                perform (audioChunk, midiChunk, audioPlayHead, threadPool, profileNodes);
 
                 chunkStartSample += maxSamples;
             }
@@ -79,10 +461,17 @@ struct GraphRenderSequence
         currentMidiOutputBuffer.clear();
 
         {
-            const Context context { renderingBuffer.getArrayOfWritePointers(), midiBuffers.begin(), audioPlayHead, numSamples };
+            const Context context { renderingBuffer.getArrayOfWritePointers(), midiBuffers.begin(), audioPlayHead, numSamples, profileNodes };
 
-            for (auto* op : renderOps)
-                op->perform (context);
+            if (canRenderInParallel (threadPool))
+            {
+                performTasks (*threadPool, context);
+            }
+            else
+            {
+                for (auto* op : renderOps)
+                    op->perform (context);
+            }
         }
 
         for (int i = 0; i < buffer.getNumChannels(); ++i)
@@ -95,11 +484,14 @@ struct GraphRenderSequence
 
     void addClearChannelOp (int index)
     {
+        writeResource (getAudioResource (index));
         createOp ([=] (const Context& c)    { FloatVectorOperations::clear (c.audioBuffers[index], c.numSamples); });
     }
 
     void addCopyChannelOp (int srcIndex, int dstIndex)
     {
+        readResource (getAudioResource (srcIndex));
+        writeResource (getAudioResource (dstIndex));
         createOp ([=] (const Context& c)    { FloatVectorOperations::copy (c.audioBuffers[dstIndex],
                                                                            c.audioBuffers[srcIndex],
                                                                            c.numSamples); });
@@ -107,6 +499,8 @@ struct GraphRenderSequence
 
     void addAddChannelOp (int srcIndex, int dstIndex)
     {
+        readResource (getAudioResource (srcIndex));
+        writeResource (getAudioResource (dstIndex));
         createOp ([=] (const Context& c)    { FloatVectorOperations::add (c.audioBuffers[dstIndex],
                                                                           c.audioBuffers[srcIndex],
                                                                           c.numSamples); });
@@ -114,29 +508,106 @@ struct GraphRenderSequence
 
     void addClearMidiBufferOp (int index)
     {
+        writeResource (getMidiResource (index));
         createOp ([=] (const Context& c)    { c.midiBuffers[index].clear(); });
     }
 
     void addCopyMidiBufferOp (int srcIndex, int dstIndex)
     {
+        readResource (getMidiResource (srcIndex));
+        writeResource (getMidiResource (dstIndex));
         createOp ([=] (const Context& c)    { c.midiBuffers[dstIndex] = c.midiBuffers[srcIndex]; });
     }
 
     void addAddMidiBufferOp (int srcIndex, int dstIndex)
     {
+        readResource (getMidiResource (srcIndex));
+        writeResource (getMidiResource (dstIndex));
         createOp ([=] (const Context& c)    { c.midiBuffers[dstIndex].addEvents (c.midiBuffers[srcIndex],
                                                                                  0, c.numSamples, 0); });
     }
 
     void addDelayChannelOp (int chan, int delaySize)
     {
+        writeResource (getAudioResource (chan));
         renderOps.add (new DelayChannelOp (chan, delaySize));
     }
 
     void addProcessOp (const AudioProcessorGraph::Node::Ptr& node,
                        const Array<int>& audioChannelsUsed, int totalNumChans, int midiBuffer)
     {
-        renderOps.add (new ProcessOp (node, audioChannelsUsed, totalNumChans, midiBuffer));
+        // processors may write to any of their channels, even to the read-only empty buffer
+        for (auto index : audioChannelsUsed)
+            writeResource (getAudioResource (index));
+
+        if (audioChannelsUsed.isEmpty())
+            writeResource (getAudioResource (0));
+
+        writeResource (getMidiResource (midiBuffer));
+
+        if (auto* ioProc = dynamic_cast<AudioProcessorGraph::AudioGraphIOProcessor*> (node->getProcessor()))
+        {
+            if (ioProc->getType() == AudioProcessorGraph::AudioGraphIOProcessor::audioOutputNode)
+                writeResource (audioOutputResource);
+            else if (ioProc->getType() == AudioProcessorGraph::AudioGraphIOProcessor::midiOutputNode)
+                writeResource (midiOutputResource);
+        }
+
+        auto* op = new ProcessOp (node, audioChannelsUsed, totalNumChans, midiBuffer);
+        renderOps.add (op);
+        processOps.add (op);
+    }
+
+    /*  Calls the given function with each node and the high resolution ticks that it took to
+        render since the last call, which is only measured if the sequence was performed with
+        profileNodes set. Must be called on the thread that calls perform().
+    */
+    template <typename Function>
+    void forEachProfiledNode (Function&& function)
+    {
+        for (auto* op : processOps)
+        {
+            function (*op->node, op->renderTicks);
+            op->renderTicks = 0;
+        }
+    }
+
+    //==============================================================================
+    /*  When rendering in parallel, the ops of each node form a task, and a task depends on the
+        earlier tasks that last wrote to a resource that it accesses, or that read a resource
+        that it overwrites. Any order of the tasks that respects these dependencies has the
+        same result as performing all ops in sequence.
+    */
+    void beginTask()
+    {
+        RenderTask task;
+        task.firstOp = renderOps.size();
+        tasks.add (task);
+    }
+
+    void prepareTasks (int numThreads)
+    {
+        resourceAccesses.clear();
+
+        if (numThreads <= 0 || tasks.size() < 2)
+        {
+            tasks.clear();
+            return;
+        }
+
+        for (int i = 0; i < tasks.size(); ++i)
+        {
+            auto& task = tasks.getReference (i);
+            task.numOps = (i + 1 < tasks.size() ? tasks.getReference (i + 1).firstOp : renderOps.size()) - task.firstOp;
+
+            if (task.numDependencies == 0)
+                initialTasks.add (i);
+        }
+
+        pendingDependencies.reset (new std::atomic<int>[(size_t) tasks.size()]);
+
+        for (int i = 0; i <= numThreads; ++i)
+            taskQueues.add (new GraphRenderTaskQueue (tasks.size()));
     }
 
     void prepareBuffers (int blockSize)
@@ -183,6 +654,132 @@ struct GraphRenderSequence
     MidiBuffer midiChunk;
 
 private:
+    //==============================================================================
+    struct RenderTask
+    {
+        int firstOp = 0, numOps = 0, numDependencies = 0;
+        Array<int> successors;
+    };
+
+    struct ResourceAccess
+    {
+        int lastWriter = -1;
+        Array<int> readers;
+    };
+
+    enum { audioOutputResource = -1, midiOutputResource = -2 };
+
+    static int getAudioResource (int index) noexcept        { return index * 2; }
+    static int getMidiResource (int index) noexcept         { return index * 2 + 1; }
+
+    Array<RenderTask> tasks;
+    Array<int> initialTasks;
+    std::map<int, ResourceAccess> resourceAccesses;
+
+    std::unique_ptr<std::atomic<int>[]> pendingDependencies;
+    OwnedArray<GraphRenderTaskQueue> taskQueues;
+    std::atomic<int> numRemainingTasks { 0 };
+
+    void addDependency (int taskIndex, int dependency)
+    {
+        if (dependency >= 0 && dependency != taskIndex
+             && tasks.getReference (dependency).successors.addIfNotAlreadyThere (taskIndex))
+            ++tasks.getReference (taskIndex).numDependencies;
+    }
+
+    void readResource (int resource)
+    {
+        if (tasks.isEmpty())
+            return;
+
+        const auto taskIndex = tasks.size() - 1;
+        auto& access = resourceAccesses[resource];
+
+        addDependency (taskIndex, access.lastWriter);
+        access.readers.addIfNotAlreadyThere (taskIndex);
+    }
+
+    void writeResource (int resource)
+    {
+        if (tasks.isEmpty())
+            return;
+
+        const auto taskIndex = tasks.size() - 1;
+        auto& access = resourceAccesses[resource];
+
+        addDependency (taskIndex, access.lastWriter);
+
+        for (auto reader : access.readers)
+            addDependency (taskIndex, reader);
+
+        access.readers.clearQuick();
+        access.lastWriter = taskIndex;
+    }
+
+    bool canRenderInParallel (GraphRenderThreadPool* threadPool) const noexcept
+    {
+        // the sequence may still have been built for a different number of threads
+        return threadPool != nullptr && taskQueues.size() == threadPool->getNumThreads() + 1;
+    }
+
+    void performTasks (GraphRenderThreadPool& threadPool, const Context& context)
+    {
+        for (int i = 0; i < tasks.size(); ++i)
+            pendingDependencies[(size_t) i].store (tasks.getReference (i).numDependencies, std::memory_order_relaxed);
+
+        for (auto* queue : taskQueues)
+            queue->clear();
+
+        // pushed in reverse, so that the calling thread starts with the first task
+        for (int i = initialTasks.size(); --i >= 0;)
+            taskQueues.getUnchecked (0)->push (initialTasks.getUnchecked (i));
+
+        numRemainingTasks = tasks.size();
+
+        struct TaskJob  : public GraphRenderThreadPool::Job
+        {
+            TaskJob (GraphRenderSequence& s, const Context& c) : sequence (s), context (c) {}
+            void execute (int threadIndex) override     { sequence.executeTasks (threadIndex, context); }
+
+            GraphRenderSequence& sequence;
+            const Context& context;
+        };
+
+        TaskJob job (*this, context);
+        threadPool.run (job);
+    }
+
+    void executeTasks (int threadIndex, const Context& context)
+    {
+        auto& ownQueue = *taskQueues.getUnchecked (threadIndex);
+        const auto numQueues = taskQueues.size();
+
+        while (numRemainingTasks.load (std::memory_order_acquire) > 0)
+        {
+            auto taskIndex = ownQueue.pop();
+
+            for (int i = 1; taskIndex < 0 && i < numQueues; ++i)
+                taskIndex = taskQueues.getUnchecked ((threadIndex + i) % numQueues)->steal();
+
+            if (taskIndex < 0)
+            {
+                Thread::yield();
+                continue;
+            }
+
+            const auto& task = tasks.getReference (taskIndex);
+
+            for (int i = task.firstOp; i < task.firstOp + task.numOps; ++i)
+                renderOps.getUnchecked (i)->perform (context);
+
+            for (auto successor : task.successors)
+                if (pendingDependencies[(size_t) successor].fetch_sub (1, std::memory_order_acq_rel) == 1)
+                    ownQueue.push (successor);
+
+            numRemainingTasks.fetch_sub (1, std::memory_order_acq_rel);
+        }
+    }
+
     //==============================================================================
     struct RenderingOp
     {
@@ -270,9 +867,19 @@ private:
             AudioBuffer<FloatType> buffer (audioChannels, totalChans, c.numSamples);
 
             if (processor.isSuspended())
+            {
                 buffer.clear();
+            }
+            else if (c.profileNodes)
+            {
+                const auto startTicks = Time::getHighResolutionTicks();
+                callProcess (buffer, c.midiBuffers[midiBufferToUse]);
+                renderTicks += Time::getHighResolutionTicks() - startTicks;
+            }
             else
+            {
                 callProcess (buffer, c.midiBuffers[midiBufferToUse]);
+            }
         }
 
         void callProcess (AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
@@ -327,8 +934,13 @@ private:
         AudioBuffer<float> tempBufferFloat, tempBufferDouble;
         const int totalChans, midiBufferToUse;
 
+        // summed up across the chunks of a block, see forEachProfiledNode()
+        int64 renderTicks = 0;
+
         JUCE_DECLARE_NON_COPYABLE (ProcessOp)
     };
+
+    Array<ProcessOp*> processOps;
 };
 
 //==============================================================================
@@ -336,21 +948,38 @@ private:
 template <typename RenderSequence>
 struct RenderSequenceBuilder
 {
-    RenderSequenceBuilder (AudioProcessorGraph& g, RenderSequence& s)
-        : graph (g), sequence (s)
+    RenderSequenceBuilder (AudioProcessorGraph& g, RenderSequence& s,
+                           const Array<AudioProcessorGraph::Node*>& nodesInRenderOrder, int numParallelRenderThreads)
+        : graph (g), sequence (s), orderedNodes (nodesInRenderOrder)
     {
-        createOrderedNodeList();
+        for (int i = 0; i < orderedNodes.size(); ++i)
+        {
+            auto* node = orderedNodes.getUnchecked (i);
+            nodesByID.set (node->nodeID.uid, node);
+            nodePositions.set (node->nodeID.uid, i);
+        }
 
         audioBuffers.add (AssignedBuffer::createReadOnlyEmpty()); // first buffer is read-only zeros
         midiBuffers .add (AssignedBuffer::createReadOnlyEmpty());
 
         for (int i = 0; i < orderedNodes.size(); ++i)
         {
+            if (numParallelRenderThreads > 0)
+                sequence.beginTask();
+
             createRenderingOpsForNode (*orderedNodes.getUnchecked(i), i);
-            markAnyUnusedBuffersAsFree (audioBuffers, i);
-            markAnyUnusedBuffersAsFree (midiBuffers, i);
+
+            // when rendering in parallel, buffers are not recycled, so that nodes that don't
+            // depend on each other never share a buffer and can be rendered at the same time
+            if (numParallelRenderThreads == 0)
+            {
+                markAnyUnusedBuffersAsFree (audioBuffers, i);
+                markAnyUnusedBuffersAsFree (midiBuffers, i);
+            }
         }
 
+        sequence.prepareTasks (numParallelRenderThreads);
+
         graph.setLatencySamples (totalLatency);
 
         s.numBuffersNeeded = audioBuffers.size();
@@ -363,7 +992,11 @@ struct RenderSequenceBuilder
     AudioProcessorGraph& graph;
     RenderSequence& sequence;
 
-    Array<AudioProcessorGraph::Node*> orderedNodes;
+    const Array<AudioProcessorGraph::Node*>& orderedNodes;
+
+    // looked up by NodeID, since buffers refer to the channels they hold by NodeID
+    HashMap<uint32, AudioProcessorGraph::Node*> nodesByID;
+    HashMap<uint32, int> nodePositions;
 
     struct AssignedBuffer
     {
@@ -403,31 +1036,17 @@ struct RenderSequenceBuilder
         return delays[nodeID.uid];
     }
 
-    int getInputLatencyForNode (NodeID nodeID) const
+    int getInputLatencyForNode (const AudioProcessorGraph::Node& node) const
     {
         int maxLatency = 0;
 
-        for (auto&& c : graph.getConnections())
-            if (c.destination.nodeID == nodeID)
-                maxLatency = jmax (maxLatency, getNodeDelay (c.source.nodeID));
+        for (auto&& i : node.inputs)
+            maxLatency = jmax (maxLatency, getNodeDelay (i.otherNode->nodeID));
 
         return maxLatency;
     }
 
     //==============================================================================
-    void createOrderedNodeList()
-    {
-        for (auto* node : graph.getNodes())
-        {
-            int j = 0;
-
-            for (; j < orderedNodes.size(); ++j)
-                if (graph.isAnInputTo (*node, *orderedNodes.getUnchecked(j)))
-                  break;
-
-            orderedNodes.insert (j, node);
-        }
-    }
 
     int findBufferForInputAudioChannel (AudioProcessorGraph::Node& node, const int inputChan,
                                         const int ourRenderingIndex, const int maxLatency)
@@ -660,7 +1279,7 @@ struct RenderSequenceBuilder
         auto totalChans = jmax (numIns, numOuts);
 
         Array<int> audioChannelsToUse;
-        auto maxLatency = getInputLatencyForNode (node.nodeID);
+        auto maxLatency = getInputLatencyForNode (node);
 
         for (int inputChan = 0; inputChan < numIns; ++inputChan)
         {
@@ -700,11 +1319,16 @@ struct RenderSequenceBuilder
     Array<AudioProcessorGraph::NodeAndChannel> getSourcesForChannel (AudioProcessorGraph::Node& node, int inputChannelIndex)
     {
         Array<AudioProcessorGraph::NodeAndChannel> results;
-        AudioProcessorGraph::NodeAndChannel nc { node.nodeID, inputChannelIndex };
 
-        for (auto&& c : graph.getConnections())
-            if (c.destination == nc)
-                results.add (c.source);
+        for (auto&& i : node.inputs)
+            if (i.thisChannel == inputChannelIndex)
+                results.add ({ i.otherNode->nodeID, i.otherChannel });
+
+        // sorted like the graph's connections, which determines the order in which the sources are mixed
+        std::sort (results.begin(), results.end(), [] (const AudioProcessorGraph::NodeAndChannel& a, const AudioProcessorGraph::NodeAndChannel& b)
+        {
+            return a.nodeID != b.nodeID ? a.nodeID < b.nodeID : a.channelIndex < b.channelIndex;
+        });
 
         return results;
     }
@@ -745,26 +1369,28 @@ struct RenderSequenceBuilder
                               int inputChannelOfIndexToIgnore,
                               AudioProcessorGraph::NodeAndChannel output) const
     {
-        while (stepIndexToSearchFrom < orderedNodes.size())
+        // only the nodes connected to the output need to be looked at, rather than all nodes from the given step on
+        auto* sourceNode = nodesByID[output.nodeID.uid];
+
+        if (sourceNode == nullptr)
+            return false;
+
+        for (auto&& o : sourceNode->outputs)
         {
-            auto* node = orderedNodes.getUnchecked (stepIndexToSearchFrom);
+            if (o.thisChannel != output.channelIndex)
+                continue;
 
-            if (output.isMIDI())
-            {
-                if (inputChannelOfIndexToIgnore != AudioProcessorGraph::midiChannelIndex
-                     && graph.isConnected ({ { output.nodeID, AudioProcessorGraph::midiChannelIndex },
-                                             { node->nodeID,  AudioProcessorGraph::midiChannelIndex } }))
-                    return true;
-            }
-            else
-            {
-                for (int i = 0; i < node->getProcessor()->getTotalNumInputChannels(); ++i)
-                    if (i != inputChannelOfIndexToIgnore && graph.isConnected ({ output, { node->nodeID, i } }))
-                        return true;
-            }
+            auto& destination = *o.otherNode;
+            const auto step = nodePositions[destination.nodeID.uid];
+
+            if (step < stepIndexToSearchFrom)
+                continue;
+
+            if (step == stepIndexToSearchFrom && o.otherChannel == inputChannelOfIndexToIgnore)
+                continue;
 
-            inputChannelOfIndexToIgnore = -1;
-            ++stepIndexToSearchFrom;
+            if (output.isMIDI() || o.otherChannel < destination.getProcessor()->getTotalNumInputChannels())
+                return true;
         }
 
         return false;
@@ -804,12 +1430,14 @@ bool AudioProcessorGraph::Connection::operator< (const Connection& other) const
 }
 
 //==============================================================================
-AudioProcessorGraph::Node::Node (NodeID n, std::unique_ptr<AudioProcessor> p) noexcept
-    : nodeID (n), processor (std::move (p))
+AudioProcessorGraph::Node::Node (NodeID n, std::unique_ptr<AudioProcessor> p)
+    : nodeID (n), processor (std::move (p)), profileData (std::make_unique<ProfileData>())
 {
     jassert (processor != nullptr);
 }
 
+AudioProcessorGraph::Node::~Node() = default;
+
 void AudioProcessorGraph::Node::prepare (double newSampleRate, int newBlockSize,
                                          AudioProcessorGraph* graph, ProcessingPrecision precision)
 {
@@ -885,8 +1513,145 @@ void AudioProcessorGraph::Node::setBypassed (bool shouldBeBypassed) noexcept
 struct AudioProcessorGraph::RenderSequenceFloat   : public GraphRenderSequence<float> {};
 struct AudioProcessorGraph::RenderSequenceDouble  : public GraphRenderSequence<double> {};
 
+struct AudioProcessorGraph::RenderSequences
+{
+    RenderSequenceFloat  sequenceFloat;
+    RenderSequenceDouble sequenceDouble;
+
+    GraphRenderSequence<float>&  getSequence (AudioBuffer<float>&) noexcept     { return sequenceFloat; }
+    GraphRenderSequence<double>& getSequence (AudioBuffer<double>&) noexcept    { return sequenceDouble; }
+};
+
+//==============================================================================
+/*  Keeps the nodes of a graph in an order in which each node comes after all the nodes that
+    feed into it, which is the order in which the rendering sequence processes them.
+
+    Rather than sorting all nodes whenever the rendering sequence is rebuilt, the order is
+    maintained as the graph is edited, after Pearce and Kelly: new nodes are appended, removing
+    nodes or connections never breaks the order, and a new connection that goes against the order
+    only rearranges the nodes between its two ends that are affected by it.
+
+    Connections that would close a feedback loop can't be ordered, so the graph refuses them
+    (see wouldCloseLoop()).
+*/
+struct AudioProcessorGraph::RenderOrder
+{
+    const Array<Node*>& getNodes() const noexcept   { return nodes; }
+
+    int getPosition (const Node& node) const
+    {
+        const auto it = positions.find (&node);
+        jassert (it != positions.end());
+        return it->second;
+    }
+
+    void clear()
+    {
+        nodes.clear();
+        positions.clear();
+    }
+
+    void addNode (Node& node)
+    {
+        positions[&node] = nodes.size();
+        nodes.add (&node);
+    }
+
+    void removeNode (Node& node)
+    {
+        const auto position = getPosition (node);
+        nodes.remove (position);
+        positions.erase (&node);
+
+        for (int i = position; i < nodes.size(); ++i)
+            positions[nodes.getUnchecked (i)] = i;
+    }
+
+    // Only the nodes placed between the two ends can lie on a path from the destination back to the source.
+    bool wouldCloseLoop (Node& source, Node& destination) const
+    {
+        const auto lowerBound = getPosition (destination);
+        const auto upperBound = getPosition (source);
+
+        return lowerBound <= upperBound
+                && collectNodesBetween (destination, &Node::outputs, lowerBound, upperBound).contains (&source);
+    }
+
+    void addConnection (Node& source, Node& destination)
+    {
+        const auto lowerBound = getPosition (destination);
+        const auto upperBound = getPosition (source);
+
+        if (upperBound < lowerBound)
+            return;
+
+        // The nodes fed by the destination that are placed before the source need to move behind
+        // the nodes that feed the source, all within the positions that these nodes occupy now.
+        auto forward  = collectNodesBetween (destination, &Node::outputs, lowerBound, upperBound);
+
+        if (forward.contains (&source))
+        {
+            jassertfalse; // the graph should have refused a connection that closes a feedback loop
+            return;
+        }
+
+        auto backward = collectNodesBetween (source,      &Node::inputs,  lowerBound, upperBound);
+
+        Array<int> freePositions;
+
+        for (auto* node : backward)     freePositions.add (getPosition (*node));
+        for (auto* node : forward)      freePositions.add (getPosition (*node));
+
+        freePositions.sort();
+
+        int i = 0;
+
+        for (auto* node : backward)     place (*node, freePositions.getUnchecked (i++));
+        for (auto* node : forward)      place (*node, freePositions.getUnchecked (i++));
+    }
+
+private:
+    // Returns the nodes reachable from the given node within the given range of positions, in their current order.
+    Array<Node*> collectNodesBetween (Node& start, Array<Node::Connection> Node::* connections, int lowerBound, int upperBound) const
+    {
+        Array<Node*> result { &start }, stack { &start };
+        std::unordered_set<const Node*> visited { &start };
+
+        while (! stack.isEmpty())
+        {
+            auto* node = stack.getLast();
+            stack.removeLast();
+
+            for (auto& c : node->*connections)
+            {
+                const auto position = getPosition (*c.otherNode);
+
+                if (lowerBound <= position && position <= upperBound && visited.insert (c.otherNode).second)
+                {
+                    result.add (c.otherNode);
+                    stack.add (c.otherNode);
+                }
+            }
+        }
+
+        std::sort (result.begin(), result.end(), [this] (const Node* a, const Node* b) { return getPosition (*a) < getPosition (*b); });
+        return result;
+    }
+
+    void place (Node& node, int position)
+    {
+        nodes.set (position, &node);
+        positions[&node] = position;
+    }
+
+    Array<Node*> nodes;
+    std::map<const Node*, int> positions;
+};
+
 //==============================================================================
 AudioProcessorGraph::AudioProcessorGraph()
+    : renderOrder (std::make_unique<RenderOrder>()),
+      renderProfiler (std::make_unique<RenderProfiler>())
 {
 }
 
@@ -919,6 +1684,7 @@ void AudioProcessorGraph::clear()
         return;
 
     nodes.clear();
+    renderOrder->clear();
     topologyChanged();
 }
 
@@ -963,6 +1729,8 @@ AudioProcessorGraph::Node::Ptr AudioProcessorGraph::addNode (std::unique_ptr<Aud
         nodes.add (n.get());
     }
 
+    renderOrder->addNode (*n);
+
     n->setParentGraph (this);
     topologyChanged();
     return n;
@@ -978,6 +1746,7 @@ AudioProcessorGraph::Node::Ptr AudioProcessorGraph::removeNode (NodeID nodeId)
         {
             disconnectNode (nodeId);
             auto node = nodes.removeAndReturn (i);
+            renderOrder->removeNode (*node);
             topologyChanged();
             return node;
         }
@@ -1054,20 +1823,25 @@ bool AudioProcessorGraph::isAnInputTo (Node& src, Node& dst) const noexcept
     jassert (nodes.contains (&src));
     jassert (nodes.contains (&dst));
 
-    return isAnInputTo (src, dst, nodes.size());
-}
+    // visits each node only once, rather than following every path through the inputs
+    Array<Node*> stack { &dst };
+    std::unordered_set<const Node*> visited { &dst };
 
-bool AudioProcessorGraph::isAnInputTo (Node& src, Node& dst, int recursionCheck) const noexcept
-{
-    for (auto&& i : dst.inputs)
-        if (i.otherNode == &src)
-            return true;
+    while (! stack.isEmpty())
+    {
+        auto* node = stack.getLast();
+        stack.removeLast();
 
-    if (recursionCheck > 0)
-        for (auto&& i : dst.inputs)
-            if (isAnInputTo (src, *i.otherNode, recursionCheck - 1))
+        for (auto&& i : node->inputs)
+        {
+            if (i.otherNode == &src)
                 return true;
 
+            if (visited.insert (i.otherNode).second)
+                stack.add (i.otherNode);
+        }
+    }
+
     return false;
 }
 
@@ -1092,7 +1866,8 @@ bool AudioProcessorGraph::canConnect (Node* source, int sourceChannel, Node* des
          || (destIsMIDI && ! dest->processor->acceptsMidi()))
         return false;
 
-    return ! isConnected (source, sourceChannel, dest, destChannel);
+    return ! isConnected (source, sourceChannel, dest, destChannel)
+            && ! renderOrder->wouldCloseLoop (*source, *dest);
 }
 
 bool AudioProcessorGraph::canConnect (const Connection& c) const
@@ -1118,6 +1893,7 @@ bool AudioProcessorGraph::addConnection (const Connection& c)
             {
                 source->outputs.add ({ dest, destChan, sourceChan });
                 dest->inputs.add ({ source, sourceChan, destChan });
+                renderOrder->addConnection (*source, *dest);
                 jassert (isConnected (c));
                 topologyChanged();
                 return true;
@@ -1206,14 +1982,7 @@ bool AudioProcessorGraph::removeIllegalConnections()
 //==============================================================================
 void AudioProcessorGraph::clearRenderingSequence()
 {
-    std::unique_ptr<RenderSequenceFloat> oldSequenceF;
-    std::unique_ptr<RenderSequenceDouble> oldSequenceD;
-
-    {
-        const ScopedLock sl (getCallbackLock());
-        std::swap (renderSequenceFloat, oldSequenceF);
-        std::swap (renderSequenceDouble, oldSequenceD);
-    }
+    publishRenderSequences (nullptr);
 }
 
 bool AudioProcessorGraph::anyNodesNeedPreparing() const noexcept
@@ -1227,31 +1996,42 @@ bool AudioProcessorGraph::anyNodesNeedPreparing() const noexcept
 
 void AudioProcessorGraph::buildRenderingSequence()
 {
-    auto newSequenceF = std::make_unique<RenderSequenceFloat>();
-    auto newSequenceD = std::make_unique<RenderSequenceDouble>();
-
-    RenderSequenceBuilder<RenderSequenceFloat>  builderF (*this, *newSequenceF);
-    RenderSequenceBuilder<RenderSequenceDouble> builderD (*this, *newSequenceD);
+    auto newSequences = std::make_unique<RenderSequences>();
 
-    const ScopedLock sl (getCallbackLock());
+    {
+        const auto numParallelRenderThreads = getNumParallelRenderThreads();
+        RenderSequenceBuilder<RenderSequenceFloat>  builderF (*this, newSequences->sequenceFloat, renderOrder->getNodes(), numParallelRenderThreads);
+        RenderSequenceBuilder<RenderSequenceDouble> builderD (*this, newSequences->sequenceDouble, renderOrder->getNodes(), numParallelRenderThreads);
+    }
 
+    // The audio thread keeps rendering the previous sequences while the new ones are prepared,
+    // so this doesn't need the callback lock. Nodes that still need preparing are not part of
+    // the previous sequences, unless the whole graph has been unprepared and isn't rendering.
     const auto currentBlockSize = getBlockSize();
-    newSequenceF->prepareBuffers (currentBlockSize);
-    newSequenceD->prepareBuffers (currentBlockSize);
+    newSequences->sequenceFloat.prepareBuffers (currentBlockSize);
+    newSequences->sequenceDouble.prepareBuffers (currentBlockSize);
 
     if (anyNodesNeedPreparing())
-    {
-        renderSequenceFloat.reset();
-        renderSequenceDouble.reset();
-
         for (auto* node : nodes)
             node->prepare (getSampleRate(), currentBlockSize, this, getProcessingPrecision());
-    }
+
+    publishRenderSequences (std::move (newSequences));
 
     isPrepared = 1;
+}
+
+void AudioProcessorGraph::publishRenderSequences (std::unique_ptr<RenderSequences> newSequences)
+{
+    publishedRenderSequences = newSequences.get();
 
-    std::swap (renderSequenceFloat,  newSequenceF);
-    std::swap (renderSequenceDouble, newSequenceD);
+    // Any block that starts from now on picks up the new sequences, so the previous ones can be
+    // deleted once the block that may currently be rendering them has finished.
+    const auto numBlocks = numBlocksRendered.load();
+
+    while (isRendering && numBlocksRendered == numBlocks)
+        Thread::yield();
+
+    std::swap (renderSequences, newSequences);
 }
 
 void AudioProcessorGraph::handleAsyncUpdate()
@@ -1259,6 +2039,149 @@ void AudioProcessorGraph::handleAsyncUpdate()
     buildRenderingSequence();
 }
 
+//==============================================================================
+void AudioProcessorGraph::setNumParallelRenderThreads (int numThreads)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    numThreads = jmax (0, numThreads);
+
+    if (numThreads == getNumParallelRenderThreads())
+        return;
+
+    std::unique_ptr<ParallelRenderPool> newPool (numThreads > 0 ? new ParallelRenderPool (numThreads) : nullptr);
+
+    {
+        // until the sequences have been rebuilt, they don't match the new pool and are rendered serially
+        const ScopedLock sl (getCallbackLock());
+        std::swap (parallelRenderPool, newPool);
+    }
+
+    topologyChanged();
+}
+
+int AudioProcessorGraph::getNumParallelRenderThreads() const noexcept
+{
+    return parallelRenderPool != nullptr ? parallelRenderPool->getNumThreads() : 0;
+}
+
+//==============================================================================
+void AudioProcessorGraph::setNodeProfilingEnabled (bool shouldBeEnabled) noexcept
+{
+    renderProfiler->setEnabled (shouldBeEnabled);
+}
+
+bool AudioProcessorGraph::isNodeProfilingEnabled() const noexcept
+{
+    return renderProfiler->isEnabled();
+}
+
+AudioProcessorGraph::RenderProfile AudioProcessorGraph::getRenderProfile() const
+{
+    return renderProfiler->createProfile (nodes);
+}
+
+void AudioProcessorGraph::resetRenderProfile() noexcept
+{
+    renderProfiler->requestReset();
+}
+
+double AudioProcessorGraph::NodeProfile::getHistogramBucketLimitSeconds (int bucket) noexcept
+{
+    if (bucket >= numHistogramBuckets - 1)
+        return std::numeric_limits<double>::infinity();
+
+    return std::ldexp (1.0e-6, jmax (0, bucket));
+}
+
+double AudioProcessorGraph::NodeProfile::getAverageSeconds() const noexcept
+{
+    return numBlocks > 0 ? totalSeconds / (double) numBlocks : 0.0;
+}
+
+double AudioProcessorGraph::NodeProfile::getPercentileSeconds (double proportion) const noexcept
+{
+    const auto threshold = jlimit (0.0, 1.0, proportion) * (double) numBlocks;
+    int64 count = 0;
+
+    for (int i = 0; i < histogram.size(); ++i)
+    {
+        count += histogram.getUnchecked (i);
+
+        if ((double) count >= threshold)
+            return jmin (maxSeconds, getHistogramBucketLimitSeconds (i));
+    }
+
+    return maxSeconds;
+}
+
+String AudioProcessorGraph::RenderProfile::toString() const
+{
+    const auto percentOf = [] (double seconds, double total)
+    {
+        return String (total > 0.0 ? 100.0 * seconds / total : 0.0, 2);
+    };
+
+    const auto microseconds = [] (double seconds)               { return String (seconds * 1.0e6, 1); };
+    const auto column = [] (const String& text, int width)      { return text.paddedLeft (' ', width); };
+
+    String result;
+    result << "AudioProcessorGraph render profile: " << numBlocks << " blocks, "
+           << percentOf (totalSeconds, availableSeconds) << "% of the available time, "
+           << microseconds (maxSeconds) << " us max per block, " << numOverruns << " overruns" << newLine
+           << column ("node", 8) << "  " << String ("name").paddedRight (' ', 24) << column ("blocks", 10)
+           << column ("avg us", 12) << column ("p99 us", 12) << column ("max us", 12)
+           << column ("load %", 10) << column ("overruns", 10) << newLine;
+
+    for (auto& node : nodes)
+        result << column (String (node.nodeID.uid), 8) << "  " << node.name.substring (0, 23).paddedRight (' ', 24)
+               << column (String (node.numBlocks), 10)
+               << column (microseconds (node.getAverageSeconds()), 12)
+               << column (microseconds (node.getPercentileSeconds (0.99)), 12)
+               << column (microseconds (node.maxSeconds), 12)
+               << column (percentOf (node.totalSeconds, availableSeconds), 10)
+               << column (String (node.numOverruns), 10) << newLine;
+
+    return result;
+}
+
+String AudioProcessorGraph::RenderProfile::toJSON() const
+{
+    Array<var> nodeObjects;
+
+    for (auto& node : nodes)
+    {
+        Array<var> histogram;
+
+        for (auto count : node.histogram)
+            histogram.add (count);
+
+        auto* object = new DynamicObject();
+        object->setProperty ("id",              (int64) node.nodeID.uid);
+        object->setProperty ("name",            node.name);
+        object->setProperty ("latencySamples",  node.latencySamples);
+        object->setProperty ("blocks",          node.numBlocks);
+        object->setProperty ("totalSeconds",    node.totalSeconds);
+        object->setProperty ("averageSeconds",  node.getAverageSeconds());
+        object->setProperty ("p99Seconds",      node.getPercentileSeconds (0.99));
+        object->setProperty ("maxSeconds",      node.maxSeconds);
+        object->setProperty ("overruns",        node.numOverruns);
+        object->setProperty ("overrunSeconds",  node.overrunSeconds);
+        object->setProperty ("histogram",       histogram);
+        nodeObjects.add (var (object));
+    }
+
+    auto* object = new DynamicObject();
+    object->setProperty ("blocks",              numBlocks);
+    object->setProperty ("totalSeconds",        totalSeconds);
+    object->setProperty ("availableSeconds",    availableSeconds);
+    object->setProperty ("maxSeconds",          maxSeconds);
+    object->setProperty ("overruns",            numOverruns);
+    object->setProperty ("nodes",               nodeObjects);
+
+    return JSON::toString (var (object), true);
+}
+
 //==============================================================================
 void AudioProcessorGraph::prepareToPlay (double sampleRate, int estimatedSamplesPerBlock)
 {
@@ -1311,11 +2234,11 @@ void AudioProcessorGraph::releaseResources()
 
     unprepare();
 
-    if (renderSequenceFloat != nullptr)
-        renderSequenceFloat->releaseBuffers();
-
-    if (renderSequenceDouble != nullptr)
-        renderSequenceDouble->releaseBuffers();
+    if (renderSequences != nullptr)
+    {
+        renderSequences->sequenceFloat.releaseBuffers();
+        renderSequences->sequenceDouble.releaseBuffers();
+    }
 }
 
 void AudioProcessorGraph::reset()
@@ -1342,30 +2265,52 @@ bool AudioProcessorGraph::producesMidi() const                      { return tru
 void AudioProcessorGraph::getStateInformation (juce::MemoryBlock&)  {}
 void AudioProcessorGraph::setStateInformation (const void*, int)    {}
 
-template <typename FloatType, typename SequenceType>
-static void processBlockForBuffer (AudioBuffer<FloatType>& buffer, MidiBuffer& midiMessages,
-                                   AudioProcessorGraph& graph,
-                                   std::unique_ptr<SequenceType>& renderSequence,
-                                   std::atomic<bool>& isPrepared)
+template <typename FloatType>
+void AudioProcessorGraph::processBlockForBuffer (AudioBuffer<FloatType>& buffer, MidiBuffer& midiMessages)
 {
-    if (graph.isNonRealtime())
+    const auto renderPublishedSequences = [&]
+    {
+        // announced before picking up the sequences, see publishRenderSequences()
+        isRendering = true;
+        renderingSequences = publishedRenderSequences.load();
+
+        if (renderingSequences != nullptr)
+        {
+            auto& sequence = renderingSequences->getSequence (buffer);
+
+            if (renderProfiler->isEnabled())
+            {
+                renderProfiler->beginBlock();
+                sequence.perform (buffer, midiMessages, getPlayHead(), parallelRenderPool.get(), true);
+                renderProfiler->endBlock (sequence, buffer.getNumSamples(), getSampleRate());
+            }
+            else
+            {
+                sequence.perform (buffer, midiMessages, getPlayHead(), parallelRenderPool.get());
+            }
+        }
+
+        renderingSequences = nullptr;
+        ++numBlocksRendered;
+        isRendering = false;
+    };
+
+    if (isNonRealtime())
     {
         while (! isPrepared)
             Thread::sleep (1);
 
-        const ScopedLock sl (graph.getCallbackLock());
+        const ScopedLock sl (getCallbackLock());
 
-        if (renderSequence != nullptr)
-            renderSequence->perform (buffer, midiMessages, graph.getPlayHead());
+        renderPublishedSequences();
     }
     else
     {
-        const ScopedLock sl (graph.getCallbackLock());
+        const ScopedLock sl (getCallbackLock());
 
         if (isPrepared)
         {
-            if (renderSequence != nullptr)
-                renderSequence->perform (buffer, midiMessages, graph.getPlayHead());
+            renderPublishedSequences();
         }
         else
         {
@@ -1380,7 +2325,7 @@ void AudioProcessorGraph::processBlock (AudioBuffer<float>& buffer, MidiBuffer&
     if ((! isPrepared) && MessageManager::getInstance()->isThisTheMessageThread())
         handleAsyncUpdate();
 
-    processBlockForBuffer<float> (buffer, midiMessages, *this, renderSequenceFloat, isPrepared);
+    processBlockForBuffer (buffer, midiMessages);
 }
 
 void AudioProcessorGraph::processBlock (AudioBuffer<double>& buffer, MidiBuffer& midiMessages)
@@ -1388,7 +2333,7 @@ void AudioProcessorGraph::processBlock (AudioBuffer<double>& buffer, MidiBuffer&
     if ((! isPrepared) && MessageManager::getInstance()->isThisTheMessageThread())
         handleAsyncUpdate();
 
-    processBlockForBuffer<double> (buffer, midiMessages, *this, renderSequenceDouble, isPrepared);
+    processBlockForBuffer (buffer, midiMessages);
 }
 
 //==============================================================================
@@ -1492,13 +2437,15 @@ static void processIOBlock (AudioProcessorGraph::AudioGraphIOProcessor& io, Sequ
 void AudioProcessorGraph::AudioGraphIOProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
 {
     jassert (graph != nullptr);
-    processIOBlock (*this, *graph->renderSequenceFloat, buffer, midiMessages);
+    jassert (graph->renderingSequences != nullptr);
+    processIOBlock (*this, graph->renderingSequences->sequenceFloat, buffer, midiMessages);
 }
 
 void AudioProcessorGraph::AudioGraphIOProcessor::processBlock (AudioBuffer<double>& buffer, MidiBuffer& midiMessages)
 {
     jassert (graph != nullptr);
-    processIOBlock (*this, *graph->renderSequenceDouble, buffer, midiMessages);
+    jassert (graph->renderingSequences != nullptr);
+    processIOBlock (*this, graph->renderingSequences->sequenceDouble, buffer, midiMessages);
 }
 
 double AudioProcessorGraph::AudioGraphIOProcessor::getTailLengthSeconds() const
@@ -1547,4 +2494,417 @@ void AudioProcessorGraph::AudioGraphIOProcessor::setParentGraph (AudioProcessorG
     }
 }
 
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class AudioProcessorGraphTests  : public UnitTest
+{
+public:
+    AudioProcessorGraphTests()
+        : UnitTest ("AudioProcessorGraph", UnitTestCategories::audio)
+    {}
+
+    void runTest() override
+    {
+        beginTest ("Rendering a wide graph in parallel matches rendering it serially");
+        {
+            AudioProcessorGraph serialGraph, parallelGraph;
+            createWideGraph (serialGraph);
+            createWideGraph (parallelGraph);
+            parallelGraph.setNumParallelRenderThreads (3);
+
+            prepare (serialGraph);
+            prepare (parallelGraph);
+            expectEqualRenders (serialGraph, parallelGraph);
+        }
+
+        beginTest ("Rendering a deep graph in parallel matches rendering it serially");
+        {
+            AudioProcessorGraph serialGraph, parallelGraph;
+            createDeepGraph (serialGraph);
+            createDeepGraph (parallelGraph);
+            parallelGraph.setNumParallelRenderThreads (2);
+
+            prepare (serialGraph);
+            prepare (parallelGraph);
+            expectEqualRenders (serialGraph, parallelGraph);
+        }
+
+        beginTest ("Changing the number of render threads keeps the output intact");
+        {
+            AudioProcessorGraph serialGraph, parallelGraph;
+            createWideGraph (serialGraph);
+            createWideGraph (parallelGraph);
+
+            for (auto numThreads : { 1, 4, 0, 2 })
+            {
+                parallelGraph.setNumParallelRenderThreads (numThreads);
+                expectEquals (parallelGraph.getNumParallelRenderThreads(), numThreads);
+
+                // rebuilding a graph resets its latency compensation, so both graphs start from scratch
+                prepare (serialGraph);
+                prepare (parallelGraph);
+
+                expectEqualRenders (serialGraph, parallelGraph);
+            }
+        }
+
+        beginTest ("Profiling measures every node and attributes overruns to the most expensive one");
+        {
+            AudioProcessorGraph graph;
+            createWideGraph (graph);
+
+            const auto slowNode = graph.addNode (std::make_unique<SlowProcessor>())->nodeID;
+            connectAudio (graph, graph.getNode (0)->nodeID, slowNode);
+            connectAudio (graph, slowNode, graph.getNode (1)->nodeID);
+
+            expect (! graph.isNodeProfilingEnabled());
+            graph.setNodeProfilingEnabled (true);
+            prepare (graph);
+            render (graph, numBlocks);
+
+            const auto profile = graph.getRenderProfile();
+            expectEquals (profile.numBlocks, (int64) numBlocks);
+            expectEquals (profile.numOverruns, (int64) numBlocks);
+            expectEquals (profile.nodes.size(), graph.getNumNodes());
+            expect (profile.nodes.getFirst().nodeID == slowNode);
+            expectEquals (profile.nodes.getFirst().numOverruns, (int64) numBlocks);
+            expect (profile.nodes.getFirst().getPercentileSeconds (0.5) >= 0.001 * SlowProcessor::sleepMilliseconds);
+
+            for (auto& node : profile.nodes)
+            {
+                int64 numHistogramBlocks = 0;
+
+                for (auto count : node.histogram)
+                    numHistogramBlocks += count;
+
+                expectEquals (node.numBlocks, (int64) numBlocks);
+                expectEquals (numHistogramBlocks, (int64) numBlocks);
+            }
+
+            const auto json = JSON::parse (profile.toJSON());
+            expectEquals (json["nodes"].size(), graph.getNumNodes());
+            expectEquals ((int) json["nodes"][0]["id"], (int) slowNode.uid);
+
+            graph.resetRenderProfile();
+            expectEquals (graph.getRenderProfile().numBlocks, (int64) 0);
+
+            render (graph, 1);
+            expectEquals (graph.getRenderProfile().numBlocks, (int64) 1);
+            expectEquals (graph.getRenderProfile().nodes.getFirst().numBlocks, (int64) 1);
+
+            graph.setNodeProfilingEnabled (false);
+            render (graph, 1);
+            expectEquals (graph.getRenderProfile().numBlocks, (int64) 1);
+        }
+
+        beginTest ("Adding and removing connections in a prepared graph matches a freshly built graph");
+        {
+            AudioProcessorGraph freshGraph, editedGraph;
+            createChainGraph (freshGraph, { 2, 0, 1 });
+            connectAudio (freshGraph, freshGraph.getNode (2)->nodeID, freshGraph.getNode (1)->nodeID);
+
+            const auto nodes  = createChainGraph (editedGraph, { 0, 1 });
+            const auto input  = editedGraph.getNode (0)->nodeID;
+            const auto output = editedGraph.getNode (1)->nodeID;
+            prepare (editedGraph);
+            render (editedGraph, 2);
+
+            // the new node is placed behind the chain, so feeding the chain from it has to reorder the nodes
+            const auto newNode = addTestNode (editedGraph, 2, false);
+            connectAudio (editedGraph, input, newNode);
+            disconnectAudio (editedGraph, input, nodes[0]);
+            connectAudio (editedGraph, newNode, nodes[0]);
+            connectAudio (editedGraph, newNode, output);
+
+            prepare (freshGraph);
+            expectEqualRenders (freshGraph, editedGraph);
+        }
+
+        beginTest ("A connection that would close a feedback loop is refused and leaves the order unchanged");
+        {
+            AudioProcessorGraph freshGraph, editedGraph;
+            createChainGraph (freshGraph, { 0, 1, 2 });
+
+            const auto nodes = createChainGraph (editedGraph, { 0, 1, 2 });
+            prepare (editedGraph);
+            render (editedGraph, 2);
+
+            for (auto source : { nodes[1], nodes[2] })
+            {
+                const AudioProcessorGraph::Connection feedback { { source, 0 }, { nodes[0], 0 } };
+                expect (! editedGraph.canConnect (feedback));
+                expect (! editedGraph.addConnection (feedback));
+                expect (! editedGraph.isConnected (feedback));
+            }
+
+            prepare (freshGraph);
+            expectEqualRenders (freshGraph, editedGraph);
+        }
+
+        beginTest ("Removing a node in the middle of a chain matches a freshly built graph");
+        {
+            AudioProcessorGraph freshGraph, editedGraph;
+            createChainGraph (freshGraph, { 0, 2 });
+
+            const auto nodes = createChainGraph (editedGraph, { 0, 1, 2 });
+            prepare (editedGraph);
+            render (editedGraph, 2);
+
+            expect (editedGraph.removeNode (nodes[1]) != nullptr);
+            expect (! editedGraph.isAnInputTo (*editedGraph.getNodeForId (nodes[0]), *editedGraph.getNodeForId (nodes[2])));
+            connectAudio (editedGraph, nodes[0], nodes[2]);
+
+            prepare (freshGraph);
+            expectEqualRenders (freshGraph, editedGraph);
+        }
+    }
+
+private:
+    enum { blockSize = 128, numBlocks = 8 };
+
+    // Applies a gain and an offset to its stereo input, optionally reporting latency and adding a note to its midi input
+    struct TestProcessor  : public AudioProcessor
+    {
+        TestProcessor (float gainToUse, float offsetToUse, int latency, bool usesMidi)
+            : AudioProcessor (BusesProperties().withInput  ("Input",  AudioChannelSet::stereo())
+                                               .withOutput ("Output", AudioChannelSet::stereo())),
+              gain (gainToUse), offset (offsetToUse), midi (usesMidi)
+        {
+            setLatencySamples (latency);
+        }
+
+        const String getName() const override                           { return "Test"; }
+        void prepareToPlay (double, int) override                       {}
+        void releaseResources() override                                {}
+
+        void processBlock (AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override
+        {
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            {
+                auto* data = buffer.getWritePointer (channel);
+
+                for (int i = 0; i < buffer.getNumSamples(); ++i)
+                    data[i] = data[i] * gain + offset;
+            }
+
+            if (midi)
+                midiMessages.addEvent (MidiMessage::noteOn (1, roundToInt (offset * 100.0f) % 128, 1.0f), 0);
+        }
+
+        using AudioProcessor::processBlock;
+
+        double getTailLengthSeconds() const override                    { return 0.0; }
+        bool acceptsMidi() const override                               { return midi; }
+        bool producesMidi() const override                              { return midi; }
+        AudioProcessorEditor* createEditor() override                   { return nullptr; }
+        bool hasEditor() const override                                 { return false; }
+        int getNumPrograms() override                                   { return 1; }
+        int getCurrentProgram() override                                { return 0; }
+        void setCurrentProgram (int) override                           {}
+        const String getProgramName (int) override                      { return {}; }
+        void changeProgramName (int, const String&) override            {}
+        void getStateInformation (MemoryBlock&) override                {}
+        void setStateInformation (const void*, int) override            {}
+
+        const float gain, offset;
+        const bool midi;
+    };
+
+    // Takes longer to process a block than the block lasts
+    struct SlowProcessor  : public TestProcessor
+    {
+        SlowProcessor() : TestProcessor (1.0f, 0.0f, 0, false) {}
+
+        const String getName() const override                           { return "Slow"; }
+
+        void processBlock (AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override
+        {
+            Thread::sleep (sleepMilliseconds);
+            TestProcessor::processBlock (buffer, midiMessages);
+        }
+
+        using AudioProcessor::processBlock;
+
+        static constexpr int sleepMilliseconds = 10;
+    };
+
+    static AudioProcessorGraph::NodeID addIONode (AudioProcessorGraph& graph, AudioProcessorGraph::AudioGraphIOProcessor::IODeviceType type)
+    {
+        return graph.addNode (std::make_unique<AudioProcessorGraph::AudioGraphIOProcessor> (type))->nodeID;
+    }
+
+    static AudioProcessorGraph::NodeID addTestNode (AudioProcessorGraph& graph, int index, bool usesMidi)
+    {
+        return graph.addNode (std::make_unique<TestProcessor> (0.5f + 0.01f * (float) index,
+                                                               0.001f * (float) index,
+                                                               index % 5,
+                                                               usesMidi))->nodeID;
+    }
+
+    static void connectAudio (AudioProcessorGraph& graph, AudioProcessorGraph::NodeID source, AudioProcessorGraph::NodeID destination)
+    {
+        for (int channel = 0; channel < 2; ++channel)
+            graph.addConnection ({ { source, channel }, { destination, channel } });
+    }
+
+    static void disconnectAudio (AudioProcessorGraph& graph, AudioProcessorGraph::NodeID source, AudioProcessorGraph::NodeID destination)
+    {
+        for (int channel = 0; channel < 2; ++channel)
+            graph.removeConnection ({ { source, channel }, { destination, channel } });
+    }
+
+    static void connectMidi (AudioProcessorGraph& graph, AudioProcessorGraph::NodeID source, AudioProcessorGraph::NodeID destination)
+    {
+        graph.addConnection ({ { source,      AudioProcessorGraph::midiChannelIndex },
+                               { destination, AudioProcessorGraph::midiChannelIndex } });
+    }
+
+    // many chains of a few nodes each, mixed together at the output with latency compensation
+    static void createWideGraph (AudioProcessorGraph& graph)
+    {
+        setPlayConfig (graph);
+
+        const auto input  = addIONode (graph, AudioProcessorGraph::AudioGraphIOProcessor::audioInputNode);
+        const auto output = addIONode (graph, AudioProcessorGraph::AudioGraphIOProcessor::audioOutputNode);
+
+        for (int chain = 0; chain < 16; ++chain)
+        {
+            auto previous = input;
+
+            for (int i = 0; i < 3; ++i)
+            {
+                const auto node = addTestNode (graph, chain * 3 + i, false);
+                connectAudio (graph, previous, node);
+                previous = node;
+            }
+
+            connectAudio (graph, previous, output);
+        }
+    }
+
+    // a long chain with a few side branches, passing midi along
+    static void createDeepGraph (AudioProcessorGraph& graph)
+    {
+        setPlayConfig (graph);
+
+        const auto input      = addIONode (graph, AudioProcessorGraph::AudioGraphIOProcessor::audioInputNode);
+        const auto output     = addIONode (graph, AudioProcessorGraph::AudioGraphIOProcessor::audioOutputNode);
+        const auto midiInput  = addIONode (graph, AudioProcessorGraph::AudioGraphIOProcessor::midiInputNode);
+        const auto midiOutput = addIONode (graph, AudioProcessorGraph::AudioGraphIOProcessor::midiOutputNode);
+
+        auto previous = input;
+        auto previousMidi = midiInput;
+
+        for (int i = 0; i < 10; ++i)
+        {
+            const auto node = addTestNode (graph, i, true);
+            connectAudio (graph, previous, node);
+            connectMidi (graph, previousMidi, node);
+
+            if (i % 4 == 3)
+            {
+                const auto branch = addTestNode (graph, 100 + i, false);
+                connectAudio (graph, previous, branch);
+                connectAudio (graph, branch, output);
+            }
+
+            previous = previousMidi = node;
+        }
+
+        connectAudio (graph, previous, output);
+        connectMidi (graph, previousMidi, midiOutput);
+    }
+
+    // the test nodes with the given indices in a chain from the input to the output, which are the graph's first two nodes
+    static Array<AudioProcessorGraph::NodeID> createChainGraph (AudioProcessorGraph& graph, std::initializer_list<int> indices)
+    {
+        setPlayConfig (graph);
+
+        const auto input  = addIONode (graph, AudioProcessorGraph::AudioGraphIOProcessor::audioInputNode);
+        const auto output = addIONode (graph, AudioProcessorGraph::AudioGraphIOProcessor::audioOutputNode);
+
+        Array<AudioProcessorGraph::NodeID> chain;
+        auto previous = input;
+
+        for (auto index : indices)
+        {
+            chain.add (addTestNode (graph, index, false));
+            connectAudio (graph, previous, chain.getLast());
+            previous = chain.getLast();
+        }
+
+        connectAudio (graph, previous, output);
+        return chain;
+    }
+
+    // the channels of the IO nodes are taken from the graph when they are added
+    static void setPlayConfig (AudioProcessorGraph& graph)
+    {
+        graph.setPlayConfigDetails (2, 2, 44100.0, blockSize);
+    }
+
+    static void prepare (AudioProcessorGraph& graph)
+    {
+        graph.prepareToPlay (44100.0, blockSize);
+    }
+
+    static void render (AudioProcessorGraph& graph, int numBlocksToRender)
+    {
+        Random random (0x4321);
+        AudioBuffer<float> buffer (2, blockSize);
+        MidiBuffer midi;
+
+        for (int block = 0; block < numBlocksToRender; ++block)
+        {
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    buffer.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+            midi.clear();
+            graph.processBlock (buffer, midi);
+        }
+    }
+
+    void expectEqualRenders (AudioProcessorGraph& serialGraph, AudioProcessorGraph& parallelGraph)
+    {
+        expectEquals (parallelGraph.getLatencySamples(), serialGraph.getLatencySamples());
+
+        Random random (0x1234);
+        AudioBuffer<float> serialBuffer (2, blockSize), parallelBuffer (2, blockSize);
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    serialBuffer.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+            parallelBuffer.makeCopyOf (serialBuffer);
+
+            MidiBuffer serialMidi, parallelMidi;
+            serialMidi.addEvent (MidiMessage::noteOn (1, 60, 1.0f), block);
+            parallelMidi.addEvent (MidiMessage::noteOn (1, 60, 1.0f), block);
+
+            serialGraph.processBlock (serialBuffer, serialMidi);
+            parallelGraph.processBlock (parallelBuffer, parallelMidi);
+
+            auto numMismatches = 0;
+
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    if (serialBuffer.getSample (channel, i) != parallelBuffer.getSample (channel, i))
+                        ++numMismatches;
+
+            expect (serialBuffer.getMagnitude (0, blockSize) > 0.0f);
+            expectEquals (numMismatches, 0);
+            expectEquals (parallelMidi.getNumEvents(), serialMidi.getNumEvents());
+        }
+    }
+};
+
+static AudioProcessorGraphTests audioProcessorGraphTests;
+
+#endif
+
 } // namespace juce
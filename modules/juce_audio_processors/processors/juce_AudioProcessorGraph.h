@@ -128,11 +128,17 @@ public:
         /** A convenient typedef for referring to a pointer to a node object. */
         using Ptr = ReferenceCountedObjectPtr<Node>;
 
+        /** @internal */
+        ~Node() override;
+
     private:
         //==============================================================================
         friend class AudioProcessorGraph;
         template <typename Float>
         friend struct GraphRenderSequence;
+        template <typename RenderSequence>
+        friend struct RenderSequenceBuilder;
+        friend class GraphRenderProfiler;
 
         struct Connection
         {
@@ -147,7 +153,10 @@ public:
         bool isPrepared = false;
         std::atomic<bool> bypassed { false };
 
-        Node (NodeID, std::unique_ptr<AudioProcessor>) noexcept;
+        struct ProfileData;
+        std::unique_ptr<ProfileData> profileData;
+
+        Node (NodeID, std::unique_ptr<AudioProcessor>);
 
         void setParentGraph (AudioProcessorGraph*) const;
         void prepare (double newSampleRate, int newBlockSize, AudioProcessorGraph*, ProcessingPrecision);
@@ -267,7 +276,8 @@ public:
     /** Attempts to connect two specified channels of two nodes.
 
         If this isn't allowed (e.g. because you're trying to connect a midi channel
-        to an audio one or other such nonsense), then it'll return false.
+        to an audio one or other such nonsense, or because the connection would
+        create a feedback loop), then it'll return false.
     */
     bool addConnection (const Connection&);
 
@@ -291,6 +301,116 @@ public:
     */
     bool removeIllegalConnections();
 
+    //==============================================================================
+    /** Enables rendering independent nodes of the graph in parallel.
+
+        The graph will start the given number of realtime worker threads, which help the
+        thread calling processBlock() to render each block. The nodes are split into tasks
+        that only depend on the nodes whose buffers they read or overwrite, and the tasks are
+        distributed across the threads by a lock-free work-stealing scheduler, so that the
+        output is identical to rendering the nodes one after another.
+
+        In this mode, the buffers of the graph are not recycled between nodes, so the graph
+        needs more memory, but unrelated chains of nodes never share a buffer and can run
+        side by side. This pays off for graphs with many parallel chains of expensive nodes,
+        whereas deep chains with little work per node are better rendered serially.
+
+        Pass 0 to switch back to rendering on the calling thread only, which is the default.
+        This must be called on the message thread.
+    */
+    void setNumParallelRenderThreads (int numThreads);
+
+    /** Returns the number of worker threads used for rendering, see setNumParallelRenderThreads(). */
+    int getNumParallelRenderThreads() const noexcept;
+
+    //==============================================================================
+    /** The processing times that were measured for a node, see getRenderProfile(). */
+    struct JUCE_API  NodeProfile
+    {
+        NodeID nodeID;
+        String name;
+        int latencySamples = 0;
+
+        /** The number of blocks in which the node was rendered, and the time it took. */
+        int64 numBlocks = 0;
+        double totalSeconds = 0.0, maxSeconds = 0.0;
+
+        /** The number of blocks that took longer to render than their duration, in which
+            this node was the most expensive one, and the time the node spent in all of the
+            blocks that took too long.
+        */
+        int64 numOverruns = 0;
+        double overrunSeconds = 0.0;
+
+        /** The number of blocks per range of processing time. Bucket 0 counts the blocks that
+            took less than a microsecond, and each following bucket covers twice the range of
+            the one before, see getHistogramBucketLimitSeconds().
+        */
+        Array<int64> histogram;
+
+        static constexpr int numHistogramBuckets = 24;
+
+        /** Returns the upper limit of the processing times counted by the given bucket. */
+        static double getHistogramBucketLimitSeconds (int bucket) noexcept;
+
+        double getAverageSeconds() const noexcept;
+
+        /** Returns the processing time that the given proportion of blocks stayed below, e.g. 0.99
+            for the 99th percentile. This is estimated from the histogram, so it is rounded up to
+            the limit of a bucket.
+        */
+        double getPercentileSeconds (double proportion) const noexcept;
+    };
+
+    /** The processing times measured while node profiling was enabled, see setNodeProfilingEnabled(). */
+    struct JUCE_API  RenderProfile
+    {
+        /** The number of profiled blocks, the time it took to render them and their total duration. */
+        int64 numBlocks = 0;
+        double totalSeconds = 0.0, availableSeconds = 0.0, maxSeconds = 0.0;
+
+        /** The number of blocks that took longer to render than their duration. */
+        int64 numOverruns = 0;
+
+        /** The nodes that have been rendered, with the most expensive one first. */
+        Array<NodeProfile> nodes;
+
+        /** Returns a table of the nodes that is meant for reading. */
+        String toString() const;
+
+        /** Returns the profile as a single line of JSON, for writing to logs. */
+        String toJSON() const;
+    };
+
+    /** Enables measuring how long each node of the graph takes to render.
+
+        While enabled, the time spent in each node is taken with the high resolution
+        ticks timer and collected in a histogram per node. Blocks that take longer to render
+        than the audio they contain are counted as overruns, and attributed to the node that
+        took the most time in them, which makes it easy to find the nodes that cause dropouts.
+
+        This is cheap enough to be left on in production, but is off by default.
+        @see getRenderProfile
+    */
+    void setNodeProfilingEnabled (bool shouldBeEnabled) noexcept;
+
+    /** Returns true if node profiling is enabled, see setNodeProfilingEnabled(). */
+    bool isNodeProfilingEnabled() const noexcept;
+
+    /** Returns the processing times measured since node profiling was enabled or last reset.
+
+        This reads the measurements without blocking the audio thread, so while the graph is
+        rendering, the numbers may be off by the block being rendered.
+    */
+    RenderProfile getRenderProfile() const;
+
+    /** Discards all measurements taken so far.
+
+        The measurements are cleared by the audio thread with the next profiled block, but
+        getRenderProfile() returns an empty profile from now on until then.
+    */
+    void resetRenderProfile() noexcept;
+
     //==============================================================================
     /** A special type of AudioProcessor that can live inside an AudioProcessorGraph
         in order to use the audio that comes into and out of the graph itself.
@@ -427,11 +547,27 @@ private:
 
     struct RenderSequenceFloat;
     struct RenderSequenceDouble;
-    std::unique_ptr<RenderSequenceFloat> renderSequenceFloat;
-    std::unique_ptr<RenderSequenceDouble> renderSequenceDouble;
+    struct RenderSequences;
+    std::unique_ptr<RenderSequences> renderSequences;
+
+    // The audio thread renders the published sequences, and announces when it is rendering,
+    // so that the message thread can replace them without taking the callback lock.
+    std::atomic<RenderSequences*> publishedRenderSequences { nullptr };
+    RenderSequences* renderingSequences = nullptr;
+    std::atomic<bool> isRendering { false };
+    std::atomic<uint32> numBlocksRendered { 0 };
+
+    struct RenderOrder;
+    std::unique_ptr<RenderOrder> renderOrder;
 
     PrepareSettings prepareSettings;
 
+    struct ParallelRenderPool;
+    std::unique_ptr<ParallelRenderPool> parallelRenderPool;
+
+    struct RenderProfiler;
+    std::unique_ptr<RenderProfiler> renderProfiler;
+
     friend class AudioGraphIOProcessor;
 
     std::atomic<bool> isPrepared { false };
@@ -441,9 +577,11 @@ private:
     void handleAsyncUpdate() override;
     void clearRenderingSequence();
     void buildRenderingSequence();
+    void publishRenderSequences (std::unique_ptr<RenderSequences>);
+    template <typename FloatType>
+    void processBlockForBuffer (AudioBuffer<FloatType>&, MidiBuffer&);
     bool anyNodesNeedPreparing() const noexcept;
     bool isConnected (Node* src, int sourceChannel, Node* dest, int destChannel) const noexcept;
-    bool isAnInputTo (Node& src, Node& dst, int recursionCheck) const noexcept;
     bool canConnect (Node* src, int sourceChannel, Node* dest, int destChannel) const noexcept;
     bool isLegal (Node* src, int sourceChannel, Node* dest, int destChannel) const noexcept;
     static void getNodeConnections (Node&, std::vector<Connection>&);
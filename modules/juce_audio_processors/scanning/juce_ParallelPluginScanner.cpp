@@ -0,0 +1,395 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 6 End-User License
+   Agreement and JUCE Privacy Policy (both effective as of the 16th June 2020).
+
+   End User License Agreement: www.juce.com/juce-6-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+// The scanner sends <SCAN format="..." identifier="..."/> for each file, and the
+// worker replies with <RESULT identifier="..."> containing the types it has found.
+static MemoryBlock pluginScanMessageToMemoryBlock (const XmlElement& xml)
+{
+    auto text = xml.toString (XmlElement::TextFormat().singleLine().withoutHeader());
+    return { text.toRawUTF8(), text.getNumBytesAsUTF8() };
+}
+
+//==============================================================================
+struct ParallelPluginScanner::Worker  : public ChildProcessMaster
+{
+    enum class State
+    {
+        idle,
+        scanning,
+        finished,
+        lost
+    };
+
+    Worker (ParallelPluginScanner& s)  : owner (s) {}
+
+    ~Worker() override
+    {
+        killSlaveProcess();
+    }
+
+    bool launch()
+    {
+        // The workers' output is discarded, so that they can't block on a full pipe..
+        running = launchSlaveProcess (owner.workerExecutable, owner.commandLineUniqueID, 0, 0);
+        return running;
+    }
+
+    void kill()
+    {
+        // A worker that has hung won't react to the kill message..
+        terminateSlaveProcess();
+
+        const ScopedLock sl (lock);
+        running = false;
+        state = State::idle;
+    }
+
+    bool startScanning (int index, const String& file)
+    {
+        {
+            const ScopedLock sl (lock);
+            state = State::scanning;
+            fileIndex = index;
+            fileOrIdentifier = file;
+            startTime = Time::getMillisecondCounter();
+            typesFound.clear();
+        }
+
+        XmlElement message ("SCAN");
+        message.setAttribute ("format", owner.format.getName());
+        message.setAttribute ("identifier", file);
+
+        return sendMessageToSlave (pluginScanMessageToMemoryBlock (message));
+    }
+
+    State getState (bool& hasTimedOut)
+    {
+        const ScopedLock sl (lock);
+
+        // The connection may take a long time to notice that the worker has crashed..
+        if (state == State::scanning && ! isSlaveProcessRunning())
+            state = State::lost;
+
+        hasTimedOut = (state == State::scanning
+                        && Time::getMillisecondCounter() - startTime > (uint32) owner.scanTimeoutMs);
+        return state;
+    }
+
+    bool isRunning() const
+    {
+        const ScopedLock sl (lock);
+        return running && isSlaveProcessRunning();
+    }
+
+    void handleMessageFromSlave (const MemoryBlock& mb) override
+    {
+        auto xml = parseXML (mb.toString());
+
+        if (xml == nullptr || ! xml->hasTagName ("RESULT"))
+            return;
+
+        const ScopedLock sl (lock);
+
+        if (state != State::scanning || xml->getStringAttribute ("identifier") != fileOrIdentifier)
+            return;
+
+        forEachXmlChildElement (*xml, e)
+        {
+            PluginDescription desc;
+
+            if (desc.loadFromXml (*e))
+                typesFound.add (new PluginDescription (desc));
+        }
+
+        state = State::finished;
+        owner.workerStateChanged.signal();
+    }
+
+    void handleConnectionLost() override
+    {
+        const ScopedLock sl (lock);
+        running = false;
+
+        if (state == State::scanning)
+            state = State::lost;
+
+        owner.workerStateChanged.signal();
+    }
+
+    ParallelPluginScanner& owner;
+    CriticalSection lock;
+    State state = State::idle;
+    bool running = false;
+    int fileIndex = -1;
+    String fileOrIdentifier;
+    uint32 startTime = 0;
+    OwnedArray<PluginDescription> typesFound;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Worker)
+};
+
+//==============================================================================
+ParallelPluginScanner::ParallelPluginScanner (KnownPluginList& listToAddTo,
+                                              AudioPluginFormat& formatToLookFor,
+                                              const File& executable,
+                                              const String& uniqueID,
+                                              int numWorkers,
+                                              PluginScanCache* cacheToUse)
+    : list (listToAddTo),
+      format (formatToLookFor),
+      workerExecutable (executable),
+      commandLineUniqueID (uniqueID),
+      maxNumWorkers (jmax (1, numWorkers)),
+      cache (cacheToUse)
+{
+}
+
+ParallelPluginScanner::~ParallelPluginScanner()
+{
+    list.scanFinished();
+}
+
+//==============================================================================
+bool ParallelPluginScanner::scanDirectories (FileSearchPath directoriesToSearch,
+                                             bool recursive,
+                                             bool dontRescanIfAlreadyInList,
+                                             bool allowAsync)
+{
+    directoriesToSearch.removeRedundantPaths();
+    return scanFiles (format.searchPathsForPlugins (directoriesToSearch, recursive, allowAsync),
+                      dontRescanIfAlreadyInList);
+}
+
+bool ParallelPluginScanner::scanFiles (const StringArray& files, bool dontRescanIfAlreadyInList)
+{
+    std::vector<FileScanResult> results ((size_t) files.size(), FileScanResult::skipped);
+    std::vector<OwnedArray<PluginDescription>> typesFound ((size_t) files.size());
+    std::vector<int> numAttempts ((size_t) files.size(), 0);
+    Array<int> filesToScan;
+
+    failedFiles.clear();
+    crashedFiles.clear();
+    numFilesScanned = 0;
+    progress = 0.0f;
+
+    for (int i = 0; i < files.size(); ++i)
+    {
+        auto& file = files[i];
+
+        if (file.isEmpty()
+             || list.getBlacklistedFiles().contains (file)
+             || (dontRescanIfAlreadyInList && list.isListingUpToDate (file, format)))
+            continue;
+
+        bool wasCrashed = false;
+
+        if (dontRescanIfAlreadyInList && cache != nullptr
+             && cache->getCachedResults (format.getName(), file, typesFound[(size_t) i], wasCrashed))
+        {
+            results[(size_t) i] = wasCrashed ? FileScanResult::crashed
+                                             : (typesFound[(size_t) i].isEmpty() ? FileScanResult::failed : FileScanResult::found);
+            continue;
+        }
+
+        results[(size_t) i] = FileScanResult::pending;
+        filesToScan.add (i);
+    }
+
+    OwnedArray<Worker> workers;
+
+    for (int i = jmin (maxNumWorkers, filesToScan.size()); --i >= 0;)
+        workers.add (new Worker (*this));
+
+    const int numToScan = filesToScan.size();
+    int numStarted = 0;
+    bool completed = true;
+
+    while (numFilesScanned < numToScan)
+    {
+        if (Thread::currentThreadShouldExit() || workers.isEmpty())
+        {
+            completed = false;
+            break;
+        }
+
+        for (int w = workers.size(); --w >= 0;)
+        {
+            auto& worker = *workers.getUnchecked (w);
+            bool hasTimedOut = false;
+            auto state = worker.getState (hasTimedOut);
+
+            if (state == Worker::State::finished || state == Worker::State::lost || hasTimedOut)
+            {
+                auto index = (size_t) worker.fileIndex;
+
+                if (state == Worker::State::finished)
+                {
+                    typesFound[index].swapWith (worker.typesFound);
+                    results[index] = typesFound[index].isEmpty() ? FileScanResult::failed : FileScanResult::found;
+
+                    if (cache != nullptr)
+                        cache->setResults (format.getName(), files[(int) index], typesFound[index]);
+
+                    const ScopedLock sl (worker.lock);
+                    worker.state = Worker::State::idle;
+                }
+                else
+                {
+                    // The worker has crashed or hung, so it will be relaunched for the next file..
+                    worker.kill();
+
+                    // A worker can die for reasons that have nothing to do with the file it was
+                    // scanning, so a file that crashes is given a second chance before it's blacklisted..
+                    if (! hasTimedOut && numAttempts[index] < 2)
+                    {
+                        filesToScan.add ((int) index);
+                        results[index] = FileScanResult::pending;
+                    }
+                    else
+                    {
+                        results[index] = FileScanResult::crashed;
+
+                        if (cache != nullptr)
+                            cache->setCrashed (format.getName(), files[(int) index]);
+                    }
+                }
+
+                if (results[index] != FileScanResult::pending)
+                {
+                    ++numFilesScanned;
+                    progress = (float) numFilesScanned / (float) numToScan;
+
+                    if (onFileScanned != nullptr)
+                        onFileScanned (files[(int) index]);
+                }
+            }
+
+            if (numStarted < filesToScan.size() && worker.getState (hasTimedOut) == Worker::State::idle)
+            {
+                auto index = filesToScan.getUnchecked (numStarted);
+
+                if ((worker.isRunning() || worker.launch()) && worker.startScanning (index, files[index]))
+                {
+                    ++numAttempts[(size_t) index];
+                    ++numStarted;
+                }
+                else
+                {
+                    // This worker can't be launched, so leave its files to the others..
+                    jassertfalse;
+                    workers.remove (w);
+                }
+            }
+        }
+
+        workerStateChanged.wait (100);
+    }
+
+    workers.clear();
+
+    for (int i = 0; i < files.size(); ++i)
+    {
+        switch (results[(size_t) i])
+        {
+            case FileScanResult::found:
+                for (auto* desc : typesFound[(size_t) i])
+                    list.addType (*desc);
+                break;
+
+            case FileScanResult::failed:
+                failedFiles.add (files[i]);
+                break;
+
+            case FileScanResult::crashed:
+                list.addToBlacklist (files[i]);
+                crashedFiles.add (files[i]);
+                break;
+
+            case FileScanResult::skipped:
+            case FileScanResult::pending:
+            default:
+                break;
+        }
+    }
+
+    if (cache != nullptr)
+        cache->save();
+
+    return completed;
+}
+
+//==============================================================================
+PluginScanWorker::PluginScanWorker (AudioPluginFormatManager& formats)
+    : formatManager (formats)
+{
+}
+
+PluginScanWorker::~PluginScanWorker() {}
+
+void PluginScanWorker::handleMessageFromMaster (const MemoryBlock& mb)
+{
+    auto xml = parseXML (mb.toString());
+
+    if (xml == nullptr || ! xml->hasTagName ("SCAN"))
+        return;
+
+    auto formatName = xml->getStringAttribute ("format");
+    auto fileOrIdentifier = xml->getStringAttribute ("identifier");
+
+    // Many plugins expect to be loaded on the message thread..
+    MessageManager::callAsync ([this, formatName, fileOrIdentifier] { scanFile (formatName, fileOrIdentifier); });
+}
+
+void PluginScanWorker::scanFile (const String& formatName, const String& fileOrIdentifier)
+{
+    XmlElement reply ("RESULT");
+    reply.setAttribute ("identifier", fileOrIdentifier);
+
+    for (auto* format : formatManager.getFormats())
+    {
+        if (format->getName() == formatName)
+        {
+            OwnedArray<PluginDescription> found;
+            format->findAllTypesForFile (found, fileOrIdentifier);
+
+            for (auto* desc : found)
+                reply.addChildElement (desc->createXml().release());
+
+            break;
+        }
+    }
+
+    sendMessageToMaster (pluginScanMessageToMemoryBlock (reply));
+}
+
+void PluginScanWorker::handleConnectionLost()
+{
+    MessageManager::getInstance()->stopDispatchLoop();
+}
+
+} // namespace juce
@@ -0,0 +1,210 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 6 End-User License
+   Agreement and JUCE Privacy Policy (both effective as of the 16th June 2020).
+
+   End User License Agreement: www.juce.com/juce-6-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Scans plugins in a number of child processes at once, and adds them to a KnownPluginList.
+
+    Unlike PluginDirectoryScanner, which loads one plugin after the other into the
+    calling process, this hands the files out to a pool of worker processes. A plugin
+    that crashes or hangs while being scanned only takes down the worker that was
+    scanning it, which is then relaunched to carry on with the remaining files, and the
+    plugin is added to the list's blacklist. A plugin that crashes is tried once more
+    before it gets blacklisted, in case its worker died for some other reason. There's
+    no need for a dead-man's-pedal file.
+
+    The workers are launched from an executable that creates a PluginScanWorker when it
+    is started with the matching command line, which is typically the host itself, e.g.
+
+    @code
+    void initialise (const String& commandLine) override
+    {
+        auto worker = std::make_unique<PluginScanWorker> (formatManager);
+
+        if (worker->initialiseFromCommandLine (commandLine, "pluginscanworker"))
+        {
+            scanWorker = std::move (worker);  // the worker quits the app when the scan has finished
+            return;
+        }
+
+        // carry on with the normal start-up..
+    }
+    @endcode
+
+    The types found are added to the list in the order of the files that were scanned,
+    so the list ends up the same no matter which worker finishes first. If a PluginScanCache
+    is used, files that haven't changed since their results were cached aren't loaded at all.
+
+    @see PluginDirectoryScanner, PluginScanWorker, PluginScanCache
+
+    @tags{Audio}
+*/
+class JUCE_API  ParallelPluginScanner
+{
+public:
+    //==============================================================================
+    /**
+        Creates a scanner.
+
+        @param listToAddResultsTo       this will get the new types added to it.
+        @param formatToLookFor          the format to scan for. The worker processes must have
+                                        a format with the same name in their AudioPluginFormatManager.
+        @param workerExecutable         the executable to launch the workers from
+        @param commandLineUniqueID      the ID that the workers pass to
+                                        ChildProcessSlave::initialiseFromCommandLine()
+        @param numWorkers               the maximum number of worker processes to run at once
+        @param cacheToUse               if this isn't nullptr, the results of each file are stored
+                                        in it, and files whose cached results are still up-to-date
+                                        aren't rescanned. The cache is saved after each scan, and
+                                        must outlive the scanner.
+    */
+    ParallelPluginScanner (KnownPluginList& listToAddResultsTo,
+                           AudioPluginFormat& formatToLookFor,
+                           const File& workerExecutable,
+                           const String& commandLineUniqueID,
+                           int numWorkers = SystemStats::getNumCpus(),
+                           PluginScanCache* cacheToUse = nullptr);
+
+    /** Destructor. */
+    ~ParallelPluginScanner();
+
+    //==============================================================================
+    /** Searches the given directories for plugins of the scanner's format and scans them.
+        @see scanFiles, AudioPluginFormat::searchPathsForPlugins
+    */
+    bool scanDirectories (FileSearchPath directoriesToSearch,
+                          bool searchRecursively,
+                          bool dontRescanIfAlreadyInList,
+                          bool allowPluginsWhichRequireAsynchronousInstantiation = false);
+
+    /** Scans the given files or identifiers, blocking until all of them have been scanned.
+
+        If dontRescanIfAlreadyInList is true, files that are already in the list and
+        don't need rescanning are skipped, as are files whose results in the cache are
+        still up-to-date. If it is false, all files are loaded again, and the cache is
+        only updated.
+
+        If this is called on a Thread, the scan stops early when the thread is asked
+        to exit, in which case the remaining files are left unscanned.
+
+        Returns false if no worker process could be launched, or if the scan was stopped.
+    */
+    bool scanFiles (const StringArray& filesOrIdentifiersToScan,
+                    bool dontRescanIfAlreadyInList);
+
+    /** Sets how long a worker may spend on a single file before the file is considered
+        to have hung and the worker is killed. The default is one minute.
+    */
+    void setScanTimeout (int milliseconds) noexcept         { scanTimeoutMs = milliseconds; }
+
+    /** Called on the scanning thread whenever a worker has finished with a file. */
+    std::function<void (const String& fileOrIdentifier)> onFileScanned;
+
+    //==============================================================================
+    /** Returns the estimated progress of the current scan, between 0 and 1.
+        This can be called from any thread.
+    */
+    float getProgress() const noexcept                      { return progress; }
+
+    /** Returns the files of the last scan that looked like plugins, but which failed to open. */
+    const StringArray& getFailedFiles() const noexcept      { return failedFiles; }
+
+    /** Returns the files of the last scan that crashed or hung, and were added to the blacklist. */
+    const StringArray& getCrashedFiles() const noexcept     { return crashedFiles; }
+
+    /** Returns the number of files that were loaded by the workers during the last scan,
+        i.e. not counting those which were up-to-date in the list or in the cache.
+    */
+    int getNumFilesScanned() const noexcept                 { return numFilesScanned; }
+
+private:
+    //==============================================================================
+    struct Worker;
+
+    // the state of each file during scanFiles()
+    enum class FileScanResult
+    {
+        skipped,
+        pending,
+        found,
+        failed,
+        crashed
+    };
+
+    KnownPluginList& list;
+    AudioPluginFormat& format;
+    const File workerExecutable;
+    const String commandLineUniqueID;
+    const int maxNumWorkers;
+    PluginScanCache* cache;
+    int scanTimeoutMs = 60000;
+
+    WaitableEvent workerStateChanged;
+    StringArray failedFiles, crashedFiles;
+    std::atomic<float> progress { 0.0f };
+    int numFilesScanned = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParallelPluginScanner)
+};
+
+//==============================================================================
+/**
+    Scans plugins on behalf of a ParallelPluginScanner in a child process.
+
+    Create one of these in the executable that the scanner launches, and call
+    initialiseFromCommandLine() with the command-line ID that was given to the scanner,
+    see ParallelPluginScanner for an example. The files are scanned on the message thread,
+    so the process must run its message loop, which is stopped when the scanner disconnects.
+
+    If a file hangs, the scanner kills the process, since its message loop won't return.
+
+    @tags{Audio}
+*/
+class JUCE_API  PluginScanWorker  : public ChildProcessSlave
+{
+public:
+    /** Creates a worker that scans with the formats of the given manager, which must outlive the worker. */
+    explicit PluginScanWorker (AudioPluginFormatManager& formatsToScanWith);
+
+    /** Destructor. */
+    ~PluginScanWorker() override;
+
+    /** @internal */
+    void handleMessageFromMaster (const MemoryBlock&) override;
+    /** @internal */
+    void handleConnectionLost() override;
+
+private:
+    void scanFile (const String& formatName, const String& fileOrIdentifier);
+
+    AudioPluginFormatManager& formatManager;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginScanWorker)
+};
+
+} // namespace juce
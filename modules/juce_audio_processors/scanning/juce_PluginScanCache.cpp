@@ -0,0 +1,337 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 6 End-User License
+   Agreement and JUCE Privacy Policy (both effective as of the 16th June 2020).
+
+   End User License Agreement: www.juce.com/juce-6-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+static String getPluginScanCacheKey (const String& formatName, const String& fileOrIdentifier)
+{
+    return formatName + ":" + fileOrIdentifier;
+}
+
+PluginScanCache::PluginScanCache (const File& cacheFile)  : file (cacheFile)
+{
+    reload();
+}
+
+PluginScanCache::~PluginScanCache() {}
+
+//==============================================================================
+bool PluginScanCache::getFileState (const String& fileOrIdentifier, FileState& result)
+{
+    if (! File::isAbsolutePath (fileOrIdentifier))
+        return false;
+
+    File f (fileOrIdentifier);
+
+    if (f.existsAsFile())
+    {
+        result.size = f.getSize();
+        result.lastModified = f.getLastModificationTime().toMilliseconds();
+        return true;
+    }
+
+    if (f.isDirectory())
+    {
+        // Replacing or removing anything inside a bundle changes the size of its files
+        // or the modification time of the directory that contained it..
+        result.size = 0;
+        result.lastModified = f.getLastModificationTime().toMilliseconds();
+
+        for (auto& child : f.findChildFiles (File::findFilesAndDirectories, true))
+        {
+            if (! child.isDirectory())
+                result.size += child.getSize();
+
+            result.lastModified = jmax (result.lastModified, child.getLastModificationTime().toMilliseconds());
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+bool PluginScanCache::getCachedResults (const String& formatName,
+                                        const String& fileOrIdentifier,
+                                        OwnedArray<PluginDescription>& typesFound,
+                                        bool& wasCrashed) const
+{
+    auto it = entries.find (getPluginScanCacheKey (formatName, fileOrIdentifier));
+
+    if (it == entries.end())
+        return false;
+
+    FileState state;
+
+    if (! getFileState (fileOrIdentifier, state) || ! (state == it->second.state))
+        return false;
+
+    for (auto& type : it->second.types)
+        typesFound.add (new PluginDescription (type));
+
+    wasCrashed = it->second.crashed;
+    return true;
+}
+
+void PluginScanCache::setEntry (Entry entry)
+{
+    if (getFileState (entry.fileOrIdentifier, entry.state))
+    {
+        auto key = getPluginScanCacheKey (entry.formatName, entry.fileOrIdentifier);
+        entries[key] = std::move (entry);
+    }
+}
+
+void PluginScanCache::setResults (const String& formatName,
+                                  const String& fileOrIdentifier,
+                                  const OwnedArray<PluginDescription>& typesFound)
+{
+    Entry entry;
+    entry.formatName = formatName;
+    entry.fileOrIdentifier = fileOrIdentifier;
+
+    for (auto* type : typesFound)
+        entry.types.add (*type);
+
+    setEntry (std::move (entry));
+}
+
+void PluginScanCache::setCrashed (const String& formatName,
+                                  const String& fileOrIdentifier)
+{
+    Entry entry;
+    entry.formatName = formatName;
+    entry.fileOrIdentifier = fileOrIdentifier;
+    entry.crashed = true;
+
+    setEntry (std::move (entry));
+}
+
+void PluginScanCache::remove (const String& formatName, const String& fileOrIdentifier)
+{
+    entries.erase (getPluginScanCacheKey (formatName, fileOrIdentifier));
+}
+
+void PluginScanCache::clear()
+{
+    entries.clear();
+}
+
+//==============================================================================
+bool PluginScanCache::save() const
+{
+    XmlElement xml ("PLUGINSCANCACHE");
+
+    for (auto& item : entries)
+    {
+        auto& entry = item.second;
+
+        if (! File (entry.fileOrIdentifier).exists())
+            continue;
+
+        auto* e = xml.createNewChildElement ("ENTRY");
+        e->setAttribute ("format", entry.formatName);
+        e->setAttribute ("file", entry.fileOrIdentifier);
+        e->setAttribute ("size", String (entry.state.size));
+        e->setAttribute ("modified", String::toHexString (entry.state.lastModified));
+
+        if (entry.crashed)
+            e->setAttribute ("crashed", true);
+
+        for (auto& type : entry.types)
+            e->addChildElement (type.createXml().release());
+    }
+
+    return xml.writeTo (file);
+}
+
+void PluginScanCache::reload()
+{
+    entries.clear();
+
+    if (auto xml = parseXML (file))
+    {
+        if (xml->hasTagName ("PLUGINSCANCACHE"))
+        {
+            forEachXmlChildElementWithTagName (*xml, e, "ENTRY")
+            {
+                Entry entry;
+                entry.formatName = e->getStringAttribute ("format");
+                entry.fileOrIdentifier = e->getStringAttribute ("file");
+                entry.state.size = e->getStringAttribute ("size").getLargeIntValue();
+                entry.state.lastModified = e->getStringAttribute ("modified").getHexValue64();
+                entry.crashed = e->getBoolAttribute ("crashed");
+
+                forEachXmlChildElement (*e, typeXml)
+                {
+                    PluginDescription type;
+
+                    if (type.loadFromXml (*typeXml))
+                        entry.types.add (type);
+                }
+
+                auto key = getPluginScanCacheKey (entry.formatName, entry.fileOrIdentifier);
+                entries[key] = std::move (entry);
+            }
+        }
+    }
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class PluginScanCacheTests  : public UnitTest
+{
+public:
+    PluginScanCacheTests()
+        : UnitTest ("PluginScanCache", UnitTestCategories::audio)
+    {}
+
+    void runTest() override
+    {
+        auto dir = File::getSpecialLocation (File::tempDirectory).getNonexistentChildFile ("PluginScanCacheTests", {});
+        dir.createDirectory();
+
+        auto cacheFile = dir.getChildFile ("cache.xml");
+        auto plugin = dir.getChildFile ("Plugin.so");
+        auto bundle = dir.getChildFile ("Plugin.vst3");
+        auto bundleBinary = bundle.getChildFile ("Contents").getChildFile ("x86_64-linux").getChildFile ("Plugin.so");
+
+        plugin.replaceWithText ("plugin");
+        bundleBinary.getParentDirectory().createDirectory();
+        bundleBinary.replaceWithText ("bundle");
+
+        const auto modificationTime = Time::getCurrentTime() - RelativeTime::hours (1);
+
+        for (auto& f : { plugin, bundle, bundleBinary, bundleBinary.getParentDirectory(), bundleBinary.getParentDirectory().getParentDirectory() })
+            f.setLastModificationTime (modificationTime);
+
+        beginTest ("Unchanged files return their cached results");
+        {
+            PluginScanCache cache (cacheFile);
+            expectEquals (cache.getNumEntries(), 0);
+
+            cache.setResults ("LADSPA", plugin.getFullPathName(), createTypes (plugin, 2));
+            cache.setCrashed ("VST3", bundle.getFullPathName());
+            cache.setResults ("LADSPA", "not a file", createTypes (plugin, 1));
+            expectEquals (cache.getNumEntries(), 2);
+
+            expectCached (cache, "LADSPA", plugin, 2, false);
+            expectCached (cache, "VST3", bundle, 0, true);
+            expectNotCached (cache, "VST3", plugin);
+        }
+
+        beginTest ("Saved results are restored");
+        {
+            PluginScanCache cache (cacheFile);
+            expectEquals (cache.getNumEntries(), 0);
+
+            cache.setResults ("LADSPA", plugin.getFullPathName(), createTypes (plugin, 2));
+            cache.setCrashed ("VST3", bundle.getFullPathName());
+            expect (cache.save());
+
+            PluginScanCache restored (cacheFile);
+            expectEquals (restored.getNumEntries(), 2);
+
+            OwnedArray<PluginDescription> types;
+            bool crashed = true;
+            expect (restored.getCachedResults ("LADSPA", plugin.getFullPathName(), types, crashed));
+            expect (! crashed);
+            expectEquals (types.size(), 2);
+            expectEquals (types[1]->name, String ("Plugin 1"));
+            expectEquals (types[1]->uid, 1);
+
+            expectCached (restored, "VST3", bundle, 0, true);
+        }
+
+        beginTest ("Changing a file or the contents of a bundle invalidates its entry");
+        {
+            PluginScanCache cache (cacheFile);
+            expectEquals (cache.getNumEntries(), 2);
+
+            plugin.setLastModificationTime (modificationTime + RelativeTime::seconds (10));
+            expectNotCached (cache, "LADSPA", plugin);
+
+            bundleBinary.replaceWithText ("a larger bundle");
+            bundleBinary.setLastModificationTime (modificationTime);
+            expectNotCached (cache, "VST3", bundle);
+
+            cache.setResults ("VST3", bundle.getFullPathName(), createTypes (bundle, 1));
+            expectCached (cache, "VST3", bundle, 1, false);
+        }
+
+        beginTest ("Entries of files that no longer exist are not saved");
+        {
+            PluginScanCache cache (cacheFile);
+            plugin.deleteFile();
+            expect (cache.save());
+
+            PluginScanCache restored (cacheFile);
+            expectEquals (restored.getNumEntries(), 1);
+        }
+
+        dir.deleteRecursively();
+    }
+
+private:
+    static OwnedArray<PluginDescription> createTypes (const File& f, int numTypes)
+    {
+        OwnedArray<PluginDescription> types;
+
+        for (int i = 0; i < numTypes; ++i)
+        {
+            auto* type = types.add (new PluginDescription());
+            type->name = "Plugin " + String (i);
+            type->fileOrIdentifier = f.getFullPathName();
+            type->uid = i;
+        }
+
+        return types;
+    }
+
+    void expectCached (const PluginScanCache& cache, const String& formatName, const File& f, int numTypes, bool shouldBeCrashed)
+    {
+        OwnedArray<PluginDescription> types;
+        bool crashed = ! shouldBeCrashed;
+        expect (cache.getCachedResults (formatName, f.getFullPathName(), types, crashed));
+        expectEquals (types.size(), numTypes);
+        expect (crashed == shouldBeCrashed);
+    }
+
+    void expectNotCached (const PluginScanCache& cache, const String& formatName, const File& f)
+    {
+        OwnedArray<PluginDescription> types;
+        bool crashed = false;
+        expect (! cache.getCachedResults (formatName, f.getFullPathName(), types, crashed));
+        expect (types.isEmpty());
+    }
+};
+
+static PluginScanCacheTests pluginScanCacheTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 6 End-User License
+   Agreement and JUCE Privacy Policy (both effective as of the 16th June 2020).
+
+   End User License Agreement: www.juce.com/juce-6-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A persistent record of the results of scanning plug-in files, which lets a
+    rescan skip all files that haven't changed since they were last scanned.
+
+    Each entry stores the types found in a file by a particular format, or the fact
+    that the file crashed or hung while being scanned, along with the size and
+    modification time of the file. For bundles, such as VST3 or AU bundles, the size
+    of all files inside the bundle and the latest modification time of anything in it
+    are used instead, so that replacing the binary inside a bundle invalidates its entry.
+
+    Only identifiers that are absolute paths of existing files or bundles are cached,
+    since there's no way to tell whether other kinds of plug-in identifiers have changed.
+
+    The cache is not thread-safe.
+
+    @see ParallelPluginScanner
+    @tags{Audio}
+*/
+class JUCE_API  PluginScanCache
+{
+public:
+    //==============================================================================
+    /** Creates a cache that is stored in the given file, and loads any entries
+        that have previously been saved to it.
+    */
+    explicit PluginScanCache (const File& cacheFile);
+
+    /** Destructor. This doesn't save the cache, see save(). */
+    ~PluginScanCache();
+
+    //==============================================================================
+    /** Looks up the results of a previous scan of a file.
+
+        Returns true if the file has been scanned by the given format before and hasn't
+        changed since, in which case the types that were found are added to typesFound,
+        and wasCrashed is set if the file crashed or hung while being scanned.
+    */
+    bool getCachedResults (const String& formatName,
+                           const String& fileOrIdentifier,
+                           OwnedArray<PluginDescription>& typesFound,
+                           bool& wasCrashed) const;
+
+    /** Records the types that a format has found in a file. */
+    void setResults (const String& formatName,
+                     const String& fileOrIdentifier,
+                     const OwnedArray<PluginDescription>& typesFound);
+
+    /** Records that a file crashed or hung while being scanned by a format. */
+    void setCrashed (const String& formatName,
+                     const String& fileOrIdentifier);
+
+    /** Removes the entry for a file, so that it will be scanned again. */
+    void remove (const String& formatName,
+                 const String& fileOrIdentifier);
+
+    /** Removes all entries. */
+    void clear();
+
+    /** Returns the number of files in the cache. */
+    int getNumEntries() const noexcept                   { return (int) entries.size(); }
+
+    //==============================================================================
+    /** Writes the cache to its file, leaving out entries of files that no longer exist.
+        Returns false if the file couldn't be written.
+    */
+    bool save() const;
+
+    /** Replaces the entries with the ones stored in the cache file. */
+    void reload();
+
+    /** Returns the file that the cache is stored in. */
+    const File& getFile() const noexcept                 { return file; }
+
+private:
+    //==============================================================================
+    struct FileState
+    {
+        int64 size = 0;
+        int64 lastModified = 0;
+
+        bool operator== (const FileState& other) const noexcept   { return size == other.size && lastModified == other.lastModified; }
+    };
+
+    struct Entry
+    {
+        String formatName, fileOrIdentifier;
+        FileState state;
+        bool crashed = false;
+        Array<PluginDescription> types;
+    };
+
+    static bool getFileState (const String& fileOrIdentifier, FileState& result);
+    void setEntry (Entry);
+
+    File file;
+    std::map<String, Entry> entries;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginScanCache)
+};
+
+} // namespace juce
@@ -82,11 +82,18 @@ private:
     using Listener = AudioProcessorValueTreeState::Listener;
 
 public:
-    explicit ParameterAdapter (RangedAudioParameter& parameterIn)
+    /*  Whenever the value of the parameter changes, the adapter adds itself to the given list of
+        adapters that need flushing to the tree, see flushParameterValuesToValueTree(). An adapter
+        starts out in the list, so that the initial value is written to the tree as well.
+    */
+    explicit ParameterAdapter (RangedAudioParameter& parameterIn,
+                               std::atomic<ParameterAdapter*>* changedAdaptersToUse = nullptr)
         : parameter (parameterIn),
+          changedAdapters (changedAdaptersToUse),
           // For legacy reasons, the unnormalised value should *not* be snapped on construction
           unnormalisedValue (getRange().convertFrom0to1 (parameter.getDefaultValue()))
     {
+        markAsChanged();
         parameter.addListener (this);
 
         if (auto* ptr = dynamic_cast<Parameter*> (&parameter))
@@ -126,13 +133,39 @@ public:
     float getDenormalisedValue() const                { return unnormalisedValue; }
     std::atomic<float>& getRawDenormalisedValue()     { return unnormalisedValue; }
 
-    bool flushToTree (const Identifier& key, UndoManager* um)
+    /*  Takes all adapters from the given list, and returns the one that changed first.
+        An adapter can only be added to a list while it isn't part of one, so the taken
+        adapters stay linked until they leave the list through leaveChangedAdapters().
+    */
+    static ParameterAdapter* takeChangedAdapters (std::atomic<ParameterAdapter*>& list) noexcept
     {
-        auto needsUpdateTestValue = true;
+        ParameterAdapter* first = nullptr;
+        auto* adapter = list.exchange (nullptr, std::memory_order_acquire);
 
-        if (! needsUpdate.compare_exchange_strong (needsUpdateTestValue, false))
-            return false;
+        // adapters are added at the head of the list, so it is reversed to flush them in order of change
+        while (adapter != nullptr)
+        {
+            auto* next = adapter->nextChangedAdapter;
+            adapter->nextChangedAdapter = first;
+            first = adapter;
+            adapter = next;
+        }
+
+        return first;
+    }
+
+    // Returns the next adapter of the list taken by takeChangedAdapters().
+    ParameterAdapter* leaveChangedAdapters() noexcept
+    {
+        auto* next = nextChangedAdapter;
+
+        // any change from now on adds the adapter to the list again, even while it is being flushed
+        needsUpdate = false;
+        return next;
+    }
 
+    void flushToTree (const Identifier& key, UndoManager* um)
+    {
         if (auto valueProperty = tree.getPropertyPointer (key))
         {
             if ((float) *valueProperty != unnormalisedValue)
@@ -145,8 +178,6 @@ public:
         {
             tree.setProperty (key, unnormalisedValue.load(), nullptr);
         }
-
-        return true;
     }
 
     ValueTree tree;
@@ -164,7 +195,22 @@ private:
         unnormalisedValue = newValue;
         listeners.call ([=] (Listener& l) { l.parameterChanged (parameter.paramID, unnormalisedValue); });
         listenersNeedCalling = false;
-        needsUpdate = true;
+        markAsChanged();
+    }
+
+    // Adds the adapter to the list of changed adapters without locking, so this can be called on the audio thread.
+    void markAsChanged() noexcept
+    {
+        if (needsUpdate.exchange (true) || changedAdapters == nullptr)
+            return;
+
+        auto* head = changedAdapters->load (std::memory_order_relaxed);
+
+        do
+        {
+            nextChangedAdapter = head;
+        }
+        while (! changedAdapters->compare_exchange_weak (head, this, std::memory_order_release, std::memory_order_relaxed));
     }
 
     float denormalise (float normalised) const
@@ -213,9 +259,11 @@ private:
     };
 
     RangedAudioParameter& parameter;
+    std::atomic<ParameterAdapter*>* const changedAdapters;
+    ParameterAdapter* nextChangedAdapter = nullptr;
     LockedListeners listeners;
     std::atomic<float> unnormalisedValue { 0.0f };
-    std::atomic<bool> needsUpdate { true }, listenersNeedCalling { true };
+    std::atomic<bool> needsUpdate { false }, listenersNeedCalling { true };
     bool ignoreParameterChangedCallbacks { false };
 };
 
@@ -338,7 +386,7 @@ RangedAudioParameter* AudioProcessorValueTreeState::createAndAddParameter (std::
 //==============================================================================
 void AudioProcessorValueTreeState::addParameterAdapter (RangedAudioParameter& param)
 {
-    adapterTable.emplace (param.paramID, std::make_unique<ParameterAdapter> (param));
+    adapterTable.emplace (param.paramID, std::make_unique<ParameterAdapter> (param, &changedAdapters));
 }
 
 AudioProcessorValueTreeState::ParameterAdapter* AudioProcessorValueTreeState::getParameterAdapter (StringRef paramID) const
@@ -465,12 +513,21 @@ void AudioProcessorValueTreeState::valueTreeRedirected (ValueTree& v)
 
 bool AudioProcessorValueTreeState::flushParameterValuesToValueTree()
 {
+    // only the adapters whose values have changed since the last flush are visited
+    if (changedAdapters.load (std::memory_order_relaxed) == nullptr)
+        return false;
+
     ScopedLock lock (valueTreeChanging);
 
-    bool anyUpdated = false;
+    auto* adapter = ParameterAdapter::takeChangedAdapters (changedAdapters);
+    const auto anyUpdated = adapter != nullptr;
 
-    for (auto& p : adapterTable)
-        anyUpdated |= p.second->flushToTree (valuePropertyID, undoManager);
+    while (adapter != nullptr)
+    {
+        auto* next = adapter->leaveChangedAdapters();
+        adapter->flushToTree (valuePropertyID, undoManager);
+        adapter = next;
+    }
 
     return anyUpdated;
 }
@@ -479,8 +536,12 @@ void AudioProcessorValueTreeState::timerCallback()
 {
     auto anythingUpdated = flushParameterValuesToValueTree();
 
-    startTimer (anythingUpdated ? 1000 / 50
-                                : jlimit (50, 500, getTimerInterval() + 20));
+    const auto interval = anythingUpdated ? 1000 / 50
+                                          : jlimit (50, 500, getTimerInterval() + 20);
+
+    // once idle, the timer keeps running at its longest interval without being rescheduled
+    if (interval != getTimerInterval())
+        startTimer (interval);
 }
 
 //==============================================================================
@@ -951,7 +1012,100 @@ public:
             expectEquals (listener.value, newValue);
             expectEquals (listener.id, String (key));
         }
+
+        beginTest ("Flushing the state only updates the parameters that have changed, in the order of change");
+        {
+            TestAudioProcessor proc (createFloatParameters (100));
+            proc.state.copyState();
+
+            PropertyChangeRecorder recorder;
+            proc.state.state.addListener (&recorder);
+
+            proc.state.getParameter ("p7")->setValueNotifyingHost (0.5f);
+            proc.state.getParameter ("p3")->setValueNotifyingHost (0.25f);
+            proc.state.getParameter ("p7")->setValueNotifyingHost (0.75f);
+            proc.state.copyState();
+
+            expect (recorder.ids == StringArray { "p7", "p3" });
+            expectEquals ((float) proc.state.state.getChildWithProperty ("id", "p7")["value"], 0.75f);
+
+            recorder.ids.clear();
+            proc.state.copyState();
+            expect (recorder.ids.isEmpty());
+
+            proc.state.state.removeListener (&recorder);
+        }
+
+        beginTest ("Parameter changes on other threads are flushed to the state");
+        {
+            const auto numParameters = 64;
+            TestAudioProcessor proc (createFloatParameters (numParameters));
+            proc.state.copyState();
+
+            OwnedArray<ParameterWriter> writers;
+
+            for (int i = 0; i < 4; ++i)
+                writers.add (new ParameterWriter (proc, i, 4))->startThread();
+
+            // flush concurrently with the writers, then once more after they are done
+            while (writers.getFirst()->isThreadRunning())
+                proc.state.copyState();
+
+            writers.clear();
+            const auto tree = proc.state.copyState();
+
+            for (int i = 0; i < numParameters; ++i)
+            {
+                const auto id = "p" + String (i);
+                const auto value = proc.state.getRawParameterValue (id)->load();
+                expectEquals ((float) tree.getChildWithProperty ("id", id)["value"], value);
+                expectEquals (value, (float) ((1000 + i) % 100) / 100.0f);
+            }
+        }
+    }
+
+private:
+    static ParameterLayout createFloatParameters (int numParameters)
+    {
+        ParameterLayout layout;
+
+        for (int i = 0; i < numParameters; ++i)
+            layout.add (std::make_unique<AudioParameterFloat> ("p" + String (i), "", NormalisableRange<float>(), 0.0f));
+
+        return layout;
     }
+
+    struct PropertyChangeRecorder final : public ValueTree::Listener
+    {
+        void valueTreePropertyChanged (ValueTree& tree, const Identifier&) override
+        {
+            ids.add (tree["id"].toString());
+        }
+
+        StringArray ids;
+    };
+
+    // Sets every numWriters-th parameter of the processor to a sequence of values
+    struct ParameterWriter final : public Thread
+    {
+        ParameterWriter (AudioProcessor& processorIn, int firstIndex, int numWriters)
+            : Thread ("Parameter writer"), processor (processorIn), first (firstIndex), step (numWriters)
+        {}
+
+        ~ParameterWriter() override     { stopThread (-1); }
+
+        void run() override
+        {
+            const auto& parameters = processor.getParameters();
+
+            for (int value = 1; value <= 1000; ++value)
+                for (int i = first; i < parameters.size(); i += step)
+                    parameters.getUnchecked (i)->setValueNotifyingHost ((float) ((value + i) % 100) / 100.0f);
+        }
+
+        AudioProcessor& processor;
+        const int first, step;
+    };
 };
 
 static AudioProcessorValueTreeStateTests audioProcessorValueTreeStateTests;
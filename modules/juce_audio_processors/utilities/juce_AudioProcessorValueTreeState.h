@@ -550,6 +550,9 @@ private:
 
     std::map<StringRef, std::unique_ptr<ParameterAdapter>, StringRefLessThan> adapterTable;
 
+    // the adapters whose values need flushing to the tree, see flushParameterValuesToValueTree()
+    std::atomic<ParameterAdapter*> changedAdapters { nullptr };
+
     CriticalSection valueTreeChanging;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioProcessorValueTreeState)
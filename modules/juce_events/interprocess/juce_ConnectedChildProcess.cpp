@@ -54,6 +54,14 @@ struct ChildProcessPingThread  : public Thread,
     void pingReceived() noexcept            { countdown = timeoutMs / 1000 + 1; }
     void triggerConnectionLostMessage()     { triggerAsyncUpdate(); }
 
+    void stopPingThread()
+    {
+        // wake the thread up from its wait, so that closing a connection doesn't block for up to a second
+        signalThreadShouldExit();
+        notify();
+        stopThread (10000);
+    }
+
     virtual bool sendPingMessage (const MemoryBlock&) = 0;
     virtual void pingFailed() = 0;
 
@@ -90,13 +98,15 @@ struct ChildProcessMaster::Connection  : public InterprocessConnection,
           ChildProcessPingThread (timeout),
           owner (m)
     {
-        if (createPipe (pipeName, timeoutMs))
-            startThread (4);
+        createPipe (pipeName, timeoutMs);
     }
 
+    // the pings can only be sent once the slave has opened its end of the pipe
+    void startPinging()     { startThread (4); }
+
     ~Connection() override
     {
-        stopThread (10000);
+        stopPingThread();
     }
 
 private:
@@ -149,21 +159,25 @@ bool ChildProcessMaster::launchSlaveProcess (const File& executable, const Strin
     args.add (executable.getFullPathName());
     args.add (getCommandLinePrefix (commandLineUniqueID) + pipeName);
 
-    childProcess.reset (new ChildProcess());
+    // the pipe has to exist before the child starts, as it only waits briefly for it to appear
+    connection.reset (new Connection (*this, pipeName, timeoutMs <= 0 ? defaultTimeoutMs : timeoutMs));
 
-    if (childProcess->start (args, streamFlags))
+    if (connection->isConnected())
     {
-        connection.reset (new Connection (*this, pipeName, timeoutMs <= 0 ? defaultTimeoutMs : timeoutMs));
+        childProcess.reset (new ChildProcess());
 
-        if (connection->isConnected())
+        if (childProcess->start (args, streamFlags)
+             && sendMessageToSlave ({ startMessage, specialMessageSize }))
         {
-            sendMessageToSlave ({ startMessage, specialMessageSize });
+            connection->startPinging();
             return true;
         }
 
-        connection.reset();
+        connection->disconnect();
+        childProcess.reset();
     }
 
+    connection.reset();
     return false;
 }
 
@@ -179,6 +193,20 @@ void ChildProcessMaster::killSlaveProcess()
     childProcess.reset();
 }
 
+bool ChildProcessMaster::isSlaveProcessRunning() const
+{
+    return childProcess != nullptr && childProcess->isRunning();
+}
+
+void ChildProcessMaster::terminateSlaveProcess()
+{
+    if (childProcess != nullptr && childProcess->isRunning())
+        if (childProcess->kill())
+            childProcess->waitForProcessToFinish (1000);
+
+    killSlaveProcess();
+}
+
 //==============================================================================
 struct ChildProcessSlave::Connection  : public InterprocessConnection,
                                         private ChildProcessPingThread
@@ -194,7 +222,7 @@ struct ChildProcessSlave::Connection  : public InterprocessConnection,
 
     ~Connection() override
     {
-        stopThread (10000);
+        stopPingThread();
     }
 
 private:
@@ -203,7 +231,8 @@ private:
     void connectionMade() override  {}
     void connectionLost() override  { owner.handleConnectionLost(); }
 
-    bool sendPingMessage (const MemoryBlock& m) override    { return owner.sendMessageToMaster (m); }
+    // the first ping can be sent before the owner has been given this connection
+    bool sendPingMessage (const MemoryBlock& m) override    { return sendMessage (m); }
     void pingFailed() override                              { connectionLost(); }
 
     void messageReceived (const MemoryBlock& m) override
@@ -171,6 +171,21 @@ public:
     */
     void killSlaveProcess();
 
+    /** Returns true if the slave process is still running.
+
+        A slave that has crashed isn't always noticed by the connection straight away,
+        so this can be used to find out about it sooner than handleConnectionLost().
+    */
+    bool isSlaveProcessRunning() const;
+
+    /** Kills the slave process without waiting for it to react to the kill message,
+        and disconnects from it.
+
+        This is for getting rid of a slave that has stopped responding, which
+        killSlaveProcess() can't do.
+    */
+    void terminateSlaveProcess();
+
     /** This will be called to deliver a message from the slave process.
         The call will probably be made on a background thread, so be careful with your thread-safety!
     */